@@ -30,34 +30,60 @@ void setupApiEndpoints(WebServer &srv) {
   });
 }
 
+void api_fill_sensor_channels(JsonDocument &doc, const ProcessSnapshot &snap) {
+  const SensorChannel* table = snap.channels;
+  const SensorReading* rd = snap.readings;
+  int count = snap.channelCount;
+
+  // t1/t2 = pierwsze dwie sondy komory - pola oczekiwane przez panel w chmurze
+  static const char* const chamberKeys[] = {"t1", "t2"};
+  int chamberIdx = 0;
+  JsonArray arr = doc.createNestedArray("ch");
+  for (int i = 0; i < count; i++) {
+    JsonObject o = arr.createNestedObject();
+    o["n"]  = table[i].name;
+    o["r"]  = sensors_role_name(table[i].role);
+    o["v"]  = rd[i].value;
+    o["ok"] = rd[i].valid;
+    if (table[i].role == (uint8_t)SensorRole::CHAMBER && chamberIdx < 2) {
+      doc[chamberKeys[chamberIdx++]] = rd[i].value;
+    }
+  }
+}
+
 void handleApiStatus() {
-  StaticJsonDocument<512> doc;
+  StaticJsonDocument<1024> doc;
+
+  // [FIX] Wcześniej g_* czytane bez state_lock (rozjechane pola) - teraz jedna migawka
+  static ProcessSnapshot snap;   // tylko taskWeb
+  state_snapshot_read(snap);
 
-  bool h1    = (ledcRead(PIN_SSR1) > 0);
-  bool h2    = (ledcRead(PIN_SSR2) > 0);
-  bool h3    = (ledcRead(PIN_SSR3) > 0);
+  double duty[3];
+  outputs_heater_duties(duty);   // [MOD] grzałki nie są już na LEDC
+  bool h1    = (duty[0] > 0);
+  bool h2    = (duty[1] > 0);
+  bool h3    = (duty[2] > 0);
   bool fanOn = (digitalRead(PIN_FAN) == HIGH);
 
-  doc["t1"]   = g_tChamber1;
-  doc["t2"]   = g_tChamber2;
-  doc["tc"]   = (g_tChamber1 + g_tChamber2) / 2.0;
-  doc["tm"]   = g_tMeat;
-  doc["ts"]   = g_tSet;
-  doc["ps"]   = processStateStr();
-  doc["cs"]   = g_currentStep;
-  doc["sc"]   = g_stepCount;
-  doc["sn"]   = (g_currentStep < g_stepCount) ? g_profile[g_currentStep].name : "";
+  api_fill_sensor_channels(doc, snap);
+  doc["tc"]   = snap.tChamber;
+  doc["tm"]   = snap.tMeat;
+  doc["ts"]   = snap.tSet;
+  doc["ps"]   = processStateStr(snap.state);
+  doc["cs"]   = snap.currentStep;
+  doc["sc"]   = snap.stepCount;
+  doc["sn"]   = snap.stepName;
   doc["str"]  = 0;
-  doc["tte"]  = (unsigned long)((millis() - g_processStartTime) / 1000);
-  doc["pm"]   = g_powerMode;
-  doc["fm"]   = g_fanMode;
-  doc["sp"]   = g_manualSmokePwm;
-  doc["do"]   = g_doorOpen;
+  doc["tte"]  = (unsigned long)((millis() - snap.processStartTime) / 1000);
+  doc["pm"]   = snap.powerMode;
+  doc["fm"]   = snap.fanMode;
+  doc["sp"]   = snap.manualSmokePwm;
+  doc["do"]   = snap.doorOpen;
   doc["h1"]   = h1;
   doc["h2"]   = h2;
   doc["h3"]   = h3;
   doc["fo"]   = fanOn;
-  doc["pid"]  = pidOutput;
+  doc["pid"]  = snap.pidOutput;
   doc["rssi"] = WiFi.RSSI();
   doc["ssid"] = WiFi.SSID();
   doc["fw"]   = FW_VERSION;
@@ -227,10 +253,7 @@ void handleApiCommand() {
       // Zastosuj natychmiast jeśli proces działa
       ProcessState st = g_currentState;
       if (st == ProcessState::RUNNING_MANUAL || st == ProcessState::RUNNING_AUTO) {
-        if (output_lock()) {
-          ledcWrite(PIN_SMOKE_FAN, pwm);
-          output_unlock();
-        }
+        outputs_set_smoke(pwm);
       }
       server.send(200, "application/json", "{\"ok\":true}");
     } else {
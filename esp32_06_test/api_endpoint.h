@@ -6,6 +6,9 @@
 #define API_ENDPOINT_H
 
 #include <WebServer.h>
+#include <ArduinoJson.h>
+
+struct ProcessSnapshot;
 
 // Dodaj to do setup() serwera WWW:
 // server.on("/api/status", HTTP_GET, handleApiStatus);
@@ -17,4 +20,9 @@ void handleApiCommand();
 
 void setupApiEndpoints(WebServer &server);
 
+// [NEW] Tablica kanałów czujników do JSON ("ch" + zgodne wstecz t1/t2)
+// - wspólne dla /api/status i telemetrii w chmurze
+// [MOD] Z migawki stanu (state_snapshot_read), bez osobnego state_lock
+void api_fill_sensor_channels(JsonDocument &doc, const ProcessSnapshot &snap);
+
 #endif
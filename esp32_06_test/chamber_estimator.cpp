@@ -0,0 +1,117 @@
+// chamber_estimator.cpp - Obserwator temperatury powietrza w komorze
+// [NEW] 3-stanowy filtr Kalmana (Ta, Tp, d), macierze 3x3 rozpisane ręcznie
+#include "chamber_estimator.h"
+#include <string.h>
+#include <math.h>
+
+// Domyślne parametry dobrane dla sondy w stalowej osłonie i komory ~150 l
+static constexpr float DEF_TAU_PROBE   = 45.0f;
+static constexpr float DEF_TAU_AIR     = 900.0f;
+static constexpr float DEF_HEATER_GAIN = 60.0f;
+static constexpr float DEF_AMBIENT     = 20.0f;
+static constexpr float DEF_Q_AIR       = 0.01f;
+static constexpr float DEF_Q_DIST      = 1e-6f;
+static constexpr float DEF_R_MEAS      = 0.04f;
+static constexpr float DEF_MAX_DEV     = 15.0f;
+
+static constexpr float MAX_SUBSTEP_S   = 0.5f;    // max krok dyskretyzacji
+static constexpr float Q_PROBE         = 1e-4f;   // model sondy jest prawie dokładny
+
+void chamber_est_reset(EstimatorState& st) {
+    memset(&st, 0, sizeof(st));
+}
+
+static void predictStep(const EstimatorConfig& cfg, EstimatorState& st,
+                        float u, float ambient, float dt) {
+    const float a = dt / cfg.tauAir;
+    const float b = dt / cfg.tauProbe;
+
+    // x = F x + B
+    //     | 1-a  0    dt |
+    // F = | b    1-b  0  |
+    //     | 0    0    1  |
+    float ta = st.x[EST_AIR], tp = st.x[EST_PROBE], d = st.x[EST_DIST];
+    st.x[EST_AIR]   = ta + a * (ambient + cfg.heaterGain * u - ta) + dt * d;
+    st.x[EST_PROBE] = tp + b * (ta - tp);
+
+    // P = F P F^T + Q
+    const float F[3][3] = {
+        { 1.0f - a, 0.0f,     dt   },
+        { b,        1.0f - b, 0.0f },
+        { 0.0f,     0.0f,     1.0f }
+    };
+    float FP[3][3];
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            FP[i][j] = F[i][0] * st.P[0][j] + F[i][1] * st.P[1][j] + F[i][2] * st.P[2][j];
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            st.P[i][j] = FP[i][0] * F[j][0] + FP[i][1] * F[j][1] + FP[i][2] * F[j][2];
+
+    st.P[EST_AIR][EST_AIR]     += cfg.qAir * dt;
+    st.P[EST_PROBE][EST_PROBE] += Q_PROBE * dt;
+    st.P[EST_DIST][EST_DIST]   += cfg.qDist * dt;
+}
+
+void chamber_est_predict(const EstimatorConfig& cfg, EstimatorState& st,
+                         float u, float ambient, float dt) {
+    if (!st.init || !(dt > 0.0f)) return;
+    while (dt > 0.0f) {
+        float h = dt > MAX_SUBSTEP_S ? MAX_SUBSTEP_S : dt;
+        predictStep(cfg, st, u, ambient, h);
+        dt -= h;
+    }
+}
+
+void chamber_est_correct(const EstimatorConfig& cfg, EstimatorState& st, float y) {
+    if (!st.init) {
+        chamber_est_reset(st);
+        st.x[EST_AIR]   = y;
+        st.x[EST_PROBE] = y;
+        st.P[EST_AIR][EST_AIR]     = 4.0f;
+        st.P[EST_PROBE][EST_PROBE] = cfg.rMeas;
+        st.P[EST_DIST][EST_DIST]   = 1e-4f;
+        st.init = true;
+        return;
+    }
+
+    // H = [0 1 0] -> S = P11 + R, K = P[:,1] / S
+    float s = st.P[EST_PROBE][EST_PROBE] + cfg.rMeas;
+    if (!(s > 0.0f)) return;
+    float innov = y - st.x[EST_PROBE];
+    float k[3];
+    for (int i = 0; i < 3; i++) k[i] = st.P[i][EST_PROBE] / s;
+    for (int i = 0; i < 3; i++) st.x[i] += k[i] * innov;
+
+    // P = (I - K H) P, symetryzacja zapobiega dryfowi numerycznemu float
+    float row[3] = { st.P[EST_PROBE][0], st.P[EST_PROBE][1], st.P[EST_PROBE][2] };
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            st.P[i][j] -= k[i] * row[j];
+    for (int i = 0; i < 3; i++)
+        for (int j = i + 1; j < 3; j++)
+            st.P[i][j] = st.P[j][i] = 0.5f * (st.P[i][j] + st.P[j][i]);
+}
+
+bool chamber_est_config_valid(const EstimatorConfig& cfg) {
+    if (!(cfg.tauProbe >= 1.0f) || cfg.tauProbe > 3600.0f) return false;
+    if (!(cfg.tauAir >= 10.0f) || cfg.tauAir > 36000.0f) return false;
+    if (!(cfg.heaterGain >= 0.0f) || cfg.heaterGain > 500.0f) return false;
+    if (!(cfg.ambient > -50.0f) || cfg.ambient > 80.0f) return false;
+    if (!(cfg.qAir > 0.0f) || !(cfg.qDist > 0.0f) || !(cfg.rMeas > 0.0f)) return false;
+    if (!(cfg.maxDeviation > 0.0f)) return false;
+    return true;
+}
+
+void chamber_est_config_default(EstimatorConfig& cfg) {
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.usePid       = 0;
+    cfg.tauProbe     = DEF_TAU_PROBE;
+    cfg.tauAir       = DEF_TAU_AIR;
+    cfg.heaterGain   = DEF_HEATER_GAIN;
+    cfg.ambient      = DEF_AMBIENT;
+    cfg.qAir         = DEF_Q_AIR;
+    cfg.qDist        = DEF_Q_DIST;
+    cfg.rMeas        = DEF_R_MEAS;
+    cfg.maxDeviation = DEF_MAX_DEV;
+}
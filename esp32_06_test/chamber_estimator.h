@@ -0,0 +1,48 @@
+// chamber_estimator.h - Obserwator temperatury powietrza w komorze
+// [NEW] Sondy DS18B20 w stalowych osłonach opóźniają temperaturę powietrza
+//       o kilkadziesiąt sekund. Filtr Kalmana na modelu:
+//         dTa/dt = (Tamb + K*u - Ta) / tauAir + d      (powietrze, u = moc grzałek)
+//         dTp/dt = (Ta - Tp) / tauProbe                (sonda - I rząd)
+//         dd/dt  = 0 (+ szum)                          (nieznane straty: drzwi, wiatr, drewno)
+//       Pomiar: y = Tp (średnia kanałów CHAMBER). Estymata Ta może zastąpić pidInput.
+//       Czysty C++ (bez Arduino) - liczony też w symulacji na hoście.
+#pragma once
+#include <stdint.h>
+
+// Konfiguracja - blob NVS "est_cfg", układ stały
+struct EstimatorConfig {
+    uint8_t usePid;          // 1 = pidInput z estymaty zamiast surowej średniej
+    uint8_t reserved[3];
+    float   tauProbe;        // [s] stała czasowa sondy
+    float   tauAir;          // [s] stała czasowa komory
+    float   heaterGain;      // [°C] przyrost ustalony ponad otoczenie na 1 grzałkę 100%
+    float   ambient;         // [°C] temperatura otoczenia gdy brak kanału AMBIENT
+    float   qAir;            // szum procesu Ta [°C^2/s]
+    float   qDist;           // szum procesu d [(°C/s)^2/s]
+    float   rMeas;           // szum pomiaru [°C^2]
+    float   maxDeviation;    // [°C] większa różnica estymata/pomiar -> PID na surowym pomiarze
+};
+
+struct EstimatorState {
+    float x[3];              // Ta, Tp, d
+    float P[3][3];
+    bool  init;
+};
+
+enum { EST_AIR = 0, EST_PROBE = 1, EST_DIST = 2 };
+
+void chamber_est_reset(EstimatorState& st);
+
+// Krok predykcji: u = suma wysterowania grzałek [0..3 "pełnych grzałek"], dt [s].
+// Duże dt dzielone jest na podkroki (stabilność dyskretyzacji Eulera).
+void chamber_est_predict(const EstimatorConfig& cfg, EstimatorState& st,
+                         float u, float ambient, float dt);
+
+// Korekta nowym pomiarem sondy. Pierwszy pomiar inicjalizuje stan (Ta = Tp = y).
+void chamber_est_correct(const EstimatorConfig& cfg, EstimatorState& st, float y);
+
+inline float chamber_est_air(const EstimatorState& st)  { return st.x[EST_AIR]; }
+inline float chamber_est_dist(const EstimatorState& st) { return st.x[EST_DIST]; }
+
+bool chamber_est_config_valid(const EstimatorConfig& cfg);
+void chamber_est_config_default(EstimatorConfig& cfg);
@@ -0,0 +1,251 @@
+// checkpoint.cpp - Punkty kontrolne procesu i wznowienie po zaniku zasilania (patrz checkpoint.h)
+#include "checkpoint.h"
+#include "config.h"
+#include "state.h"
+#include "storage.h"
+#include "process.h"
+#include "flash_storage.h"
+#include "energy.h"
+#include <esp_system.h>
+
+static constexpr uint32_t SLOTS_PER_SECTOR = FLASH_SECTOR_SIZE / sizeof(ProcessCheckpoint);
+static constexpr uint32_t CKPT_SLOTS = (CHECKPOINT_END - CHECKPOINT_START + 1) * SLOTS_PER_SECTOR;
+
+// Zapis (taskMonitor; przed startem zadań - setup)
+static uint32_t nextSlot = 0;
+static uint32_t nextSeq  = 1;
+static bool     ringReady = false;
+
+// Pod state_lock (taskControl kopiuje, taskMonitor zapisuje)
+static ProcessCheckpoint pending;
+static bool              pendingValid = false;
+
+// Tylko taskControl
+static ProcessState   lastState = ProcessState::IDLE;
+static int            lastStep = -1;
+static unsigned long  lastCaptureMs = 0;
+
+// Wznowienie: ustawiane w setup, rozstrzygane w taskControl
+static ProcessCheckpoint resumeCp;
+static bool     resumePending = false;
+static bool     resumeGapKnown = false;
+static uint32_t resumeSensorSeq = 0;
+static unsigned long resumeWaitStart = 0;
+
+static uint32_t crc32(const void* data, size_t len, uint32_t crc = 0) {
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+static uint32_t slotAddress(uint32_t slot) {
+    return CHECKPOINT_START * FLASH_SECTOR_SIZE + slot * sizeof(ProcessCheckpoint);
+}
+
+static bool recordValid(const ProcessCheckpoint& cp) {
+    return cp.magic == CKPT_MAGIC && cp.version == CKPT_VERSION &&
+           cp.crc == crc32(&cp, offsetof(ProcessCheckpoint, crc));
+}
+
+static bool slotBlank(uint32_t slot) {
+    uint8_t buf[sizeof(ProcessCheckpoint)];
+    flash_read_data(slotAddress(slot), buf, sizeof(buf));
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        if (buf[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+// Procesy, które po resecie mają wrócić - pauza użytkownika, awarie i koniec profilu nie
+static bool isResumable(ProcessState st) {
+    return st == ProcessState::RUNNING_AUTO || st == ProcessState::RUNNING_MANUAL ||
+           st == ProcessState::SOFT_RESUME || st == ProcessState::PAUSE_DOOR ||
+           st == ProcessState::PAUSE_SENSOR;
+}
+
+// Reset bez zaniku zasilania - przerwa to czas startu, sekundy
+static bool resetKeepsGapShort() {
+    switch (esp_reset_reason()) {
+        case ESP_RST_SW:
+        case ESP_RST_PANIC:
+        case ESP_RST_INT_WDT:
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_WDT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void checkpoint_init() {
+    if (!flash_is_ready()) {
+        log_msg(LOG_LEVEL_WARN, "Checkpoint: flash not ready - no power-loss resume");
+        return;
+    }
+
+    // Najnowszy poprawny rekord; uszkodzony (zapis przerwany zanikiem) pomijany
+    ProcessCheckpoint cp, latest = {};
+    uint32_t latestSlot = 0;
+    bool found = false;
+    for (uint32_t slot = 0; slot < CKPT_SLOTS; slot++) {
+        flash_read_data(slotAddress(slot), (uint8_t*)&cp, sizeof(cp));
+        if (!recordValid(cp)) continue;
+        if (!found || (int32_t)(cp.seq - latest.seq) > 0) {
+            latest = cp;
+            latestSlot = slot;
+            found = true;
+        }
+    }
+
+    nextSlot = found ? (latestSlot + 1) % CKPT_SLOTS : 0;
+    nextSeq = found ? latest.seq + 1 : 1;
+    // Następny slot nie jest czysty (przerwany zapis) - od początku kolejnego sektora
+    if (!slotBlank(nextSlot)) {
+        if (nextSlot % SLOTS_PER_SECTOR) {
+            nextSlot = (nextSlot / SLOTS_PER_SECTOR + 1) * SLOTS_PER_SECTOR % CKPT_SLOTS;
+        }
+        flash_erase_sector(CHECKPOINT_START + nextSlot / SLOTS_PER_SECTOR);
+    }
+    ringReady = true;
+
+    if (!found || !isResumable((ProcessState)latest.state)) return;
+
+    bool autoMode = latest.runMode == (uint8_t)RunMode::MODE_AUTO;
+    const char* path = storage_get_profile_path();
+    if (autoMode) {
+        if (latest.profileCrc != crc32(path, strlen(path))) {
+            log_msg(LOG_LEVEL_WARN, "Checkpoint: profile changed since last run - not resuming");
+            return;
+        }
+        if (!storage_load_profile()) {
+            LOG_FMT(LOG_LEVEL_ERROR, "Checkpoint: cannot load %s - not resuming", path);
+            return;
+        }
+    }
+
+    resumeCp = latest;
+    resumeGapKnown = resetKeepsGapShort();
+    resumeSensorSeq = g_sensorSeq;
+    resumePending = true;
+    LOG_FMT(LOG_LEVEL_INFO, "Checkpoint #%lu: %s step %d, %lu s into step, T=%.1f C (reset: %s)",
+            (unsigned long)latest.seq, autoMode ? "AUTO" : "MANUAL", latest.step,
+            (unsigned long)latest.stepElapsedSec, latest.tChamber,
+            resumeGapKnown ? "short" : "power loss");
+}
+
+// Pierwszy świeży pomiar komory po starcie - wznowić czy zapomnieć
+static void decideResume() {
+    if (!state_lock()) return;
+    ProcessState st = g_currentState;
+    uint32_t seq = g_sensorSeq;
+    double tChamber = g_tChamber;
+    bool sensorError = g_errorSensor;
+    state_unlock();
+
+    if (st != ProcessState::IDLE) {   // użytkownik zdążył coś uruchomić
+        resumePending = false;
+        return;
+    }
+    if (seq == resumeSensorSeq || sensorError || isnan(tChamber)) {
+        if (!resumeWaitStart) resumeWaitStart = millis();
+        if (millis() - resumeWaitStart > CKPT_RESUME_WAIT_MS) {
+            log_msg(LOG_LEVEL_WARN, "Checkpoint: no chamber reading - not resuming");
+            resumePending = false;
+        }
+        return;
+    }
+    resumePending = false;
+
+    double drop = resumeCp.tChamber - tChamber;
+    if (!resumeGapKnown && drop > CKPT_MAX_TEMP_DROP_C) {
+        LOG_FMT(LOG_LEVEL_WARN, "Checkpoint: chamber cooled %.1f C (limit %.1f) - not resuming",
+                drop, CKPT_MAX_TEMP_DROP_C);
+        return;
+    }
+    if (process_restore(resumeCp)) {
+        LOG_FMT(LOG_LEVEL_WARN, "Process restored after reset: step %d, T %.1f -> %.1f C",
+                resumeCp.step, resumeCp.tChamber, tChamber);
+    }
+}
+
+// Pod state_lock
+static void captureLocked(ProcessState st, unsigned long now) {
+    ProcessCheckpoint& cp = pending;
+    memset(&cp, 0, sizeof(cp));
+    cp.magic = CKPT_MAGIC;
+    cp.version = CKPT_VERSION;
+    cp.state = (uint8_t)st;
+    cp.runMode = (uint8_t)g_lastRunMode;
+    cp.step = (int8_t)g_currentStep;
+    cp.powerMode = (uint8_t)g_powerMode;
+    cp.fanMode = (uint8_t)g_fanMode;
+    cp.smokePwm = (uint8_t)g_manualSmokePwm;
+    cp.stepElapsedSec = (now - g_stepStartTime) / 1000;
+    cp.processElapsedSec = (now - g_processStartTime) / 1000;
+    const char* path = storage_get_profile_path();
+    cp.profileCrc = crc32(path, strlen(path));
+    cp.tSet = (float)g_tSet;
+    cp.tChamber = (float)g_tChamber;
+    cp.runSec = g_processStats.totalRunTime / 1000;
+    cp.heatingSec = g_processStats.activeHeatingTime / 1000;
+    cp.stepChanges = (uint16_t)g_processStats.stepChanges;
+    cp.pauseCount = (uint16_t)g_processStats.pauseCount;
+    cp.avgTemp = (float)g_processStats.avgTemp;
+    cp.fanOnTime = g_fanOnTime;
+    cp.fanOffTime = g_fanOffTime;
+    uint64_t wh = g_processStats.energyUj / ENERGY_UJ_PER_WH;
+    cp.energyWh = wh > 0xFFFF ? 0xFFFF : (uint16_t)wh;
+    pendingValid = true;
+}
+
+void checkpoint_tick() {
+    if (!ringReady) return;
+    if (resumePending) decideResume();
+
+    if (!state_lock()) return;
+    ProcessState st = g_currentState;
+    int step = g_currentStep;
+    unsigned long now = millis();
+    // Zmiana stanu/kroku od razu; okresowo tylko w procesie. Przejście do stanu
+    // bez wznowienia zapisuje rekord końcowy - po resecie start w IDLE.
+    bool changed = st != lastState || step != lastStep;
+    bool periodic = isResumable(st) && now - lastCaptureMs >= CKPT_INTERVAL_MS;
+    if ((changed && (isResumable(st) || isResumable(lastState))) || periodic) {
+        captureLocked(st, now);
+        lastCaptureMs = now;
+    }
+    state_unlock();
+    lastState = st;
+    lastStep = step;
+}
+
+void checkpoint_flush() {
+    if (!ringReady) return;
+    ProcessCheckpoint cp;
+    if (!state_lock()) return;
+    bool have = pendingValid;
+    if (have) cp = pending;
+    pendingValid = false;
+    state_unlock();
+    if (!have) return;
+
+    cp.seq = nextSeq++;
+    cp.crc = crc32(&cp, offsetof(ProcessCheckpoint, crc));
+    uint32_t slot = nextSlot;
+    if (slot % SLOTS_PER_SECTOR == 0 && !slotBlank(slot)) {   // kasowanie z wyprzedzeniem nie zdążyło
+        flash_erase_sector(CHECKPOINT_START + slot / SLOTS_PER_SECTOR);
+    }
+    flash_write_page(slotAddress(slot), (const uint8_t*)&cp, sizeof(cp));
+    nextSlot = (slot + 1) % CKPT_SLOTS;
+
+    // Pierwszy rekord w sektorze - następny (najstarsze rekordy) kasowany teraz,
+    // żeby kolejne wejście w sektor było samym zapisem strony
+    if (slot % SLOTS_PER_SECTOR == 0) {
+        uint32_t ahead = (slot / SLOTS_PER_SECTOR + 1) % (CHECKPOINT_END - CHECKPOINT_START + 1);
+        flash_erase_sector(CHECKPOINT_START + ahead);
+    }
+}
@@ -0,0 +1,57 @@
+// checkpoint.h - Punkty kontrolne procesu w pierścieniu flash, wznowienie po zaniku zasilania
+// [NEW] Brownout albo reset WDT w trakcie 10-godzinnego wędzenia kończył się startem
+//       w IDLE - krok, czas kroku i statystyki przepadały. Rekord 64 B (krok, czasy
+//       kroku/procesu, zadana, tryby, statystyki, CRC32) zapisywany co
+//       CKPT_INTERVAL_MS i przy każdej zmianie stanu/kroku do sektorów
+//       CHECKPOINT_START..CHECKPOINT_END W25Q128, poza FAT. Kolejne rekordy trafiają
+//       na skasowane strony (sam page program), sektor za bieżącym kasowany z
+//       wyprzedzeniem. Przy starcie najnowszy poprawny rekord (najwyższy seq):
+//       proces, który był w toku, wraca w SOFT_RESUME na tym samym kroku, z czasem
+//       kroku z rekordu (przerwa nie liczy się do kroku).
+//       Przerwa: reset programowy/WDT/panic - sekundy, wznowienie zawsze. Zanik
+//       zasilania - brak zegara, przerwę ogranicza spadek temperatury komory:
+//       wznowienie tylko gdy pierwszy pomiar >= rekord - CKPT_MAX_TEMP_DROP_C.
+//       Zapis we flash z taskMonitor (kasowanie sektora do ~400 ms), taskControl
+//       tylko kopiuje rekord pod state_lock.
+#pragma once
+#include <Arduino.h>
+
+constexpr unsigned long CKPT_INTERVAL_MS     = 30000;   // zapis okresowy w trakcie procesu
+constexpr double        CKPT_MAX_TEMP_DROP_C = 15.0;    // limit przerwy przy zaniku zasilania
+constexpr unsigned long CKPT_RESUME_WAIT_MS  = 30000;   // tyle czekania na pierwszy pomiar komory
+constexpr uint16_t      CKPT_MAGIC           = 0xC4E7;
+constexpr uint8_t       CKPT_VERSION         = 1;
+
+struct __attribute__((packed)) ProcessCheckpoint {
+    uint16_t magic;
+    uint8_t  version;
+    uint8_t  state;               // ProcessState
+    uint32_t seq;                 // rośnie z każdym zapisem - najnowszy rekord
+    uint8_t  runMode;             // RunMode
+    int8_t   step;
+    uint8_t  powerMode;
+    uint8_t  fanMode;
+    uint8_t  smokePwm;
+    uint8_t  reserved;
+    uint16_t energyWh;            // [NEW] energia grzałek w procesie (starsze rekordy: 0)
+    uint32_t stepElapsedSec;
+    uint32_t processElapsedSec;
+    uint32_t profileCrc;          // CRC32 ścieżki profilu
+    float    tSet;
+    float    tChamber;
+    uint32_t runSec;              // ProcessStats.totalRunTime
+    uint32_t heatingSec;          // ProcessStats.activeHeatingTime
+    uint16_t stepChanges;
+    uint16_t pauseCount;
+    float    avgTemp;
+    uint32_t fanOnTime, fanOffTime;
+    uint32_t crc;                 // CRC32 wszystkich pól powyżej
+};
+static_assert(sizeof(ProcessCheckpoint) == 64, "checkpoint record must be 64 B");
+
+// setup: po flash, konfiguracji NVS i WiFi (profil z GitHub) - szuka rekordu do wznowienia
+void checkpoint_init();
+// taskControl, po process_run_control_logic(): wznowienie po pierwszym pomiarze, kopia rekordu
+void checkpoint_tick();
+// taskMonitor: zapis oczekującego rekordu do flash
+void checkpoint_flush();
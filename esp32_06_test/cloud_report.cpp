@@ -10,6 +10,7 @@
 #include "process.h"
 #include "storage.h"
 #include "config.h"
+#include "api_endpoint.h"
 
 #include <WiFi.h>
 #include <HTTPClient.h>
@@ -51,44 +52,30 @@ static void stopProcess() {
 
 // ── TELEMETRIA → Supabase ────────────────────────────────────
 static void sendTelemetry() {
-  bool h1    = (ledcRead(PIN_SSR1) > 0);
-  bool h2    = (ledcRead(PIN_SSR2) > 0);
-  bool h3    = (ledcRead(PIN_SSR3) > 0);
+  double duty[3];
+  outputs_heater_duties(duty);   // [MOD] grzałki nie są już na LEDC
+  bool h1    = (duty[0] > 0);
+  bool h2    = (duty[1] > 0);
+  bool h3    = (duty[2] > 0);
   bool fanOn = (digitalRead(PIN_FAN) == HIGH);
 
-  // ── Odczyt czasów pod lockiem ────────────────────────────
+  // ── [MOD] Jedna migawka stanu zamiast dwóch state_lock + odczytów bez locka ──
+  static ProcessSnapshot snap;   // tylko loop()
+  state_snapshot_read(snap);
+
   unsigned long stepRemaining  = 0;
-  unsigned long totalElapsed   = 0;
-  unsigned long totalRemaining = 0;
-  int           currentStep    = 0;
-  int           stepCount      = 0;
-  ProcessState  state          = ProcessState::IDLE;
+  unsigned long totalElapsed   = (unsigned long)((millis() - snap.processStartTime) / 1000);
+  unsigned long totalRemaining = snap.remainingProcessTimeSec;
   const char*   stepName       = "";
 
-  if (state_lock()) {
-    state        = g_currentState;
-    currentStep  = g_currentStep;
-    stepCount    = g_stepCount;
-    totalElapsed = (unsigned long)((millis() - g_processStartTime) / 1000);
-    totalRemaining = g_processStats.remainingProcessTimeSec;
-
-    if (state == ProcessState::RUNNING_AUTO &&
-        currentStep >= 0 && currentStep < stepCount) {
-      unsigned long stepElapsed = (millis() - g_stepStartTime) / 1000;
-      unsigned long stepTotal   = g_profile[currentStep].minTimeMs / 1000;
-      stepRemaining = (stepTotal > stepElapsed) ? (stepTotal - stepElapsed) : 0;
-      stepName = g_profile[currentStep].name;
-    }
-    state_unlock();
+  if (snap.state == ProcessState::RUNNING_AUTO &&
+      snap.currentStep >= 0 && snap.currentStep < snap.stepCount) {
+    unsigned long stepElapsed = (millis() - snap.stepStartTime) / 1000;
+    unsigned long stepTotal   = snap.stepMinTimeMs / 1000;
+    stepRemaining = (stepTotal > stepElapsed) ? (stepTotal - stepElapsed) : 0;
+    stepName = snap.stepName;
   }
 
-  double ntcAdc = 0, ntcRes = 0;
-if (state_lock()) {
-    ntcAdc = g_ntcAdc;
-    ntcRes = g_ntcResistance;
-    state_unlock();
-}
-
   // Lista profili z Flash
   String profilesJson = storage_list_profiles_json();
 
@@ -96,30 +83,33 @@ if (state_lock()) {
   const char* currentProfile = storage_get_profile_path();
   const char* baseName = extractBaseName(currentProfile);
 
-  StaticJsonDocument<896> doc;
+  StaticJsonDocument<1536> doc;
   doc["device_id"] = CFG_CLOUD_DEVICE_ID;
-  doc["t1"]        = g_tChamber1;
-  doc["t2"]        = g_tChamber2;
-  doc["tm"]        = g_tMeat;
-  doc["ts"]        = g_tSet;
-  doc["ps"]        = processStateStr();
-  doc["cs"]        = currentStep;
-  doc["sc"]        = stepCount;
+  api_fill_sensor_channels(doc, snap);
+  doc["tm"]        = snap.tMeat;
+  doc["ts"]        = snap.tSet;
+  doc["ps"]        = processStateStr(snap.state);
+  doc["cs"]        = snap.currentStep;
+  doc["sc"]        = snap.stepCount;
   doc["sn"]        = stepName;
   doc["str"]       = stepRemaining;    // pozostały czas kroku (sekundy)
   doc["tte"]       = totalElapsed;     // czas od startu (sekundy)
   doc["trem"]      = totalRemaining;   // pozostały czas całego procesu (sekundy)
-  doc["pm"]        = g_powerMode;
-  doc["fm"]        = g_fanMode;
-  doc["sp"]        = g_manualSmokePwm;
-  doc["do"]        = g_doorOpen;
+  doc["meta"]      = snap.meatEtaSec;  // [NEW] prognoza dojścia rdzenia mięsa (s, -1 = brak)
+  doc["metac"]     = snap.meatEtaConf; // [NEW] pewność prognozy 0..1
+  doc["pm"]        = snap.powerMode;
+  doc["fm"]        = snap.fanMode;
+  doc["sp"]        = snap.manualSmokePwm;
+  doc["do"]        = snap.doorOpen;
   doc["h1"]        = h1;
   doc["h2"]        = h2;
   doc["h3"]        = h3;
   doc["fo"]        = fanOn;
-  doc["pid"]       = pidOutput;
-  doc["nadc"] = ntcAdc;
-  doc["nr"]   = ntcRes;
+  doc["pid"]       = snap.pidOutput;
+  doc["ewh"]       = snap.energyWh;      // [NEW] energia grzałek w procesie (Wh)
+  doc["sewh"]      = snap.stepEnergyWh;  // [NEW] energia bieżącego kroku (Wh)
+  doc["nadc"] = snap.ntcAdc;
+  doc["nr"]   = snap.ntcResistance;
   doc["rssi"]      = WiFi.RSSI();
   doc["fw"]        = FW_VERSION;
   doc["up"]        = (unsigned long)(millis() / 1000);
@@ -196,7 +186,7 @@ static void executeCommand(const char* cmd, float value, const char* strVal, con
       if (state_lock()) { g_manualSmokePwm = pwm; state_unlock(); }
       if (g_currentState == ProcessState::RUNNING_MANUAL ||
           g_currentState == ProcessState::RUNNING_AUTO) {
-        if (output_lock()) { ledcWrite(PIN_SMOKE_FAN, pwm); output_unlock(); }
+        outputs_set_smoke(pwm);
       }
     }
   }
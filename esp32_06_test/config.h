@@ -4,6 +4,8 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include "device_config.h"
+#include "step_cond.h"
+#include "sensor_filter.h"
 
 // ======================================================
 // 0. METADANE FIRMWARE
@@ -51,6 +53,12 @@ constexpr int    NTC_SAMPLES       = 100;          // Liczba próbek do uśredni
 constexpr double NTC_TEMP_MIN      = -10.0;       // Min akceptowalna temperatura
 constexpr double NTC_TEMP_MAX      = 200.0;       // Max akceptowalna temperatura
 constexpr float NTC_FILTER_ALPHA = 0.91f;
+
+// --- [NEW] Skaner NTC: kilka sond na ADC1 w jednym strumieniu DMA ---
+constexpr int      MAX_NTC_CHANNELS             = 4;
+constexpr uint32_t NTC_SCAN_SAMPLE_FREQ         = 20000;  // Hz, cały strumień (minimum ESP32)
+constexpr int      NTC_SCAN_CONV_PER_PIN        = 64;     // konwersji na pin w jednej ramce
+constexpr int      NTC_SCAN_MAX_FRAMES_PER_POLL = 16;
 // ======================================================
 // KONFIGURACJA ADC ESP32 DLA NTC
 // ======================================================
@@ -68,13 +76,24 @@ constexpr int SCREEN_HEIGHT = 160;
 #define ST77XX_DARKGREY 0x7BEF
 
 // --- LEDC (PWM) ---
+// [MOD] Tylko wentylator dymu - grzałki przez ssr_driver
 constexpr int LEDC_FREQ = 5000;
 constexpr int LEDC_RESOLUTION = 8;
 
+// --- [NEW] Grzałki: SSR z przejściem przez zero, modulacja półokresami sieci ---
+constexpr uint32_t SSR_MAINS_HZ          = 50;
+constexpr uint32_t SSR_HALF_CYCLE_US     = 1000000UL / (2 * SSR_MAINS_HZ);   // takt esp_timer
+constexpr uint16_t SSR_WINDOW_MS_DEFAULT = 2000;   // okno trybu proporcjonalnego
+constexpr uint16_t SSR_MIN_ON_MS_DEFAULT = 20;     // pełny okres - bez składowej stałej
+constexpr uint16_t SSR_WINDOW_MS_MIN     = 200;
+constexpr uint16_t SSR_WINDOW_MS_MAX     = 10000;
+
 // --- PID ---
 constexpr double CFG_Kp = 5.0;
 constexpr double CFG_Ki = 0.3;
 constexpr double CFG_Kd = 20.0;
+constexpr double PID_AW_DEADBAND_PCT = 0.5;   // [NEW] anti-windup: różnica wyjście zadane/oddane
+constexpr double PID_SP_JUMP_C       = 2.0;   // [NEW] skok setpointu -> przeskalowanie całki
 
 // --- Limity ---
 constexpr double CFG_T_MAX_SOFT = 130.0;
@@ -110,13 +129,14 @@ constexpr unsigned long TEMP_CONVERSION_TIME = 850;
 constexpr int SENSOR_ERROR_THRESHOLD = 3;
 constexpr unsigned long SENSOR_READ_TIMEOUT = 100;
 
-// --- Stałe przypisania czujników ---
-constexpr int DEFAULT_CHAMBER_SENSOR_1 = 0;
-constexpr int DEFAULT_CHAMBER_SENSOR_2 = 1;
-constexpr unsigned long SENSOR_ASSIGNMENT_CHECK = 10000;
+// --- [NEW] Tablica kanałów czujników ---
+constexpr int MAX_SENSOR_CHANNELS = 8;
+constexpr int SENSOR_NAME_LEN = 12;
 
 // --- Profil ---
-constexpr int MAX_STEPS = 10;
+// [MOD] Górna granica kroków (krok int8 w checkpoint/run recorder), pamięć profilu
+//       według rzeczywistej liczby kroków (profile_store.h)
+constexpr int MAX_STEPS = 64;
 
 // --- Timeouty dla mutexów ---
 constexpr TickType_t CFG_MUTEX_TIMEOUT_MS = 1000;
@@ -131,6 +151,29 @@ constexpr int CURRENT_LOG_LEVEL = LOG_LEVEL_INFO;
 // --- Adaptive PID ---
 constexpr unsigned long PID_ADAPTATION_INTERVAL = 60000;
 
+// --- [NEW] Takt sterowania ---
+// taskControl budzony powiadomieniem z taskSensors (świeży pomiar komory) albo
+// taktem esp_timer co CONTROL_TICK_MS (bezpieczeństwo, timery kroków, soft-enable).
+// [MOD] Takt ze stałym okresem, niezależny od czasu pracy - jitter i WCET w /api/perf.
+// PID liczony raz na pomiar, SampleTime = rzeczywisty odstęp między pomiarami.
+constexpr unsigned long CONTROL_TICK_MS   = 100;
+constexpr unsigned long PID_SAMPLE_MIN_MS = CONTROL_TICK_MS;
+constexpr unsigned long PID_SAMPLE_MAX_MS = 3 * TEMP_REQUEST_INTERVAL;   // przerwa w pomiarach
+
+// --- [NEW] Kaskada: pętla zewnętrzna na temperaturze mięsa ---
+constexpr unsigned long CASCADE_UPDATE_MS   = 30000;   // co ile nowy setpoint komory
+constexpr float         CASCADE_TRACK_TAU_S = 900.0f;  // korekta odchyłki od trajektorii rdzenia
+constexpr float         CASCADE_K_DEFAULT   = 1.5e-4f; // [1/s] wymiana ciepła mięsa zanim meat_eta oceni k
+constexpr float         CASCADE_MAX_STEP_C  = 3.0f;    // max zmiana setpointu na aktualizację
+constexpr float         CASCADE_MIN_MARGIN_C = 2.0f;   // domyślne tmin = tMeat + margines
+
+// --- [NEW] Rampa setpointu i wyprzedzenie następnego kroku ---
+constexpr float         RAMP_HEAT_RATE_DEFAULT = 0.5f;   // [°C/min na grzałkę] do pierwszego pomiaru
+constexpr float         RAMP_COOL_RATE_DEFAULT = 0.3f;   // [°C/min] stygnięcie przy wyłączonym grzaniu
+constexpr unsigned long RAMP_IDENT_WINDOW_MS   = 60000;  // okno pomiaru narastania/stygnięcia komory
+constexpr float         RAMP_IDENT_MIN_ERR_C   = 3.0f;   // pomiar tylko daleko od setpointu (nasycenie PID)
+constexpr float         GAIN_SCHED_SP_HYST_C   = 1.0f;   // rampa przesuwa setpoint co tick - retuning co 1 °C
+
 // --- Progi pamięci ---
 constexpr uint32_t HEAP_WARNING_THRESHOLD = 20000;
 constexpr uint32_t HEAP_CRITICAL_THRESHOLD = 10000;
@@ -154,6 +197,17 @@ constexpr double HEATER_MIN_TEMP_RISE     = 2.0;
 constexpr double HEATER_FAULT_MIN_PID     = 50.0;
 constexpr double HEATER_FAULT_MIN_ERROR   = 10.0;
 
+// ======================================================
+// [NEW] AUTOTUNE PID (test przekaźnikowy Åström–Hägglund)
+// ======================================================
+constexpr double ATUNE_RELAY_HIGH      = 100.0;   // wyjście PID w fazie grzania [%]
+constexpr double ATUNE_RELAY_LOW       = 0.0;     // wyjście PID w fazie stygnięcia [%]
+constexpr double ATUNE_HYSTERESIS      = 0.5;     // [°C] histereza przekaźnika wokół setpointu
+constexpr int    ATUNE_CYCLES          = 3;       // okresy uśredniane do wyniku
+constexpr int    ATUNE_MAX_CYCLES      = 10;      // bez zbieżności po tylu okresach -> błąd
+constexpr double ATUNE_MAX_SPREAD      = 0.25;    // max rozrzut amplitudy i okresu (względny)
+constexpr unsigned long ATUNE_MAX_TIME_MS = 4UL * 60UL * 60UL * 1000UL;
+
 // ======================================================
 // 3. DEFINICJE TYPÓW I STRUKTUR
 // ======================================================
@@ -168,7 +222,8 @@ enum class ProcessState {
     PAUSE_USER,
     ERROR_PROFILE,
     SOFT_RESUME,
-    PAUSE_HEATER_FAULT
+    PAUSE_HEATER_FAULT,
+    AUTOTUNE               // [NEW] test przekaźnikowy PID
 };
 
 enum class RunMode {
@@ -187,13 +242,45 @@ enum class ErrorCode {
     TASK_TIMEOUT
 };
 
+// [NEW] Kanał czujnika - typ, rola i źródło. Blob w NVS, układ stały.
+enum class SensorType : uint8_t { NONE = 0, DS18B20 = 1, NTC = 2 };
+enum class SensorRole : uint8_t { CHAMBER = 0, MEAT = 1, SMOKE = 2, AMBIENT = 3 };
+
+struct SensorChannel {
+    uint8_t type;                 // SensorType
+    uint8_t role;                 // SensorRole
+    uint8_t pin;                  // NTC: pin ADC
+    uint8_t reserved;
+    uint8_t rom[8];               // DS18B20: adres ROM
+    char    name[SENSOR_NAME_LEN];
+    float   offset;               // korekta [°C]
+    FilterConfig filter;          // [MOD] łańcuch filtrów - przenosi się razem z kanałem
+};
+
+// Wynik odczytu kanału - cała tablica publikowana raz na cykl
+struct SensorReading {
+    float value;                  // po filtrze [°C], ostatnia poprawna wartość
+    float raw;                    // surowy odczyt z tego cyklu
+    float adc;                    // NTC: średnie ADC
+    unsigned long timestamp;      // ostatnia poprawna próbka (0 = nigdy)
+    bool  valid;                  // próbka z tego cyklu poprawna
+};
+
 struct HeaterEnable {
     bool h1, h2, h3;
     unsigned long t1, t2, t3;
 };
 
+// [NEW] Tryb regulacji kroku profilu
+enum class StepControl : uint8_t {
+    CHAMBER = 0,   // stała temperatura komory tSet
+    CASCADE = 1    // pętla na mięsie przestawia setpoint komory w [cascMin, cascMax]
+};
+
+// [MOD] Pełny krok - wynik parsowania i kopia robocza; załadowany profil trzyma
+//       zwarte ProfileStep w arenie (profile_store.h)
 struct Step {
-    char name[32];
+    const char* name;             // [MOD] w linii parsowanej / w arenie (pod state_lock)
     double tSet;
     double tMeatTarget;
     unsigned long minTimeMs;
@@ -203,6 +290,17 @@ struct Step {
     unsigned long fanOnTime;
     unsigned long fanOffTime;
     bool useMeatTemp;
+    // [NEW] Pola key=value za 10. kolumną .prof
+    StepControl control;
+    float cascMin, cascMax;       // granice setpointu komory w kaskadzie [°C]
+    float cascRate;               // [°C/min] narastanie rdzenia, 0 = z cascTimeMs
+    unsigned long cascTimeMs;     // dojście rdzenia do tMeatTarget od startu kroku
+    float rampRate;               // [°C/min] dojście setpointu do tSet, 0 = skok
+    bool  lookahead;              // końcówka kroku grzeje/studzi już do tSet następnego
+    uint16_t smokeOnSec, smokeOffSec;   // [NEW] impulsy dymu (smoke_sched.h), offSec 0 = ciągle
+    uint16_t smokeRampSec;        // [NEW] dojście PWM dymu od poziomu poprzedniego kroku
+    float smokeDensity;           // [NEW] cel czujnika dymu [%], 0 = bez regulacji
+    StepCond exitCond;            // [NEW] exit= skompilowane (step_cond.h), len 0 = minTime/tMeat
 };
 
 struct ProcessStats {
@@ -214,6 +312,12 @@ struct ProcessStats {
     unsigned long lastUpdate;
     unsigned long totalProcessTimeSec;
     unsigned long remainingProcessTimeSec;
+    bool  remainingOpen;    // [NEW] w pozostałych krokach jest exit= - czas orientacyjny
+    long  meatEtaSec;       // [NEW] prognoza dojścia rdzenia do celu kroku [s], -1 = brak
+    float meatEtaConf;      // [NEW] pewność prognozy 0..1
+    uint8_t heaterFaultMask;   // [NEW] grzałki (fizyczne) uznane za martwe, bit 0 = H1
+    float heatersEffective;    // [NEW] grzałki efektywne z bilansu mocy (heater_fault.h)
+    uint64_t energyUj;                 // [NEW] energia grzałek w procesie [µJ] (energy.h)
 };
 
 // ======================================================
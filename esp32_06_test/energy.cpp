@@ -0,0 +1,115 @@
+// energy.cpp - Energia grzałek z półokresów SSR (patrz energy.h)
+#include "energy.h"
+#include "config.h"
+#include "state.h"
+#include "storage.h"
+#include "ssr_driver.h"
+
+static constexpr uint8_t ENERGY_CFG_VERSION = 1;
+
+// Pod heater_lock (taskControl + WWW)
+static EnergyConfig cfg;
+// Tylko taskControl
+static uint32_t lastCounts[SSR_CHANNELS];
+static bool     countsValid = false;
+
+static bool configValid(const EnergyConfig& c) {
+    for (int i = 0; i < 3; i++) {
+        if (c.watts[i] > ENERGY_MAX_W) return false;
+    }
+    return c.pricePerKwh >= 0 && c.pricePerKwh < 1000;
+}
+
+void energy_load() {
+    EnergyConfig c;
+    if (!storage_load_blob_nvs("energy_cfg", &c, sizeof(c)) ||
+        c.version != ENERGY_CFG_VERSION || !configValid(c)) {
+        memset(&c, 0, sizeof(c));
+        c.version = ENERGY_CFG_VERSION;
+        for (int i = 0; i < 3; i++) c.watts[i] = ENERGY_DEFAULT_W;
+    }
+    if (!heater_lock()) return;
+    cfg = c;
+    heater_unlock();
+    LOG_FMT(LOG_LEVEL_INFO, "Energy: heaters %u/%u/%u W, price %.2f/kWh",
+            c.watts[0], c.watts[1], c.watts[2], c.pricePerKwh);
+}
+
+uint64_t energy_take_uj() {
+    uint32_t counts[SSR_CHANNELS];
+    ssr_on_counts(counts);
+    if (!countsValid) {
+        memcpy(lastCounts, counts, sizeof(lastCounts));
+        countsValid = true;
+        return 0;
+    }
+    uint16_t w[3];
+    if (!heater_lock()) return 0;   // półokresy zostają w delcie na następny tick
+    memcpy(w, cfg.watts, sizeof(w));
+    heater_unlock();
+
+    uint64_t uj = 0;
+    for (int i = 0; i < SSR_CHANNELS; i++) {
+        uint32_t d = counts[i] - lastCounts[i];   // licznik zawija się - różnica poprawna
+        lastCounts[i] = counts[i];
+        uj += (uint64_t)d * w[i] * SSR_HALF_CYCLE_US;
+    }
+    return uj;
+}
+
+bool energy_get_config(EnergyConfig& out) {
+    if (!heater_lock()) return false;
+    out = cfg;
+    heater_unlock();
+    return true;
+}
+
+bool energy_set_config(const EnergyConfig& c) {
+    if (!configValid(c)) return false;
+    if (!heater_lock()) return false;
+    cfg = c;
+    cfg.version = ENERGY_CFG_VERSION;
+    EnergyConfig copy = cfg;
+    heater_unlock();
+    storage_save_blob_nvs("energy_cfg", &copy, sizeof(copy));
+    return true;
+}
+
+String energy_json() {
+    EnergyConfig c;
+    if (!energy_get_config(c)) return "{}";
+    // [FIX] Energia kroków w arenie profilu - kopia o jej rozmiarze; bufor
+    // przydzielany poza lockiem, liczba kroków sprawdzana ponownie przy kopii
+    if (!state_lock()) return "{}";
+    int stepCount = g_stepCount;
+    state_unlock();
+    uint64_t* stepUj = stepCount > 0 ? (uint64_t*)malloc(stepCount * sizeof(uint64_t)) : nullptr;
+    if (!stepUj) stepCount = 0;
+
+    uint64_t runUj;
+    if (!state_lock()) {
+        free(stepUj);
+        return "{}";
+    }
+    runUj = g_processStats.energyUj;
+    stepCount = min(stepCount, g_stepCount);
+    if (stepCount > 0) memcpy(stepUj, profile_step_energy(g_profile), stepCount * sizeof(uint64_t));
+    state_unlock();
+
+    // [MOD] Lista kroków dopisywana do String
+    double runWh = energy_wh(runUj);
+    char buf[160];
+    snprintf(buf, sizeof(buf),
+        "{\"watts\":[%u,%u,%u],\"price\":%.3f,\"run_wh\":%.1f,\"run_cost\":%.2f,\"steps_wh\":[",
+        c.watts[0], c.watts[1], c.watts[2], c.pricePerKwh, runWh, runWh / 1000.0 * c.pricePerKwh);
+    String json;
+    json.reserve(strlen(buf) + stepCount * 8 + 4);
+    json += buf;
+    for (int i = 0; i < stepCount; i++) {
+        snprintf(buf, sizeof(buf), "%s%.1f", i ? "," : "", energy_wh(stepUj[i]));
+        json += buf;
+    }
+    json += "]}";
+    free(stepUj);
+    return json;
+}
@@ -0,0 +1,33 @@
+// energy.h - Energia grzałek na proces i na krok z półokresów SSR
+// [NEW] ProcessStats.activeHeatingTime liczy tylko czas z pidOutput > 5 - bez
+//       liczby grzałek i wypełnienia, więc koszt wsadu był nieznany. Energia =
+//       półokresy faktycznie przewodzące (ssr_on_counts) x moc grzałki x czas
+//       półokresu. W x µs = µJ - liczniki 64-bit w µJ bez zaokrągleń (2^64 µJ
+//       to ponad 5 mln kWh). Sumowane w ProcessStats (process.cpp) na proces i na
+//       krok; raport w /status, chmurze, na TFT i w zapisie przebiegu.
+//       Moce grzałek i cena kWh - blob NVS "energy_cfg", GET/POST /api/energy.
+#pragma once
+#include <Arduino.h>
+
+constexpr uint16_t ENERGY_DEFAULT_W  = 1500;               // [W] moc jednej grzałki
+constexpr uint16_t ENERGY_MAX_W      = 6000;
+constexpr uint64_t ENERGY_UJ_PER_WH  = 3600000000ULL;
+
+struct EnergyConfig {
+    uint8_t  version;
+    uint8_t  reserved;
+    uint16_t watts[3];        // moc grzałek fizycznych H1..H3 [W]
+    float    pricePerKwh;     // 0 = bez kosztu
+};
+
+void energy_load();                       // setup, po ssr_init
+// taskControl co tick: µJ oddane przez grzałki od poprzedniego wywołania
+uint64_t energy_take_uj();
+
+bool   energy_get_config(EnergyConfig& cfg);
+bool   energy_set_config(const EnergyConfig& cfg);
+String energy_json();
+
+inline double energy_wh(uint64_t uj) {
+    return uj / (double)ENERGY_UJ_PER_WH;
+}
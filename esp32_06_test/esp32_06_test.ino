@@ -4,15 +4,22 @@
 #include "state.h"
 #include "hardware.h"
 #include "storage.h"
+#include "sensors.h"
 #include "flash_storage.h"
 #include "web_server.h"
 #include "tasks.h"
 #include "outputs.h"
+#include "process.h"
+#include "history.h"
+#include "heater_rotation.h"
+#include "energy.h"
 #include "ui.h"
 #include <esp_task_wdt.h>
 #include "cloud_report.h"
 #include "api_endpoint.h"
 #include "notifications.h"
+#include "checkpoint.h"
+#include "run_recorder.h"
 
 void setup() {
     Serial.begin(115200);
@@ -52,6 +59,8 @@ void setup() {
 
     // 5. PWM/LEDC
     hardware_init_ledc();
+    heater_rot_load();   // [NEW] po ssr_init() - liczniki SSR
+    energy_load();       // [NEW] moce grzałek do liczenia energii
     esp_task_wdt_reset();
 
     // 6. [NEW] Mutex SPI
@@ -83,10 +92,13 @@ void setup() {
     hardware_init_flash();
     boot_screen_status("Flash W25Q", flash_is_ready());
     esp_task_wdt_reset();
-	calibration_load();
     
     // 10. Konfiguracja z NVS
     storage_load_config_nvs();
+    sensors_init_channels();
+    estimator_load_config();
+    process_load_tunings();
+    history_init();
     boot_screen_status("Konfig NVS", true);
     esp_task_wdt_reset();
 
@@ -107,6 +119,11 @@ void setup() {
         Serial.printf("AP: %s\n", WiFi.softAPIP().toString().c_str());
     }
 
+    // [NEW] Punkt kontrolny procesu - po WiFi (profil z GitHub), wznowienie w taskControl
+    checkpoint_init();
+    runrec_init();   // [NEW] zapis przebiegów, domknięcie pliku przerwanego resetem
+    esp_task_wdt_reset();
+
     // 13. Serwer WWW
     web_server_init();
     boot_screen_status("WebServer",  true);
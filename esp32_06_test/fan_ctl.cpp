@@ -0,0 +1,50 @@
+// fan_ctl.cpp - Sterowanie wentylatorem obiegowym (patrz fan_ctl.h)
+#include "fan_ctl.h"
+#include <math.h>
+#include <string.h>
+
+static float clamp01(float x) {
+    return x < 0 ? 0 : (x > 1 ? 1 : x);
+}
+
+void fan_ctl_reset(FanCtlState& st) {
+    memset(&st, 0, sizeof(st));
+}
+
+uint32_t fan_ctl_update(FanCtlState& st, uint32_t nowMs, float spread, float trend,
+                        float tChamber, float tSet, uint32_t profileOffMs) {
+    float want = 0;
+    if (!isnan(spread)) {
+        want = clamp01((spread - FAN_SPREAD_DEAD_C) / (FAN_SPREAD_FULL_C - FAN_SPREAD_DEAD_C));
+    }
+    if (!isnan(trend) && !isnan(tChamber) && trend > 0) {
+        float over = tChamber + trend * FAN_LOOKAHEAD_S - tSet;
+        float d = clamp01(over / FAN_OVERSHOOT_FULL_C);
+        if (d > want) want = d;
+    }
+
+    float dt = st.started ? (nowMs - st.lastMs) / 1000.0f : 0;
+    st.lastMs = nowMs;
+    st.started = true;
+    if (want >= st.demand) st.demand = want;
+    else st.demand += (want - st.demand) * dt / (FAN_DEMAND_TAU_S + dt);
+
+    uint32_t minOff = profileOffMs < FAN_MIN_OFF_MS ? profileOffMs : FAN_MIN_OFF_MS;
+    return profileOffMs - (uint32_t)(st.demand * (profileOffMs - minOff));
+}
+
+float fan_ctl_slope(const float* t, const bool* valid, int n) {
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+        if (!valid[i]) continue;
+        sx += i;
+        sy += t[i];
+        sxx += (double)i * i;
+        sxy += i * (double)t[i];
+        m++;
+    }
+    if (m < n / 2 || m < 3) return NAN;
+    double den = m * sxx - sx * sx;
+    return den > 0 ? (float)((m * sxy - sx * sy) / den) : NAN;
+}
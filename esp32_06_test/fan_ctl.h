@@ -0,0 +1,37 @@
+// fan_ctl.h - Sterowanie wentylatorem obiegowym (fanMode 2) z rozwarstwienia i trendu komory
+// [NEW] predictiveFanControl() mnożył g_fanOnTime/g_fanOffTime przez 1.5/0.7 z
+//       trendu 5 próbek i zapisywał je pod state_lock w każdym ticku - wartości
+//       profilu przepadały, czasy dryfowały między progami. Teraz profil zostaje
+//       nietknięty i jest granicą: fanOnTime = długość nadmuchu, fanOffTime =
+//       najdłuższa przerwa. Zapotrzebowanie na mieszanie 0..1 skraca przerwę do
+//       FAN_MIN_OFF_MS (nie krócej niż profil pozwala):
+//         - rozwarstwienie: różnica max-min czujników CHAMBER (g_tChamberSpread),
+//         - przeregulowanie: trend komory z historii (tier 0, FAN_TREND_WINDOW_S)
+//           przewidziany o FAN_LOOKAHEAD_S do przodu ponad tSet.
+//       Wzrost zapotrzebowania od razu, spadek ze stałą FAN_DEMAND_TAU_S.
+//       Przeliczane co FAN_CTL_PERIOD_MS, bez zapisu stanu globalnego.
+//       Czysty C++ (bez Arduino) - liczony też w symulacji na hoście.
+#pragma once
+#include <stdint.h>
+
+constexpr uint32_t FAN_CTL_PERIOD_MS   = 10000;
+constexpr int      FAN_TREND_WINDOW_S  = 60;       // okno regresji trendu (próbki 1 s)
+constexpr float    FAN_LOOKAHEAD_S     = 120.0f;   // horyzont przewidywania przeregulowania
+constexpr float    FAN_OVERSHOOT_FULL_C = 3.0f;    // przewidziane przeregulowanie = pełne mieszanie
+constexpr float    FAN_SPREAD_DEAD_C   = 1.0f;     // rozwarstwienie bez reakcji
+constexpr float    FAN_SPREAD_FULL_C   = 5.0f;     // rozwarstwienie = pełne mieszanie
+constexpr float    FAN_DEMAND_TAU_S    = 120.0f;
+constexpr uint32_t FAN_MIN_OFF_MS      = 10000;
+
+struct FanCtlState {
+    float    demand;          // 0..1
+    uint32_t lastMs;
+    bool     started;
+};
+
+void fan_ctl_reset(FanCtlState& st);
+// spread [°C], trend [°C/s]: NAN = brak danych. Zwraca przerwę [ms] w granicach profilu.
+uint32_t fan_ctl_update(FanCtlState& st, uint32_t nowMs, float spread, float trend,
+                        float tChamber, float tSet, uint32_t profileOffMs);
+// Nachylenie [°C/s] regresji liniowej próbek co 1 s, NAN gdy za mało poprawnych
+float fan_ctl_slope(const float* t, const bool* valid, int n);
@@ -778,6 +778,88 @@ bool flash_file_append(const char* path, const String& content) {
     return flash_file_write_string(path, content);
 }
 
+// ======================================================
+// [NEW] PLIK Z REZERWACJA - rejestrator przebiegu (run_recorder.h)
+// flash_file_append zapisuje FAT przy kazdym dopisaniu (2 kasowania sektora),
+// przy rekordzie co kilka sekund przez 10 h to tysiace cykli sektorow FAT.
+// Tu: rezerwacja kasuje sektory i zapisuje FAT raz, fileSize = cala rezerwacja
+// (czytelna w trakcie, niezapisane strony 0xFF), truncate na koniec.
+// ======================================================
+bool flash_file_reserve(const char* path, uint32_t size) {
+    if (!flashReady || size == 0) return false;
+    if (fat_find_file(path) >= 0) {
+        LOG_FMT(LOG_LEVEL_ERROR, "flash_file_reserve: '%s' exists", path);
+        return false;
+    }
+    uint16_t sectorsNeeded = (size + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE;
+    uint16_t rangeStart, rangeEnd;
+    fat_get_sector_range(path, rangeStart, rangeEnd);
+    uint16_t startSector = fat_find_free_contiguous(rangeStart, rangeEnd, sectorsNeeded);
+    if (startSector == 0xFFFF) {
+        LOG_FMT(LOG_LEVEL_WARN, "flash_file_reserve: no space '%s' (%u sect)", path, sectorsNeeded);
+        return false;
+    }
+    int freeSlot = fat_find_free_slot();
+    if (freeSlot < 0) {
+        log_msg(LOG_LEVEL_ERROR, "flash_file_reserve: FAT full");
+        return false;
+    }
+
+    // Kasowanie sektor po sektorze z oddaniem mutexa - TFT nie czeka na cala rezerwacje
+    for (uint16_t k = 0; k < sectorsNeeded; k++) {
+        if (!spi_take()) {
+            log_msg(LOG_LEVEL_ERROR, "flash_file_reserve: mutex timeout");
+            return false;
+        }
+        _flash_erase_sector(startSector + k);
+        uint8_t diag = 0;
+        _flash_read_data((uint32_t)(startSector + k) * FLASH_SECTOR_SIZE, &diag, 1);
+        spi_give();
+        if (diag != 0xFF) {
+            LOG_FMT(LOG_LEVEL_ERROR, "flash_file_reserve: erase FAILED sect=%u", startSector + k);
+            return false;
+        }
+        vTaskDelay(1);
+    }
+
+    memset(&fatTable[freeSlot], 0, sizeof(FlashFileEntry));
+    strncpy(fatTable[freeSlot].filename, path, MAX_FILENAME_LEN - 1);
+    fatTable[freeSlot].filename[MAX_FILENAME_LEN - 1] = '\0';
+    fatTable[freeSlot].startSector = startSector;
+    fatTable[freeSlot].sectorCount = sectorsNeeded;
+    fatTable[freeSlot].fileSize    = (uint32_t)sectorsNeeded * FLASH_SECTOR_SIZE;
+    fatTable[freeSlot].valid       = 0x01;
+    fat_save();
+    LOG_FMT(LOG_LEVEL_INFO, "File reserved: %s (sect %u+%u)", path, startSector, sectorsNeeded);
+    return true;
+}
+
+// Zapis w obrebie rezerwacji - obszar musi byc skasowany (kazda strona raz)
+bool flash_file_write_at(const char* path, uint32_t offset, const uint8_t* data, uint32_t size) {
+    if (!flashReady) return false;
+    int idx = fat_find_file(path);
+    if (idx < 0) return false;
+    if (offset + size > (uint32_t)fatTable[idx].sectorCount * FLASH_SECTOR_SIZE) return false;
+    uint32_t addr = (uint32_t)fatTable[idx].startSector * FLASH_SECTOR_SIZE + offset;
+    if (!spi_take()) return false;
+    bool ok = _flash_write_data_locked(addr, data, size);
+    spi_give();
+    return ok;
+}
+
+bool flash_file_truncate(const char* path, uint32_t size) {
+    if (!flashReady) return false;
+    int idx = fat_find_file(path);
+    if (idx < 0) return false;
+    uint16_t sectors = (size + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE;
+    if (sectors > fatTable[idx].sectorCount) return false;
+    if (sectors == 0) sectors = 1;   // wpis FAT zawsze z sektorem
+    fatTable[idx].sectorCount = sectors;
+    fatTable[idx].fileSize    = size;
+    fat_save();
+    return true;
+}
+
 int flash_list_files(const char* dirPrefix, char files[][MAX_FILENAME_LEN], int maxFiles) {
     int count     = 0;
     int prefixLen = strlen(dirPrefix);
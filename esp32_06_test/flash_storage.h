@@ -26,6 +26,8 @@
 #define LOGS_END            201
 #define WEB_START           202
 #define WEB_END             231   // 30 sektorow = 120KB na pliki web
+#define CHECKPOINT_START    232   // [NEW] pierscien punktow kontrolnych procesu (checkpoint.h), poza FAT
+#define CHECKPOINT_END      239
 #define MAX_FLASH_FILES     64
 #define MAX_FILENAME_LEN    48
 #define FAT_MAGIC           0x46415432UL  // "FAT2"
@@ -63,6 +65,13 @@ int      flash_file_read(const char* path, uint8_t* buffer, uint32_t maxSize);
 bool     flash_file_delete(const char* path);
 bool     flash_file_append(const char* path, const String& content);
 
+// [NEW] Plik z rezerwacja (rejestrator przebiegu): sektory skasowane raz przy
+// tworzeniu, dopisywanie samym zapisem stron bez zapisu FAT, rozmiar ustalany
+// na koniec - jeden zapis FAT, nieuzyte sektory wracaja do puli
+bool     flash_file_reserve(const char* path, uint32_t size);
+bool     flash_file_write_at(const char* path, uint32_t offset, const uint8_t* data, uint32_t size);
+bool     flash_file_truncate(const char* path, uint32_t size);
+
 // [FIX-17] Strumieniowy odczyt - dla HTTP bez alokacji calego pliku
 uint32_t flash_file_get_size(const char* path);
 int      flash_file_read_chunk(const char* path, uint32_t offset, uint8_t* buf, uint32_t size);
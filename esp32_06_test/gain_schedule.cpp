@@ -0,0 +1,87 @@
+// gain_schedule.cpp - Tablica nastaw PID zależna od setpointu i powerMode
+#include "gain_schedule.h"
+#include <string.h>
+#include <math.h>
+
+static constexpr uint8_t GS_VERSION = 1;
+
+void gs_default(GainSchedule& gs) {
+    memset(&gs, 0, sizeof(gs));
+    gs.version  = GS_VERSION;
+    gs.adaptive = 1;   // dotychczasowe zachowanie
+}
+
+static bool pointValid(const GainPoint& p) {
+    if (p.powerMode < 1 || p.powerMode > 3) return false;
+    if (!(p.setpoint >= 0.0f) || p.setpoint > 200.0f) return false;
+    if (!(p.kp >= 0.0f) || !(p.ki >= 0.0f) || !(p.kd >= 0.0f)) return false;
+    return true;
+}
+
+bool gs_valid(const GainSchedule& gs) {
+    if (gs.version != GS_VERSION || gs.count > GS_MAX_POINTS) return false;
+    for (int i = 0; i < gs.count; i++) {
+        if (!pointValid(gs.pt[i])) return false;
+    }
+    return true;
+}
+
+bool gs_lookup(const GainSchedule& gs, int powerMode, float setpoint,
+               float& kp, float& ki, float& kd) {
+    // Punkty są posortowane - szukamy sąsiadów setpointu w obrębie powerMode
+    const GainPoint* lo = nullptr;
+    const GainPoint* hi = nullptr;
+    for (int i = 0; i < gs.count; i++) {
+        const GainPoint& p = gs.pt[i];
+        if (p.powerMode != powerMode) continue;
+        if (p.setpoint <= setpoint) lo = &p;
+        else if (!hi) hi = &p;
+    }
+    if (!lo && !hi) return false;
+    if (!lo || !hi) {
+        const GainPoint* p = lo ? lo : hi;
+        kp = p->kp; ki = p->ki; kd = p->kd;
+        return true;
+    }
+    float f = (setpoint - lo->setpoint) / (hi->setpoint - lo->setpoint);
+    kp = lo->kp + f * (hi->kp - lo->kp);
+    ki = lo->ki + f * (hi->ki - lo->ki);
+    kd = lo->kd + f * (hi->kd - lo->kd);
+    return true;
+}
+
+static bool pointLess(const GainPoint& a, const GainPoint& b) {
+    if (a.powerMode != b.powerMode) return a.powerMode < b.powerMode;
+    return a.setpoint < b.setpoint;
+}
+
+bool gs_set_point(GainSchedule& gs, const GainPoint& p) {
+    if (!pointValid(p)) return false;
+
+    for (int i = 0; i < gs.count; i++) {
+        if (gs.pt[i].powerMode == p.powerMode &&
+            fabsf(gs.pt[i].setpoint - p.setpoint) < GS_MERGE_BAND) {
+            gs_remove_point(gs, i);
+            break;
+        }
+    }
+    if (gs.count >= GS_MAX_POINTS) return false;
+
+    // Wstawienie z zachowaniem kolejności
+    int pos = gs.count;
+    while (pos > 0 && pointLess(p, gs.pt[pos - 1])) {
+        gs.pt[pos] = gs.pt[pos - 1];
+        pos--;
+    }
+    gs.pt[pos] = p;
+    gs.count++;
+    return true;
+}
+
+bool gs_remove_point(GainSchedule& gs, int index) {
+    if (index < 0 || index >= gs.count) return false;
+    for (int i = index; i < gs.count - 1; i++) gs.pt[i] = gs.pt[i + 1];
+    gs.count--;
+    memset(&gs.pt[gs.count], 0, sizeof(GainPoint));
+    return true;
+}
@@ -0,0 +1,44 @@
+// gain_schedule.h - Tablica nastaw PID zależna od setpointu i powerMode
+// [NEW] Punkty (setpoint, powerMode) -> Kp/Ki/Kd. Dla danego powerMode nastawy
+//       interpolowane liniowo po setpoincie między sąsiednimi punktami, poza
+//       zakresem - nastawy skrajnego punktu. Brak punktów dla powerMode = brak
+//       harmonogramu (wołający używa nastaw z autotune / CFG_Kp..).
+//       Czysty C++ - blob NVS "pid_sched", liczony też w symulacji na hoście.
+#pragma once
+#include <stdint.h>
+
+constexpr int   GS_MAX_POINTS = 12;
+constexpr float GS_MERGE_BAND = 5.0f;   // [°C] punkt bliżej niż tyle = zastąpienie
+
+enum class GainSource : uint8_t {
+    USER     = 0,   // wpisany ręcznie (nie MANUAL - koliduje z makrem PID_v1)
+    AUTOTUNE = 1
+};
+
+struct GainPoint {
+    float   setpoint;     // [°C]
+    float   kp, ki, kd;
+    uint8_t powerMode;    // 1..3
+    uint8_t source;       // GainSource
+    uint8_t reserved[2];
+};
+
+struct GainSchedule {
+    uint8_t   version;
+    uint8_t   count;
+    uint8_t   adaptive;   // 1 = heurystyka adaptPidParameters() jako warstwa na nastawach
+    uint8_t   reserved;
+    GainPoint pt[GS_MAX_POINTS];   // posortowane po (powerMode, setpoint)
+};
+
+void gs_default(GainSchedule& gs);
+bool gs_valid(const GainSchedule& gs);
+
+// Nastawy dla (powerMode, setpoint). false = brak punktów dla tego powerMode.
+bool gs_lookup(const GainSchedule& gs, int powerMode, float setpoint,
+               float& kp, float& ki, float& kd);
+
+// Dodaje punkt lub zastępuje istniejący (ten sam powerMode, |dSP| < GS_MERGE_BAND).
+// false = tablica pełna lub niepoprawny punkt.
+bool gs_set_point(GainSchedule& gs, const GainPoint& p);
+bool gs_remove_point(GainSchedule& gs, int index);
@@ -7,6 +7,7 @@
 #include "config.h"
 #include "state.h"
 #include "outputs.h"
+#include "ssr_driver.h"
 #include "wifimanager.h"
 #include "flash_storage.h"
 #include <nvs_flash.h>
@@ -77,9 +78,8 @@ void hardware_init_spi_mutex() {
 
 void hardware_init_ledc() {
     bool ok = true;
-    if (!ledcAttach(PIN_SSR1,      LEDC_FREQ, LEDC_RESOLUTION)) { log_msg(LOG_LEVEL_ERROR, "LEDC SSR1 fail");  ok = false; }
-    if (!ledcAttach(PIN_SSR2,      LEDC_FREQ, LEDC_RESOLUTION)) { log_msg(LOG_LEVEL_ERROR, "LEDC SSR2 fail");  ok = false; }
-    if (!ledcAttach(PIN_SSR3,      LEDC_FREQ, LEDC_RESOLUTION)) { log_msg(LOG_LEVEL_ERROR, "LEDC SSR3 fail");  ok = false; }
+    // [MOD] Grzałki: SSR zero-cross przez ssr_driver (esp_timer), LEDC tylko dla dymu
+    ssr_init();
     if (!ledcAttach(PIN_SMOKE_FAN, LEDC_FREQ, LEDC_RESOLUTION)) { log_msg(LOG_LEVEL_ERROR, "LEDC SMOKE fail"); ok = false; }
     allOutputsOff();
     if (ok) log_msg(LOG_LEVEL_INFO, "LEDC/PWM initialized");
@@ -322,17 +322,14 @@ void runStartupSelfTest() {
     delay(1000);
     esp_task_wdt_reset();
 
+    // [MOD] Wszystkie DS18B20 z magistrali - wymagany co najmniej jeden sprawny
     int cnt = sensors.getDeviceCount();
     bool s1ok = false;
-    if (cnt >= 1) {
-        double t = sensors.getTempCByIndex(0);
-        s1ok = (t != DEVICE_DISCONNECTED_C && t != 85.0 && t > -20 && t < 100);
-        LOG_FMT(LOG_LEVEL_INFO, "Sensor 0: %.1f C %s", t, s1ok?"OK":"FAIL");
-    }
-    if (cnt >= 2) {
-        double t = sensors.getTempCByIndex(1);
+    for (int i = 0; i < cnt; i++) {
+        double t = sensors.getTempCByIndex(i);
         bool ok = (t != DEVICE_DISCONNECTED_C && t != 85.0 && t > -20 && t < 100);
-        LOG_FMT(LOG_LEVEL_INFO, "Sensor 1: %.1f C %s", t, ok?"OK":"WARN");
+        if (ok) s1ok = true;
+        LOG_FMT(LOG_LEVEL_INFO, "Sensor %d: %.1f C %s", i, t, ok?"OK":"WARN");
     }
 
     log_msg(LOG_LEVEL_INFO, "=== OUTPUT TEST ===");
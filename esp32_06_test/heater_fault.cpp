@@ -0,0 +1,128 @@
+// heater_fault.cpp - Wykrywanie martwej grzałki z bilansu mocy komory (patrz heater_fault.h)
+#include "heater_fault.h"
+#include <math.h>
+#include <string.h>
+
+void heater_fault_reset(HeaterFaultState& st) {
+    memset(&st, 0, sizeof(st));
+    st.var = 4.0f * HF_SIGMA_MIN * HF_SIGMA_MIN;
+}
+
+void heater_fault_hold(HeaterFaultState& st) {
+    st.inBlock = false;
+    st.blocks = 0;
+}
+
+void heater_fault_rebase(HeaterFaultState& st) {
+    heater_fault_hold(st);
+    st.baseValid = false;
+}
+
+static void startBlock(HeaterFaultState& st, uint32_t nowMs, float tAir) {
+    st.blockStartMs = nowMs;
+    st.blockTa0 = tAir;
+    st.sumU[0] = st.sumU[1] = st.sumU[2] = 0;
+    st.sumTa = st.sumAmb = 0;
+    st.samples = 0;
+    st.inBlock = true;
+}
+
+static uint8_t finishBlock(HeaterFaultState& st, float rObs, const float u[3], float ta,
+                           float amb, float gainPerSec, float invTau) {
+    // Grzałka już uznana za martwą nie wchodzi do oczekiwanego narastania -
+    // kolejne hipotezy testują dalszą awarię
+    float sumU = 0;
+    for (int i = 0; i < 3; i++) {
+        if (!(st.faultMask & (1 << i))) sumU += u[i];
+    }
+    float x = gainPerSec * sumU + (amb - ta) * invTau - rObs;
+
+    st.blocks++;
+    st.commanded = sumU;
+    st.ambiguous = false;
+    if (st.blocks <= HF_WARMUP_BLOCKS) {
+        // Po starcie i nowej zadanej: linia bazowa = średnia pierwszych bloków.
+        // Po wznowieniu zostaje poprzednia, bloki z przejściowym stanem komory bez decyzji.
+        if (!st.baseValid) {
+            st.base += (x - st.base) / st.blocks;
+            if (st.blocks == HF_WARMUP_BLOCKS) st.baseValid = true;
+        }
+        st.effective = sumU;
+        return 0;
+    }
+
+    float dev = x - st.base;
+    float sigma2 = st.var > HF_SIGMA_MIN * HF_SIGMA_MIN ? st.var : HF_SIGMA_MIN * HF_SIGMA_MIN;
+    uint8_t detected = 0;
+    bool quiet = true, alarm = false, evidence = false;
+    for (int i = 0; i < 3; i++) {
+        if (st.faultMask & (1 << i)) continue;
+        float mu = gainPerSec * u[i];
+        if (u[i] >= HF_MIN_DUTY) {
+            float c = st.cusum[i] + mu / sigma2 * (dev - 0.5f * mu);
+            st.cusum[i] = c > 0 ? c : 0;
+            if (st.cusum[i] > HF_CUSUM_H) alarm = true;
+        }
+        st.sse[i] = HF_ATTRIB_DECAY * st.sse[i] + (dev - mu) * (dev - mu) / sigma2;
+        if (st.cusum[i] > 0) evidence = true;
+        if (st.cusum[i] > 0.5f * HF_CUSUM_H) quiet = false;
+    }
+
+    if (alarm) {
+        // CUSUM mówi "brakuje mocy", którą grzałkę - najlepsze dopasowanie
+        // odchyłek z ostatnich bloków (najmniejsza ważona suma kwadratów).
+        // Grzałki o podobnym wysterowaniu pasują tak samo - wtedy bez wskazania,
+        // rozstrzygnie blok z różnym u
+        int best = -1, second = -1;
+        for (int i = 0; i < 3; i++) {
+            if (st.faultMask & (1 << i)) continue;
+            if (best < 0 || st.sse[i] < st.sse[best]) {
+                second = best;
+                best = i;
+            } else if (second < 0 || st.sse[i] < st.sse[second]) {
+                second = i;
+            }
+        }
+        if (second >= 0 && 0.5f * (st.sse[second] - st.sse[best]) < HF_ATTRIB_LLR) {
+            st.ambiguous = true;
+        } else {
+            st.faultMask |= (1 << best);
+            detected = 1 << best;
+        }
+        evidence = false;
+        st.cusum[0] = st.cusum[1] = st.cusum[2] = 0;
+    }
+    if (!evidence) st.sse[0] = st.sse[1] = st.sse[2] = 0;
+
+    st.effective = gainPerSec > 0 ? sumU - dev / gainPerSec : sumU;
+    if (st.effective < 0) st.effective = 0;
+
+    // Linia bazowa i szum tylko bez podejrzenia - awaria nie wchodzi w normę
+    if (quiet) {
+        st.base += (x - st.base) / HF_BASE_BLOCKS;
+        st.var += (dev * dev - st.var) / HF_BASE_BLOCKS;
+    }
+    return detected;
+}
+
+uint8_t heater_fault_sample(HeaterFaultState& st, uint32_t nowMs, float tAir, float tAmbient,
+                            const float duty[3], float gainPerSec, float invTau) {
+    if (!st.inBlock) {
+        startBlock(st, nowMs, tAir);
+        return 0;
+    }
+    for (int i = 0; i < 3; i++) st.sumU[i] += duty[i];
+    st.sumTa += tAir;
+    st.sumAmb += tAmbient;
+    st.samples++;
+    if (nowMs - st.blockStartMs < HF_BLOCK_MS) return 0;
+
+    float dtS = (nowMs - st.blockStartMs) / 1000.0f;
+    float u[3];
+    for (int i = 0; i < 3; i++) u[i] = (float)(st.sumU[i] / st.samples);
+    float ta = (float)(st.sumTa / st.samples);
+    float amb = (float)(st.sumAmb / st.samples);
+    float rObs = (tAir - st.blockTa0) / dtS;
+    startBlock(st, nowMs, tAir);
+    return finishBlock(st, rObs, u, ta, amb, gainPerSec, invTau);
+}
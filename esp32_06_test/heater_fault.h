@@ -0,0 +1,60 @@
+// heater_fault.h - Wykrywanie martwej grzałki z bilansu mocy komory
+// [NEW] checkHeaterEfficiency() czeka 20 min na brak wzrostu o 2 °C, a martwy SSR
+//       jednej z trzech grzałek nie wstrzymuje wzrostu - nie był wykrywany wcale.
+//       Co blok HF_BLOCK_MS porównanie narastania powietrza z modelem obserwatora:
+//         rExp = K/tauAir * Σu + (Tamb - Ta) / tauAir     (u - wysterowanie grzałek 0..1)
+//         x    = rExp - rObs                              [°C/s] brakujące narastanie
+//       x minus wolna linia bazowa (błąd modelu, ściany) = odchyłka. Hipoteza
+//       "grzałka i martwa" przewiduje odchyłkę mu_i = K/tauAir * u_i. CUSUM ilorazu
+//       wiarygodności (szum gaussowski, wariancja z historii) osobno dla każdej
+//       hipotezy - alarm po przekroczeniu HF_CUSUM_H, zwykle w kilka minut.
+//       Grzałki efektywne = Σu - odchyłka / (K/tauAir). Alarm CUSUM wskazuje grzałkę
+//       najlepiej pasującą do odchyłek z ostatnich bloków; przy zbliżonym u kilku
+//       grzałek dopasowanie nie rozstrzyga - wtedy tylko "ambiguous" (brak mocy).
+//       Martwa grzałka wypada z modelu, CUSUM startuje od zera.
+//       Nowa zadana (skok >= PID_SP_JUMP_C) zmienia straty komory - linia bazowa
+//       uczona od nowa. Wykrywa zmianę w trakcie procesu - grzałka martwa od startu
+//       wchodzi w linię bazową (całkowity brak grzania łapie nadal okno braku wzrostu).
+//       Czysty C++ (bez Arduino) - liczony też w symulacji na hoście.
+#pragma once
+#include <stdint.h>
+
+constexpr uint32_t HF_BLOCK_MS      = 60000;
+constexpr float    HF_MIN_DUTY      = 0.3f;    // hipoteza tylko dla grzałki, która grzała
+constexpr float    HF_CUSUM_H       = 12.0f;   // próg alarmu (log ilorazu wiarygodności)
+constexpr float    HF_BASE_BLOCKS   = 15.0f;   // stała czasowa linii bazowej [bloki]
+constexpr int      HF_WARMUP_BLOCKS = 3;       // po starcie/wznowieniu/skoku zadanej bez decyzji
+constexpr float    HF_ATTRIB_DECAY  = 0.5f;    // zapominanie dopasowania [na blok]
+constexpr float    HF_ATTRIB_LLR    = 3.0f;    // min. przewaga wskazanej grzałki (log ilorazu)
+constexpr float    HF_SIGMA_MIN     = 0.015f;  // [°C/s] dolna granica szumu odchyłki
+
+struct HeaterFaultState {
+    // bieżący blok
+    uint32_t blockStartMs;
+    float    blockTa0;
+    double   sumU[3];
+    double   sumTa, sumAmb;
+    uint32_t samples;
+    bool     inBlock;
+    // model odchyłki
+    float    base;           // linia bazowa x [°C/s]
+    bool     baseValid;
+    float    var;            // wariancja odchyłki [(°C/s)^2]
+    int      blocks;         // bloki od startu/wznowienia/nowej zadanej
+    float    cusum[3];
+    float    sse[3];         // Σ (odchyłka - mu_i)^2 / sigma^2, z zapominaniem
+    // wynik
+    float    effective;      // grzałki efektywne w ostatnim bloku
+    float    commanded;      // Σu sprawnych grzałek w ostatnim bloku
+    uint8_t  faultMask;      // bit i = grzałka i (fizyczna) uznana za martwą
+    bool     ambiguous;      // alarm w ostatnim bloku bez wskazania grzałki
+};
+
+void heater_fault_reset(HeaterFaultState& st);   // nowy proces
+void heater_fault_hold(HeaterFaultState& st);    // pauza/drzwi - blok przerwany, rozgrzewka od nowa
+void heater_fault_rebase(HeaterFaultState& st);  // nowa zadana - jak hold + linia bazowa od nowa
+
+// Świeża próbka: tAir - estymata powietrza, duty[] - grzałki fizyczne 0..1,
+// gainPerSec = K/tauAir, invTau = 1/tauAir. Zwraca bit grzałki wykrytej w tej próbce.
+uint8_t heater_fault_sample(HeaterFaultState& st, uint32_t nowMs, float tAir, float tAmbient,
+                            const float duty[3], float gainPerSec, float invTau);
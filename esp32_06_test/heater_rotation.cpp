@@ -0,0 +1,169 @@
+// heater_rotation.cpp - Rotacja grzałki wiodącej i liczniki czasu pracy grzałek
+#include "heater_rotation.h"
+#include "config.h"
+#include "state.h"
+#include "storage.h"
+#include "outputs.h"
+#include "ssr_driver.h"
+
+static constexpr uint8_t  HTR_STATS_VERSION = 1;
+static constexpr uint32_t TICKS_PER_SEC = 1000000UL / SSR_HALF_CYCLE_US;
+
+struct HeaterStats {
+    uint8_t  version;
+    uint8_t  mode;           // HeaterRotation
+    uint8_t  lead;           // 0..2 - fizyczna grzałka dla 1. stopnia
+    uint8_t  reserved;
+    uint32_t onSec[3];       // czas załączenia SSR [s]
+    uint32_t leadCount[3];   // ile razy grzałka została wiodącą
+};
+
+// Pod heater_lock (taskControl + WWW)
+static HeaterStats   stats;
+static uint32_t      lastCounts[3];
+static uint32_t      pendingTicks[3];   // półokresy jeszcze nie przeliczone na sekundy
+static unsigned long leadSince = 0;
+static unsigned long lastSave = 0;
+static bool          dirty = false;
+static volatile uint8_t leadCache = 0;  // gdy heater_lock się nie uda
+
+static const char* modeName(uint8_t m) {
+    switch ((HeaterRotation)m) {
+        case HeaterRotation::OFF:     return "off";
+        case HeaterRotation::PER_RUN: return "per_run";
+        case HeaterRotation::HOURLY:  return "hourly";
+    }
+    return "off";
+}
+
+// Pod heater_lock - wiodąca = najkrótszy czas pracy, remis -> następna po obecnej
+static void pickLeadLocked() {
+    uint8_t best = (stats.lead + 1) % 3;
+    for (int k = 2; k <= 3; k++) {
+        uint8_t i = (stats.lead + k) % 3;
+        if (stats.onSec[i] < stats.onSec[best]) best = i;
+    }
+    stats.lead = best;
+    stats.leadCount[best]++;
+    leadCache = best;
+    leadSince = millis();
+    dirty = true;
+}
+
+static void saveStats(const HeaterStats& copy) {
+    storage_save_blob_nvs("htr_stats", &copy, sizeof(copy));
+}
+
+void heater_rot_load() {
+    HeaterStats s;
+    if (!storage_load_blob_nvs("htr_stats", &s, sizeof(s)) ||
+        s.version != HTR_STATS_VERSION || s.mode > (uint8_t)HeaterRotation::HOURLY || s.lead > 2) {
+        memset(&s, 0, sizeof(s));
+        s.version = HTR_STATS_VERSION;
+        s.mode = (uint8_t)HeaterRotation::PER_RUN;
+    }
+    if (!heater_lock()) return;
+    stats = s;
+    leadCache = s.mode == (uint8_t)HeaterRotation::OFF ? 0 : s.lead;
+    ssr_on_counts(lastCounts);
+    memset(pendingTicks, 0, sizeof(pendingTicks));
+    leadSince = lastSave = millis();
+    heater_unlock();
+    LOG_FMT(LOG_LEVEL_INFO, "Heater rotation: %s, lead=H%d, on: %.1f/%.1f/%.1f h",
+            modeName(s.mode), s.lead + 1,
+            s.onSec[0] / 3600.0, s.onSec[1] / 3600.0, s.onSec[2] / 3600.0);
+}
+
+void heater_rot_on_start() {
+    if (!heater_lock()) return;
+    bool rotate = stats.mode != (uint8_t)HeaterRotation::OFF;
+    if (rotate) pickLeadLocked();
+    HeaterStats copy = stats;
+    lastSave = millis();
+    dirty = false;
+    heater_unlock();
+    saveStats(copy);
+    if (rotate) LOG_FMT(LOG_LEVEL_INFO, "Lead heater: H%d", copy.lead + 1);
+}
+
+void heater_rot_map(const double stage[3], double phys[3]) {
+    uint32_t counts[3];
+    ssr_on_counts(counts);
+    unsigned long now = millis();
+
+    uint8_t lead = leadCache;
+    bool save = false;
+    HeaterStats copy;
+    if (heater_lock()) {
+        for (int i = 0; i < 3; i++) {
+            pendingTicks[i] += counts[i] - lastCounts[i];
+            lastCounts[i] = counts[i];
+            if (pendingTicks[i] >= TICKS_PER_SEC) {
+                stats.onSec[i] += pendingTicks[i] / TICKS_PER_SEC;
+                pendingTicks[i] %= TICKS_PER_SEC;
+                dirty = true;
+            }
+        }
+        if (stats.mode == (uint8_t)HeaterRotation::HOURLY &&
+            now - leadSince >= HEATER_ROTATE_INTERVAL_MS) {
+            pickLeadLocked();
+            LOG_FMT(LOG_LEVEL_INFO, "Lead heater rotated: H%d", stats.lead + 1);
+        }
+        lead = stats.mode == (uint8_t)HeaterRotation::OFF ? 0 : stats.lead;
+        if (dirty && now - lastSave >= HEATER_STATS_SAVE_MS) {
+            copy = stats;
+            save = true;
+            dirty = false;
+            lastSave = now;
+        }
+        heater_unlock();
+    }
+
+    for (int k = 0; k < 3; k++) phys[(lead + k) % 3] = stage[k];
+    if (save) saveStats(copy);
+}
+
+bool heater_rot_set_mode(HeaterRotation mode) {
+    if ((uint8_t)mode > (uint8_t)HeaterRotation::HOURLY) return false;
+    if (!heater_lock()) return false;
+    stats.mode = (uint8_t)mode;
+    if (mode == HeaterRotation::OFF) stats.lead = 0;
+    leadCache = stats.lead;
+    leadSince = millis();
+    HeaterStats copy = stats;
+    heater_unlock();
+    saveStats(copy);
+    return true;
+}
+
+void heater_rot_reset_counters() {
+    if (!heater_lock()) return;
+    memset(stats.onSec, 0, sizeof(stats.onSec));
+    memset(stats.leadCount, 0, sizeof(stats.leadCount));
+    memset(pendingTicks, 0, sizeof(pendingTicks));
+    HeaterStats copy = stats;
+    heater_unlock();
+    saveStats(copy);
+    log_msg(LOG_LEVEL_INFO, "Heater counters reset");
+}
+
+String heater_rot_json() {
+    HeaterStats s;
+    if (!heater_lock()) return "{}";
+    s = stats;
+    heater_unlock();
+    double duty[3];
+    outputs_heater_duties(duty);
+
+    char buf[384];
+    int len = snprintf(buf, sizeof(buf), "{\"mode\":\"%s\",\"lead\":%d,\"heaters\":[",
+                       modeName(s.mode), s.lead + 1);
+    for (int i = 0; i < 3 && len < (int)sizeof(buf); i++) {
+        len += snprintf(buf + len, sizeof(buf) - len,
+                        "%s{\"id\":%d,\"on_h\":%.2f,\"lead_count\":%lu,\"duty\":%.1f,\"on\":%s}",
+                        i ? "," : "", i + 1, s.onSec[i] / 3600.0, (unsigned long)s.leadCount[i],
+                        duty[i], ssr_is_on(i) ? "true" : "false");
+    }
+    if (len < (int)sizeof(buf)) snprintf(buf + len, sizeof(buf) - len, "]}");
+    return String(buf);
+}
@@ -0,0 +1,27 @@
+// heater_rotation.h - Rotacja grzałki wiodącej i liczniki czasu pracy grzałek
+// [NEW] mapPowerToHeaters() dzieli moc na stopnie (1. stopień pracuje zawsze,
+//       2. i 3. przy wyższym powerMode). Stopień 1 trafia na grzałkę wiodącą,
+//       kolejne na następne fizyczne grzałki. Wiodąca = grzałka o najkrótszym
+//       czasie pracy, wybierana przy starcie procesu (PER_RUN) albo co godzinę
+//       (HOURLY). Liczniki czasu załączenia SSR - blob NVS "htr_stats".
+#pragma once
+#include <Arduino.h>
+
+enum class HeaterRotation : uint8_t {
+    OFF      = 0,   // stała kolejność SSR1, SSR2, SSR3
+    PER_RUN  = 1,
+    HOURLY   = 2
+};
+
+constexpr unsigned long HEATER_ROTATE_INTERVAL_MS = 60UL * 60UL * 1000UL;
+constexpr unsigned long HEATER_STATS_SAVE_MS      = 15UL * 60UL * 1000UL;
+
+void heater_rot_load();                 // setup, po nvs_init
+void heater_rot_on_start();             // start procesu AUTO/MANUAL
+// Co tick z mapPowerToHeaters(): liczniki, rotacja HOURLY, zapis NVS.
+// stage[] -> phys[]: moc stopni 1..3 rozłożona na fizyczne grzałki.
+void heater_rot_map(const double stage[3], double phys[3]);
+
+bool   heater_rot_set_mode(HeaterRotation mode);
+void   heater_rot_reset_counters();
+String heater_rot_json();
@@ -0,0 +1,385 @@
+// history.cpp - Historia pomiarów w pamięci RAM
+// [NEW] Zapis tylko z taskControl (history_tick), odczyt z dowolnego tasku pod historyMutex
+#include "history.h"
+#include "state.h"
+#include "sensors.h"
+#include "outputs.h"
+#include <esp_heap_caps.h>
+
+static constexpr int16_t  HIST_NONE         = INT16_MIN;   // brak poprawnego odczytu
+static constexpr int      HIST_DUTY_SERIES  = 4;           // PID + 3 grzałki
+static constexpr uint32_t HIST_TIER1_RATIO  = 60;          // próbek tier0 na kubełek tier1
+static constexpr uint32_t HIST_TIER2_RATIO  = 10;          // kubełków tier1 na kubełek tier2
+static constexpr uint32_t HIST_HEAP_RESERVE = 40000;       // nie schodzimy poniżej tego heapu
+static constexpr unsigned long HIST_SAMPLE_MAX_AGE_MS = 5000;  // starszy odczyt = brak
+
+struct HistTier {
+    uint8_t* buf;
+    int      slots;
+    int      stride;
+    int      head;      // indeks następnego zapisu
+    int      count;
+    uint32_t period;    // [s]
+    uint32_t lastT;     // czas najnowszego slotu
+};
+
+// Akumulator kubełka min/avg/max (temperatury w 0.1°C, wysterowania w 0.5%)
+struct HistAcc {
+    int32_t  sum[MAX_SENSOR_CHANNELS];
+    int16_t  mn[MAX_SENSOR_CHANNELS];
+    int16_t  mx[MAX_SENSOR_CHANNELS];
+    uint16_t n[MAX_SENSOR_CHANNELS];
+    uint32_t dutySum[HIST_DUTY_SERIES];
+    uint32_t samples;
+};
+
+static SemaphoreHandle_t historyMutex = NULL;
+static uint8_t*  arena = nullptr;
+static size_t    arenaSize = 0;
+static bool      arenaPsram = false;
+static int       histChannels = -1;
+static HistTier  tiers[HIST_TIERS];
+static HistAcc   acc1, acc2;
+static unsigned long lastSampleMs = 0;
+
+static bool history_lock() {
+    return historyMutex && xSemaphoreTake(historyMutex, pdMS_TO_TICKS(CFG_MUTEX_TIMEOUT_MS)) == pdTRUE;
+}
+static void history_unlock() {
+    xSemaphoreGive(historyMutex);
+}
+
+// ======================================================
+// KODOWANIE
+// ======================================================
+
+static inline void put16(uint8_t* p, int16_t v) { memcpy(p, &v, 2); }
+static inline int16_t get16(const uint8_t* p) { int16_t v; memcpy(&v, p, 2); return v; }
+
+static int16_t encodeTemp(float t) {
+    float v = t * 10.0f;
+    if (v > 32767.0f) v = 32767.0f;
+    if (v < -32767.0f) v = -32767.0f;
+    return (int16_t)lroundf(v);
+}
+
+static uint8_t encodeDuty(double pct) {
+    return (uint8_t)constrain(lround(pct * 2.0), 0L, 200L);
+}
+
+static uint8_t clampSpread(int32_t d) {
+    return (uint8_t)(d < 0 ? 0 : (d > 255 ? 255 : d));
+}
+
+static void accReset(HistAcc& a) {
+    memset(&a, 0, sizeof(a));
+}
+
+static void accAdd(HistAcc& a, int ch, int16_t avg, int16_t mn, int16_t mx) {
+    if (avg == HIST_NONE) return;
+    if (a.n[ch] == 0 || mn < a.mn[ch]) a.mn[ch] = mn;
+    if (a.n[ch] == 0 || mx > a.mx[ch]) a.mx[ch] = mx;
+    a.sum[ch] += avg;
+    a.n[ch]++;
+}
+
+// Slot tier1/tier2: [int16 avg, uint8 avg-min, uint8 max-avg] x kanał, [uint8 duty] x 4
+static void writeAggSlot(HistTier& t, const HistAcc& a, uint32_t time) {
+    uint8_t* p = t.buf + t.head * t.stride;
+    for (int ch = 0; ch < histChannels; ch++, p += 4) {
+        if (a.n[ch] == 0) {
+            put16(p, HIST_NONE);
+            p[2] = p[3] = 0;
+            continue;
+        }
+        int16_t avg = (int16_t)(a.sum[ch] / (int32_t)a.n[ch]);
+        put16(p, avg);
+        p[2] = clampSpread(avg - a.mn[ch]);
+        p[3] = clampSpread(a.mx[ch] - avg);
+    }
+    for (int i = 0; i < HIST_DUTY_SERIES; i++) {
+        p[i] = a.samples ? (uint8_t)(a.dutySum[i] / a.samples) : 0;
+    }
+    t.head = (t.head + 1) % t.slots;
+    if (t.count < t.slots) t.count++;
+    t.lastT = time;
+}
+
+static void pushTier2(const HistAcc& a, uint32_t time) {
+    writeAggSlot(tiers[2], a, time);
+}
+
+static void pushTier1(const HistAcc& a, uint32_t time) {
+    HistTier& t = tiers[1];
+    writeAggSlot(t, a, time);
+
+    // Kubełek tier1 -> akumulator tier2 (średnia ze średnich, skrajne min/max)
+    const uint8_t* p = t.buf + ((t.head + t.slots - 1) % t.slots) * t.stride;
+    for (int ch = 0; ch < histChannels; ch++, p += 4) {
+        int16_t avg = get16(p);
+        if (avg == HIST_NONE) continue;
+        accAdd(acc2, ch, avg, avg - p[2], avg + p[3]);
+    }
+    for (int i = 0; i < HIST_DUTY_SERIES; i++) acc2.dutySum[i] += p[i];
+    if (++acc2.samples >= HIST_TIER2_RATIO) {
+        pushTier2(acc2, time);
+        accReset(acc2);
+    }
+}
+
+// Slot tier0: [int16 temp] x kanał, [uint8 duty] x 4
+static void pushTier0(const int16_t* temps, const uint8_t* duty, uint32_t time) {
+    HistTier& t = tiers[0];
+    uint8_t* p = t.buf + t.head * t.stride;
+    for (int ch = 0; ch < histChannels; ch++, p += 2) put16(p, temps[ch]);
+    memcpy(p, duty, HIST_DUTY_SERIES);
+    t.head = (t.head + 1) % t.slots;
+    if (t.count < t.slots) t.count++;
+    t.lastT = time;
+
+    for (int ch = 0; ch < histChannels; ch++) accAdd(acc1, ch, temps[ch], temps[ch], temps[ch]);
+    for (int i = 0; i < HIST_DUTY_SERIES; i++) acc1.dutySum[i] += duty[i];
+    if (++acc1.samples >= HIST_TIER1_RATIO) {
+        pushTier1(acc1, time);
+        accReset(acc1);
+    }
+}
+
+static bool decodeSlot(uint8_t tierIdx, int slot, uint8_t series, HistPoint& pt) {
+    const HistTier& t = tiers[tierIdx];
+    const uint8_t* p = t.buf + slot * t.stride;
+    bool agg = tierIdx > 0;
+    int tempBytes = agg ? 4 : 2;
+
+    if (series >= HIST_SERIES_PID) {
+        uint8_t d = p[histChannels * tempBytes + (series - HIST_SERIES_PID)];
+        pt.avg = pt.min = pt.max = d * 0.5f;
+        pt.valid = true;
+        return true;
+    }
+    if (series >= histChannels) return false;
+
+    p += series * tempBytes;
+    int16_t avg = get16(p);
+    pt.valid = (avg != HIST_NONE);
+    if (!pt.valid) {
+        pt.avg = pt.min = pt.max = 0;
+        return true;
+    }
+    pt.avg = avg * 0.1f;
+    pt.min = agg ? (avg - p[2]) * 0.1f : pt.avg;
+    pt.max = agg ? (avg + p[3]) * 0.1f : pt.avg;
+    return true;
+}
+
+// ======================================================
+// PRZYDZIAŁ PAMIĘCI
+// ======================================================
+
+static void layoutTiers(int nCh, int tier1Slots) {
+    int stride0 = nCh * 2 + HIST_DUTY_SERIES;
+    int strideA = nCh * 4 + HIST_DUTY_SERIES;
+    int slots[HIST_TIERS]   = { HIST_TIER0_SLOTS, tier1Slots, HIST_TIER2_SLOTS };
+    int strides[HIST_TIERS] = { stride0, strideA, strideA };
+    uint32_t periods[HIST_TIERS] = { 1, HIST_TIER1_RATIO, HIST_TIER1_RATIO * HIST_TIER2_RATIO };
+
+    uint8_t* p = arena;
+    for (int i = 0; i < HIST_TIERS; i++) {
+        tiers[i].buf    = p;
+        tiers[i].slots  = slots[i];
+        tiers[i].stride = strides[i];
+        tiers[i].head   = 0;
+        tiers[i].count  = 0;
+        tiers[i].period = periods[i];
+        tiers[i].lastT  = 0;
+        p += (size_t)slots[i] * strides[i];
+    }
+}
+
+// [MOD] Bez historyMutex - malloc nie blokuje taskControl ani czytelników
+static uint8_t* allocate(int nCh, size_t& size, bool& psram, int& tier1Slots) {
+    int stride0 = nCh * 2 + HIST_DUTY_SERIES;
+    int strideA = nCh * 4 + HIST_DUTY_SERIES;
+    tier1Slots = HIST_TIER1_SLOTS;
+
+    // PSRAM (jeśli jest) - pełny rozmiar, inaczej RAM wewnętrzny z zapasem na resztę systemu
+    size = (size_t)HIST_TIER0_SLOTS * stride0 + (size_t)(tier1Slots + HIST_TIER2_SLOTS) * strideA;
+    uint8_t* p = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    psram = (p != nullptr);
+
+    while (!p && tier1Slots >= HIST_TIER1_MIN_SLOTS) {
+        size = (size_t)HIST_TIER0_SLOTS * stride0 + (size_t)(tier1Slots + HIST_TIER2_SLOTS) * strideA;
+        if (ESP.getFreeHeap() > size + HIST_HEAP_RESERVE) {
+            p = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        }
+        if (!p) tier1Slots /= 2;
+    }
+    return p;
+}
+
+// ======================================================
+// API
+// ======================================================
+
+void history_init() {
+    if (!historyMutex) historyMutex = xSemaphoreCreateMutex();
+    int nCh = 0;
+    if (state_lock()) {
+        nCh = g_sensorChannelCount;
+        state_unlock();
+    }
+    history_set_channels(nCh);
+}
+
+// [MOD] Układ slotów i znaczenie serii zależą od tablicy kanałów - każda jej
+// zmiana (także przestawienie przy tej samej liczbie) zaczyna historię od nowa.
+// Ta sama liczba kanałów - bufor zostaje, tylko czyszczony pod historyMutex.
+// Inna - stary bufor zwalniany przed przydziałem nowego (bez podwójnego szczytu
+// pamięci); w przerwie history_tick pomija próbki, odczyty zwracają 0 punktów.
+void history_set_channels(int nCh) {
+    if (!history_lock()) return;
+    accReset(acc1);
+    accReset(acc2);
+    if (arena && nCh == histChannels) {
+        layoutTiers(nCh, tiers[1].slots);
+        history_unlock();
+        log_msg(LOG_LEVEL_INFO, "History: channel table changed - cleared");
+        return;
+    }
+    uint8_t* old = arena;
+    arena = nullptr;
+    arenaSize = 0;
+    histChannels = -1;
+    memset(tiers, 0, sizeof(tiers));
+    history_unlock();
+    if (old) heap_caps_free(old);
+
+    size_t size;
+    bool psram;
+    int tier1Slots;
+    uint8_t* p = allocate(nCh, size, psram, tier1Slots);
+    if (!p) {
+        log_msg(LOG_LEVEL_ERROR, "History: out of memory - disabled");
+        return;
+    }
+
+    if (!history_lock()) {
+        heap_caps_free(p);
+        return;
+    }
+    arena = p;
+    arenaSize = size;
+    arenaPsram = psram;
+    histChannels = nCh;
+    layoutTiers(nCh, tier1Slots);
+    accReset(acc1);
+    accReset(acc2);
+    history_unlock();
+    LOG_FMT(LOG_LEVEL_INFO, "History: %d ch, %u B in %s, 1-min tier %d slots",
+            nCh, (unsigned)size, psram ? "PSRAM" : "RAM", tier1Slots);
+}
+
+void history_tick() {
+    unsigned long now = millis();
+    if (lastSampleMs != 0 && now - lastSampleMs < 1000) return;
+
+    // Luka (np. zablokowany task) - wypełniamy powtórzeniem ostatniej próbki
+    uint32_t steps = 1;
+    if (lastSampleMs == 0) lastSampleMs = now;
+    else {
+        steps = (now - lastSampleMs) / 1000;
+        lastSampleMs += steps * 1000;
+    }
+    if (steps > (uint32_t)HIST_TIER0_SLOTS) steps = HIST_TIER0_SLOTS;
+
+    SensorChannel table[MAX_SENSOR_CHANNELS];
+    SensorReading rd[MAX_SENSOR_CHANNELS];
+    int nCh = sensors_copy_table(table, rd);
+
+    int16_t temps[MAX_SENSOR_CHANNELS];
+    for (int ch = 0; ch < nCh; ch++) {
+        bool fresh = rd[ch].timestamp != 0 && now - rd[ch].timestamp < HIST_SAMPLE_MAX_AGE_MS;
+        temps[ch] = fresh ? encodeTemp(rd[ch].value) : HIST_NONE;
+    }
+    double heaters[3];
+    outputs_heater_duties(heaters);
+    uint8_t duty[HIST_DUTY_SERIES] = {
+        encodeDuty(pidOutput), encodeDuty(heaters[0]), encodeDuty(heaters[1]), encodeDuty(heaters[2])
+    };
+
+    if (!history_lock()) return;
+    // [MOD] Przydział przy zmianie tablicy robi history_set_channels (taskSensors);
+    // do tego czasu próbki z inną liczbą kanałów pomijane
+    if (arena && nCh == histChannels) {
+        uint32_t t = now / 1000 - (steps - 1);
+        for (uint32_t i = 0; i < steps; i++) pushTier0(temps, duty, t + i);
+    }
+    history_unlock();
+}
+
+// Wołane pod historyMutex: punkty od 'skip'-tego najstarszego slotu
+static int readSlots(uint8_t tier, uint8_t series, int skip, HistPoint* out, int maxPoints) {
+    const HistTier& t = tiers[tier];
+    if (!arena || t.count == 0) return 0;
+    // Najstarszy slot ma czas lastT - (count-1)*period
+    uint32_t span = (uint32_t)(t.count - 1) * t.period;
+    uint32_t oldestT = t.lastT >= span ? t.lastT - span : 0;
+    int start = (t.head - t.count + t.slots) % t.slots;
+    int n = 0;
+    for (int i = skip < 0 ? 0 : skip; i < t.count && n < maxPoints; i++) {
+        HistPoint& pt = out[n];
+        if (!decodeSlot(tier, (start + i) % t.slots, series, pt)) break;
+        pt.t = oldestT + (uint32_t)i * t.period;
+        n++;
+    }
+    return n;
+}
+
+int history_read(uint8_t tier, uint8_t series, uint32_t sinceSec,
+                 HistPoint* out, int maxPoints) {
+    if (tier >= HIST_TIERS || series >= HIST_SERIES_COUNT || maxPoints <= 0) return 0;
+    if (!history_lock()) return 0;
+    const HistTier& t = tiers[tier];
+    int skip = 0;
+    if (t.count > 0) {
+        uint32_t span = (uint32_t)(t.count - 1) * t.period;
+        uint32_t oldestT = t.lastT >= span ? t.lastT - span : 0;
+        if (sinceSec >= oldestT) skip = (int)((sinceSec - oldestT) / t.period) + 1;
+    }
+    int n = readSlots(tier, series, skip, out, maxPoints);
+    history_unlock();
+    return n;
+}
+
+int history_read_last(uint8_t tier, uint8_t series, HistPoint* out, int count) {
+    if (tier >= HIST_TIERS || series >= HIST_SERIES_COUNT || count <= 0) return 0;
+    if (!history_lock()) return 0;
+    int n = readSlots(tier, series, tiers[tier].count - count, out, count);
+    history_unlock();
+    return n;
+}
+
+uint32_t history_tier_period(uint8_t tier) {
+    return tier < HIST_TIERS ? tiers[tier].period : 0;
+}
+
+String history_info_json() {
+    if (!history_lock()) return "{}";
+    String json;
+    json.reserve(320);
+    json = "{\"channels\":" + String(histChannels < 0 ? 0 : histChannels) +
+           ",\"bytes\":" + String((unsigned)arenaSize) +
+           ",\"psram\":" + String(arenaPsram ? "true" : "false") +
+           ",\"now\":" + String((unsigned long)(millis() / 1000)) +
+           ",\"tiers\":[";
+    for (int i = 0; i < HIST_TIERS; i++) {
+        if (i) json += ",";
+        json += "{\"period\":" + String((unsigned long)tiers[i].period) +
+                ",\"slots\":" + String(tiers[i].slots) +
+                ",\"count\":" + String(tiers[i].count) +
+                ",\"last\":" + String((unsigned long)tiers[i].lastT) + "}";
+    }
+    json += "]}";
+    history_unlock();
+    return json;
+}
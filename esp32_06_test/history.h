@@ -0,0 +1,49 @@
+// history.h - Historia pomiarów w pamięci RAM (bez ponownego odczytu czujników)
+// [NEW] Trzy poziomy, stała pamięć przydzielana raz dla danej liczby kanałów:
+//         tier 0:   1 s  x 600   (ostatnie 10 min), surowe próbki
+//         tier 1:   1 min x 1440 (24 h = CFG_MAX_PROCESS_TIME_MS), min/avg/max
+//         tier 2:  10 min x 144  (24 h), min/avg/max
+//       Serie: kanały 0..MAX_SENSOR_CHANNELS-1 (°C) + wyjście PID + 3 grzałki (%).
+//       Upakowanie: temperatura int16 [0.1°C], min/max jako uint8 odchyłki od
+//       średniej, wysterowania uint8 [0.5%]. Znaczniki czasu wynikają z pozycji
+//       w buforze (okres stały, luki wypełniane ostatnią próbką).
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+constexpr int HIST_TIERS           = 3;
+constexpr int HIST_TIER0_SLOTS     = 600;
+constexpr int HIST_TIER1_SLOTS     = (int)(CFG_MAX_PROCESS_TIME_MS / 60000UL);
+constexpr int HIST_TIER2_SLOTS     = (int)(CFG_MAX_PROCESS_TIME_MS / 600000UL);
+constexpr int HIST_TIER1_MIN_SLOTS = 120;   // minimum gdy brakuje pamięci (2 h)
+
+// Identyfikatory serii - kanały mają id równe numerowi kanału
+constexpr uint8_t HIST_SERIES_PID = MAX_SENSOR_CHANNELS;
+constexpr uint8_t HIST_SERIES_H1  = MAX_SENSOR_CHANNELS + 1;
+constexpr uint8_t HIST_SERIES_H2  = MAX_SENSOR_CHANNELS + 2;
+constexpr uint8_t HIST_SERIES_H3  = MAX_SENSOR_CHANNELS + 3;
+constexpr uint8_t HIST_SERIES_COUNT = MAX_SENSOR_CHANNELS + 4;
+
+struct HistPoint {
+    uint32_t t;       // [s] od startu (millis()/1000) - koniec okresu próbki
+    float    avg;
+    float    min;
+    float    max;
+    bool     valid;   // false = kanał bez poprawnego odczytu w całym okresie
+};
+
+// Przydział buforów dla bieżącej tablicy kanałów (setup, po sensors_init_channels)
+void history_init();
+// [NEW] Nowa tablica kanałów - historia od nowa (taskSensors, po podmianie tablicy)
+void history_set_channels(int nCh);
+// Wołane z taskControl co tick - próbkuje raz na sekundę
+void history_tick();
+
+// Punkty z poziomu 'tier' nowsze niż sinceSec, od najstarszego. Zwraca liczbę.
+int  history_read(uint8_t tier, uint8_t series, uint32_t sinceSec,
+                  HistPoint* out, int maxPoints);
+// Ostatnie 'count' punktów (do trendów: ETA, wykrywanie awarii)
+int  history_read_last(uint8_t tier, uint8_t series, HistPoint* out, int count);
+
+uint32_t history_tier_period(uint8_t tier);
+String   history_info_json();
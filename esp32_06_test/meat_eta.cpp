@@ -0,0 +1,81 @@
+// meat_eta.cpp - Prognoza czasu dojścia rdzenia mięsa (patrz meat_eta.h)
+#include "meat_eta.h"
+#include <math.h>
+#include <string.h>
+
+void meat_eta_reset(MeatEtaState& st) {
+    memset(&st, 0, sizeof(st));
+}
+
+static void recomputeSums(MeatEtaState& st) {
+    st.sxx = st.sxy = st.syy = 0;
+    for (int i = 0; i < st.count; i++) {
+        st.sxx += (double)st.x[i] * st.x[i];
+        st.sxy += (double)st.x[i] * st.y[i];
+        st.syy += (double)st.y[i] * st.y[i];
+    }
+}
+
+void meat_eta_add(MeatEtaState& st, uint32_t nowMs, float tMeat, float tChamber) {
+    if (!st.havePrev) {
+        st.prevMs = nowMs;
+        st.prevTm = tMeat;
+        st.prevTc = tChamber;
+        st.havePrev = true;
+        return;
+    }
+    uint32_t dtMs = nowMs - st.prevMs;
+    if (dtMs == 0) return;
+
+    float x = 0.5f * (tChamber + st.prevTc) - 0.5f * (tMeat + st.prevTm);
+    float y = (tMeat - st.prevTm) * 1000.0f / dtMs;
+    st.prevMs = nowMs;
+    st.prevTm = tMeat;
+    st.prevTc = tChamber;
+
+    // Okno pełne - najstarsza próbka wypada z sum
+    if (st.count == MEAT_ETA_WINDOW) {
+        float ox = st.x[st.head], oy = st.y[st.head];
+        st.sxx -= (double)ox * ox;
+        st.sxy -= (double)ox * oy;
+        st.syy -= (double)oy * oy;
+    } else {
+        st.count++;
+    }
+    st.x[st.head] = x;
+    st.y[st.head] = y;
+    st.sxx += (double)x * x;
+    st.sxy += (double)x * y;
+    st.syy += (double)y * y;
+    st.head = (st.head + 1) % MEAT_ETA_WINDOW;
+    if (st.head == 0) recomputeSums(st);
+}
+
+bool meat_eta_rate(const MeatEtaState& st, float& k, float& kStdErr) {
+    if (st.count < MEAT_ETA_MIN_SAMPLES || st.sxx < 1e-6) return false;
+    double kk = st.sxy / st.sxx;
+    if (kk <= 0) return false;
+    double sse = st.syy - kk * st.sxy;
+    if (sse < 0) sse = 0;
+    k = (float)kk;
+    kStdErr = (float)sqrt(sse / (st.count - 1) / st.sxx);
+    return true;
+}
+
+bool meat_eta_predict(const MeatEtaState& st, float tMeat, float tChamber, float target,
+                      float& etaSec, float& confidence) {
+    if (tMeat >= target) {
+        etaSec = 0;
+        confidence = 1.0f;
+        return true;
+    }
+    float k, kErr;
+    if (!meat_eta_rate(st, k, kErr)) return false;
+    if (tChamber - target < 0.1f) return false;   // przy tej komorze mięso nie dojdzie
+
+    etaSec = logf((tChamber - tMeat) / (tChamber - target)) / k;
+    float fill = (float)st.count / MEAT_ETA_WINDOW;
+    float fit = 1.0f - 2.0f * kErr / k;
+    confidence = fill * (fit > 0 ? fit : 0.0f);
+    return true;
+}
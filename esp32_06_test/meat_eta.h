@@ -0,0 +1,41 @@
+// meat_eta.h - Prognoza czasu dojścia rdzenia mięsa do temperatury docelowej
+// [NEW] Kroki z useMeatTemp kończą się dopiero przy tMeatTarget, a minTimeMs tego
+//       nie mówi. Model I rzędu (wymiana ciepła powietrze -> mięso):
+//         dTm/dt = k * (Tc - Tm)
+//       k z regresji (przez zero) pochodnej Tm względem różnicy komora-mięso w oknie
+//       przesuwnym. Sumy aktualizowane przy dodaniu/usunięciu próbki - O(1) na
+//       próbkę, przeliczane od nowa raz na obieg okna (dryf zaokrągleń).
+//       Prognoza przy komorze utrzymywanej na Tc:
+//         t = ln((Tc - Tm) / (Tc - Ttarget)) / k
+//       Pewność: zapełnienie okna x (1 - 2 * błąd względny k).
+//       Czysty C++ (bez Arduino) - liczony też w symulacji na hoście.
+#pragma once
+#include <stdint.h>
+
+constexpr int      MEAT_ETA_WINDOW    = 30;      // próbek w oknie (30 min)
+constexpr uint32_t MEAT_ETA_SAMPLE_MS = 60000;   // odstęp próbek
+constexpr int      MEAT_ETA_MIN_SAMPLES = 8;
+
+struct MeatEtaState {
+    float    x[MEAT_ETA_WINDOW];   // Tc - Tm (średnia z przedziału) [°C]
+    float    y[MEAT_ETA_WINDOW];   // dTm/dt [°C/s]
+    double   sxx, sxy, syy;
+    int      count;
+    int      head;                 // następny zapis
+    uint32_t prevMs;
+    float    prevTm, prevTc;
+    bool     havePrev;
+};
+
+void meat_eta_reset(MeatEtaState& st);
+
+// Nowy pomiar (wołać co ~MEAT_ETA_SAMPLE_MS); pierwszy tylko zapamiętuje punkt startowy
+void meat_eta_add(MeatEtaState& st, uint32_t nowMs, float tMeat, float tChamber);
+
+// Stała k [1/s] i jej błąd standardowy; false gdy za mało próbek lub k <= 0
+bool meat_eta_rate(const MeatEtaState& st, float& k, float& kStdErr);
+
+// Czas do target [s] przy komorze tChamber. false = brak prognozy
+// (za mało danych, komora nie wyżej niż target). Mięso już ciepłe: 0 s, pewność 1.
+bool meat_eta_predict(const MeatEtaState& st, float tMeat, float tChamber, float target,
+                      float& etaSec, float& confidence);
@@ -144,7 +144,7 @@ void notifications_check() {
     // W trybie AUTO - z aktualnego kroku profilu
     // W trybie MANUAL - g_tSet jest jednoczesnie celem komory i mięsa
     if (state == ProcessState::RUNNING_AUTO && g_currentStep < g_stepCount) {
-        tMeatTarget = g_profile[g_currentStep].tMeatTarget;
+        tMeatTarget = profile_steps(g_profile)[g_currentStep].tMeat / 10.0;
     } else if (state == ProcessState::RUNNING_MANUAL) {
         tMeatTarget = tSet;  // w MANUAL: alert gdy mieso osiagnie temperature zadana
     } else {
@@ -0,0 +1,86 @@
+// ntc_scanner.cpp - Skaner wielu sond NTC na ADC1 (tryb ciągły, DMA)
+#include "ntc_scanner.h"
+#include "config.h"
+
+struct ScanAccumulator {
+    uint8_t  pin;
+    uint32_t sum;       // suma średnich z ramek
+    uint32_t frames;
+};
+
+static ScanAccumulator acc[MAX_NTC_CHANNELS];
+static int  accCount = 0;
+static bool scannerActive = false;
+
+bool ntc_scanner_pin_ok(uint8_t pin) {
+    // ESP32: ADC1 = GPIO32..39. 32/33 zajęte przez przycisk i buzzer.
+    return pin >= 34 && pin <= 39 && digitalPinToAnalogChannel(pin) >= 0;
+}
+
+bool ntc_scanner_begin(const uint8_t* pins, int count) {
+    ntc_scanner_stop();
+    accCount = 0;
+    if (count <= 0) return false;
+    if (count > MAX_NTC_CHANNELS) count = MAX_NTC_CHANNELS;
+
+    uint8_t scanPins[MAX_NTC_CHANNELS];
+    for (int i = 0; i < count; i++) {
+        if (!ntc_scanner_pin_ok(pins[i])) {
+            LOG_FMT(LOG_LEVEL_ERROR, "NTC scan: GPIO%d is not a free ADC1 pin", pins[i]);
+            return false;
+        }
+        scanPins[i] = pins[i];
+        acc[i] = {pins[i], 0, 0};
+    }
+    accCount = count;
+
+    analogContinuousSetWidth(NTC_ADC_RESOLUTION);
+    analogContinuousSetAtten(NTC_ADC_ATTENUATION);
+    if (!analogContinuous(scanPins, count, NTC_SCAN_CONV_PER_PIN, NTC_SCAN_SAMPLE_FREQ, nullptr) ||
+        !analogContinuousStart()) {
+        log_msg(LOG_LEVEL_WARN, "NTC scan: continuous ADC unavailable, using sync reads");
+        analogContinuousDeinit();
+        return false;
+    }
+
+    scannerActive = true;
+    LOG_FMT(LOG_LEVEL_INFO, "NTC scan: %d pin(s), %lu Hz, %d conv/pin per frame",
+            count, (unsigned long)NTC_SCAN_SAMPLE_FREQ, NTC_SCAN_CONV_PER_PIN);
+    return true;
+}
+
+void ntc_scanner_stop() {
+    if (!scannerActive) return;
+    analogContinuousStop();
+    analogContinuousDeinit();
+    scannerActive = false;
+}
+
+bool ntc_scanner_active() { return scannerActive; }
+
+void ntc_scanner_poll() {
+    if (!scannerActive) return;
+
+    // Bez czekania - zabieramy tylko to, co DMA już skończyło
+    adc_continuous_data_t* frame = nullptr;
+    for (int n = 0; n < NTC_SCAN_MAX_FRAMES_PER_POLL; n++) {
+        if (!analogContinuousRead(&frame, 0)) break;
+        for (int i = 0; i < accCount; i++) {
+            if (frame[i].pin != acc[i].pin) continue;
+            acc[i].sum += frame[i].avg_read_raw;
+            acc[i].frames++;
+        }
+    }
+}
+
+bool ntc_scanner_take(uint8_t pin, double& adcAvg) {
+    for (int i = 0; i < accCount; i++) {
+        if (acc[i].pin != pin) continue;
+        if (acc[i].frames == 0) return false;
+        adcAvg = (double)acc[i].sum / acc[i].frames;
+        acc[i].sum = 0;
+        acc[i].frames = 0;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,21 @@
+// ntc_scanner.h - Skaner wielu sond NTC na ADC1 (tryb ciągły, DMA)
+// [NEW] Jeden strumień konwersji przeplatający kanały round-robin.
+//       taskSensors tylko zbiera gotowe ramki - bez pętli analogRead().
+#pragma once
+#include <Arduino.h>
+
+// Piny ADC1 dostępne dla sond (ADC2 jest zajęte przez WiFi)
+bool ntc_scanner_pin_ok(uint8_t pin);
+
+// (Re)konfiguracja strumienia dla podanych pinów. false = tryb ciągły
+// niedostępny - wołający używa odczytu synchronicznego.
+bool ntc_scanner_begin(const uint8_t* pins, int count);
+void ntc_scanner_stop();
+bool ntc_scanner_active();
+
+// Zbiera gotowe ramki z DMA do sum per pin - wołać co cykl taskSensors
+void ntc_scanner_poll();
+
+// Średnie ADC pinu od ostatniego wywołania (zeruje akumulator).
+// false = brak nowych ramek dla tego pinu.
+bool ntc_scanner_take(uint8_t pin, double& adcAvg);
@@ -2,6 +2,8 @@
 #include "outputs.h"
 #include "config.h"
 #include "state.h"
+#include "ssr_driver.h"   // [NEW]
+#include "heater_rotation.h"   // [NEW]
 
 // --- Zmienne dla brzęczyka ---
 static volatile bool buzzerActive = false;
@@ -17,18 +19,57 @@ static HeaterEnable he;
 // --- Zmienne dla wentylatora cyklicznego (atomic) ---
 static volatile bool fanState = true;
 static volatile unsigned long fanTimer = 0;
+// [NEW] Przerwa z fan_ctl (process.cpp), 0 = g_fanOffTime z profilu
+static volatile unsigned long fanOffOverride = 0;
+
+// [NEW] Wysterowanie grzałek po soft-enable [%] - wejście obserwatora komory i historia
+static volatile double heaterDuty[3] = {0, 0, 0};
+// [NEW] pidOutput w skali 0..100 przeliczone przez stopnie, które soft-enable przepuścił
+static volatile double appliedOutput = 0;
+// [NEW] PWM dymu na wyjściu; -1 = nieznany (pierwszy zapis zawsze do LEDC)
+static volatile int smokeOut = -1;
+
+double outputs_heater_power() {
+    return (heaterDuty[0] + heaterDuty[1] + heaterDuty[2]) / 100.0;
+}
+
+void outputs_heater_duties(double duty[3]) {
+    for (int i = 0; i < 3; i++) duty[i] = heaterDuty[i];
+}
+
+double outputs_applied_output() {
+    return appliedOutput;
+}
+
+void outputs_set_smoke(int pwm) {
+    if (pwm == smokeOut) return;
+    if (!output_lock()) return;
+    ledcWrite(PIN_SMOKE_FAN, pwm);
+    smokeOut = pwm;
+    output_unlock();
+}
+
+int outputs_smoke() {
+    return smokeOut < 0 ? 0 : smokeOut;
+}
+
+void outputs_set_fan_off(unsigned long offMs) {
+    fanOffOverride = offMs;
+}
 
 void allOutputsOff() {
+    heaterDuty[0] = heaterDuty[1] = heaterDuty[2] = 0;
+    appliedOutput = 0;
+    fanOffOverride = 0;
     // [FIX] Sprawdzenie czy udało się zablokować mutex
     if (!output_lock()) {
         log_msg(LOG_LEVEL_ERROR, "allOutputsOff: output_lock failed!");
         // Mimo to spróbuj wyłączyć wyjścia - bezpieczeństwo ważniejsze
     }
-    ledcWrite(PIN_SSR1, 0);
-    ledcWrite(PIN_SSR2, 0);
-    ledcWrite(PIN_SSR3, 0);
+    ssr_all_off();   // [MOD] grzałki przez ssr_driver
     digitalWrite(PIN_FAN, LOW);
     ledcWrite(PIN_SMOKE_FAN, 0);
+    smokeOut = 0;
     output_unlock();
 }
 
@@ -116,6 +157,8 @@ void mapPowerToHeaters() {
         else { p1 = 100; p2 = 100; p3 = (p - 66) * 3; }
     }
 
+    double requested = p1 + p2 + p3;
+
     // [FIX] Sprawdzenie locka
     if (!heater_lock()) return;
     if (!he.h1) p1 = 0;
@@ -123,11 +166,20 @@ void mapPowerToHeaters() {
     if (!he.h3) p3 = 0;
     heater_unlock();
 
+    // [NEW] Stopnie wyłączone przez soft-enable - ta część wyjścia nie dotarła do grzałek
+    appliedOutput = requested > 0 ? p * (p1 + p2 + p3) / requested : p;
+
+    // [NEW] p1..p3 to stopnie mocy - stopień 1 na grzałkę wiodącą (rotacja zużycia)
+    const double stage[3] = {p1, p2, p3};
+    double phys[3];
+    heater_rot_map(stage, phys);
+
+    // [MOD] Modulacja półokresami sieci zamiast LEDC - moc liniowa względem p
     if (!output_lock()) return;
-    ledcWrite(PIN_SSR1, (int)(p1 * 2.55));
-    ledcWrite(PIN_SSR2, (int)(p2 * 2.55));
-    ledcWrite(PIN_SSR3, (int)(p3 * 2.55));
+    for (int i = 0; i < 3; i++) ssr_set_duty(i, phys[i]);
     output_unlock();
+
+    for (int i = 0; i < 3; i++) heaterDuty[i] = phys[i];
 }
 
 void handleFanLogic() {
@@ -137,6 +189,8 @@ void handleFanLogic() {
     unsigned long onT = g_fanOnTime;
     unsigned long offT = g_fanOffTime;
     state_unlock();
+    unsigned long offOvr = fanOffOverride;
+    if (offOvr != 0 && offOvr < offT) offT = offOvr;   // [NEW] profil = najdłuższa przerwa
 
     if (fm == 0) {
         digitalWrite(PIN_FAN, LOW);
@@ -8,5 +8,11 @@ void handleBuzzer();
 void initHeaterEnable();
 void applySoftEnable();
 void mapPowerToHeaters();
+double outputs_heater_power();  // [NEW] ostatnio wysterowana moc: suma grzałek 0..3 (1 = jedna na 100%)
+void outputs_heater_duties(double duty[3]);  // [NEW] wysterowanie grzałek 0..100 %
+double outputs_applied_output();  // [NEW] wyjście PID faktycznie oddane po soft-enable (0..100) - anti-windup
+void outputs_set_smoke(int pwm);  // [NEW] PWM dymu 0..255, zapis do LEDC tylko przy zmianie
+int outputs_smoke();              // [NEW] PWM dymu faktycznie na wyjściu
+void outputs_set_fan_off(unsigned long offMs);  // [NEW] przerwa wentylatora (fanMode 2), 0 = z profilu
 void handleFanLogic();
 bool areHeatersReady();  // NOWE: sprawdza czy wszystkie grzałki soft-enabled
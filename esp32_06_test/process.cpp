@@ -5,12 +5,30 @@
 #include "state.h"
 #include "outputs.h"
 #include "ui.h"
+#include "storage.h"
+#include "chamber_estimator.h"
+#include "heater_rotation.h"
+#include "meat_eta.h"
+#include "heater_fault.h"
+#include "checkpoint.h"
+#include "smoke_sched.h"
+#include "fan_ctl.h"
+#include "history.h"
+#include "energy.h"
 
 // Struktura dla adaptacyjnego PID
+// [MOD] Adaptacja to opcjonalna warstwa: mnożniki scale* na nastawach bazowych
+//       (harmonogram nastaw -> autotune dla powerMode -> CFG_Kp/Ki/Kd)
 struct AdaptivePID {
     double errorHistory[10] = {0};
     int historyIndex = 0;
     unsigned long lastAdaptation = 0;
+    double baseKp = CFG_Kp;
+    double baseKi = CFG_Ki;
+    double baseKd = CFG_Kd;
+    double scaleKp = 1.0;
+    double scaleKi = 1.0;
+    double scaleKd = 1.0;
     double currentKp = CFG_Kp;
     double currentKi = CFG_Ki;
     double currentKd = CFG_Kd;
@@ -18,9 +36,215 @@ struct AdaptivePID {
 
 static AdaptivePID adaptivePid;
 
-// Historia temperatury dla predykcyjnego sterowania wentylatorem
-static double tempHistory[5] = {0};
-static int tempHistoryIndex = 0;
+// ======================================================
+// [NEW] NASTAWY Z AUTOTUNE - osobno dla każdego powerMode (NVS "pid_tune")
+// ======================================================
+
+static constexpr uint8_t PID_TUNE_VERSION = 1;
+
+struct PidTuneTable {
+    uint8_t    version;
+    uint8_t    reserved[3];
+    PidTuning  pm[CFG_POWERMODE_MAX];   // indeks = powerMode - 1
+};
+
+static PidTuneTable tuneTable;          // pod state_lock
+
+// [NEW] Harmonogram nastaw (setpoint x powerMode) - NVS "pid_sched", pod state_lock
+static GainSchedule gainSched;
+static bool   schedDirty = true;         // wymuszenie przeliczenia w następnym ticku
+static double schedLastSp = -1000.0;
+static int    schedLastPm = 0;
+static bool   schedAdaptive = true;      // kopia gainSched.adaptive dla taskControl
+
+void process_load_tunings() {
+    PidTuneTable t;
+    if (!storage_load_blob_nvs("pid_tune", &t, sizeof(t)) || t.version != PID_TUNE_VERSION) {
+        memset(&t, 0, sizeof(t));
+        t.version = PID_TUNE_VERSION;
+    }
+    GainSchedule gs;
+    if (!storage_load_blob_nvs("pid_sched", &gs, sizeof(gs)) || !gs_valid(gs)) {
+        gs_default(gs);
+    }
+    if (state_lock()) {
+        tuneTable = t;
+        gainSched = gs;
+        schedDirty = true;
+        state_unlock();
+    }
+    LOG_FMT(LOG_LEVEL_INFO, "PID gain schedule: %d points, adaptive=%d", gs.count, gs.adaptive);
+    for (int i = 0; i < CFG_POWERMODE_MAX; i++) {
+        if (t.pm[i].valid) {
+            LOG_FMT(LOG_LEVEL_INFO, "PID tuning pm%d: Kp=%.2f Ki=%.4f Kd=%.1f (Ku=%.2f Tu=%.0fs)",
+                    i + 1, t.pm[i].kp, t.pm[i].ki, t.pm[i].kd, t.pm[i].ku, t.pm[i].tu);
+        }
+    }
+}
+
+// Wołane pod state_lock - harmonogram dla (powerMode, setpoint), potem autotune
+// dla powerMode, na końcu stałe z config.h
+static void baseTuningsLocked(int pm, double sp, double& kp, double& ki, double& kd) {
+    float skp, ski, skd;
+    if (gs_lookup(gainSched, pm, (float)sp, skp, ski, skd)) {
+        kp = skp; ki = ski; kd = skd;
+    } else if (pm >= 1 && pm <= CFG_POWERMODE_MAX && tuneTable.pm[pm - 1].valid) {
+        const PidTuning& t = tuneTable.pm[pm - 1];
+        kp = t.kp; ki = t.ki; kd = t.kd;
+    } else {
+        kp = CFG_Kp; ki = CFG_Ki; kd = CFG_Kd;
+    }
+}
+
+bool process_get_tuning(int pm, PidTuning& out) {
+    if (pm < 1 || pm > CFG_POWERMODE_MAX) return false;
+    if (!state_lock()) return false;
+    out = tuneTable.pm[pm - 1];
+    state_unlock();
+    return out.valid != 0;
+}
+
+void process_clear_tuning(int pm) {
+    if (pm < 1 || pm > CFG_POWERMODE_MAX) return;
+    if (!state_lock()) return;
+    memset(&tuneTable.pm[pm - 1], 0, sizeof(PidTuning));
+    PidTuneTable copy = tuneTable;
+    state_unlock();
+    storage_save_blob_nvs("pid_tune", &copy, sizeof(copy));
+    LOG_FMT(LOG_LEVEL_INFO, "PID tuning pm%d cleared - using defaults", pm);
+}
+
+// Ustawia nastawy bazowe adaptacji i PID na starcie procesu - wołane pod state_lock
+static void applyBaseTuningsLocked(int pm, double sp) {
+    baseTuningsLocked(pm, sp, adaptivePid.baseKp, adaptivePid.baseKi, adaptivePid.baseKd);
+    adaptivePid.scaleKp = adaptivePid.scaleKi = adaptivePid.scaleKd = 1.0;
+    adaptivePid.currentKp = adaptivePid.baseKp;
+    adaptivePid.currentKi = adaptivePid.baseKi;
+    adaptivePid.currentKd = adaptivePid.baseKd;
+    pid.SetTunings(adaptivePid.baseKp, adaptivePid.baseKi, adaptivePid.baseKd);
+    schedLastSp = sp;
+    schedLastPm = pm;
+    schedDirty = false;
+}
+
+// [NEW] Lustro całki PID_v1 (outputSum jest prywatne) - liczone tymi samymi krokami
+// co Compute() w computePidOnSample(), wpisywane do biblioteki przez Initialize():
+// przejście MANUAL -> AUTOMATIC robi outputSum = *output, lastInput = *input.
+// Stan tylko w taskControl.
+static double pidIntegral = 0;      // [%]
+static double pidLastInput = 0;     // lastInput biblioteki (człon D)
+static double pidLastSp = 0;        // setpoint ostatniego Compute() - uchyb sprzed skoku zadanej
+
+static void pidLoadIntegral(double integral) {
+    extern double pidInput;
+    double u = pidOutput;
+    pidIntegral = constrain(integral, 0.0, 100.0);
+    pidOutput = pidIntegral;
+    pid.SetMode(MANUAL);
+    pid.SetMode(AUTOMATIC);
+    pidOutput = u;
+    pidLastInput = pidInput;
+}
+
+// Zmiana nastaw w trakcie pracy bez skoku wyjścia: całka przesunięta o różnicę
+// członu P przy uchybie z ostatniego Compute() (setpoint sprzed ewentualnego skoku
+// zadanej), człon D startuje od zera. [FIX] Wcześniej całka = wyjście - Kp * uchyb
+// do NOWEJ zadanej - przy skoku w górę zerowała moc utrzymania i nadpisywała
+// przeskalowanie z pidHandleTransitions(). Skok zadanej sam w sobie obsługuje
+// tamta funkcja; tu tylko zmiana Kp, bez zmiany nastaw nic nie robi.
+static void setTuningsBumpless(double kp, double ki, double kd) {
+    extern double pidInput;
+    double kpOld = pid.GetKp();
+    if (kp == kpOld && ki == pid.GetKi() && kd == pid.GetKd()) return;
+    pid.SetTunings(kp, ki, kd);
+    pidLoadIntegral(pidIntegral + (kpOld - kp) * (pidLastSp - pidInput));
+}
+
+static void applyCurrentGains() {
+    adaptivePid.currentKp = adaptivePid.baseKp * (schedAdaptive ? adaptivePid.scaleKp : 1.0);
+    adaptivePid.currentKi = adaptivePid.baseKi * (schedAdaptive ? adaptivePid.scaleKi : 1.0);
+    adaptivePid.currentKd = adaptivePid.baseKd * (schedAdaptive ? adaptivePid.scaleKd : 1.0);
+    setTuningsBumpless(adaptivePid.currentKp, adaptivePid.currentKi, adaptivePid.currentKd);
+}
+
+// Co tick w stanach RUNNING: nowe nastawy bazowe przy zmianie setpointu (krok profilu,
+// ręczna zmiana), powerMode lub edycji harmonogramu
+static void updateGainSchedule(double sp, int pm) {
+    if (!schedDirty && pm == schedLastPm && fabs(sp - schedLastSp) < GAIN_SCHED_SP_HYST_C) return;
+    if (!state_lock()) return;
+    baseTuningsLocked(pm, sp, adaptivePid.baseKp, adaptivePid.baseKi, adaptivePid.baseKd);
+    schedDirty = false;
+    state_unlock();
+    schedLastSp = sp;
+    schedLastPm = pm;
+    applyCurrentGains();
+    LOG_FMT(LOG_LEVEL_INFO, "PID gains for %.1fC pm%d: Kp=%.2f Ki=%.4f Kd=%.1f",
+            sp, pm, adaptivePid.currentKp, adaptivePid.currentKi, adaptivePid.currentKd);
+}
+
+bool process_get_schedule(GainSchedule& out) {
+    if (!state_lock()) return false;
+    out = gainSched;
+    state_unlock();
+    return true;
+}
+
+// Zmiana harmonogramu z WWW: mutator na kopii, zapis do NVS gdy się udał
+static bool modifySchedule(bool (*fn)(GainSchedule&, const void*), const void* arg) {
+    if (!state_lock()) return false;
+    GainSchedule gs = gainSched;
+    bool ok = fn(gs, arg);
+    if (ok) {
+        gainSched = gs;
+        schedDirty = true;
+    }
+    state_unlock();
+    if (ok) storage_save_blob_nvs("pid_sched", &gs, sizeof(gs));
+    return ok;
+}
+
+bool process_set_schedule_point(const GainPoint& p) {
+    return modifySchedule([](GainSchedule& gs, const void* a) {
+        return gs_set_point(gs, *(const GainPoint*)a);
+    }, &p);
+}
+
+bool process_remove_schedule_point(int index) {
+    return modifySchedule([](GainSchedule& gs, const void* a) {
+        return gs_remove_point(gs, *(const int*)a);
+    }, &index);
+}
+
+bool process_set_adaptive(bool enabled) {
+    uint8_t v = enabled ? 1 : 0;
+    return modifySchedule([](GainSchedule& gs, const void* a) {
+        gs.adaptive = *(const uint8_t*)a;
+        return true;
+    }, &v);
+}
+
+String schedule_json() {
+    GainSchedule gs;
+    if (!process_get_schedule(gs)) return "{}";
+    String json;
+    json.reserve(160 + gs.count * 96);
+    char buf[128];
+    snprintf(buf, sizeof(buf),
+             "{\"adaptive\":%s,\"kp\":%.3f,\"ki\":%.5f,\"kd\":%.2f,\"points\":[",
+             gs.adaptive ? "true" : "false",
+             adaptivePid.currentKp, adaptivePid.currentKi, adaptivePid.currentKd);
+    json = buf;
+    for (int i = 0; i < gs.count; i++) {
+        const GainPoint& p = gs.pt[i];
+        snprintf(buf, sizeof(buf),
+                 "%s{\"i\":%d,\"sp\":%.1f,\"pm\":%d,\"kp\":%.3f,\"ki\":%.5f,\"kd\":%.2f,\"src\":\"%s\"}",
+                 i ? "," : "", i, p.setpoint, p.powerMode, p.kp, p.ki, p.kd,
+                 p.source == (uint8_t)GainSource::AUTOTUNE ? "autotune" : "manual");
+        json += buf;
+    }
+    json += "]}";
+    return json;
+}
 
 // ======================================================
 // [NEW] MONITOR AWARII GRZAŁKI
@@ -140,10 +364,273 @@ static void checkHeaterEfficiency() {
     }
 }
 
+// ======================================================
+// [NEW] PROGNOZA DOJŚCIA MIĘSA (meat_eta.h)
+// ======================================================
+// Stan tylko w taskControl. Nowy proces (inny g_processStartTime) = puste okno.
+
+static MeatEtaState  meatEta;
+static unsigned long meatEtaRun = 0;
+static unsigned long meatEtaLastMs = 0;
+
+static void sampleMeatEta(unsigned long processStart, double tMeat, double tChamber) {
+    unsigned long now = millis();
+    if (processStart != meatEtaRun) {
+        meat_eta_reset(meatEta);
+        meatEtaRun = processStart;
+    } else if (now - meatEtaLastMs < MEAT_ETA_SAMPLE_MS) {
+        return;
+    }
+    meatEtaLastMs = now;
+    meat_eta_add(meatEta, now, (float)tMeat, (float)tChamber);
+}
+
+// ======================================================
+// [NEW] DYM: IMPULSY, RAMPA, REGULACJA CZUJNIKIEM (smoke_sched.h)
+// ======================================================
+// Stan tylko w taskControl. Rampa nowego kroku startuje z PWM faktycznie na wyjściu.
+
+static SmokeState    smokeSt;
+static unsigned long smokeRun = 0;
+static int           smokeStep = -1;
+
+static void runSmoke(unsigned long processStart, int step, const SmokeSchedule& s, float density) {
+    unsigned long now = millis();
+    if (processStart != smokeRun) {
+        smoke_reset(smokeSt);
+        smokeRun = processStart;
+        smokeStep = -1;
+    }
+    if (step != smokeStep) {
+        smoke_start_step(smokeSt, now, (uint8_t)outputs_smoke());
+        smokeStep = step;
+        if (s.density > 0 && isnan(density)) {
+            LOG_FMT(LOG_LEVEL_WARN, "Step %d: sdens=%.0f%% without smoke sensor - fixed PWM",
+                    step, s.density);
+        }
+    }
+    outputs_set_smoke(smoke_output(smokeSt, s, now, density));
+}
+
+// ======================================================
+// [NEW] KASKADA: PĘTLA ZEWNĘTRZNA NA TEMPERATURZE MIĘSA
+// ======================================================
+// Trajektoria rdzenia od temperatury na starcie kroku do tMeatTarget (time= / rate=).
+// Wymagane narastanie: r = rRef + (TmRef - Tm) / CASCADE_TRACK_TAU_S.
+// Z modelu meat_eta (dTm/dt = k (Tc - Tm)) setpoint komory Tc = Tm + r / k;
+// k z okna meat_eta, do pierwszej wiarygodnej oceny CASCADE_K_DEFAULT.
+// Bez całkowania - ograniczenie do [cascMin, cascMax] nie powoduje windupu.
+// PID komory zostaje pętlą wewnętrzną (g_tSet). Stan tylko w taskControl.
+
+static int           cascStep = -1;
+static unsigned long cascStepStart = 0;
+static unsigned long cascLastMs = 0;
+static float         cascTm0 = 0;
+static float         cascRateRef = 0;   // [°C/s]
+
+static void runCascade(double tMeat) {
+    if (!state_lock()) return;
+    int step = g_currentStep;
+    bool active = step >= 0 && step < g_stepCount &&
+                  profile_steps(g_profile)[step].control == (uint8_t)StepControl::CASCADE;
+    Step s;
+    if (active) profile_step_get(g_profile, step, s);
+    unsigned long stepStart = g_stepStartTime;
+    double sp = g_tSet;
+    state_unlock();
+
+    if (!active) {
+        cascStep = -1;
+        return;
+    }
+
+    unsigned long now = millis();
+    if (step != cascStep || stepStart != cascStepStart) {
+        cascStep = step;
+        cascStepStart = stepStart;
+        cascTm0 = (float)tMeat;
+        float span = (float)s.tMeatTarget - cascTm0;
+        if (s.cascRate > 0)          cascRateRef = s.cascRate / 60.0f;
+        else if (s.cascTimeMs > 0)   cascRateRef = span * 1000.0f / s.cascTimeMs;
+        else                         cascRateRef = 0;
+        if (cascRateRef < 0) cascRateRef = 0;
+        cascLastMs = 0;
+        LOG_FMT(LOG_LEVEL_INFO, "Cascade: meat %.1f -> %.1f C at %.2f C/min, chamber %.0f..%.0f C",
+                tMeat, s.tMeatTarget, cascRateRef * 60.0f, s.cascMin, s.cascMax);
+    }
+    if (cascLastMs != 0 && now - cascLastMs < CASCADE_UPDATE_MS) return;
+    cascLastMs = now;
+
+    float target = (float)s.tMeatTarget;
+    float tmRef = cascTm0 + cascRateRef * (now - stepStart) / 1000.0f;
+    float rRef = cascRateRef;
+    if (tmRef >= target) { tmRef = target; rRef = 0; }
+    float r = rRef + (tmRef - (float)tMeat) / CASCADE_TRACK_TAU_S;
+
+    float k, kErr;
+    if (!meat_eta_rate(meatEta, k, kErr) || kErr > 0.5f * k) k = CASCADE_K_DEFAULT;
+
+    float newSp = (float)tMeat + r / k;
+    newSp = constrain(newSp, (float)sp - CASCADE_MAX_STEP_C, (float)sp + CASCADE_MAX_STEP_C);
+    newSp = constrain(newSp, s.cascMin, s.cascMax);
+    newSp = roundf(newSp * 2.0f) / 2.0f;   // 0.5 °C - bez retuningu PID przy szumie
+    if (fabsf(newSp - (float)sp) < 0.25f) return;
+
+    if (state_lock()) {
+        g_tSet = newSp;
+        state_unlock();
+    }
+    LOG_FMT(LOG_LEVEL_DEBUG, "Cascade: meat %.1f ref %.1f k=%.2e -> chamber %.1f C",
+            tMeat, tmRef, k, newSp);
+}
+
+// ======================================================
+// [NEW] RAMPA SETPOINTU I WYPRZEDZENIE NASTĘPNEGO KROKU
+// ======================================================
+// ramp= : g_tSet dochodzi do tSet kroku o rampRate * dt co tick (start procesu -
+//         od temperatury komory, kolejne kroki - od bieżącego setpointu).
+// ahead=1 : gdy do końca minTimeMs zostaje tyle, ile komora potrzebuje na przejście
+//         do tSet następnego kroku, setpoint rusza już teraz (skok albo rampa
+//         następnego kroku). Czas przejścia z narastania/stygnięcia komory
+//         zmierzonego w tym i poprzednich procesach (identifyChamberRates).
+// Krok bez ramp= i bez wyprzedzenia - setpoint nietknięty (ręczna zmiana zostaje).
+// Stan tylko w taskControl.
+
+static int           rampStep = -1;
+static unsigned long rampStepStart = 0;
+static unsigned long rampLastMs = 0;
+static double        rampTarget = 0;
+static float         rampRateCpm = 0;    // [°C/min], 0 = setpoint ustawiony skokiem
+static bool          rampAhead = false;  // setpoint już w drodze do następnego kroku
+
+// Zmierzone: narastanie przy pełnym wyjściu PID na 1 grzałkę, stygnięcie przy zerowym
+static float         heatRatePerHeater = RAMP_HEAT_RATE_DEFAULT;
+static float         coolRate = RAMP_COOL_RATE_DEFAULT;
+static int           identDir = 0;       // +1 grzanie, -1 stygnięcie, 0 brak pomiaru
+static int           identPm = 0;
+static unsigned long identStartMs = 0;
+static double        identStartT = 0;
+
+static void identifyChamberRates(double tRaw, double sp, int pm) {
+    int dir = 0;
+    if (areHeatersReady()) {
+        if (pidOutput >= 95.0 && sp - tRaw > RAMP_IDENT_MIN_ERR_C)      dir = 1;
+        else if (pidOutput <= 1.0 && tRaw - sp > RAMP_IDENT_MIN_ERR_C)  dir = -1;
+    }
+    unsigned long now = millis();
+    if (dir == 0 || dir != identDir || pm != identPm) {
+        identDir = dir;
+        identPm = pm;
+        identStartMs = now;
+        identStartT = tRaw;
+        return;
+    }
+    if (now - identStartMs < RAMP_IDENT_WINDOW_MS) return;
+
+    float rate = (float)fabs(tRaw - identStartT) * 60000.0f / (now - identStartMs);
+    if (dir > 0) heatRatePerHeater += 0.3f * (rate / max(pm, 1) - heatRatePerHeater);
+    else         coolRate += 0.3f * (rate - coolRate);
+    identStartMs = now;
+    identStartT = tRaw;
+    LOG_FMT(LOG_LEVEL_DEBUG, "Chamber rates: heat %.2f C/min/heater, cool %.2f C/min",
+            heatRatePerHeater, coolRate);
+}
+
+// Czas [ms] przejścia komory z tFrom do tTo: fizycznie (pm grzałek / stygnięcie)
+// i nie krócej niż rampa
+static unsigned long transitionMs(double tFrom, double tTo, int pm, float rampRate) {
+    double dT = tTo - tFrom;
+    double minutes = dT > 0 ? dT / (heatRatePerHeater * max(pm, 1)) : -dT / coolRate;
+    if (rampRate > 0) minutes = max(minutes, fabs(dT) / rampRate);
+    return (unsigned long)(minutes * 60000.0);
+}
+
+static void runSetpointRamp(double tRaw) {
+    if (!state_lock()) return;
+    int step = g_currentStep;
+    bool valid = step >= 0 && step < g_stepCount;
+    bool hasNext = valid && step + 1 < g_stepCount;
+    Step cur = {}, next = {};
+    if (valid) profile_step_get(g_profile, step, cur);
+    if (hasNext) profile_step_get(g_profile, step + 1, next);
+    unsigned long stepStart = g_stepStartTime;
+    double sp = g_tSet;
+    state_unlock();
+
+    if (!valid) {
+        rampStep = -1;
+        return;
+    }
+
+    unsigned long now = millis();
+    unsigned long dtMs = now - rampLastMs;
+    if (dtMs > 1000) dtMs = 0;   // pauza - rampa stoi, bez skoku po wznowieniu
+    rampLastMs = now;
+
+    if (cur.control == StepControl::CASCADE) {
+        rampStep = -1;           // setpoint prowadzi runCascade()
+        return;
+    }
+
+    double newSp = sp;
+    if (step != rampStep || stepStart != rampStepStart) {
+        rampStep = step;
+        rampStepStart = stepStart;
+        rampAhead = false;
+        rampTarget = cur.tSet;
+        rampRateCpm = cur.rampRate;
+        if (rampRateCpm > 0) {
+            if (step == 0) newSp = tRaw;   // start procesu - od temperatury komory
+            LOG_FMT(LOG_LEVEL_INFO, "Setpoint ramp %.1f -> %.1f C at %.2f C/min",
+                    newSp, rampTarget, rampRateCpm);
+        }
+    }
+
+    // [FIX] Krok z exit= nie kończy się w minTime - brak momentu, do którego wyprzedzać
+    if (!rampAhead && cur.lookahead && !cur.useMeatTemp && cur.exitCond.len == 0 && hasNext &&
+        next.control == StepControl::CHAMBER && fabs(next.tSet - cur.tSet) >= 0.5) {
+        // Nie więcej niż połowa kroku - krótki krok nie znika w przejściu
+        unsigned long lead = min(transitionMs(cur.tSet, next.tSet, cur.powerMode, next.rampRate),
+                                 cur.minTimeMs / 2);
+        if (now - stepStart + lead >= cur.minTimeMs) {
+            rampAhead = true;
+            rampTarget = next.tSet;
+            rampRateCpm = next.rampRate;
+            if (rampRateCpm <= 0) newSp = rampTarget;
+            LOG_FMT(LOG_LEVEL_INFO, "Lookahead: setpoint -> %.1f C, %.1f min before step end",
+                    rampTarget, (cur.minTimeMs - (now - stepStart)) / 60000.0);
+        }
+    }
+
+    if (rampRateCpm > 0 && newSp != rampTarget) {
+        double d = rampRateCpm * dtMs / 60000.0;
+        newSp = newSp < rampTarget ? min(rampTarget, newSp + d) : max(rampTarget, newSp - d);
+    }
+    if (newSp == sp) return;
+
+    if (state_lock()) {
+        g_tSet = newSp;
+        state_unlock();
+    }
+}
+
 // ======================================================
 // STATYSTYKI I ADAPTACJA PID
 // ======================================================
 
+// [NEW] Energia grzałek z półokresów SSR - liczona w procesie (z SOFT_RESUME),
+// poza nim odrzucana (autotune, pauzy)
+static void accountEnergy(ProcessState st) {
+    uint64_t uj = energy_take_uj();
+    if (uj == 0) return;
+    if (st != ProcessState::RUNNING_AUTO && st != ProcessState::RUNNING_MANUAL &&
+        st != ProcessState::SOFT_RESUME) return;
+    if (!state_lock()) return;
+    g_processStats.energyUj += uj;
+    profile_energy_add(g_profile, g_currentStep, uj);   // [FIX] w arenie profilu
+    state_unlock();
+}
+
 static void updateProcessStats() {
     if (!state_lock()) return;
 
@@ -168,28 +655,45 @@ static void updateProcessStats() {
         if (g_currentState == ProcessState::RUNNING_AUTO) {
             unsigned long elapsedTotal = (now - g_processStartTime) / 1000;
 
-            unsigned long completedTime = 0;
-            for (int i = 0; i < g_currentStep; i++) {
-                if (i < g_stepCount) {
-                    completedTime += g_profile[i].minTimeMs / 1000;
-                }
-            }
-
             unsigned long stepElapsed = (now - g_stepStartTime) / 1000;
             unsigned long stepTotal = 0;
-            if (g_currentStep >= 0 && g_currentStep < g_stepCount) {
-                stepTotal = g_profile[g_currentStep].minTimeMs / 1000;
+            const ProfileStep* cur = g_currentStep >= 0 && g_currentStep < g_stepCount
+                                   ? &profile_steps(g_profile)[g_currentStep] : nullptr;
+            // [FIX] exit= - koniec kroku nieznany, minTime nie jest prognozą
+            bool stepOpen = cur && cur->condLen != 0;
+            if (cur && !stepOpen) {
+                stepTotal = cur->minTimeSec;
             }
             unsigned long stepRemaining = (stepTotal > stepElapsed) ? (stepTotal - stepElapsed) : 0;
 
-            unsigned long futureTime = 0;
-            for (int i = g_currentStep + 1; i < g_stepCount; i++) {
-                futureTime += g_profile[i].minTimeMs / 1000;
+            // [NEW] Krok kończy się dopiero przy tMeatTarget - prognoza przy komorze na tSet
+            long etaSec = -1;
+            float etaConf = 0.0f;
+            if (cur && (cur->flags & PSTEP_F_MEAT)) {
+                float eta, conf;
+                if (meat_eta_predict(meatEta, (float)g_tMeat, (float)g_tSet,
+                                     cur->tMeat / 10.0f, eta, conf)) {
+                    etaSec = (long)eta;
+                    etaConf = conf;
+                    if ((unsigned long)etaSec > stepRemaining) stepRemaining = etaSec;
+                }
+            }
+            g_processStats.meatEtaSec = etaSec;
+            g_processStats.meatEtaConf = etaConf;
+
+            unsigned long futureTime = profile_time_sec(g_profile, g_currentStep + 1, g_stepCount);
+            // Dalsze kroki z exit= liczone nominalnie (minTime) - wynik orientacyjny
+            bool open = stepOpen;
+            for (int i = g_currentStep + 1; i < g_stepCount && !open; i++) {
+                open = profile_steps(g_profile)[i].condLen != 0;
             }
 
             g_processStats.remainingProcessTimeSec = stepRemaining + futureTime;
+            g_processStats.remainingOpen = open;
         } else {
             g_processStats.remainingProcessTimeSec = 0;
+            g_processStats.remainingOpen = false;
+            g_processStats.meatEtaSec = -1;
         }
     }
 
@@ -198,6 +702,7 @@ static void updateProcessStats() {
 }
 
 static void adaptPidParameters() {
+    if (!schedAdaptive) return;   // [MOD] warstwa opcjonalna (GainSchedule.adaptive)
     unsigned long now = millis();
     if (now - adaptivePid.lastAdaptation < PID_ADAPTATION_INTERVAL) return;
 
@@ -228,20 +733,20 @@ static void adaptPidParameters() {
         errorVariance /= validCount;
 
         if (errorVariance > 5.0) {
-            adaptivePid.currentKp = CFG_Kp * 0.8;
-            adaptivePid.currentKi = CFG_Ki * 0.5;
-            adaptivePid.currentKd = CFG_Kd * 1.2;
+            adaptivePid.scaleKp = 0.8;
+            adaptivePid.scaleKi = 0.5;
+            adaptivePid.scaleKd = 1.2;
         } else if (errorVariance < 0.5 && fabs(currentError) < 2.0) {
-            adaptivePid.currentKp = CFG_Kp * 1.2;
-            adaptivePid.currentKi = CFG_Ki * 0.8;
-            adaptivePid.currentKd = CFG_Kd * 0.8;
+            adaptivePid.scaleKp = 1.2;
+            adaptivePid.scaleKi = 0.8;
+            adaptivePid.scaleKd = 0.8;
         } else {
-            adaptivePid.currentKp = CFG_Kp;
-            adaptivePid.currentKi = CFG_Ki;
-            adaptivePid.currentKd = CFG_Kd;
+            adaptivePid.scaleKp = 1.0;
+            adaptivePid.scaleKi = 1.0;
+            adaptivePid.scaleKd = 1.0;
         }
 
-        pid.SetTunings(adaptivePid.currentKp, adaptivePid.currentKi, adaptivePid.currentKd);
+        applyCurrentGains();
 
         if (adaptivePid.lastAdaptation > 0) {
             LOG_FMT(LOG_LEVEL_DEBUG, "PID adapted: Kp=%.2f Ki=%.2f Kd=%.2f var=%.2f",
@@ -254,62 +759,77 @@ static void adaptPidParameters() {
 }
 
 // ======================================================
-// PREDYKCYJNE STEROWANIE WENTYLATOREM
+// [MOD] STEROWANIE WENTYLATOREM OBIEGOWYM (fan_ctl.h)
 // ======================================================
-
-void predictiveFanControl() {
-    double currentTemp = 0;
-    if (state_lock()) {
-        currentTemp = g_tChamber;
-        state_unlock();
-    }
-
-    tempHistory[tempHistoryIndex] = currentTemp;
-    tempHistoryIndex = (tempHistoryIndex + 1) % 5;
-
-    double trend = 0;
-    int validSamples = 0;
-    for (int i = 1; i < 5; i++) {
-        int idx = (tempHistoryIndex - i + 5) % 5;
-        int prevIdx = (idx - 1 + 5) % 5;
-
-        if (tempHistory[idx] > 0 && tempHistory[prevIdx] > 0) {
-            trend += (tempHistory[idx] - tempHistory[prevIdx]);
-            validSamples++;
+// Zamiast mnożenia g_fanOnTime/g_fanOffTime - przerwa liczona z rozwarstwienia
+// i trendu komory, profil nietknięty. Stan tylko w taskControl.
+
+static FanCtlState   fanCtl;
+static unsigned long fanCtlLastMs = 0;
+// Bufory regresji poza stosem taskControl
+static HistPoint fanPts[FAN_TREND_WINDOW_S];
+static float     fanT[FAN_TREND_WINDOW_S];
+static bool      fanValid[FAN_TREND_WINDOW_S];
+
+// Średnie nachylenie kanałów CHAMBER z historii [°C/s], NAN = brak
+static float chamberTrend(const uint8_t* roles, int nCh) {
+    float sum = 0;
+    int n = 0;
+    for (int ch = 0; ch < nCh; ch++) {
+        if (roles[ch] != (uint8_t)SensorRole::CHAMBER) continue;
+        int got = history_read_last(0, (uint8_t)ch, fanPts, FAN_TREND_WINDOW_S);
+        for (int i = 0; i < got; i++) {
+            fanT[i] = fanPts[i].avg;
+            fanValid[i] = fanPts[i].valid;
         }
+        float slope = fan_ctl_slope(fanT, fanValid, got);
+        if (!isnan(slope)) { sum += slope; n++; }
     }
+    return n > 0 ? sum / n : NAN;
+}
 
-    if (validSamples > 0) {
-        trend /= validSamples;
+static void fanControl() {
+    unsigned long now = millis();
+    if (fanCtlLastMs != 0 && now - fanCtlLastMs < FAN_CTL_PERIOD_MS) return;
+    fanCtlLastMs = now;
 
-        if (state_lock()) {
-            if (g_fanMode == 2) {
-                if (trend > 0.5) {
-                    g_fanOnTime = min((unsigned long)(g_fanOnTime * 1.5), 30000UL);
-                    g_fanOffTime = max((unsigned long)(g_fanOffTime * 0.7), 10000UL);
-                } else if (trend < -0.2) {
-                    g_fanOnTime = max((unsigned long)(g_fanOnTime * 0.7), 5000UL);
-                    g_fanOffTime = min((unsigned long)(g_fanOffTime * 1.3), 120000UL);
-                } else if (fabs(trend) < 0.1 && fabs(g_tChamber - g_tSet) < 3.0) {
-                    g_fanOnTime = 10000UL;
-                    g_fanOffTime = 60000UL;
-                }
-            }
-            state_unlock();
-        }
+    uint8_t roles[MAX_SENSOR_CHANNELS];
+    if (!state_lock()) return;
+    int fm = g_fanMode;
+    unsigned long offT = g_fanOffTime;
+    double tc = g_tChamber, ts = g_tSet;
+    float spread = g_tChamberSpread;
+    int nCh = g_sensorChannelCount;
+    for (int ch = 0; ch < nCh; ch++) roles[ch] = g_sensorChannels[ch].role;
+    state_unlock();
+
+    if (fm != 2) {
+        fan_ctl_reset(fanCtl);
+        outputs_set_fan_off(0);
+        return;
     }
+    float trend = chamberTrend(roles, nCh);
+    outputs_set_fan_off(fan_ctl_update(fanCtl, now, spread, trend, (float)tc, (float)ts, offT));
 }
 
 // ======================================================
 // TRYB AUTO
 // ======================================================
 
+// [NEW] Stan stable() warunku exit= - od nowa przy każdym starcie kroku
+static CondState     condState;
+static int           condStep = -1;
+static unsigned long condStepStart = 0;
+
 static void handleAutoMode() {
     if (!state_lock()) return;
     int step = g_currentStep;
     int count = g_stepCount;
     unsigned long stepStart = g_stepStartTime;
+    unsigned long processStart = g_processStartTime;
     double meat = g_tMeat;
+    double chamber = g_tChamber, ambient = g_tAmbient, tSet = g_tSet;
+    float density = g_smokeDensity;
     state_unlock();
 
     if (step < 0 || step >= count) {
@@ -320,15 +840,38 @@ static void handleAutoMode() {
     // [FIX] Kopiujemy dane kroku pod lockiem, operujemy na kopii
     Step localStep;
     if (!state_lock()) return;
-    memcpy(&localStep, &g_profile[step], sizeof(Step));
+    profile_step_get(g_profile, step, localStep);
     state_unlock();
 
-    unsigned long elapsed = millis() - stepStart;
-
-    bool timeOk = (elapsed >= localStep.minTimeMs);
-    bool meatOk = (!localStep.useMeatTemp) || (meat >= localStep.tMeatTarget);
+    unsigned long now = millis();
+    unsigned long elapsed = now - stepStart;
+
+    bool done;
+    if (localStep.exitCond.len > 0) {
+        // [NEW] exit= z profilu zamiast minTime/useMeatTemp
+        if (step != condStep || stepStart != condStepStart) {
+            cond_reset(condState);
+            condStep = step;
+            condStepStart = stepStart;
+        }
+        float v[COND_VAR_COUNT];
+        v[COND_V_CHAMBER] = (float)chamber;
+        v[COND_V_MEAT]    = (float)meat;
+        v[COND_V_AMBIENT] = (float)ambient;
+        v[COND_V_SET]     = (float)tSet;
+        v[COND_V_TARGET]  = (float)localStep.tMeatTarget;
+        v[COND_V_TIME]    = elapsed / 60000.0f;
+        v[COND_V_MINTIME] = localStep.minTimeMs / 60000.0f;
+        v[COND_V_TOTAL]   = (now - processStart) / 60000.0f;
+        v[COND_V_SMOKE]   = density;
+        done = cond_eval(localStep.exitCond, v, condState, now);
+    } else {
+        bool timeOk = (elapsed >= localStep.minTimeMs);
+        bool meatOk = (!localStep.useMeatTemp) || (meat >= localStep.tMeatTarget);
+        done = timeOk && meatOk;
+    }
 
-    if (timeOk && meatOk) {
+    if (done) {
         // [FIX] g_currentStep++ chroniony mutexem
         if (!state_lock()) return;
         g_currentStep++;
@@ -355,24 +898,29 @@ static void handleAutoMode() {
         }
     }
 
-    predictiveFanControl();
+    fanControl();
     handleFanLogic();
 
     // [FIX] Odczyt step pod lockiem do sterowania smoke
+    // [MOD] Harmonogram dymu kroku i czujnik pod tym samym lockiem
     if (!state_lock()) return;
     step = g_currentStep;
     count = g_stepCount;
-    int smokePwm = 0;
+    SmokeSchedule smoke = {};
     if (step >= 0 && step < count) {
-        smokePwm = g_profile[step].smokePwm;
+        const ProfileStep& s = profile_steps(g_profile)[step];
+        smoke.pwm     = s.smokePwm;
+        smoke.onSec   = s.smokeOnSec;
+        smoke.offSec  = s.smokeOffSec;
+        smoke.rampSec = s.smokeRampSec;
+        smoke.density = s.smokeDensity;
     }
+    density = g_smokeDensity;
+    processStart = g_processStartTime;
     state_unlock();
 
     if (step >= 0 && step < count) {
-        if (output_lock()) {
-            ledcWrite(PIN_SMOKE_FAN, smokePwm);
-            output_unlock();
-        }
+        runSmoke(processStart, step, smoke, density);
     }
 }
 
@@ -381,17 +929,14 @@ static void handleAutoMode() {
 // ======================================================
 
 static void handleManualMode() {
-    predictiveFanControl();
+    fanControl();
     handleFanLogic();
 
     if (!state_lock()) return;
     int smoke = g_manualSmokePwm;
     state_unlock();
 
-    if (output_lock()) {
-        ledcWrite(PIN_SMOKE_FAN, smoke);
-        output_unlock();
-    }
+    outputs_set_smoke(smoke);
 }
 
 // ======================================================
@@ -410,8 +955,9 @@ void applyCurrentStep() {
     }
 
     if (state_lock()) {
-        Step& s = g_profile[step];
-        g_tSet = s.tSet;
+        Step s;
+        profile_step_get(g_profile, step, s);
+        if (s.rampRate <= 0) g_tSet = s.tSet;   // [MOD] z ramp= setpoint prowadzi runSetpointRamp()
         g_powerMode = s.powerMode;
         g_manualSmokePwm = s.smokePwm;
         g_fanMode = s.fanMode;
@@ -438,6 +984,7 @@ void process_start_auto() {
     }
     applyCurrentStep();
     initHeaterEnable();
+    heater_rot_on_start();   // [NEW] wybór grzałki wiodącej
 
     if (state_lock()) {
         g_processStartTime = millis();
@@ -449,10 +996,13 @@ void process_start_auto() {
         g_processStats.pauseCount = 0;
         g_processStats.avgTemp = 0.0;
         g_processStats.lastUpdate = millis();
-        adaptivePid.currentKp = CFG_Kp;
-        adaptivePid.currentKi = CFG_Ki;
-        adaptivePid.currentKd = CFG_Kd;
-        pid.SetTunings(CFG_Kp, CFG_Ki, CFG_Kd);
+        g_processStats.meatEtaSec = -1;   // [NEW]
+        g_processStats.heaterFaultMask = 0;   // [NEW]
+        g_processStats.heatersEffective = 0;
+        g_processStats.energyUj = 0;   // [NEW]
+        profile_energy_reset(g_profile);
+        // [MOD] Nastawy z harmonogramu / autotune dla pierwszego kroku
+        applyBaseTuningsLocked(g_powerMode, g_tSet);
         state_unlock();
     }
 
@@ -467,6 +1017,7 @@ void process_start_manual() {
         state_unlock();
     }
     initHeaterEnable();
+    heater_rot_on_start();   // [NEW]
 
     if (state_lock()) {
         g_processStartTime = millis();
@@ -478,6 +1029,12 @@ void process_start_manual() {
         g_processStats.pauseCount = 0;
         g_processStats.avgTemp = 0.0;
         g_processStats.lastUpdate = millis();
+        g_processStats.meatEtaSec = -1;   // [NEW]
+        g_processStats.heaterFaultMask = 0;   // [NEW]
+        g_processStats.heatersEffective = 0;
+        g_processStats.energyUj = 0;   // [NEW]
+        profile_energy_reset(g_profile);
+        applyBaseTuningsLocked(g_powerMode, g_tSet);   // [NEW]
         state_unlock();
     }
 
@@ -500,20 +1057,587 @@ void process_resume() {
     log_msg(LOG_LEVEL_INFO, "Process resuming...");
 }
 
+// [NEW] Czas kroku i procesu liczony od rekordu - przerwa (brak zasilania, start)
+// nie skraca kroku. Grzałka wiodąca bez zmiany, zanik liczony jako pauza.
+bool process_restore(const ProcessCheckpoint& cp) {
+    bool autoMode = cp.runMode == (uint8_t)RunMode::MODE_AUTO;
+    if (!state_lock()) return false;
+    bool ok = g_currentState == ProcessState::IDLE &&
+              (!autoMode || (!g_errorProfile && cp.step >= 0 && cp.step < g_stepCount));
+    if (ok && autoMode) g_currentStep = cp.step;
+    state_unlock();
+    if (!ok) {
+        log_msg(LOG_LEVEL_WARN, "Checkpoint does not match current state/profile - not resuming");
+        return false;
+    }
+    if (autoMode) applyCurrentStep();
+    initHeaterEnable();
+
+    if (state_lock()) {
+        unsigned long now = millis();
+        g_tSet = cp.tSet;
+        g_powerMode = constrain((int)cp.powerMode, CFG_POWERMODE_MIN, CFG_POWERMODE_MAX);
+        g_fanMode = cp.fanMode;
+        g_manualSmokePwm = cp.smokePwm;
+        g_fanOnTime = cp.fanOnTime;
+        g_fanOffTime = cp.fanOffTime;
+        g_stepStartTime = now - cp.stepElapsedSec * 1000UL;
+        g_processStartTime = now - cp.processElapsedSec * 1000UL;
+        g_lastRunMode = autoMode ? RunMode::MODE_AUTO : RunMode::MODE_MANUAL;
+        g_processStats.totalRunTime = cp.runSec * 1000UL;
+        g_processStats.activeHeatingTime = cp.heatingSec * 1000UL;
+        g_processStats.stepChanges = cp.stepChanges;
+        g_processStats.pauseCount = cp.pauseCount + 1;
+        g_processStats.avgTemp = cp.avgTemp;
+        g_processStats.lastUpdate = now;
+        g_processStats.meatEtaSec = -1;
+        g_processStats.heaterFaultMask = 0;
+        g_processStats.heatersEffective = 0;
+        // [NEW] Z rekordu tylko suma - energia kroków sprzed resetu nieznana
+        g_processStats.energyUj = (uint64_t)cp.energyWh * ENERGY_UJ_PER_WH;
+        profile_energy_reset(g_profile);
+        applyBaseTuningsLocked(g_powerMode, g_tSet);
+        g_currentState = ProcessState::SOFT_RESUME;
+        state_unlock();
+    }
+    resetHeaterFaultMonitor();
+    return true;
+}
+
+// ======================================================
+// [NEW] AUTOTUNE - TEST PRZEKAŹNIKOWY (Åström–Hägglund)
+// ======================================================
+// Wyjście PID przełączane między ATUNE_RELAY_HIGH/LOW z histerezą wokół setpointu.
+// Z ustalonych oscylacji: amplituda a i okres Tu -> Ku = 4d / (pi * sqrt(a^2 - h^2)),
+// nastawy wg Tyreus-Luyben (mniejsze przeregulowanie niż Z-N - obiekt z dużym opóźnieniem).
+
+struct RelayAutotune {
+    double        setpoint = 0;
+    int           powerMode = 1;
+    bool          relayHigh = false;
+    bool          crossed = false;       // pierwsze przełączenie - koniec rozbiegu
+    unsigned long startMs = 0;
+    unsigned long lastHighSwitch = 0;
+    double        peakMax = 0;
+    double        peakMin = 0;
+    int           cycles = 0;
+    double        amp[ATUNE_MAX_CYCLES] = {0};
+    double        period[ATUNE_MAX_CYCLES] = {0};
+};
+
+static RelayAutotune at;
+static char atuneResult[96] = "";       // pod state_lock - ostatni wynik dla WWW
+
+bool process_start_autotune(double setpoint, int powerMode) {
+    if (setpoint < CFG_T_MIN_SET || setpoint > CFG_T_MAX_SET) return false;
+    if (powerMode < CFG_POWERMODE_MIN || powerMode > CFG_POWERMODE_MAX) return false;
+    if (!state_lock()) return false;
+    ProcessState st = g_currentState;
+    bool canStart = (st == ProcessState::IDLE || st == ProcessState::PAUSE_USER ||
+                     st == ProcessState::ERROR_PROFILE);
+    if (!canStart || g_doorOpen || g_errorSensor) {
+        state_unlock();
+        return false;
+    }
+    double y = g_tChamber;
+    state_unlock();
+
+    initHeaterEnable();
+    at = RelayAutotune();
+    at.setpoint  = setpoint;
+    at.powerMode = powerMode;
+    at.relayHigh = (y < setpoint);
+    at.startMs   = millis();
+
+    if (state_lock()) {
+        g_tSet = setpoint;
+        g_powerMode = powerMode;
+        g_manualSmokePwm = 0;
+        g_processStartTime = at.startMs;
+        g_currentState = ProcessState::AUTOTUNE;
+        snprintf(atuneResult, sizeof(atuneResult), "W toku");
+        state_unlock();
+    }
+    LOG_FMT(LOG_LEVEL_INFO, "Autotune started: set=%.1f pm=%d", setpoint, powerMode);
+    return true;
+}
+
+static void finishAutotune(bool ok, const char* msg) {
+    allOutputsOff();
+    pidOutput = 0;
+    if (state_lock()) {
+        if (g_currentState == ProcessState::AUTOTUNE) g_currentState = ProcessState::IDLE;
+        snprintf(atuneResult, sizeof(atuneResult), "%s", msg);
+        state_unlock();
+    }
+    buzzerBeep(ok ? 2 : 4, 150, 150);
+    LOG_FMT(ok ? LOG_LEVEL_INFO : LOG_LEVEL_WARN, "Autotune %s: %s", ok ? "done" : "failed", msg);
+}
+
+void process_stop_autotune() {
+    if (!state_lock()) return;
+    bool active = (g_currentState == ProcessState::AUTOTUNE);
+    state_unlock();
+    if (active) finishAutotune(false, "Przerwany");
+}
+
+// Względny rozrzut ostatnich n wartości: (max - min) / średnia
+static double relSpread(const double* v, int n, double& mean) {
+    double mn = v[0], mx = v[0], sum = 0;
+    for (int i = 0; i < n; i++) {
+        mn = min(mn, v[i]);
+        mx = max(mx, v[i]);
+        sum += v[i];
+    }
+    mean = sum / n;
+    return mean > 0 ? (mx - mn) / mean : 1.0;
+}
+
+static void computeAutotuneResult() {
+    int first = at.cycles - ATUNE_CYCLES;
+    double a, tuMs;
+    relSpread(&at.amp[first], ATUNE_CYCLES, a);
+    relSpread(&at.period[first], ATUNE_CYCLES, tuMs);
+
+    double d  = (ATUNE_RELAY_HIGH - ATUNE_RELAY_LOW) / 2.0;
+    double h  = ATUNE_HYSTERESIS;
+    double aEff = (a > h) ? sqrt(a * a - h * h) : a;
+    double ku = 4.0 * d / (PI * aEff);
+    double tu = tuMs / 1000.0;
+
+    PidTuning t = {};
+    t.ku = ku;
+    t.tu = tu;
+    t.kp = ku / 2.2;                 // Tyreus-Luyben
+    t.ki = t.kp / (2.2 * tu);        // Kp / Ti
+    t.kd = t.kp * (tu / 6.3);        // Kp * Td
+    t.valid = 1;
+
+    if (state_lock()) {
+        tuneTable.pm[at.powerMode - 1] = t;
+        PidTuneTable copy = tuneTable;
+        snprintf(atuneResult, sizeof(atuneResult), "OK pm%d: Kp=%.2f Ki=%.4f Kd=%.1f",
+                 at.powerMode, t.kp, t.ki, t.kd);
+        state_unlock();
+        storage_save_blob_nvs("pid_tune", &copy, sizeof(copy));
+    }
+
+    // [NEW] Wynik trafia też do harmonogramu jako punkt (setpoint testu, powerMode)
+    GainPoint gp = {};
+    gp.setpoint  = (float)at.setpoint;
+    gp.kp = t.kp; gp.ki = t.ki; gp.kd = t.kd;
+    gp.powerMode = (uint8_t)at.powerMode;
+    gp.source    = (uint8_t)GainSource::AUTOTUNE;
+    if (!process_set_schedule_point(gp)) {
+        log_msg(LOG_LEVEL_WARN, "Autotune: gain schedule full - point not added");
+    }
+    LOG_FMT(LOG_LEVEL_INFO, "Autotune pm%d: a=%.2fC Tu=%.0fs Ku=%.2f -> Kp=%.2f Ki=%.4f Kd=%.1f",
+            at.powerMode, a, tu, ku, t.kp, t.ki, t.kd);
+}
+
+static void runAutotune(double y, bool doorOpen, bool sensorError) {
+    unsigned long now = millis();
+    if (doorOpen)    { finishAutotune(false, "Otwarte drzwi"); return; }
+    if (sensorError) { finishAutotune(false, "Blad czujnika"); return; }
+    if (now - at.startMs > ATUNE_MAX_TIME_MS) { finishAutotune(false, "Przekroczony czas"); return; }
+
+    const double sp = at.setpoint;
+    if (at.relayHigh && y > sp + ATUNE_HYSTERESIS) {
+        at.relayHigh = false;
+        at.crossed = true;
+    } else if (!at.relayHigh && y < sp - ATUNE_HYSTERESIS) {
+        at.relayHigh = true;
+        if (at.crossed) {
+            // Pełny okres od poprzedniego przełączenia w górę
+            if (at.lastHighSwitch != 0 && at.cycles < ATUNE_MAX_CYCLES) {
+                at.amp[at.cycles]    = (at.peakMax - at.peakMin) / 2.0;
+                at.period[at.cycles] = (double)(now - at.lastHighSwitch);
+                at.cycles++;
+                LOG_FMT(LOG_LEVEL_INFO, "Autotune cycle %d: a=%.2fC T=%.0fs", at.cycles,
+                        at.amp[at.cycles - 1], at.period[at.cycles - 1] / 1000.0);
+
+                // Pierwszy okres pomijany (rozbieg), potem ATUNE_CYCLES zgodnych
+                if (at.cycles > ATUNE_CYCLES) {
+                    double ma, mt;
+                    double sa = relSpread(&at.amp[at.cycles - ATUNE_CYCLES], ATUNE_CYCLES, ma);
+                    double st = relSpread(&at.period[at.cycles - ATUNE_CYCLES], ATUNE_CYCLES, mt);
+                    if (sa <= ATUNE_MAX_SPREAD && st <= ATUNE_MAX_SPREAD && ma > 0) {
+                        computeAutotuneResult();
+                        finishAutotune(true, atuneResult);
+                        return;
+                    }
+                }
+                if (at.cycles >= ATUNE_MAX_CYCLES) {
+                    finishAutotune(false, "Brak stabilnych oscylacji");
+                    return;
+                }
+            }
+            at.lastHighSwitch = now;
+            at.peakMax = y;
+            at.peakMin = y;
+        }
+        at.crossed = true;
+    }
+
+    if (at.lastHighSwitch != 0) {
+        at.peakMax = max(at.peakMax, y);
+        at.peakMin = min(at.peakMin, y);
+    }
+    pidOutput = at.relayHigh ? ATUNE_RELAY_HIGH : ATUNE_RELAY_LOW;
+}
+
+String autotune_json() {
+    PidTuneTable table;
+    char result[sizeof(atuneResult)];
+    bool active;
+    if (!state_lock()) return "{}";
+    table = tuneTable;
+    memcpy(result, atuneResult, sizeof(result));
+    active = (g_currentState == ProcessState::AUTOTUNE);
+    state_unlock();
+
+    char buf[640];
+    int len = snprintf(buf, sizeof(buf),
+        "{\"active\":%s,\"setpoint\":%.1f,\"power_mode\":%d,\"relay\":\"%s\","
+        "\"cycles\":%d,\"elapsed_s\":%lu,\"result\":\"%s\",\"tunings\":[",
+        active ? "true" : "false", at.setpoint, at.powerMode, at.relayHigh ? "high" : "low",
+        at.cycles, active ? (millis() - at.startMs) / 1000 : 0UL, result);
+    for (int i = 0; i < CFG_POWERMODE_MAX && len < (int)sizeof(buf); i++) {
+        const PidTuning& t = table.pm[i];
+        len += snprintf(buf + len, sizeof(buf) - len,
+            "%s{\"pm\":%d,\"valid\":%s,\"kp\":%.3f,\"ki\":%.5f,\"kd\":%.2f,"
+            "\"ku\":%.3f,\"tu\":%.1f}",
+            i ? "," : "", i + 1, t.valid ? "true" : "false", t.kp, t.ki, t.kd, t.ku, t.tu);
+    }
+    if (len < (int)sizeof(buf)) snprintf(buf + len, sizeof(buf) - len, "]}");
+    return String(buf);
+}
+
+// ======================================================
+// [NEW] OBSERWATOR TEMPERATURY POWIETRZA
+// ======================================================
+// estCfg pod state_lock (zmiany z WWW), estState tylko w taskControl;
+// [FIX] estShared/estFallbackShared - kopia dla WWW, pisana pod state_lock
+
+static EstimatorConfig estCfg;
+static EstimatorState  estState;
+static unsigned long   estLastTick = 0;
+static uint32_t        estLastSeq = 0;
+static bool            estFallback = false;   // estymata odrzucona (za duża różnica)
+static EstimatorState  estShared;
+static bool            estFallbackShared = false;
+
+void estimator_load_config() {
+    EstimatorConfig cfg;
+    if (!storage_load_blob_nvs("est_cfg", &cfg, sizeof(cfg)) || !chamber_est_config_valid(cfg)) {
+        chamber_est_config_default(cfg);
+    }
+    if (state_lock()) {
+        estCfg = cfg;
+        state_unlock();
+    }
+    chamber_est_reset(estState);
+    LOG_FMT(LOG_LEVEL_INFO, "Chamber estimator: tauP=%.0fs tauA=%.0fs K=%.1f pid=%d",
+            cfg.tauProbe, cfg.tauAir, cfg.heaterGain, cfg.usePid);
+}
+
+bool estimator_get_config(EstimatorConfig& cfg) {
+    if (!state_lock()) return false;
+    cfg = estCfg;
+    state_unlock();
+    return true;
+}
+
+bool estimator_set_config(const EstimatorConfig& cfg, bool persist) {
+    if (!chamber_est_config_valid(cfg)) return false;
+    if (!state_lock()) return false;
+    estCfg = cfg;
+    state_unlock();
+    if (persist) storage_save_blob_nvs("est_cfg", &cfg, sizeof(cfg));
+    return true;
+}
+
+String estimator_json() {
+    EstimatorConfig cfg;
+    EstimatorState st;
+    bool fallback;
+    double tRaw, tEst;
+    if (!state_lock()) return "{}";
+    cfg = estCfg;
+    st = estShared;
+    fallback = estFallbackShared;
+    tRaw = g_tChamber;
+    tEst = g_tChamberEst;
+    state_unlock();
+
+    char buf[384];
+    snprintf(buf, sizeof(buf),
+             "{\"use_pid\":%d,\"active\":%s,\"tau_probe\":%.1f,\"tau_air\":%.1f,"
+             "\"heater_gain\":%.2f,\"ambient\":%.1f,\"q_air\":%g,\"q_dist\":%g,"
+             "\"r_meas\":%g,\"max_dev\":%.1f,\"t_raw\":%.2f,\"t_est\":%.2f,"
+             "\"dist\":%g,\"u\":%.2f}",
+             cfg.usePid, (cfg.usePid && st.init && !fallback) ? "true" : "false",
+             cfg.tauProbe, cfg.tauAir, cfg.heaterGain, cfg.ambient,
+             cfg.qAir, cfg.qDist, cfg.rMeas, cfg.maxDeviation,
+             tRaw, tEst, chamber_est_dist(st), outputs_heater_power());
+    return String(buf);
+}
+
+// Predykcja co tick (u z poprzedniego ticku), korekta gdy czujniki dały nowy pomiar.
+// Zwraca wartość dla pidInput: estymatę lub surową średnią.
+static double updateChamberEstimate(const EstimatorConfig& cfg, double tRaw,
+                                    double tAmbient, uint32_t seq) {
+    unsigned long now = millis();
+    float dt = estLastTick ? (now - estLastTick) / 1000.0f : 0.0f;
+    estLastTick = now;
+
+    float ambient = isnan(tAmbient) ? cfg.ambient : (float)tAmbient;
+    chamber_est_predict(cfg, estState, (float)outputs_heater_power(), ambient, dt);
+    if (seq != estLastSeq) {
+        estLastSeq = seq;
+        chamber_est_correct(cfg, estState, (float)tRaw);
+    }
+    if (!estState.init) return tRaw;
+
+    double tEst = chamber_est_air(estState);
+    bool deviates = fabs(tEst - tRaw) > cfg.maxDeviation;
+    if (deviates != estFallback) {
+        estFallback = deviates;
+        if (deviates) {
+            LOG_FMT(LOG_LEVEL_WARN, "Estimator deviates (est %.1f / raw %.1f) - PID on raw", tEst, tRaw);
+        } else {
+            log_msg(LOG_LEVEL_INFO, "Estimator back within limits");
+        }
+    }
+    return (cfg.usePid && !deviates) ? tEst : tRaw;
+}
+
+// ======================================================
+// [NEW] DETEKTOR MARTWEJ GRZAŁKI (heater_fault.h)
+// ======================================================
+// Na estymacie powietrza i parametrach obserwatora (K, tauAir), raz na pomiar.
+// Część grzałek martwa - alarm, proces dalej (PID nadrabia pozostałymi).
+// Wszystkie grzałki, które grzały, martwe - PAUSE_HEATER_FAULT jak okno braku wzrostu.
+// Stan tylko w taskControl, nowy proces = nowa linia bazowa.
+
+static HeaterFaultState hfDet;
+static unsigned long    hfRun = 0;
+static uint32_t         hfLastSeq = 0;
+static double           hfLastSp = NAN;
+
+static void holdHeaterFaultDetector() {
+    heater_fault_hold(hfDet);
+}
+
+static void sampleHeaterFault(unsigned long processStart, uint32_t seq, double setpoint,
+                              const EstimatorConfig& cfg, double tAmbient) {
+    if (processStart != hfRun) {
+        heater_fault_reset(hfDet);
+        hfRun = processStart;
+        hfLastSp = setpoint;
+    }
+    if (seq == hfLastSeq || !estState.init) return;
+    hfLastSeq = seq;
+    // Skok zadanej (nowy krok) - komora w stanie przejściowym, model nie trzyma
+    // linii bazowej; bez decyzji przez rozgrzewkę jak po pauzie
+    bool spJump = fabs(setpoint - hfLastSp) >= PID_SP_JUMP_C;
+    hfLastSp = setpoint;
+    if (spJump) {
+        heater_fault_rebase(hfDet);
+        return;
+    }
+    if (!areHeatersReady()) {
+        heater_fault_hold(hfDet);
+        return;
+    }
+
+    double d[3];
+    outputs_heater_duties(d);
+    const float duty[3] = {(float)d[0] / 100.0f, (float)d[1] / 100.0f, (float)d[2] / 100.0f};
+    float ambient = isnan(tAmbient) ? cfg.ambient : (float)tAmbient;
+    uint8_t found = heater_fault_sample(hfDet, millis(), chamber_est_air(estState), ambient, duty,
+                                        cfg.heaterGain / cfg.tauAir, 1.0f / cfg.tauAir);
+    if (hfDet.samples == 0 && state_lock()) {   // koniec bloku
+        g_processStats.heaterFaultMask = hfDet.faultMask;
+        g_processStats.heatersEffective = hfDet.effective;
+        state_unlock();
+    }
+    if (hfDet.samples == 0 && hfDet.ambiguous) {
+        LOG_FMT(LOG_LEVEL_WARN, "Heater power low - effective %.1f of %.1f heaters, heater not identified",
+                hfDet.effective, hfDet.commanded);
+    }
+    if (!found) return;
+
+    uint8_t heating = 0;
+    for (int i = 0; i < 3; i++) {
+        if (found & (1 << i)) {
+            LOG_FMT(LOG_LEVEL_ERROR, "!!! HEATER FAULT !!! H%d not heating - effective %.1f of %.1f heaters",
+                    i + 1, hfDet.effective, hfDet.commanded);
+        }
+        if (duty[i] > 0) heating |= (1 << i);
+    }
+
+    if (heating & ~hfDet.faultMask) {
+        buzzerBeep(3, 300, 200);   // część grzałek działa - proces dalej
+        return;
+    }
+    if (state_lock()) {
+        g_currentState = ProcessState::PAUSE_HEATER_FAULT;
+        g_processStats.pauseCount++;
+        state_unlock();
+    }
+    allOutputsOff();
+    buzzerBeep(5, 300, 200);
+    log_msg(LOG_LEVEL_ERROR, "!!! HEATER FAULT !!! No working heater left - paused");
+}
+
+// ======================================================
+// [NEW] PID RAZ NA ŚWIEŻY POMIAR
+// ======================================================
+// Komora mierzona co ~1.2 s - Compute() co 100 ms liczyło na starym wejściu
+// (człon D zero, potem skok). SampleTime = odstęp od poprzedniego pomiaru,
+// więc Ki/Kd w jednostkach na sekundę zostają poprawne przy jitterze taktu.
+
+static uint32_t      pidLastSeq = 0;
+static unsigned long pidLastMs = 0;
+
+static void resetPidSampling() {
+    pidLastMs = 0;
+}
+
+static double pidUnclamped = 0;   // [NEW] P + I - D przed ograniczeniem do 0..100
+static double pidSampleSec = 0;   // [NEW] > 0: Compute() jeszcze nie rozliczone z wyjściem
+
+static void computePidOnSample(uint32_t seq) {
+    extern double pidInput, pidSetpoint;
+    if (seq == pidLastSeq) return;
+    unsigned long now = millis();
+    unsigned long dt = pidLastMs ? now - pidLastMs : TEMP_REQUEST_INTERVAL;
+    // [FIX] Pomiar szybciej niż PID_SAMPLE_MIN_MS: bez zużycia seq - policzony w
+    // następnym takcie. Wcześniej SampleTime > dt i Compute() odrzucał próbkę na stałe.
+    if (dt < PID_SAMPLE_MIN_MS) return;
+    unsigned long sampleMs = min(dt, PID_SAMPLE_MAX_MS);
+    pid.SetSampleTime((int)sampleMs);
+    if (!pid.Compute()) return;
+    // [FIX] seq i czas zużyte dopiero po udanym Compute(). lastTime biblioteki to
+    // millis() z wnętrza Compute() - bywa o 1 ms późniejszy niż 'now', więc
+    // odstęp liczony od 'now' wychodził większy niż jej timeChange, Compute()
+    // zwracał false, a próbka przepadała. millis() po Compute() >= lastTime.
+    pidLastSeq = seq;
+    pidLastMs = millis();
+
+    // [NEW] Lustro całki - krok w krok jak PID_v1::Compute() (P_ON_E)
+    double dtS = sampleMs / 1000.0;
+    double e = pidSetpoint - pidInput;
+    pidIntegral = constrain(pidIntegral + pid.GetKi() * dtS * e, 0.0, 100.0);
+    pidUnclamped = pid.GetKp() * e + pidIntegral - pid.GetKd() / dtS * (pidInput - pidLastInput);
+    pidLastInput = pidInput;
+    pidLastSp = pidSetpoint;
+    pidSampleSec = dtS;
+}
+
 // ======================================================
-// GŁÓWNA LOGIKA STEROWANIA (wywoływana co 100 ms z taskControl)
+// [NEW] ANTI-WINDUP I PRZEJŚCIA BEZ SKOKU
+// ======================================================
+// Po mapPowerToHeaters(): część wyjścia, której grzałki nie oddały (nasycenie
+// 0..100, stopnie wstrzymane przez soft-enable), cofa całkę -
+//  - clamping: całkowanie z tej próbki cofnięte, gdy błąd pcha dalej w ograniczenie,
+//  - back-calculation: całka ściągana do wyjścia oddanego ze stałą
+//    Tt = sqrt(Ti * Td) (bez D: Ti), nie krócej niż odstęp próbek.
+
+static void pidTrackAppliedOutput() {
+    extern double pidInput, pidSetpoint;
+    if (pidSampleSec <= 0) return;
+    double dtS = pidSampleSec;
+    pidSampleSec = 0;
+
+    double excess = pidUnclamped - outputs_applied_output();
+    if (fabs(excess) < PID_AW_DEADBAND_PCT) return;
+
+    double kp = pid.GetKp(), ki = pid.GetKi(), kd = pid.GetKd();
+    double e = pidSetpoint - pidInput;
+    double integral = pidIntegral;
+    if (excess * e > 0) integral -= ki * dtS * e;
+    if (kp > 0 && ki > 0) {
+        double tt = kd > 0 ? sqrt(kd / ki) : kp / ki;
+        integral -= excess * min(1.0, dtS / tt);
+    }
+    pidLoadIntegral(integral);
+}
+
+// Wejście w regulację PID (start, wznowienie po pauzie/drzwiach) i skoki setpointu.
+// Start: całka od zera. Wznowienie: całka sprzed pauzy (moc utrzymania - w pauzie
+// Compute() nie liczy), człon D od bieżącego pomiaru - bez kopnięcia od spadku
+// temperatury przy otwartych drzwiach. Skok setpointu (krok profilu, wyprzedzenie,
+// zmiana ręczna): moc utrzymania ~ (setpoint - otoczenie), całka przeskalowana.
+
+static ProcessState pidPrevState = ProcessState::IDLE;
+static double       pidPrevSp = 0;
+
+static bool pidComputes(ProcessState st) {
+    return st == ProcessState::RUNNING_AUTO || st == ProcessState::RUNNING_MANUAL ||
+           st == ProcessState::SOFT_RESUME;
+}
+
+static bool isPauseState(ProcessState st) {
+    return st == ProcessState::PAUSE_DOOR || st == ProcessState::PAUSE_SENSOR ||
+           st == ProcessState::PAUSE_OVERHEAT || st == ProcessState::PAUSE_USER ||
+           st == ProcessState::PAUSE_HEATER_FAULT;
+}
+
+static void pidHandleTransitions(ProcessState st, double sp, double tAmbient) {
+    if (pidComputes(st) && !pidComputes(pidPrevState)) {
+        bool resume = isPauseState(pidPrevState);
+        pidLoadIntegral(resume ? pidIntegral : 0.0);
+        pidLastSp = sp;
+        pidSampleSec = 0;
+        LOG_FMT(LOG_LEVEL_DEBUG, "PID %s: integral %.1f%%", resume ? "resume" : "start", pidIntegral);
+    } else if (pidComputes(st) && fabs(sp - pidPrevSp) >= PID_SP_JUMP_C) {
+        double oldLoss = pidPrevSp - tAmbient;
+        double newLoss = sp - tAmbient;
+        if (oldLoss > PID_SP_JUMP_C && newLoss > 0) {
+            pidLoadIntegral(pidIntegral * newLoss / oldLoss);
+            LOG_FMT(LOG_LEVEL_DEBUG, "PID setpoint %.1f -> %.1f C: integral %.1f%%",
+                    pidPrevSp, sp, pidIntegral);
+        }
+    }
+    pidPrevState = st;
+    pidPrevSp = sp;
+}
+
+// ======================================================
+// GŁÓWNA LOGIKA STEROWANIA (taskControl: świeży pomiar lub co CONTROL_TICK_MS)
 // ======================================================
 
 void process_run_control_logic() {
     extern double pidInput, pidSetpoint;
 
+    static double tEstPublished = 0;
+
     if (!state_lock()) return;
     ProcessState st = g_currentState;
-    pidInput = g_tChamber;
+    double tRaw = g_tChamber;
+    double tAmbient = g_tAmbient;
+    uint32_t seq = g_sensorSeq;
+    double tMeat = g_tMeat;
+    bool doorOpen = g_doorOpen;
+    bool sensorError = g_errorSensor;
+    int powerMode = g_powerMode;
+    schedAdaptive = gainSched.adaptive != 0;
+    EstimatorConfig ecfg = estCfg;
+    if (estState.init) g_tChamberEst = tEstPublished;   // z poprzedniego ticku - bez drugiego locka
+    estShared = estState;
+    estFallbackShared = estFallback;
     pidSetpoint = g_tSet;
     unsigned long processStart = g_processStartTime;
+    state_snapshot_publish_locked();   // [NEW] migawka dla UI/WWW/chmury - to samo state_lock
     state_unlock();
 
+    // [NEW] Obserwator liczony zawsze (podgląd w WWW), pidInput wg usePid
+    pidInput = updateChamberEstimate(ecfg, tRaw, tAmbient, seq);
+    tEstPublished = estState.init ? chamber_est_air(estState) : tRaw;
+    pidHandleTransitions(st, pidSetpoint, tAmbient);   // [NEW]
+
     // Sprawdzenie maksymalnego czasu procesu
     if ((st == ProcessState::RUNNING_AUTO || st == ProcessState::RUNNING_MANUAL) &&
         (millis() - processStart > CFG_MAX_PROCESS_TIME_MS)) {
@@ -527,30 +1651,46 @@ void process_run_control_logic() {
         return;
     }
 
+    accountEnergy(st);   // [NEW]
+
     switch (st) {
         case ProcessState::RUNNING_AUTO:
+            updateGainSchedule(pidSetpoint, powerMode);   // [NEW]
             adaptPidParameters();
-            pid.Compute();
+            computePidOnSample(seq);   // [MOD]
             applySoftEnable();
             mapPowerToHeaters();
+            pidTrackAppliedOutput();   // [NEW] anti-windup
             handleAutoMode();
+            identifyChamberRates(tRaw, pidSetpoint, powerMode);   // [NEW]
+            runSetpointRamp(tRaw);                      // [NEW] ramp= / ahead=1
+            sampleMeatEta(processStart, tMeat, tRaw);   // [NEW]
+            runCascade(tMeat);                          // [NEW] setpoint komory w krokach ctl=cascade
             updateProcessStats();
             checkHeaterEfficiency();   // [NEW]
+            sampleHeaterFault(processStart, seq, pidSetpoint, ecfg, tAmbient);   // [NEW]
             break;
 
         case ProcessState::RUNNING_MANUAL:
-            pid.Compute();
+            updateGainSchedule(pidSetpoint, powerMode);   // [NEW]
+            computePidOnSample(seq);   // [MOD]
             applySoftEnable();
             mapPowerToHeaters();
+            pidTrackAppliedOutput();   // [NEW] anti-windup
             handleManualMode();
+            identifyChamberRates(tRaw, pidSetpoint, powerMode);   // [NEW]
+            sampleMeatEta(processStart, tMeat, tRaw);   // [NEW]
             updateProcessStats();
             checkHeaterEfficiency();   // [NEW]
+            sampleHeaterFault(processStart, seq, pidSetpoint, ecfg, tAmbient);   // [NEW]
             break;
 
         case ProcessState::SOFT_RESUME:
-            pid.Compute();
+            updateGainSchedule(pidSetpoint, powerMode);   // [NEW]
+            computePidOnSample(seq);   // [MOD]
             applySoftEnable();
             mapPowerToHeaters();
+            pidTrackAppliedOutput();   // [NEW] anti-windup
 
             if (areHeatersReady()) {
                 if (state_lock()) {
@@ -563,6 +1703,14 @@ void process_run_control_logic() {
             }
             break;
 
+        case ProcessState::AUTOTUNE:             // [NEW]
+            resetPidSampling();
+            applySoftEnable();
+            runAutotune(pidInput, doorOpen, sensorError);
+            mapPowerToHeaters();
+            handleFanLogic();
+            break;
+
         case ProcessState::IDLE:
         case ProcessState::PAUSE_DOOR:
         case ProcessState::PAUSE_SENSOR:
@@ -570,6 +1718,8 @@ void process_run_control_logic() {
         case ProcessState::PAUSE_USER:
         case ProcessState::PAUSE_HEATER_FAULT:   // [NEW]
         case ProcessState::ERROR_PROFILE:
+            resetPidSampling();   // [NEW] po pauzie pierwszy odstęp nominalny
+            holdHeaterFaultDetector();   // [NEW]
             allOutputsOff();
             break;
     }
@@ -610,17 +1760,18 @@ void process_force_next_step() {
 String getPidParameters() {
     char buffer[128];
     snprintf(buffer, sizeof(buffer),
-             "Kp=%.2f, Ki=%.2f, Kd=%.2f (base: %.1f,%.1f,%.1f)",
+             "Kp=%.2f, Ki=%.3f, Kd=%.2f (base: %.2f,%.3f,%.1f)",
              adaptivePid.currentKp, adaptivePid.currentKi, adaptivePid.currentKd,
-             CFG_Kp, CFG_Ki, CFG_Kd);
+             adaptivePid.baseKp, adaptivePid.baseKi, adaptivePid.baseKd);
     return String(buffer);
 }
 
 void resetAdaptivePid() {
-    adaptivePid.currentKp = CFG_Kp;
-    adaptivePid.currentKi = CFG_Ki;
-    adaptivePid.currentKd = CFG_Kd;
-    pid.SetTunings(CFG_Kp, CFG_Ki, CFG_Kd);
+    adaptivePid.scaleKp = adaptivePid.scaleKi = adaptivePid.scaleKd = 1.0;
+    adaptivePid.currentKp = adaptivePid.baseKp;
+    adaptivePid.currentKi = adaptivePid.baseKi;
+    adaptivePid.currentKd = adaptivePid.baseKd;
+    pid.SetTunings(adaptivePid.baseKp, adaptivePid.baseKi, adaptivePid.baseKd);
 
     for (int i = 0; i < 10; i++) {
         adaptivePid.errorHistory[i] = 0;
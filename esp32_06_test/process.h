@@ -1,6 +1,8 @@
 // process.h - Zmodernizowana wersja
 #pragma once
 #include <Arduino.h>
+#include "chamber_estimator.h"
+#include "gain_schedule.h"
 
 // Główne funkcje procesu
 void process_run_control_logic();
@@ -9,6 +11,11 @@ void process_start_manual();
 void process_resume();
 void applyCurrentStep();
 
+// [NEW] Wznowienie procesu przerwanego resetem/zanikiem zasilania (checkpoint.h).
+// Tylko z IDLE; krok i czasy z rekordu, stan SOFT_RESUME.
+struct ProcessCheckpoint;
+bool process_restore(const ProcessCheckpoint& cp);
+
 // Funkcje kontrolne
 void process_force_next_step();
 
@@ -19,3 +26,30 @@ void resetAdaptivePid();
 // [NEW] Reset stanu zabezpieczenia awarii grzałki
 // Wywoływane przy process_start_auto(), process_start_manual() i process_resume()
 void resetHeaterFaultMonitor();
+
+// [NEW] Autotune PID (test przekaźnikowy) - nastawy per powerMode w NVS "pid_tune"
+struct PidTuning {
+    float   kp, ki, kd;
+    float   ku, tu;          // wzmocnienie krytyczne i okres krytyczny [s]
+    uint8_t valid;
+    uint8_t reserved[3];
+};
+void   process_load_tunings();
+bool   process_get_tuning(int powerMode, PidTuning& out);
+void   process_clear_tuning(int powerMode);
+bool   process_start_autotune(double setpoint, int powerMode);
+void   process_stop_autotune();
+String autotune_json();
+
+// [NEW] Harmonogram nastaw PID (setpoint x powerMode), NVS "pid_sched"
+bool   process_get_schedule(GainSchedule& out);
+bool   process_set_schedule_point(const GainPoint& p);
+bool   process_remove_schedule_point(int index);
+bool   process_set_adaptive(bool enabled);
+String schedule_json();
+
+// [NEW] Obserwator temperatury powietrza (chamber_estimator) - konfiguracja NVS "est_cfg"
+void   estimator_load_config();
+bool   estimator_get_config(EstimatorConfig& cfg);
+bool   estimator_set_config(const EstimatorConfig& cfg, bool persist);
+String estimator_json();
@@ -0,0 +1,183 @@
+// profile_parser.cpp - Parser plików profili .prof
+// [NEW] Przeniesione ze storage.cpp bez zmian w formacie
+// [MOD] Pola klucz=wartość za 10. kolumną (kaskada, rampa setpointu, dym, exit=)
+// [MOD] Tekst do areny profile_store.h - bez limitu 10 kroków
+#include "profile_parser.h"
+
+// Drugi przebieg profile_parse_text() - ostrzeżenia już były w pierwszym
+static bool parseQuiet = false;
+#define PARSE_WARN(fmt, ...) do { if (!parseQuiet) LOG_FMT(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__); } while (0)
+
+static bool parseBool(const char* s) {
+    return (strcmp(s, "1") == 0 || strcasecmp(s, "true") == 0);
+}
+
+// Jedno pole klucz=wartość. false = nieznany klucz lub wartość.
+static bool parseKeyValue(char* field, Step& step) {
+    char* eq = strchr(field, '=');
+    if (!eq) return false;
+    *eq = '\0';
+    const char* key = field;
+    const char* val = eq + 1;
+
+    if (strcmp(key, "ctl") == 0) {
+        if (strcasecmp(val, "cascade") == 0)      step.control = StepControl::CASCADE;
+        else if (strcasecmp(val, "chamber") == 0) step.control = StepControl::CHAMBER;
+        else return false;
+    } else if (strcmp(key, "tmin") == 0) {
+        step.cascMin = constrain(atof(val), CFG_T_MIN_SET, CFG_T_MAX_SET);
+    } else if (strcmp(key, "tmax") == 0) {
+        step.cascMax = constrain(atof(val), CFG_T_MIN_SET, CFG_T_MAX_SET);
+    } else if (strcmp(key, "time") == 0) {
+        step.cascTimeMs = (unsigned long)max(0, atoi(val)) * 60UL * 1000UL;
+    } else if (strcmp(key, "rate") == 0) {
+        step.cascRate = max(0.0, atof(val));
+    } else if (strcmp(key, "ramp") == 0) {
+        step.rampRate = max(0.0, atof(val));
+    } else if (strcmp(key, "ahead") == 0) {
+        step.lookahead = parseBool(val);
+    } else if (strcmp(key, "spulse") == 0) {
+        char* colon = strchr((char*)val, ':');
+        if (!colon) return false;
+        step.smokeOnSec  = constrain(atoi(val), 0, 3600);
+        step.smokeOffSec = constrain(atoi(colon + 1), 0, 3600);
+    } else if (strcmp(key, "sramp") == 0) {
+        step.smokeRampSec = (uint16_t)constrain(atoi(val), 0, 600) * 60;
+    } else if (strcmp(key, "sdens") == 0) {
+        step.smokeDensity = constrain(atof(val), 0, 100);
+    } else if (strcmp(key, "exit") == 0) {
+        // Błąd składni - krok kończy się po staremu, profil ładuje się dalej
+        const char* err = "";
+        int pos = 0;
+        if (!cond_compile(val, step.exitCond, &err, &pos)) {
+            PARSE_WARN("Step '%s': exit= %s at '%s' - default exit", step.name, err, val + pos);
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Domyślne granice kaskady; kaskada bez celu mięsa -> zwykły krok
+static void finishCascade(Step& step) {
+    if (step.control != StepControl::CASCADE) return;
+    if (step.tMeatTarget <= 0) {
+        PARSE_WARN("Step '%s': cascade without tMeat - chamber control", step.name);
+        step.control = StepControl::CHAMBER;
+        return;
+    }
+    step.useMeatTemp = true;   // krok kończy dojście rdzenia
+    step.rampRate = 0;         // setpoint komory prowadzi kaskada
+    if (step.cascMax <= 0) step.cascMax = step.tSet;
+    if (step.cascMin <= 0) step.cascMin = step.tMeatTarget + CASCADE_MIN_MARGIN_C;
+    if (step.cascMin > step.cascMax) step.cascMin = step.cascMax;
+    if (step.cascRate <= 0 && step.cascTimeMs == 0) step.cascTimeMs = step.minTimeMs;
+}
+
+bool profile_parse_line(char* line, Step& step) {
+    while (*line == ' ' || *line == '\t') line++;
+
+    int len = strlen(line);
+    while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == '\n' || line[len - 1] == ' ')) {
+        line[--len] = '\0';
+    }
+
+    if (len == 0 || line[0] == '#') return false;
+
+    char* fields[PROFILE_MAX_FIELDS];
+    int fieldCount = 0;
+    char* token = strtok(line, ";");
+    while (token && fieldCount < PROFILE_MAX_FIELDS) {
+        fields[fieldCount++] = token;
+        token = strtok(NULL, ";");
+    }
+
+    if (fieldCount < 10) {
+        PARSE_WARN("%s", "Invalid profile line - not enough fields");
+        return false;
+    }
+
+    step.name         = fields[0];
+    step.tSet         = constrain(atof(fields[1]), CFG_T_MIN_SET, CFG_T_MAX_SET);
+    step.tMeatTarget  = constrain(atof(fields[2]), 0, 100);
+    step.minTimeMs    = (unsigned long)(atoi(fields[3])) * 60UL * 1000UL;
+    step.powerMode    = constrain(atoi(fields[4]), CFG_POWERMODE_MIN, CFG_POWERMODE_MAX);
+    step.smokePwm     = constrain(atoi(fields[5]), CFG_SMOKE_PWM_MIN, CFG_SMOKE_PWM_MAX);
+    step.fanMode      = constrain(atoi(fields[6]), 0, 2);
+    step.fanOnTime    = max(1000UL, (unsigned long)(atoi(fields[7])) * 1000UL);
+    step.fanOffTime   = max(1000UL, (unsigned long)(atoi(fields[8])) * 1000UL);
+    step.useMeatTemp  = parseBool(fields[9]);
+
+    step.control    = StepControl::CHAMBER;
+    step.cascMin    = 0;
+    step.cascMax    = 0;
+    step.cascRate   = 0;
+    step.cascTimeMs = 0;
+    step.rampRate   = 0;
+    step.lookahead  = false;
+    step.smokeOnSec   = 0;
+    step.smokeOffSec  = 0;
+    step.smokeRampSec = 0;
+    step.smokeDensity = 0;
+    step.exitCond.len = 0;
+    for (int i = 10; i < fieldCount; i++) {
+        if (!parseKeyValue(fields[i], step)) {
+            PARSE_WARN("Step '%s': unknown field '%s' ignored", step.name, fields[i]);
+        }
+    }
+    finishCascade(step);
+
+    return true;
+}
+
+// Przebieg po liniach; arena == nullptr - tylko liczenie kroków i rozmiarów
+static int parsePass(const char* text, size_t len, ProfileArena* arena,
+                     size_t& condBytes, size_t& nameBytes) {
+    int count = 0;
+    size_t pos = 0;
+    Step step;
+
+    while (pos < len) {
+        size_t eol = pos;
+        while (eol < len && text[eol] != '\n') eol++;
+
+        char lineBuf[256];
+        size_t lineLen = eol - pos;
+        if (lineLen > sizeof(lineBuf) - 1) lineLen = sizeof(lineBuf) - 1;
+        memcpy(lineBuf, text + pos, lineLen);
+        lineBuf[lineLen] = '\0';
+        pos = eol + 1;
+
+        if (!profile_parse_line(lineBuf, step)) continue;
+        if (count >= MAX_STEPS) {
+            PARSE_WARN("Profile longer than %d steps - rest ignored", MAX_STEPS);
+            break;
+        }
+        if (arena) {
+            profile_arena_put(arena, count, step);
+        } else {
+            size_t cb;
+            nameBytes += profile_step_extra(step, &cb);
+            condBytes += cb;
+        }
+        count++;
+    }
+    return count;
+}
+
+ProfileArena* profile_parse_text(const char* text, size_t len) {
+    size_t condBytes = 0, nameBytes = 0;
+    parseQuiet = false;
+    int count = parsePass(text, len, nullptr, condBytes, nameBytes);
+    if (count == 0) return nullptr;
+
+    ProfileArena* arena = profile_arena_alloc(count, condBytes, nameBytes);
+    if (!arena) {
+        LOG_FMT(LOG_LEVEL_ERROR, "Profile: no memory for %d steps", count);
+        return nullptr;
+    }
+    parseQuiet = true;
+    parsePass(text, len, arena, condBytes, nameBytes);
+    parseQuiet = false;
+    return arena;
+}
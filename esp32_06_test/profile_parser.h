@@ -0,0 +1,32 @@
+// profile_parser.h - Parser plików profili .prof
+// [NEW] Wydzielony ze storage.cpp - wspólny dla profili z flash, z GitHub
+//       i dla symulatora na hoście (sim/)
+// Format linii: nazwa;tSet;tMeat;minTime[min];powerMode;smokePwm;fanMode;fanOn[s];fanOff[s];useMeatTemp
+// [NEW] Za 10 kolumnami opcjonalne pola klucz=wartość (starsze firmware je pomija):
+//   ctl=cascade|chamber  - tryb regulacji kroku
+//   tmin=, tmax=         - granice setpointu komory w kaskadzie [°C] (domyślnie tMeat+2 / tSet)
+//   time=                - dojście rdzenia do tMeat [min] od startu kroku (domyślnie minTime)
+//   rate=                - zamiast time: narastanie rdzenia [°C/min]
+//   ramp=                - setpoint dochodzi do tSet z tą prędkością [°C/min] (bez = skok)
+//   ahead=1              - końcówka kroku (bez useMeatTemp) już w drodze do tSet następnego
+//   spulse=ON:OFF        - dym impulsami: ON s na smokePwm, OFF s przerwy (smoke_sched.h)
+//   sramp=               - PWM dymu dochodzi od poziomu poprzedniego kroku przez tyle [min]
+//   sdens=               - gęstość dymu z czujnika [%], smokePwm = górna granica PWM
+//   exit=                - warunek końca kroku zamiast minTime/useMeatTemp (step_cond.h)
+// Przykład: Parzenie;85;68;30;3;0;1;10;60;1;ctl=cascade;time=90;tmin=72
+//           Wedzenie;60;0;120;2;180;2;10;60;0;ramp=1;ahead=1;spulse=40:20;sramp=5
+//           Osuszanie;50;0;60;2;0;1;10;60;0;exit=stable(1,20) & time>=30 | time>=120
+#pragma once
+#include "config.h"
+#include "profile_store.h"
+
+constexpr int PROFILE_MAX_FIELDS = 16;
+
+// Parsuje jedną linię (modyfikuje bufor). false = pusta linia, komentarz lub błąd.
+// [MOD] step.name wskazuje na bufor linii.
+bool profile_parse_line(char* line, Step& step);
+
+// [MOD] Parsuje cały tekst profilu do nowej areny (profile_store.h) o rozmiarze
+// z pierwszego przebiegu. nullptr = brak kroków lub pamięci. Wołający podmienia
+// g_profile pod state_lock i zwalnia starą arenę (profile_arena_free).
+ProfileArena* profile_parse_text(const char* text, size_t len);
@@ -0,0 +1,160 @@
+// profile_store.cpp - Arena załadowanego profilu (patrz profile_store.h)
+#include "profile_store.h"
+#include <stdlib.h>
+
+static size_t align4(size_t n) {
+    return (n + 3) & ~(size_t)3;
+}
+
+static size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+static size_t nameLen(const Step& s) {
+    size_t n = s.name ? strlen(s.name) : 0;
+    return n > PROFILE_NAME_MAX ? PROFILE_NAME_MAX : n;
+}
+
+// Stałe float przed kodem - wyrównanie 4
+static size_t condSize(const StepCond& c) {
+    return c.len ? align4(c.nk * sizeof(float) + c.len) : 0;
+}
+
+size_t profile_step_extra(const Step& s, size_t* condBytes) {
+    *condBytes = condSize(s.exitCond);
+    return nameLen(s) + 1;
+}
+
+ProfileArena* profile_arena_alloc(int count, size_t condBytes, size_t nameBytes) {
+    size_t energyOff = align8(sizeof(ProfileArena) + count * sizeof(ProfileStep));
+    size_t energyEnd = energyOff + count * sizeof(uint64_t);
+    size_t size = energyEnd + condBytes + nameBytes;
+    if (count <= 0 || size > 0xFFFF) return nullptr;
+    ProfileArena* a = (ProfileArena*)malloc(size);
+    if (!a) return nullptr;
+    memset(a, 0, size);
+    a->count = (uint16_t)count;
+    a->size = (uint16_t)size;
+    a->energyOff = (uint16_t)energyOff;
+    a->condTop = (uint16_t)energyEnd;
+    a->nameTop = (uint16_t)(energyEnd + condBytes);
+    return a;
+}
+
+void profile_arena_free(ProfileArena* a) {
+    free(a);
+}
+
+static int16_t deci(double t) {
+    return (int16_t)lround(constrain(t, -3000.0, 3000.0) * 10.0);
+}
+
+static uint16_t centi(double r) {
+    return (uint16_t)lround(constrain(r, 0.0, 655.0) * 100.0);
+}
+
+static uint16_t sec16(unsigned long ms) {
+    return (uint16_t)min(ms / 1000UL, 65535UL);
+}
+
+void profile_arena_put(ProfileArena* a, int i, const Step& s) {
+    ProfileStep& p = profile_steps(a)[i];
+    uint8_t* base = (uint8_t*)a;
+
+    p.minTimeSec   = s.minTimeMs / 1000UL;
+    p.cascTimeSec  = s.cascTimeMs / 1000UL;
+    p.tSet         = deci(s.tSet);
+    p.tMeat        = deci(s.tMeatTarget);
+    p.cascMin      = deci(s.cascMin);
+    p.cascMax      = deci(s.cascMax);
+    p.cascRate     = centi(s.cascRate);
+    p.rampRate     = centi(s.rampRate);
+    p.fanOnSec     = sec16(s.fanOnTime);
+    p.fanOffSec    = sec16(s.fanOffTime);
+    p.smokeOnSec   = s.smokeOnSec;
+    p.smokeOffSec  = s.smokeOffSec;
+    p.smokeRampSec = s.smokeRampSec;
+    p.powerMode    = (uint8_t)s.powerMode;
+    p.smokePwm     = (uint8_t)s.smokePwm;
+    p.fanMode      = (uint8_t)s.fanMode;
+    p.control      = (uint8_t)s.control;
+    p.flags        = (s.useMeatTemp ? PSTEP_F_MEAT : 0) | (s.lookahead ? PSTEP_F_AHEAD : 0);
+    p.smokeDensity = (uint8_t)lround(constrain(s.smokeDensity, 0.0f, 100.0f));
+
+    const StepCond& c = s.exitCond;
+    p.condLen = c.len;
+    p.condConsts = c.nk;
+    p.condOff = a->condTop;
+    if (c.len) {
+        memcpy(base + a->condTop, c.k, c.nk * sizeof(float));
+        memcpy(base + a->condTop + c.nk * sizeof(float), c.code, c.len);
+        a->condTop += condSize(c);
+    }
+
+    size_t n = nameLen(s);
+    p.nameOff = a->nameTop;
+    if (n) memcpy(base + a->nameTop, s.name, n);
+    base[a->nameTop + n] = '\0';
+    a->nameTop += n + 1;
+}
+
+void profile_step_get(const ProfileArena* a, int i, Step& out) {
+    const ProfileStep& p = profile_steps(a)[i];
+    const uint8_t* base = (const uint8_t*)a;
+
+    out.name         = (const char*)base + p.nameOff;
+    out.tSet         = p.tSet / 10.0;
+    out.tMeatTarget  = p.tMeat / 10.0;
+    out.minTimeMs    = p.minTimeSec * 1000UL;
+    out.powerMode    = p.powerMode;
+    out.smokePwm     = p.smokePwm;
+    out.fanMode      = p.fanMode;
+    out.fanOnTime    = p.fanOnSec * 1000UL;
+    out.fanOffTime   = p.fanOffSec * 1000UL;
+    out.useMeatTemp  = p.flags & PSTEP_F_MEAT;
+    out.control      = (StepControl)p.control;
+    out.cascMin      = p.cascMin / 10.0f;
+    out.cascMax      = p.cascMax / 10.0f;
+    out.cascRate     = p.cascRate / 100.0f;
+    out.cascTimeMs   = p.cascTimeSec * 1000UL;
+    out.rampRate     = p.rampRate / 100.0f;
+    out.lookahead    = p.flags & PSTEP_F_AHEAD;
+    out.smokeOnSec   = p.smokeOnSec;
+    out.smokeOffSec  = p.smokeOffSec;
+    out.smokeRampSec = p.smokeRampSec;
+    out.smokeDensity = p.smokeDensity;
+
+    StepCond& c = out.exitCond;
+    c.len = p.condLen;
+    c.nk = p.condConsts;
+    if (c.len) {
+        memcpy(c.k, base + p.condOff, c.nk * sizeof(float));
+        memcpy(c.code, base + p.condOff + c.nk * sizeof(float), c.len);
+    }
+}
+
+const char* profile_step_name(const ProfileArena* a, int i) {
+    return (const char*)a + profile_steps(a)[i].nameOff;
+}
+
+uint32_t profile_time_sec(const ProfileArena* a, int from, int to) {
+    uint32_t sum = 0;
+    int n = profile_count(a);
+    for (int i = from < 0 ? 0 : from; i < to && i < n; i++) sum += profile_steps(a)[i].minTimeSec;
+    return sum;
+}
+
+void profile_step_skip(ProfileArena* a, int i) {
+    if (i < 0 || i >= profile_count(a)) return;
+    profile_steps(a)[i].minTimeSec = 0;
+    profile_steps(a)[i].condLen = 0;
+}
+
+void profile_energy_add(ProfileArena* a, int i, uint64_t uj) {
+    if (i < 0 || i >= profile_count(a)) return;
+    profile_step_energy(a)[i] += uj;
+}
+
+void profile_energy_reset(ProfileArena* a) {
+    if (a) memset(profile_step_energy(a), 0, a->count * sizeof(uint64_t));
+}
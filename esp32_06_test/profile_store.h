@@ -0,0 +1,83 @@
+// profile_store.h - Załadowany profil w jednej arenie o rozmiarze z parsowania
+// [NEW] g_profile był tablicą MAX_STEPS (10) pełnych Step (~180 B, nazwa char[32],
+//       exit= 65 B, double i unsigned long ms) - dłuższe receptury ucinane, krótkie
+//       i tak zajmowały całą tablicę. Teraz profile_parse_text() liczy kroki, nazwy
+//       i kod exit=, po czym buduje jeden blok:
+//         ProfileArena | ProfileStep[count] | energia kroków | kod exit= | nazwy
+//       ProfileStep (44 B): temperatury w 0.1 °C (int16), tempa w 0.01 °C/min,
+//       czasy w sekundach. Nazwy i kod exit= tylko tyle, ile mają.
+//       Odczyt przez kopię do Step (profile_step_get) - kod sterowania bez zmian.
+//       Arena podmieniana w całości pod state_lock (storage_load_profile), stara
+//       zwalniana po zwolnieniu locka; wskaźniki z areny ważne tylko pod lockiem.
+//       [FIX] Podmiana odrzucana w trakcie procesu auto (storage.cpp), więc arena
+//       żyje co najmniej do końca przebiegu - razem z nią licznik energii kroków
+//       (uint64 µJ na krok, zerowany na starcie procesu).
+//       Czysty C++ - używane też w symulatorze.
+#pragma once
+#include "config.h"
+
+constexpr int PROFILE_NAME_MAX = 31;   // znaki nazwy kroku (jak dawne char[32])
+
+struct ProfileStep {
+    uint32_t minTimeSec;
+    uint32_t cascTimeSec;
+    int16_t  tSet, tMeat;             // [0.1 °C]
+    int16_t  cascMin, cascMax;        // [0.1 °C]
+    uint16_t cascRate, rampRate;      // [0.01 °C/min]
+    uint16_t fanOnSec, fanOffSec;
+    uint16_t smokeOnSec, smokeOffSec, smokeRampSec;
+    uint16_t nameOff;                 // od początku areny
+    uint16_t condOff;                 // stałe (float), za nimi kod; condLen 0 = brak exit=
+    uint8_t  condLen, condConsts;
+    uint8_t  powerMode, smokePwm, fanMode;
+    uint8_t  control;                 // StepControl
+    uint8_t  flags;                   // PSTEP_F_*
+    uint8_t  smokeDensity;            // [%]
+};
+static_assert(sizeof(ProfileStep) == 44, "compact profile step");
+
+constexpr uint8_t PSTEP_F_MEAT  = 0x01;   // useMeatTemp
+constexpr uint8_t PSTEP_F_AHEAD = 0x02;   // lookahead
+
+struct ProfileArena {
+    uint16_t count;
+    uint16_t size;                    // bajty całej areny
+    uint16_t condTop, nameTop;        // budowa: następny wolny bajt kodu / nazw
+    uint16_t energyOff;               // uint64_t[count] energii kroków [µJ]
+    uint16_t reserved;
+};
+
+inline ProfileStep* profile_steps(ProfileArena* a) {
+    return (ProfileStep*)(a + 1);
+}
+inline const ProfileStep* profile_steps(const ProfileArena* a) {
+    return (const ProfileStep*)(a + 1);
+}
+inline int profile_count(const ProfileArena* a) {
+    return a ? a->count : 0;
+}
+inline uint64_t* profile_step_energy(ProfileArena* a) {
+    return (uint64_t*)((uint8_t*)a + a->energyOff);
+}
+inline const uint64_t* profile_step_energy(const ProfileArena* a) {
+    return (const uint64_t*)((const uint8_t*)a + a->energyOff);
+}
+
+// Rozmiar potrzebny na krok poza ProfileStep (nazwa i kod exit=)
+size_t profile_step_extra(const Step& s, size_t* condBytes);
+// Pusta arena na 'count' kroków; nullptr = brak pamięci
+ProfileArena* profile_arena_alloc(int count, size_t condBytes, size_t nameBytes);
+void profile_arena_free(ProfileArena* a);
+// Dopisanie kroku (kolejno od 0) - ProfileStep, kod i nazwa
+void profile_arena_put(ProfileArena* a, int i, const Step& s);
+
+// Kopia kroku do pełnego Step; name wskazuje na arenę (ważne pod state_lock)
+void profile_step_get(const ProfileArena* a, int i, Step& out);
+const char* profile_step_name(const ProfileArena* a, int i);
+// Suma minTime kroków [from, to) [s]
+uint32_t profile_time_sec(const ProfileArena* a, int from, int to);
+// "Następny krok" z WWW: minTime 0, bez exit=
+void profile_step_skip(ProfileArena* a, int i);
+// Energia kroku [µJ] - dopisywana / zerowana pod state_lock; nullptr ignorowane
+void profile_energy_add(ProfileArena* a, int i, uint64_t uj);
+void profile_energy_reset(ProfileArena* a);
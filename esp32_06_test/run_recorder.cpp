@@ -0,0 +1,340 @@
+// run_recorder.cpp - Binarny zapis przebiegu procesu (patrz run_recorder.h)
+#include "run_recorder.h"
+#include "config.h"
+#include "state.h"
+#include "storage.h"
+#include "outputs.h"
+#include "flash_storage.h"
+
+constexpr int RUNREC_KEEP_RUNS = 2;   // razem z nowym - poprzedni przebieg zostaje do pobrania
+constexpr int RUNREC_MAX_LIST = 8;
+
+enum class RecCmd : uint8_t { START, BLOCK, END };
+
+struct RecQueueItem {
+    RecCmd cmd;
+    union {
+        RunFileHeader hdr;
+        RunBlock      block;
+    };
+};
+
+// Pod state_lock (taskControl dodaje, taskMonitor zdejmuje).
+// Bloki zajmują najwyżej RUNREC_QUEUE miejsc - START i END zawsze się mieszczą.
+static constexpr int QUEUE_LEN = RUNREC_QUEUE + 2;
+static RecQueueItem queue[QUEUE_LEN];
+static int qHead = 0, qCount = 0;
+
+// Tylko taskControl
+static bool          recReady = false;
+static bool          recActive = false;
+static RunBlock      cur;
+static uint32_t      blockSeq = 0;
+static uint32_t      nextRunNo = 1;
+static unsigned long runProcessStart = 0;
+static unsigned long runStartMs = 0;
+static unsigned long lastRecMs = 0;
+static ProcessState  lastState = ProcessState::IDLE;
+static int           lastStep = -1;
+static uint32_t      dropped = 0;
+
+// Tylko taskMonitor
+static char     filePath[MAX_FILENAME_LEN];
+static bool     fileOpen = false;
+static bool     fileFullLogged = false;
+static uint32_t writeOffset = 0;
+
+static bool parseRunNo(const char* path, uint32_t& no) {
+    unsigned long n = 0;
+    if (sscanf(path, RUNREC_DIR "r_%lu.bin", &n) != 1) return false;
+    no = (uint32_t)n;
+    return true;
+}
+
+// Długość od początku pliku do pierwszej strony bez poprawnego bloku
+static uint32_t scanLength(const char* path, uint32_t size) {
+    uint32_t off = FLASH_PAGE_SIZE;
+    RunBlock b;
+    while (off + sizeof(RunBlock) <= size) {
+        if (flash_file_read_chunk(path, off, (uint8_t*)&b, sizeof(b)) != (int)sizeof(b)) break;
+        if (!runrec_block_valid(b)) break;
+        off += sizeof(RunBlock);
+    }
+    return off;
+}
+
+// Przebieg przerwany resetem - rozmiar = cała rezerwacja, przycięcie do zapisanych bloków
+static void checkRunFile(const char* path, uint32_t no) {
+    RunFileHeader hdr;
+    uint32_t size = flash_file_get_size(path);
+    if (flash_file_read_chunk(path, 0, (uint8_t*)&hdr, sizeof(hdr)) != (int)sizeof(hdr) ||
+        hdr.magic != RUNREC_FILE_MAGIC) {
+        LOG_FMT(LOG_LEVEL_WARN, "Run recorder: run #%lu without header - deleted", (unsigned long)no);
+        flash_file_delete(path);
+        return;
+    }
+    uint32_t len = scanLength(path, size);
+    if (len < size) {
+        flash_file_truncate(path, len);
+        LOG_FMT(LOG_LEVEL_INFO, "Run recorder: run #%lu closed after reset (%lu B)",
+                (unsigned long)no, (unsigned long)len);
+    }
+}
+
+void runrec_init() {
+    if (!flash_is_ready()) {
+        log_msg(LOG_LEVEL_WARN, "Run recorder: flash not ready - runs not recorded");
+        return;
+    }
+    char files[RUNREC_MAX_LIST][MAX_FILENAME_LEN];
+    int n = flash_list_files(RUNREC_DIR, files, RUNREC_MAX_LIST);
+    for (int i = 0; i < n; i++) {
+        uint32_t no;
+        if (!parseRunNo(files[i], no)) continue;
+        if (no >= nextRunNo) nextRunNo = no + 1;
+        checkRunFile(files[i], no);
+    }
+    recReady = true;
+}
+
+// Przebieg trwa od startu procesu (lub autotune) do IDLE/błędu profilu/końca profilu
+static bool isRecorded(ProcessState st, int step) {
+    switch (st) {
+        case ProcessState::IDLE:
+        case ProcessState::ERROR_PROFILE:
+            return false;
+        case ProcessState::PAUSE_USER:
+            return !(g_lastRunMode == RunMode::MODE_AUTO && step >= g_stepCount);
+        default:
+            return true;
+    }
+}
+
+// Pod state_lock
+static bool enqueueLocked(const RecQueueItem& item) {
+    if (qCount >= (item.cmd == RecCmd::BLOCK ? RUNREC_QUEUE : QUEUE_LEN)) {
+        dropped++;
+        return false;
+    }
+    queue[(qHead + qCount) % QUEUE_LEN] = item;
+    qCount++;
+    return true;
+}
+
+static uint8_t halfPercent(double pct) {
+    if (pct <= 0) return 0;
+    if (pct >= 100) return 200;
+    return (uint8_t)lround(pct * 2.0);
+}
+
+// Pod state_lock
+static void appendLocked(ProcessState st, int step, unsigned long now, bool event) {
+    uint32_t dt = (now - lastRecMs) / 100;
+    if (dt > 0xFFFF) dt = 0xFFFF;
+    lastRecMs += dt * 100;   // czas odtwarzany z delt bez dryfu zaokrągleń
+
+    if (cur.count == 0) {
+        memset(&cur, 0xFF, sizeof(cur));
+        cur.magic = RUNREC_BLOCK_MAGIC;
+        cur.seq = blockSeq;
+        cur.baseMs = lastRecMs - runStartMs;
+        cur.count = 0;
+    }
+    RunRecord& r = cur.rec[cur.count];
+    memset(&r, 0, sizeof(r));
+    r.dt = (uint16_t)dt;
+    r.state = (uint8_t)st;
+    r.flags = (digitalRead(PIN_FAN) == HIGH ? RUNREC_F_FAN : 0) |
+              (g_doorOpen ? RUNREC_F_DOOR : 0) |
+              (uint8_t)((g_powerMode & 3) << RUNREC_F_POWER_SH) |
+              (g_errorSensor ? RUNREC_F_SENSOR : 0) |
+              (event ? RUNREC_F_EVENT : 0);
+    r.step = (int8_t)step;
+    r.smoke = (uint8_t)outputs_smoke();   // [MOD] po impulsach/rampie/regulacji dymu
+    r.pid = halfPercent(pidOutput);
+    double duty[3];
+    outputs_heater_duties(duty);
+    for (int i = 0; i < 3; i++) r.heater[i] = halfPercent(duty[i]);
+    r.tSet = runrec_centi(g_tSet);
+    r.tChamber = runrec_centi(g_tChamber);
+    r.tEst = runrec_centi(g_tChamberEst);
+    r.tMeat = runrec_centi(g_tMeat);
+    r.tAmbient = runrec_centi(g_tAmbient);
+    for (int i = 0; i < RUNREC_CHANNELS; i++) {
+        bool ok = i < g_sensorChannelCount && g_sensorReadings[i].timestamp != 0;
+        r.ch[i] = ok ? runrec_centi(g_sensorReadings[i].value) : RUNREC_NO_TEMP;
+    }
+    uint64_t joules = g_processStats.energyUj / 1000000ULL;   // [NEW]
+    cur.energyJ = joules >= 0xFFFFFFFFULL ? 0xFFFFFFFEUL : (uint32_t)joules;
+
+    if (++cur.count == RUNREC_RECS_PER_BLOCK) {
+        cur.crc = runrec_crc32(cur.rec, sizeof(cur.rec));
+        RecQueueItem item;
+        item.cmd = RecCmd::BLOCK;
+        item.block = cur;
+        enqueueLocked(item);   // pełna kolejka - blok tracony, seq pokaże lukę
+        blockSeq++;
+        cur.count = 0;
+    }
+}
+
+// Pod state_lock
+static void startRunLocked(unsigned long now) {
+    RecQueueItem item;
+    item.cmd = RecCmd::START;
+    RunFileHeader& h = item.hdr;
+    memset(&h, 0, sizeof(h));
+    h.magic = RUNREC_FILE_MAGIC;
+    h.version = RUNREC_VERSION;
+    h.recordSize = sizeof(RunRecord);
+    h.channels = (uint8_t)min(g_sensorChannelCount, RUNREC_CHANNELS);
+    h.runMode = (uint8_t)g_lastRunMode;
+    h.intervalMs = RUNREC_INTERVAL_MS;
+    h.runNo = nextRunNo++;
+    for (int i = 0; i < RUNREC_CHANNELS; i++) {
+        h.chRole[i] = i < g_sensorChannelCount ? g_sensorChannels[i].role : 0xFF;
+    }
+    if (g_lastRunMode == RunMode::MODE_AUTO) {
+        strncpy(h.profile, storage_get_profile_path(), sizeof(h.profile) - 1);
+    }
+    enqueueLocked(item);
+
+    recActive = true;
+    runProcessStart = g_processStartTime;
+    runStartMs = now;
+    lastRecMs = now;
+    blockSeq = 0;
+    cur.count = 0;
+}
+
+// Pod state_lock - niepełny blok idzie razem z END
+static void endRunLocked() {
+    if (cur.count > 0) {
+        cur.crc = runrec_crc32(cur.rec, cur.count * sizeof(RunRecord));
+        RecQueueItem item;
+        item.cmd = RecCmd::BLOCK;
+        item.block = cur;
+        enqueueLocked(item);
+        cur.count = 0;
+    }
+    RecQueueItem item;
+    item.cmd = RecCmd::END;
+    enqueueLocked(item);
+    recActive = false;
+}
+
+void runrec_tick() {
+    if (!recReady) return;
+    if (!state_lock()) return;
+    ProcessState st = g_currentState;
+    int step = g_currentStep;
+    unsigned long now = millis();
+    bool want = isRecorded(st, step);
+    bool changed = st != lastState || step != lastStep;
+    uint32_t droppedNow = dropped;
+
+    if (recActive && (!want || g_processStartTime != runProcessStart)) {
+        appendLocked(st, step, now, true);   // stan końcowy
+        endRunLocked();
+    }
+    if (want && !recActive) {
+        startRunLocked(now);
+        appendLocked(st, step, now, true);
+    } else if (recActive && (changed || now - lastRecMs >= RUNREC_INTERVAL_MS)) {
+        appendLocked(st, step, now, changed);
+    }
+    droppedNow = dropped - droppedNow;
+    state_unlock();
+    lastState = st;
+    lastStep = step;
+
+    if (droppedNow) log_msg(LOG_LEVEL_WARN, "Run recorder: queue full - block dropped");
+}
+
+// Poprzednie przebiegi ponad limit (i gdy brak miejsca) - od najstarszego
+static bool deleteOldestRun(int keep) {
+    char files[RUNREC_MAX_LIST][MAX_FILENAME_LEN];
+    int n = flash_list_files(RUNREC_DIR, files, RUNREC_MAX_LIST);
+    int runs = 0, oldest = -1;
+    uint32_t oldestNo = UINT32_MAX;
+    for (int i = 0; i < n; i++) {
+        uint32_t no;
+        if (!parseRunNo(files[i], no)) continue;
+        runs++;
+        if (no < oldestNo) { oldestNo = no; oldest = i; }
+    }
+    if (oldest < 0 || runs <= keep) return false;
+    return flash_file_delete(files[oldest]);
+}
+
+static void openRun(const RunFileHeader& hdr) {
+    snprintf(filePath, sizeof(filePath), RUNREC_DIR "r_%lu.bin", (unsigned long)hdr.runNo);
+    while (deleteOldestRun(RUNREC_KEEP_RUNS - 1)) {}
+    uint32_t size = (uint32_t)RUNREC_FILE_SECTORS * FLASH_SECTOR_SIZE;
+    bool ok = flash_file_reserve(filePath, size);
+    while (!ok && deleteOldestRun(0)) ok = flash_file_reserve(filePath, size);
+    if (!ok || !flash_file_write_at(filePath, 0, (const uint8_t*)&hdr, sizeof(hdr))) {
+        LOG_FMT(LOG_LEVEL_WARN, "Run recorder: cannot create %s - run not recorded", filePath);
+        return;
+    }
+    fileOpen = true;
+    fileFullLogged = false;
+    writeOffset = FLASH_PAGE_SIZE;
+    LOG_FMT(LOG_LEVEL_INFO, "Run recorder: %s started", filePath);
+}
+
+static void writeBlock(const RunBlock& b) {
+    if (!fileOpen) return;
+    if (writeOffset + sizeof(RunBlock) > (uint32_t)RUNREC_FILE_SECTORS * FLASH_SECTOR_SIZE) {
+        if (!fileFullLogged) {
+            LOG_FMT(LOG_LEVEL_WARN, "Run recorder: %s full - recording stopped", filePath);
+            fileFullLogged = true;
+        }
+        return;
+    }
+    if (flash_file_write_at(filePath, writeOffset, (const uint8_t*)&b, sizeof(b))) {
+        writeOffset += sizeof(RunBlock);
+    }
+}
+
+static void closeRun() {
+    if (!fileOpen) return;
+    fileOpen = false;
+    flash_file_truncate(filePath, writeOffset);
+    LOG_FMT(LOG_LEVEL_INFO, "Run recorder: %s closed (%lu blocks)", filePath,
+            (unsigned long)(writeOffset / FLASH_PAGE_SIZE - 1));
+}
+
+void runrec_flush() {
+    if (!recReady) return;
+    for (;;) {
+        RecQueueItem item;
+        if (!state_lock()) return;
+        bool have = qCount > 0;
+        if (have) {
+            item = queue[qHead];
+            qHead = (qHead + 1) % QUEUE_LEN;
+            qCount--;
+        }
+        state_unlock();
+        if (!have) return;
+
+        switch (item.cmd) {
+            case RecCmd::START:
+                closeRun();
+                openRun(item.hdr);
+                break;
+            case RecCmd::BLOCK:
+                writeBlock(item.block);
+                break;
+            case RecCmd::END:
+                closeRun();
+                break;
+        }
+    }
+}
+
+uint32_t runrec_file_length(const char* path) {
+    if (fileOpen && strcmp(path, filePath) == 0) return writeOffset;
+    return flash_file_get_size(path);
+}
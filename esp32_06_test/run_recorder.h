@@ -0,0 +1,112 @@
+// run_recorder.h - Binarny zapis przebiegu procesu do plików w regionie LOGS
+// [NEW] Po wędzeniu zostawały tylko średnie ProcessStats i tekst z logToFile() -
+//       nie dało się odtworzyć, co robił regulator. Rekord 32 B o stałym układzie:
+//       delta czasu, temperatury w setnych °C (int16), wyjście PID, wysterowanie
+//       grzałek, wentylator/dym, stan. Zapis co RUNREC_INTERVAL_MS i od razu przy
+//       zmianie stanu/kroku, do /logs/runs/r_<n>.bin:
+//         strona 0   - RunFileHeader (kanały czujników, tryb, profil)
+//         strona 1.. - RunBlock: nagłówek 32 B (seq, czas pierwszego rekordu, CRC32)
+//                      + 7 rekordów - jedna strona W25Q128 = jeden page program.
+//                      [NEW] W nagłówku bloku narastająca energia grzałek (energy.h).
+//       Plik rezerwowany w całości na starcie (flash_file_reserve), dopisywany bez
+//       zapisu FAT; rozmiar ustalany na końcu przebiegu. Po zaniku zasilania
+//       init przycina plik do ostatniego poprawnego bloku (ginie niepełna strona).
+//       Brak miejsca - najstarszy przebieg kasowany. GET /api/runs - lista i pobieranie,
+//       sim/wedzarnia_sim --replay - odtworzenie przez kod sterowania na hoście.
+//       Struktury i pomocnicze inline - czysty C++, bez Arduino (używane w symulatorze).
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+constexpr uint32_t RUNREC_INTERVAL_MS   = 10000;   // rekord okresowy
+constexpr uint16_t RUNREC_FILE_SECTORS  = 36;      // 575 bloków x 7 rekordów ~ 11 h co 10 s
+constexpr int      RUNREC_QUEUE         = 4;       // bloki czekające na taskMonitor
+constexpr int      RUNREC_CHANNELS      = 6;       // kanały czujników w rekordzie
+constexpr int      RUNREC_RECS_PER_BLOCK = 7;
+constexpr uint32_t RUNREC_FILE_MAGIC    = 0x4E555257UL;   // "WRUN"
+constexpr uint32_t RUNREC_BLOCK_MAGIC   = 0x4B4C4252UL;   // "RBLK"
+constexpr uint8_t  RUNREC_VERSION       = 1;
+constexpr int16_t  RUNREC_NO_TEMP       = INT16_MIN;      // NAN / brak odczytu
+#define RUNREC_DIR "/logs/runs/"
+
+// flags
+constexpr uint8_t RUNREC_F_FAN       = 0x01;
+constexpr uint8_t RUNREC_F_DOOR      = 0x02;
+constexpr uint8_t RUNREC_F_POWER_SH  = 2;      // bity 2-3: powerMode 1..3
+constexpr uint8_t RUNREC_F_SENSOR    = 0x10;   // g_errorSensor
+constexpr uint8_t RUNREC_F_EVENT     = 0x20;   // rekord ze zmiany stanu/kroku
+
+struct __attribute__((packed)) RunFileHeader {
+    uint32_t magic;
+    uint8_t  version;
+    uint8_t  recordSize;
+    uint8_t  channels;            // zapisane kanały (<= RUNREC_CHANNELS)
+    uint8_t  runMode;             // RunMode
+    uint32_t intervalMs;
+    uint32_t runNo;
+    uint8_t  chRole[RUNREC_CHANNELS];   // SensorRole kanałów, 0xFF = brak
+    uint8_t  reserved[2];
+    char     profile[40];
+};
+static_assert(sizeof(RunFileHeader) == 64, "run header must be 64 B");
+
+struct __attribute__((packed)) RunRecord {
+    uint16_t dt;                  // [100 ms] od poprzedniego rekordu
+    uint8_t  state;               // ProcessState
+    uint8_t  flags;               // RUNREC_F_*
+    int8_t   step;
+    uint8_t  smoke;               // PWM dymu 0..255
+    uint8_t  pid;                 // wyjście PID [0.5 %]
+    uint8_t  heater[3];           // grzałki fizyczne [0.5 %]
+    int16_t  tSet, tChamber, tEst, tMeat, tAmbient;   // [0.01 °C]
+    int16_t  ch[RUNREC_CHANNELS];                     // kanały czujników [0.01 °C]
+};
+static_assert(sizeof(RunRecord) == 32, "run record must be 32 B");
+
+struct __attribute__((packed)) RunBlock {
+    uint32_t  magic;
+    uint32_t  seq;                // numer bloku od 0
+    uint32_t  baseMs;             // czas pierwszego rekordu od startu przebiegu
+    uint8_t   count;              // rekordy w bloku (ostatni blok może być niepełny)
+    uint8_t   reserved[3];
+    uint32_t  energyJ;            // [NEW] energia grzałek w procesie przy ostatnim rekordzie [J],
+                                  //       0xFFFFFFFF = brak (zapisy sprzed energy.h)
+    uint8_t   reserved2[8];
+    uint32_t  crc;                // CRC32 rekordów
+    RunRecord rec[RUNREC_RECS_PER_BLOCK];
+};
+static_assert(sizeof(RunBlock) == 256, "run block must be one flash page");
+
+inline uint32_t runrec_crc32(const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t crc = 0xFFFFFFFFUL;
+    while (len--) {
+        crc ^= *p++;
+        for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+inline bool runrec_block_valid(const RunBlock& b) {
+    return b.magic == RUNREC_BLOCK_MAGIC && b.count >= 1 && b.count <= RUNREC_RECS_PER_BLOCK &&
+           b.crc == runrec_crc32(b.rec, b.count * sizeof(RunRecord));
+}
+
+inline int16_t runrec_centi(double t) {
+    if (isnan(t) || t < -300.0 || t > 320.0) return RUNREC_NO_TEMP;
+    return (int16_t)lround(t * 100.0);
+}
+
+inline double runrec_temp(int16_t v) {
+    return v == RUNREC_NO_TEMP ? NAN : v / 100.0;
+}
+
+// setup, po flash_init: numeracja przebiegów, przycięcie pliku przerwanego resetem
+void runrec_init();
+// taskControl, po process_run_control_logic(): rekordy do bloku w RAM
+void runrec_tick();
+// taskMonitor: tworzenie pliku, zapis pełnych bloków, zamknięcie przebiegu
+void runrec_flush();
+// Długość do pobrania - dla bieżącego przebiegu tylko zapisane bloki
+uint32_t runrec_file_length(const char* path);
@@ -0,0 +1,191 @@
+// sensor_filter.cpp - Łańcuch filtrów dla kanałów temperatury
+// [NEW] Czysty C++ (bez Arduino), żeby dało się go uruchomić na hoście
+#include "sensor_filter.h"
+#include <string.h>
+#include <math.h>
+
+// Domyślne parametry - odpowiadają dotychczasowemu zachowaniu:
+// NTC = sam EMA 0.91, DS18B20 = tylko odrzucanie skoków (bez dodatkowego opóźnienia)
+static constexpr float   DEF_SPIKE_MAX_STEP   = 5.0f;   // °C na próbkę (~1.2 s)
+static constexpr uint8_t DEF_SPIKE_MAX_REJECT = 3;
+static constexpr uint8_t DEF_MEDIAN_WINDOW    = 5;
+static constexpr float   DEF_EMA_ALPHA        = 0.91f;  // = NTC_FILTER_ALPHA
+static constexpr float   DEF_KALMAN_Q         = 0.01f;
+static constexpr float   DEF_KALMAN_R         = 0.25f;
+
+static const char* const FILTER_NAMES[] = {"none", "spike", "median", "ema", "kalman"};
+
+void filter_reset(FilterState& st) {
+    memset(&st, 0, sizeof(st));
+}
+
+// ======================================================
+// ETAPY
+// ======================================================
+
+static bool stage_spike(const FilterConfig& cfg, FilterState& st, float in) {
+    if (!st.spikeInit) {
+        st.spikeLast = in;
+        st.spikeInit = true;
+        st.spikeRejects = 0;
+        return true;
+    }
+    if (fabsf(in - st.spikeLast) > cfg.spikeMaxStep && st.spikeRejects < cfg.spikeMaxRejects) {
+        st.spikeRejects++;
+        return false;
+    }
+    // Po spikeMaxRejects odrzuceniach z rzędu przyjmujemy nowy poziom (prawdziwy skok)
+    st.spikeLast = in;
+    st.spikeRejects = 0;
+    return true;
+}
+
+static float stage_median(const FilterConfig& cfg, FilterState& st, float in) {
+    uint8_t n = cfg.medianWindow;
+    if (n < 1) n = 1;
+    if (n > FILTER_MEDIAN_MAX) n = FILTER_MEDIAN_MAX;
+
+    st.medianBuf[st.medianIdx] = in;
+    st.medianIdx = (st.medianIdx + 1) % n;
+    if (st.medianCount < n) st.medianCount++;
+
+    // Sortowanie przez wstawianie kopii - max 7 elementów
+    float sorted[FILTER_MEDIAN_MAX];
+    uint8_t cnt = st.medianCount;
+    for (uint8_t i = 0; i < cnt; i++) {
+        float v = st.medianBuf[i];
+        int j = i - 1;
+        while (j >= 0 && sorted[j] > v) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = v;
+    }
+    if (cnt & 1) return sorted[cnt / 2];
+    return 0.5f * (sorted[cnt / 2 - 1] + sorted[cnt / 2]);
+}
+
+static float stage_ema(const FilterConfig& cfg, FilterState& st, float in) {
+    if (!st.emaInit) {
+        st.ema = in;
+        st.emaInit = true;
+    } else {
+        st.ema = cfg.emaAlpha * st.ema + (1.0f - cfg.emaAlpha) * in;
+    }
+    return st.ema;
+}
+
+static float stage_kalman(const FilterConfig& cfg, FilterState& st, float in) {
+    if (!st.kalmanInit) {
+        st.kalmanX = in;
+        st.kalmanP = cfg.kalmanR;
+        st.kalmanInit = true;
+        return in;
+    }
+    st.kalmanP += cfg.kalmanQ;
+    float k = st.kalmanP / (st.kalmanP + cfg.kalmanR);
+    st.kalmanX += k * (in - st.kalmanX);
+    st.kalmanP *= (1.0f - k);
+    return st.kalmanX;
+}
+
+// ======================================================
+// API
+// ======================================================
+
+bool filter_apply(const FilterConfig& cfg, FilterState& st, float in, float& out) {
+    float v = in;
+    for (int i = 0; i < FILTER_MAX_STAGES; i++) {
+        switch ((FilterType)cfg.stages[i]) {
+            case FilterType::NONE:   i = FILTER_MAX_STAGES; break;
+            case FilterType::SPIKE:  if (!stage_spike(cfg, st, v)) return false; break;
+            case FilterType::MEDIAN: v = stage_median(cfg, st, v); break;
+            case FilterType::EMA:    v = stage_ema(cfg, st, v); break;
+            case FilterType::KALMAN: v = stage_kalman(cfg, st, v); break;
+        }
+    }
+    out = v;
+    return true;
+}
+
+bool filter_config_valid(const FilterConfig& cfg) {
+    for (int i = 0; i < FILTER_MAX_STAGES; i++) {
+        if (cfg.stages[i] > (uint8_t)FilterType::KALMAN) return false;
+    }
+    if (cfg.medianWindow < 1 || cfg.medianWindow > FILTER_MEDIAN_MAX) return false;
+    if (!(cfg.spikeMaxStep > 0.0f) || cfg.spikeMaxStep > 100.0f) return false;
+    if (!(cfg.emaAlpha >= 0.0f) || cfg.emaAlpha >= 1.0f) return false;
+    if (!(cfg.kalmanQ > 0.0f) || !(cfg.kalmanR > 0.0f)) return false;
+    return true;
+}
+
+static void filter_config_base(FilterConfig& cfg) {
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.medianWindow    = DEF_MEDIAN_WINDOW;
+    cfg.spikeMaxRejects = DEF_SPIKE_MAX_REJECT;
+    cfg.spikeMaxStep    = DEF_SPIKE_MAX_STEP;
+    cfg.emaAlpha        = DEF_EMA_ALPHA;
+    cfg.kalmanQ         = DEF_KALMAN_Q;
+    cfg.kalmanR         = DEF_KALMAN_R;
+}
+
+void filter_config_default_ds18b20(FilterConfig& cfg) {
+    filter_config_base(cfg);
+    cfg.stages[0] = (uint8_t)FilterType::SPIKE;
+}
+
+void filter_config_default_ntc(FilterConfig& cfg) {
+    filter_config_base(cfg);
+    cfg.stages[0] = (uint8_t)FilterType::EMA;
+}
+
+const char* filter_type_name(FilterType t) {
+    uint8_t i = (uint8_t)t;
+    if (i > (uint8_t)FilterType::KALMAN) return "?";
+    return FILTER_NAMES[i];
+}
+
+int filter_stages_to_string(const FilterConfig& cfg, char* buf, int bufSize) {
+    if (bufSize <= 0) return 0;
+    int len = 0;
+    buf[0] = '\0';
+    for (int i = 0; i < FILTER_MAX_STAGES; i++) {
+        if (cfg.stages[i] == (uint8_t)FilterType::NONE) break;
+        const char* name = filter_type_name((FilterType)cfg.stages[i]);
+        int n = (int)strlen(name) + (len > 0 ? 1 : 0);
+        if (len + n >= bufSize) break;
+        if (len > 0) buf[len++] = ',';
+        strcpy(buf + len, name);
+        len += (int)strlen(name);
+    }
+    return len;
+}
+
+bool filter_stages_from_string(FilterConfig& cfg, const char* str) {
+    uint8_t stages[FILTER_MAX_STAGES] = {0};
+    int count = 0;
+    const char* p = str;
+
+    while (p && *p) {
+        while (*p == ' ' || *p == ',') p++;
+        if (!*p) break;
+        const char* end = p;
+        while (*end && *end != ',') end++;
+        size_t len = end - p;
+        while (len > 0 && p[len - 1] == ' ') len--;
+
+        bool found = false;
+        for (uint8_t t = 1; t <= (uint8_t)FilterType::KALMAN; t++) {
+            if (strlen(FILTER_NAMES[t]) == len && strncmp(p, FILTER_NAMES[t], len) == 0) {
+                if (count >= FILTER_MAX_STAGES) return false;
+                stages[count++] = t;
+                found = true;
+                break;
+            }
+        }
+        if (!found && !(len == 4 && strncmp(p, "none", 4) == 0)) return false;
+        p = end;
+    }
+    memcpy(cfg.stages, stages, sizeof(stages));
+    return true;
+}
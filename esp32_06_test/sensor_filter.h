@@ -0,0 +1,58 @@
+// sensor_filter.h - Łańcuch filtrów dla kanałów temperatury
+// [NEW] Spike rejection, mediana z N próbek, EMA i 1-D Kalman.
+//       Stała pamięć: każdy kanał ma własny FilterConfig + FilterState,
+//       brak alokacji, brak zależności od Arduino (kompiluje się na hoście).
+#pragma once
+#include <stdint.h>
+
+constexpr int FILTER_MAX_STAGES = 4;
+constexpr int FILTER_MEDIAN_MAX = 7;
+
+enum class FilterType : uint8_t {
+    NONE   = 0,
+    SPIKE  = 1,   // odrzucenie skoków > spikeMaxStep względem ostatniej przyjętej próbki
+    MEDIAN = 2,   // mediana z medianWindow ostatnich próbek
+    EMA    = 3,   // out = emaAlpha * prev + (1 - emaAlpha) * in
+    KALMAN = 4    // model stałej wartości (random walk), szumy kalmanQ / kalmanR
+};
+
+// Konfiguracja łańcucha - zapisywana w NVS jako blob, więc układ jest stały
+struct FilterConfig {
+    uint8_t stages[FILTER_MAX_STAGES];   // FilterType w kolejności wykonania, NONE = koniec
+    uint8_t medianWindow;                // 1..FILTER_MEDIAN_MAX (1 = bez wygładzania)
+    uint8_t spikeMaxRejects;             // po tylu odrzuceniach z rzędu skok uznajemy za prawdziwy
+    uint8_t reserved[2];
+    float   spikeMaxStep;                // [°C] max zmiana między kolejnymi próbkami
+    float   emaAlpha;                    // waga poprzedniej wartości (jak NTC_FILTER_ALPHA)
+    float   kalmanQ;                     // szum procesu [°C^2 / próbkę]
+    float   kalmanR;                     // szum pomiaru [°C^2]
+};
+
+struct FilterState {
+    float   spikeLast;
+    uint8_t spikeRejects;
+    bool    spikeInit;
+    uint8_t medianCount;
+    uint8_t medianIdx;
+    float   medianBuf[FILTER_MEDIAN_MAX];
+    float   ema;
+    bool    emaInit;
+    bool    kalmanInit;
+    float   kalmanX;
+    float   kalmanP;
+};
+
+void filter_reset(FilterState& st);
+
+// Przepuszcza próbkę przez łańcuch. Zwraca false gdy próbka została odrzucona
+// (spike) - wtedy 'out' nie jest zmieniane i wołający powinien użyć ostatniej wartości.
+bool filter_apply(const FilterConfig& cfg, FilterState& st, float in, float& out);
+
+bool filter_config_valid(const FilterConfig& cfg);
+void filter_config_default_ds18b20(FilterConfig& cfg);
+void filter_config_default_ntc(FilterConfig& cfg);
+
+// Nazwy etapów dla API WWW: "spike,median,ema"
+const char* filter_type_name(FilterType t);
+int  filter_stages_to_string(const FilterConfig& cfg, char* buf, int bufSize);
+bool filter_stages_from_string(FilterConfig& cfg, const char* str);
@@ -1,38 +1,302 @@
-// sensors.cpp - [MOD] Oba DS18B20 = komora (średnia), NTC 100k na GPIO34 = mięso
+// sensors.cpp - [MOD] Tablica kanałów: dowolna liczba DS18B20 / NTC z rolą i filtrem
 #include "sensors.h"
 #include "config.h"
 #include "state.h"
 #include "outputs.h"
+#include "storage.h"
+#include "flash_storage.h"
+#include "ntc_scanner.h"
+#include "smoke_sched.h"
+#include "history.h"
 #include <nvs_flash.h>
 #include <nvs.h>
 #include <math.h>           // log()
 #include "ntc_lut.h"
 
-struct CachedReading {
-    double value;
-    unsigned long timestamp;
-    bool valid;
-    int readAttempts;
-};
-
 static unsigned long lastTempRequest = 0;
 static unsigned long lastTempReadPossible = 0;
-static CachedReading cachedChamber1 = {25.0, 0, false, 0};
-static CachedReading cachedChamber2 = {25.0, 0, false, 0};
-static CachedReading cachedMeatNtc   = {25.0, 0, false, 0};
 static int sensorErrorCount = 0;
 
-// Filtr EMA dla NTC (stan między wywołaniami)
-static float filteredNtcTemp   = 25.0f;
-static bool  ntcFilterInitialized = false;
+// ======================================================
+// [NEW] TABLICA KANAŁÓW
+// Kopia robocza należy do taskSensors. Zmiany z WWW trafiają do kopii
+// oczekującej i są podmieniane na początku cyklu odczytu.
+// ======================================================
+
+// Blob w NVS - wersja zmienia się razem z układem SensorChannel
+struct SensorTableBlob {
+    uint8_t version;
+    uint8_t count;
+    uint8_t reserved[2];
+    SensorChannel ch[MAX_SENSOR_CHANNELS];
+};
+// [MOD] v2: FilterConfig w SensorChannel (v1: osobne klucze "flt<n>" per slot)
+static constexpr uint8_t SENSOR_TABLE_VERSION = 2;
+
+// Układ v1 - tylko do migracji
+struct SensorChannelV1 {
+    uint8_t type, role, pin, reserved;
+    uint8_t rom[8];
+    char    name[SENSOR_NAME_LEN];
+    float   offset;
+};
+struct SensorTableBlobV1 {
+    uint8_t version;
+    uint8_t count;
+    uint8_t reserved[2];
+    SensorChannelV1 ch[MAX_SENSOR_CHANNELS];
+};
+
+static SensorChannel channels[MAX_SENSOR_CHANNELS];
+static int           channelCount = 0;
+static SensorChannel channelsPending[MAX_SENSOR_CHANNELS];
+static int           channelCountPending = 0;
+static bool          channelsDirty = false;
+
+// Stan łańcucha filtrów per slot (konfiguracja w channels[ch].filter)
+static FilterState  filterState[MAX_SENSOR_CHANNELS];
+static uint32_t     filterRejected[MAX_SENSOR_CHANNELS] = {0};
+// [FIX] Ostatni przyjęty surowy odczyt DS18B20 (przed offsetem, NAN = brak) -
+// dla isDsGlitch(), niezależnie od etapów łańcucha
+static float        dsLastRaw[MAX_SENSOR_CHANNELS];
+
+// Odczyty z bieżącego cyklu - publikowane jednym state_lock
+static SensorReading readings[MAX_SENSOR_CHANNELS];
+
+static const char* const ROLE_NAMES[] = {"chamber", "meat", "smoke", "ambient"};
+static const char* const TYPE_NAMES[] = {"none", "ds18b20", "ntc"};
+
+const char* sensors_role_name(uint8_t role) {
+    return role <= (uint8_t)SensorRole::AMBIENT ? ROLE_NAMES[role] : "?";
+}
+
+const char* sensors_type_name(uint8_t type) {
+    return type <= (uint8_t)SensorType::NTC ? TYPE_NAMES[type] : "?";
+}
+
+bool sensors_role_from_name(const char* name, uint8_t& role) {
+    for (uint8_t i = 0; i <= (uint8_t)SensorRole::AMBIENT; i++) {
+        if (strcmp(name, ROLE_NAMES[i]) == 0) { role = i; return true; }
+    }
+    return false;
+}
+
+void sensors_rom_to_str(const uint8_t* rom, char* out, size_t outSize) {
+    snprintf(out, outSize, "%02X%02X%02X%02X%02X%02X%02X%02X",
+             rom[0], rom[1], rom[2], rom[3], rom[4], rom[5], rom[6], rom[7]);
+}
+
+bool sensors_rom_from_str(const char* str, uint8_t* rom) {
+    if (strlen(str) != 16) return false;
+    for (int i = 0; i < 8; i++) {
+        char hex[3] = {str[i * 2], str[i * 2 + 1], '\0'};
+        char* end;
+        long v = strtol(hex, &end, 16);
+        if (*end != '\0') return false;
+        rom[i] = (uint8_t)v;
+    }
+    return true;
+}
+
+static void filterDefaultFor(const SensorChannel& c, FilterConfig& cfg) {
+    if (c.type == (uint8_t)SensorType::NTC) {
+        filter_config_default_ntc(cfg);
+        cfg.emaAlpha = NTC_FILTER_ALPHA;
+    } else {
+        filter_config_default_ds18b20(cfg);
+    }
+}
+
+static bool channelValid(const SensorChannel& c) {
+    if (c.role > (uint8_t)SensorRole::AMBIENT) return false;
+    if (c.type == (uint8_t)SensorType::DS18B20) return c.rom[0] == 0x28 || c.rom[0] == 0x10 || c.rom[0] == 0x22;
+    if (c.type == (uint8_t)SensorType::NTC)     return ntc_scanner_pin_ok(c.pin);
+    return false;
+}
+
+// Domyślny układ: wszystkie DS18B20 z magistrali = komora, NTC na PIN_NTC = mięso
+static int buildDefaultTable(SensorChannel* table) {
+    int count = 0;
+    int deviceCount = sensors.getDeviceCount();
 
-uint8_t sensorAddresses[2][8];
-bool sensorsIdentified = false;
-int chamberSensor1Index = DEFAULT_CHAMBER_SENSOR_1;
-int chamberSensor2Index = DEFAULT_CHAMBER_SENSOR_2;
+    for (int i = 0; i < deviceCount && count < MAX_SENSOR_CHANNELS - 1; i++) {
+        SensorChannel& c = table[count];
+        memset(&c, 0, sizeof(c));
+        if (!sensors.getAddress(c.rom, i)) continue;
+        c.type = (uint8_t)SensorType::DS18B20;
+        c.role = (uint8_t)SensorRole::CHAMBER;
+        snprintf(c.name, sizeof(c.name), "DS%d", i + 1);
+        filterDefaultFor(c, c.filter);
+
+        char addrStr[20];
+        sensors_rom_to_str(c.rom, addrStr, sizeof(addrStr));
+        LOG_FMT(LOG_LEVEL_INFO, "DS18B20 %d: %s (CHAMBER)", i, addrStr);
+        count++;
+    }
+
+    SensorChannel& ntc = table[count];
+    memset(&ntc, 0, sizeof(ntc));
+    ntc.type   = (uint8_t)SensorType::NTC;
+    ntc.role   = (uint8_t)SensorRole::MEAT;
+    ntc.pin    = PIN_NTC;
+    ntc.offset = NTC_TEMP_OFFSET;
+    strncpy(ntc.name, "NTC", sizeof(ntc.name) - 1);
+    filterDefaultFor(ntc, ntc.filter);
+    count++;
+
+    if (deviceCount == 0) log_msg(LOG_LEVEL_WARN, "No DS18B20 sensors found!");
+    return count;
+}
+
+static void saveTable(const SensorChannel* table, int count) {
+    SensorTableBlob blob;
+    memset(&blob, 0, sizeof(blob));
+    blob.version = SENSOR_TABLE_VERSION;
+    blob.count   = (uint8_t)count;
+    memcpy(blob.ch, table, sizeof(SensorChannel) * count);
+    storage_save_blob_nvs("sens_tab", &blob, sizeof(blob));
+}
+
+// Zleca podmianę tablicy (taskWeb/UI) - taskSensors podmieni na początku cyklu
+static bool queueTable(const SensorChannel* table, int count, bool persist) {
+    if (count < 0 || count > MAX_SENSOR_CHANNELS) return false;
+    if (!state_lock()) return false;
+    memcpy(channelsPending, table, sizeof(SensorChannel) * count);
+    channelCountPending = count;
+    channelsDirty = true;
+    state_unlock();
+
+    if (persist) saveTable(table, count);
+    return true;
+}
+
+static void startNtcScanner();
+
+static void publishChannelTable() {
+    memcpy(g_sensorChannels, channels, sizeof(SensorChannel) * channelCount);
+    g_sensorChannelCount = channelCount;
+}
+
+// Tablica v1 + filtry z kluczy "flt<n>" -> v2, zapis pod "sens_tab"
+static bool migrateTableV1(SensorTableBlob& blob) {
+    SensorTableBlobV1 old;
+    if (!storage_load_blob_nvs("sens_tab", &old, sizeof(old)) || old.version != 1 ||
+        old.count == 0 || old.count > MAX_SENSOR_CHANNELS) return false;
+
+    memset(&blob, 0, sizeof(blob));
+    blob.version = SENSOR_TABLE_VERSION;
+    blob.count   = old.count;
+    for (int i = 0; i < old.count; i++) {
+        SensorChannel& c = blob.ch[i];
+        const SensorChannelV1& o = old.ch[i];
+        c.type = o.type;
+        c.role = o.role;
+        c.pin  = o.pin;
+        memcpy(c.rom, o.rom, sizeof(c.rom));
+        memcpy(c.name, o.name, sizeof(c.name));
+        c.offset = o.offset;
+        char key[8];
+        snprintf(key, sizeof(key), "flt%d", i);
+        if (!storage_load_blob_nvs(key, &c.filter, sizeof(c.filter)) || !filter_config_valid(c.filter)) {
+            filterDefaultFor(c, c.filter);
+        }
+    }
+    storage_save_blob_nvs("sens_tab", &blob, sizeof(blob));
+    log_msg(LOG_LEVEL_INFO, "Sensor table migrated to v2 (filters per channel)");
+    return true;
+}
+
+void sensors_init_channels() {
+    SensorTableBlob blob;
+    bool loaded = (storage_load_blob_nvs("sens_tab", &blob, sizeof(blob)) &&
+                   blob.version == SENSOR_TABLE_VERSION) || migrateTableV1(blob);
+    loaded = loaded && blob.count > 0 && blob.count <= MAX_SENSOR_CHANNELS;
+    if (loaded) {
+        for (int i = 0; i < blob.count; i++) {
+            if (!channelValid(blob.ch[i])) { loaded = false; break; }
+        }
+    }
+
+    if (loaded) {
+        channelCount = blob.count;
+        memcpy(channels, blob.ch, sizeof(SensorChannel) * channelCount);
+        LOG_FMT(LOG_LEVEL_INFO, "Sensor table loaded from NVS: %d channel(s)", channelCount);
+    } else {
+        channelCount = buildDefaultTable(channels);
+        LOG_FMT(LOG_LEVEL_INFO, "Sensor table autodetected: %d channel(s)", channelCount);
+    }
+
+    for (int ch = 0; ch < channelCount; ch++) {
+        if (!filter_config_valid(channels[ch].filter)) filterDefaultFor(channels[ch], channels[ch].filter);
+        filter_reset(filterState[ch]);
+        dsLastRaw[ch] = NAN;
+        readings[ch] = {25.0f, 0.0f, 0.0f, 0, false};
+
+        char stages[48];
+        filter_stages_to_string(channels[ch].filter, stages, sizeof(stages));
+        LOG_FMT(LOG_LEVEL_INFO, "Ch%d %s/%s '%s' filter: %s", ch,
+                sensors_type_name(channels[ch].type), sensors_role_name(channels[ch].role),
+                channels[ch].name, stages[0] ? stages : "none");
+    }
+
+    if (state_lock()) {
+        publishChannelTable();
+        memcpy(g_sensorReadings, readings, sizeof(SensorReading) * channelCount);
+        state_unlock();
+    }
+
+    calibration_load();
+    startNtcScanner();
+}
+
+// Kopia tablicy, na której pracują zmiany z WWW - oczekująca, jeśli jest
+static int copyEditableTable(SensorChannel* table) {
+    if (!state_lock()) return -1;
+    int count = channelsDirty ? channelCountPending : g_sensorChannelCount;
+    memcpy(table, channelsDirty ? channelsPending : g_sensorChannels, sizeof(SensorChannel) * count);
+    state_unlock();
+    return count;
+}
+
+// [MOD] Filtr kanału zostaje, o ile w slocie jest nadal ten sam typ czujnika;
+// inny typ (lub nowy slot) - domyślny łańcuch dla typu
+bool sensors_set_channel(int ch, const SensorChannel& cfg) {
+    if (!channelValid(cfg)) return false;
+
+    SensorChannel table[MAX_SENSOR_CHANNELS];
+    int count = copyEditableTable(table);
+    if (count < 0) return false;
+
+    if (ch < 0 || ch > count || ch >= MAX_SENSOR_CHANNELS) return false;
+    SensorChannel c = cfg;
+    if (ch < count && table[ch].type == c.type) c.filter = table[ch].filter;
+    else filterDefaultFor(c, c.filter);
+    table[ch] = c;
+    if (ch == count) count++;
+    return queueTable(table, count, true);
+}
+
+bool sensors_remove_channel(int ch) {
+    SensorChannel table[MAX_SENSOR_CHANNELS];
+    int count = copyEditableTable(table);
+
+    if (ch < 0 || ch >= count || count <= 1) return false;
+    for (int i = ch; i < count - 1; i++) table[i] = table[i + 1];
+    return queueTable(table, count - 1, true);
+}
+
+bool autoDetectAndAssignSensors() {
+    SensorChannel table[MAX_SENSOR_CHANNELS];
+    int count = buildDefaultTable(table);
+    if (count <= 1) {
+        log_msg(LOG_LEVEL_ERROR, "Need at least 1 DS18B20 sensor");
+        return false;
+    }
+    return queueTable(table, count, true);
+}
 
 // ======================================================
-// ODCZYT TEMPERATURY Z NTC 100k (GPIO34)
+// ODCZYT TEMPERATURY Z NTC 100k
 // ======================================================
 
 // Funkcja obliczająca temperaturę z tabeli
@@ -54,24 +318,44 @@ double getTempFromLUT(double currentAdc) {
     return -999.0;
 }
 
-static double getTempFromCalibration(double adc);
+static double getTempFromCalibration(uint8_t pin, double adc);
+
+// [NEW] Strumień ADC dla wszystkich pinów NTC z tablicy kanałów
+static void startNtcScanner() {
+    uint8_t pins[MAX_NTC_CHANNELS];
+    int count = 0;
+    for (int ch = 0; ch < channelCount && count < MAX_NTC_CHANNELS; ch++) {
+        if (channels[ch].type != (uint8_t)SensorType::NTC) continue;
+        bool dup = false;
+        for (int i = 0; i < count; i++) dup |= (pins[i] == channels[ch].pin);
+        if (!dup) pins[count++] = channels[ch].pin;
+    }
+    if (count == 0) {
+        ntc_scanner_stop();
+        return;
+    }
+    ntc_scanner_begin(pins, count);
+}
 
-double readNtcTemperature() {
+// ADC ze skanera (średnia ramek od poprzedniego odczytu); bez skanera - pętla synchroniczna.
+// false = skaner nie ma nowych ramek pinu
+static bool readAdc(uint8_t pin, double& adcAvg) {
+    if (ntc_scanner_active()) return ntc_scanner_take(pin, adcAvg);
     uint32_t adcSum = 0;
     for (int i = 0; i < NTC_SAMPLES; i++) {
-        adcSum += analogRead(PIN_NTC);
+        adcSum += analogRead(pin);
         delayMicroseconds(140);
     }
-
-    double adcAvg = (double)adcSum / NTC_SAMPLES;
-
-    // [FIX] Zapisz ADC do zmiennych globalnych dla telemetrii Supabase
-if (state_lock()) {
-    g_ntcAdc = adcAvg;
-    g_ntcResistance = 0;
-    state_unlock();
+    adcAvg = (double)adcSum / NTC_SAMPLES;
+    return true;
 }
 
+// [MOD] Pin z kanału, surowa wartość (bez offsetu i filtra), ADC zwracany przez adcOut.
+double readNtcTemperature(uint8_t pin, double* adcOut) {
+    double adcAvg;
+    if (!readAdc(pin, adcAvg)) return -999.0;
+    if (adcOut) *adcOut = adcAvg;
+
     if (adcAvg < 20 || adcAvg > NTC_ADC_MAX - 20) {
         return -999.0;
     }
@@ -80,68 +364,127 @@ if (state_lock()) {
 //    double resistance = R_PULLUP / ((NTC_ADC_MAX / adcAvg) - 1.0);
 
     // --- NOWE OBLICZENIE TEMPERATURY Z LUT ---
-    double rawTemp = getTempFromCalibration(adcAvg);
-    // -----------------------------------------
-
+    return getTempFromCalibration(pin, adcAvg);
+}
 
+// ======================================================
+// [NEW] ŁAŃCUCH FILTRÓW PER KANAŁ
+// ======================================================
 
-    // FILTR EMA (bez zmian)
-    if (!ntcFilterInitialized) {
-        filteredNtcTemp = rawTemp;
-        ntcFilterInitialized = true;
-    } else {
-        filteredNtcTemp = NTC_FILTER_ALPHA * filteredNtcTemp + (1.0f - NTC_FILTER_ALPHA) * rawTemp;
-    }
+// Wywoływane z taskWeb - [MOD] filtr jest częścią kanału, więc zmiana idzie tą
+// samą podmianą tablicy co reszta (taskSensors) i zapisem bloba "sens_tab"
+bool sensors_filter_set(int ch, const FilterConfig& cfg, bool persist) {
+    if (ch < 0 || ch >= MAX_SENSOR_CHANNELS || !filter_config_valid(cfg)) return false;
 
-    return filteredNtcTemp + NTC_TEMP_OFFSET;
+    SensorChannel table[MAX_SENSOR_CHANNELS];
+    int count = copyEditableTable(table);
+    if (ch >= count) return false;
+    table[ch].filter = cfg;
+    return queueTable(table, count, persist);
 }
 
+bool sensors_filter_get(int ch, FilterConfig& cfg) {
+    if (ch < 0 || ch >= MAX_SENSOR_CHANNELS) return false;
+    if (!state_lock()) return false;
+    int count = channelsDirty ? channelCountPending : g_sensorChannelCount;
+    bool exists = ch < count;
+    if (exists) cfg = (channelsDirty ? channelsPending : g_sensorChannels)[ch].filter;
+    state_unlock();
+    return exists;
+}
 
+String sensors_filters_json() {
+    SensorChannel table[MAX_SENSOR_CHANNELS];
+    SensorReading rd[MAX_SENSOR_CHANNELS];
+    int count = sensors_copy_table(table, rd);
+
+    String json = "{\"channels\":[";
+    for (int ch = 0; ch < count; ch++) {
+        FilterConfig cfg;
+        if (!sensors_filter_get(ch, cfg)) continue;
+        char stages[48];
+        filter_stages_to_string(cfg, stages, sizeof(stages));
+        char buf[320];
+        snprintf(buf, sizeof(buf),
+            "%s{\"ch\":%d,\"name\":\"%s\",\"stages\":\"%s\",\"median\":%u,"
+            "\"spike_step\":%.2f,\"spike_rejects\":%u,\"ema_alpha\":%.3f,"
+            "\"kalman_q\":%.4f,\"kalman_r\":%.4f,\"raw\":%.2f,\"out\":%.2f,\"rejected\":%lu}",
+            ch > 0 ? "," : "", ch, table[ch].name, stages, cfg.medianWindow,
+            cfg.spikeMaxStep, cfg.spikeMaxRejects, cfg.emaAlpha,
+            cfg.kalmanQ, cfg.kalmanR, rd[ch].raw, rd[ch].value,
+            (unsigned long)filterRejected[ch]);
+        json += buf;
+    }
+    json += "]}";
+    return json;
+}
 
-// ======================================================
-// FUNKCJE DS18B20 – bez zmian (tylko drobne kosmetyki)
-// ======================================================
-
-void identifyAndAssignSensors() {
-    if (sensorsIdentified) return;
+// Ten sam czujnik w tej samej roli (historia slotu nadal ma sens)
+static bool sameSource(const SensorChannel& a, const SensorChannel& b) {
+    return a.type == b.type && a.role == b.role && a.pin == b.pin &&
+           memcmp(a.rom, b.rom, sizeof(a.rom)) == 0;
+}
 
-    int deviceCount = sensors.getDeviceCount();
-    LOG_FMT(LOG_LEVEL_INFO, "Identifying %d DS18B20 sensor(s) (both = chamber)...", deviceCount);
-
-    if (deviceCount >= 2) {
-        for (int i = 0; i < deviceCount && i < 2; i++) {
-            if (sensors.getAddress(sensorAddresses[i], i)) {
-                char addrStr[24];
-                snprintf(addrStr, sizeof(addrStr), "%02X%02X%02X%02X%02X%02X%02X%02X",
-                         sensorAddresses[i][0], sensorAddresses[i][1],
-                         sensorAddresses[i][2], sensorAddresses[i][3],
-                         sensorAddresses[i][4], sensorAddresses[i][5],
-                         sensorAddresses[i][6], sensorAddresses[i][7]);
-                LOG_FMT(LOG_LEVEL_INFO, "DS18B20 Sensor %d: %s (CHAMBER)", i, addrStr);
-            }
+// Podmiana tablicy (z filtrami) zleconej z WWW - tylko z taskSensors
+static void applyPendingConfig() {
+    if (!state_lock()) return;
+    bool tableChanged = channelsDirty;
+    bool sourcesChanged = false;
+    if (channelsDirty) {
+        int oldCount = channelCount;
+        SensorChannel old[MAX_SENSOR_CHANNELS];
+        memcpy(old, channels, sizeof(SensorChannel) * oldCount);
+        channelCount = channelCountPending;
+        memcpy(channels, channelsPending, sizeof(SensorChannel) * channelCount);
+        channelsDirty = false;
+        publishChannelTable();
+        // [MOD] Stan filtra i licznik odrzuceń należą do slotu - zerowane, gdy
+        // w slocie jest inny kanał albo zmienił się jego filtr
+        sourcesChanged = channelCount != oldCount;
+        for (int ch = 0; ch < channelCount; ch++) {
+            if (ch < oldCount && !sameSource(old[ch], channels[ch])) sourcesChanged = true;
+            if (ch < oldCount && memcmp(&old[ch], &channels[ch], sizeof(SensorChannel)) == 0) continue;
+            filter_reset(filterState[ch]);
+            filterRejected[ch] = 0;
+            dsLastRaw[ch] = NAN;
+            readings[ch] = {25.0f, 0.0f, 0.0f, 0, false};
         }
+        log_msg(LOG_LEVEL_INFO, "Sensor table updated");
+    }
+    state_unlock();
 
-        chamberSensor1Index = 0;
-        chamberSensor2Index = 1;
-        sensorsIdentified = true;
-
-        LOG_FMT(LOG_LEVEL_INFO, "Both DS18B20 assigned to CHAMBER (avg)");
-        LOG_FMT(LOG_LEVEL_INFO, "NTC 100k on GPIO%d assigned to MEAT", PIN_NTC);
+    if (tableChanged) {
+        calibration_load();
+        startNtcScanner();
+    }
+    // [FIX] Serie historii = sloty tablicy; sama zmiana filtra/nazwy ich nie rusza
+    if (sourcesChanged) history_set_channels(channelCount);
+}
 
-        buzzerBeep(3, 200, 100);
-    } else if (deviceCount == 1) {
-        log_msg(LOG_LEVEL_WARN, "Only 1 DS18B20 found - using single sensor for chamber");
-        chamberSensor1Index = 0;
-        chamberSensor2Index = -1;
-        sensorsIdentified = true;
-    } else {
-        log_msg(LOG_LEVEL_WARN, "No DS18B20 sensors found!");
-        sensorsIdentified = false;
+// Przepuszcza surową próbkę przez łańcuch kanału. false = próbka odrzucona.
+static bool filterSample(int ch, double raw, double& out) {
+    float v;
+    if (!filter_apply(channels[ch].filter, filterState[ch], (float)raw, v)) {
+        filterRejected[ch]++;
+        return false;
     }
+    out = v;
+    return true;
+}
+
+// DS18B20 zwraca 85.0 po resecie zasilania i 127.0 przy błędzie odczytu.
+// Obie wartości mogą być też prawdziwe - przyjmujemy je tylko gdy pasują do historii.
+// [FIX] Porównanie z ostatnim przyjętym surowym odczytem kanału (w spikeMaxStep
+// kanału). Wcześniej ze stanem etapu spike - bez niego w łańcuchu każde 85.0
+// odrzucane na stałe, a stan spike jest po offsecie.
+static bool isDsGlitch(int ch, double t) {
+    if (t != 85.0 && t != 127.0) return false;
+    float last = dsLastRaw[ch];
+    return isnan(last) || fabsf((float)t - last) > channels[ch].filter.spikeMaxStep;
 }
 
 // ======================================================
-// GŁÓWNE FUNKCJE CZUJNIKÓW – reszta bez dużych zmian
+// GŁÓWNE FUNKCJE CZUJNIKÓW
 // ======================================================
 
 void requestTemperature() {
@@ -157,145 +500,199 @@ void requestTemperature() {
     }
 }
 
+// [MOD] 85/127 obsługuje isDsGlitch() + etap spike łańcucha filtrów
 static bool isValidTemperature(double t) {
     return (t != DEVICE_DISCONNECTED_C &&
-            t != 85.0 &&
-            t != 127.0 &&
             t >= -20.0 &&
             t <= 200.0);
 }
 
-static double readTempWithTimeout(uint8_t sensorIndex) {
-    double temp = sensors.getTempCByIndex(sensorIndex);
+static double readDsWithRetry(const uint8_t* rom) {
+    double temp = sensors.getTempC(rom);
     if (temp == 85.0) {
         delay(10);
-        temp = sensors.getTempCByIndex(sensorIndex);
+        temp = sensors.getTempC(rom);
     }
     return temp;
 }
 
-void readTemperature() {
+// Odczyt jednego kanału do readings[ch]; true = świeża poprawna próbka
+static bool readChannel(int ch, unsigned long now) {
+    const SensorChannel& c = channels[ch];
+    SensorReading& r = readings[ch];
+    double t = -999.0;
+    bool ok = false;
+
+    if (c.type == (uint8_t)SensorType::DS18B20) {
+        t = readDsWithRetry(c.rom);
+        r.raw = (float)t;
+        ok = isValidTemperature(t) && !isDsGlitch(ch, t);
+        if (ok) {
+            dsLastRaw[ch] = (float)t;
+            t += c.offset;
+        }
+    } else if (c.type == (uint8_t)SensorType::NTC && c.role == (uint8_t)SensorRole::SMOKE) {
+        // [MOD] Kanał analogowy w roli dymu (np. MQ-135): wartość to gęstość [%]
+        double adc = 0;
+        if (readAdc(c.pin, adc)) {
+            r.adc = (float)adc;
+            t = smoke_density_from_adc(adc);
+        } else {
+            t = NAN;
+        }
+        if (!isnan(t)) t += c.offset;
+        r.raw = (float)t;
+        ok = !isnan(t);
+    } else if (c.type == (uint8_t)SensorType::NTC) {
+        double adc = 0;
+        t = readNtcTemperature(c.pin, &adc);
+        r.adc = (float)adc;
+        if (t > -999.0) t += c.offset;
+        r.raw = (float)t;
+        ok = (t > NTC_TEMP_MIN && t < NTC_TEMP_MAX);
+    }
+
+    if (ok) ok = filterSample(ch, t, t);
+    if (ok) {
+        r.value     = (float)t;
+        r.timestamp = now;
+    }
+    r.valid = ok;
+    return ok;
+}
+
+bool readTemperature() {
+    ntc_scanner_poll();
+
     unsigned long now = millis();
-    if (lastTempReadPossible == 0 || now < lastTempReadPossible) return;
+    if (lastTempReadPossible == 0 || now < lastTempReadPossible) return false;
     lastTempReadPossible = 0;
 
-    if (!sensorsIdentified) {
-        identifyAndAssignSensors();
-        if (!sensorsIdentified) {
-            log_msg(LOG_LEVEL_WARN, "Sensors not identified, using defaults");
-            chamberSensor1Index = DEFAULT_CHAMBER_SENSOR_1;
-            chamberSensor2Index = DEFAULT_CHAMBER_SENSOR_2;
+    applyPendingConfig();
+
+    // Odczyt wszystkich kanałów bez blokady - stan tylko w tym tasku
+    double chamberSum = 0, chamberCacheSum = 0;
+    double chamberLo = 1e9, chamberHi = -1e9;
+    int chamberValid = 0, chamberCached = 0, chamberTotal = 0;
+    double meatMin = 1e9;
+    bool meatValid = false;
+    double ambientSum = 0;
+    int ambientValid = 0;
+    double smokeSum = 0;
+    int smokeValid = 0;
+    double ntcAdc = -1;
+
+    for (int ch = 0; ch < channelCount; ch++) {
+        bool ok = readChannel(ch, now);
+        const SensorReading& r = readings[ch];
+
+        if (channels[ch].type == (uint8_t)SensorType::NTC &&
+            channels[ch].role != (uint8_t)SensorRole::SMOKE && ntcAdc < 0) ntcAdc = r.adc;
+
+        switch ((SensorRole)channels[ch].role) {
+            case SensorRole::CHAMBER:
+                chamberTotal++;
+                if (ok) {
+                    chamberSum += r.value; chamberValid++;
+                    if (r.value < chamberLo) chamberLo = r.value;
+                    if (r.value > chamberHi) chamberHi = r.value;
+                }
+                else if (r.timestamp != 0) {
+                    chamberCacheSum += r.value; chamberCached++;
+                    LOG_FMT(LOG_LEVEL_WARN, "Ch%d '%s' invalid (%.1f), using cached: %.1f",
+                            ch, channels[ch].name, r.raw, r.value);
+                }
+                break;
+            case SensorRole::MEAT:
+                // Kilka sond w mięsie - decyduje najzimniejsza
+                if (ok && r.value < meatMin) { meatMin = r.value; meatValid = true; }
+                else if (!ok && r.timestamp != 0) {
+                    LOG_FMT(LOG_LEVEL_WARN, "Ch%d '%s' invalid (%.1f), using cached: %.1f",
+                            ch, channels[ch].name, r.raw, r.value);
+                }
+                break;
+            case SensorRole::AMBIENT:
+                if (ok) { ambientSum += r.value; ambientValid++; }
+                break;
+            case SensorRole::SMOKE:
+                // [MOD] Gęstość dymu - średnia kanałów analogowych; DS18B20 w tej
+                // roli to temperatura dymu, do gęstości się nie liczy
+                if (ok && channels[ch].type == (uint8_t)SensorType::NTC) {
+                    smokeSum += r.value; smokeValid++;
+                }
+                break;
+            default:
+                break;
         }
     }
 
-    // Komora – DS18B20
-    double tChamber1 = readTempWithTimeout(chamberSensor1Index);
-    bool t1Valid = isValidTemperature(tChamber1);
-
-    double tChamber2 = -999.0;
-    bool t2Valid = false;
-    if (chamberSensor2Index >= 0) {
-        tChamber2 = readTempWithTimeout(chamberSensor2Index);
-        t2Valid = isValidTemperature(tChamber2);
-    }
-
-    double chamberAvg = 25.0;
-    if (t1Valid && t2Valid) {
-        chamberAvg = (tChamber1 + tChamber2) / 2.0;
-    } else if (t1Valid) {
-        chamberAvg = tChamber1;
-    } else if (t2Valid) {
-        chamberAvg = tChamber2;
-    }
-
-    // Obsługa błędów i cache komory
-    if (!t1Valid && !t2Valid) {
-        sensorErrorCount++;
-        if (sensorErrorCount >= SENSOR_ERROR_THRESHOLD) {
-            if (state_lock()) {
-                g_errorSensor = true;
-                if (g_currentState == ProcessState::RUNNING_AUTO ||
-                    g_currentState == ProcessState::RUNNING_MANUAL) {
-                    g_currentState = ProcessState::PAUSE_SENSOR;
-                    log_msg(LOG_LEVEL_ERROR, "Both chamber sensors error - pausing process");
-                }
-                state_unlock();
+    // Mięso bez świeżej próbki - ostatnie poprawne wartości sond
+    if (!meatValid) {
+        for (int ch = 0; ch < channelCount; ch++) {
+            if (channels[ch].role == (uint8_t)SensorRole::MEAT && readings[ch].timestamp != 0 &&
+                readings[ch].value < meatMin) {
+                meatMin = readings[ch].value;
+                meatValid = true;
             }
         }
-        // fallback na cache
-        if (cachedChamber1.valid || cachedChamber2.valid) {
-            if (state_lock()) {
-                if (cachedChamber1.valid && cachedChamber2.valid) {
-                    g_tChamber = (cachedChamber1.value + cachedChamber2.value) / 2.0;
-                } else if (cachedChamber1.valid) {
-                    g_tChamber = cachedChamber1.value;
-                } else {
-                    g_tChamber = cachedChamber2.value;
-                }
-                state_unlock();
+    }
+    // Dym bez nowych ramek skanera - ostatnie poprawne wartości
+    if (smokeValid == 0) {
+        for (int ch = 0; ch < channelCount; ch++) {
+            if (channels[ch].role == (uint8_t)SensorRole::SMOKE &&
+                channels[ch].type == (uint8_t)SensorType::NTC && readings[ch].timestamp != 0) {
+                smokeSum += readings[ch].value; smokeValid++;
             }
         }
-    } else {
-        sensorErrorCount = 0;
+    }
+    float smokeDensity = smokeValid > 0 ? (float)(smokeSum / smokeValid) : NAN;
 
-        if (t1Valid) {
-            cachedChamber1.value = tChamber1;
-            cachedChamber1.timestamp = now;
-            cachedChamber1.valid = true;
-            cachedChamber1.readAttempts = 0;
-        }
-        if (t2Valid) {
-            cachedChamber2.value = tChamber2;
-            cachedChamber2.timestamp = now;
-            cachedChamber2.valid = true;
-            cachedChamber2.readAttempts = 0;
-        }
+    bool chamberError = (chamberTotal > 0 && chamberValid == 0);
+    if (chamberError) sensorErrorCount++;
+    else sensorErrorCount = 0;
 
-        if (state_lock()) {
-            g_tChamber = chamberAvg;
-            g_tChamber1 = t1Valid ? tChamber1 : cachedChamber1.value;
-            g_tChamber2 = t2Valid ? tChamber2 : cachedChamber2.value;
+    // Publikacja całego cyklu - jedno state_lock
+    if (!state_lock()) return false;
 
-            if (g_errorSensor && g_currentState == ProcessState::PAUSE_SENSOR) {
-                g_errorSensor = false;
-                log_msg(LOG_LEVEL_INFO, "Chamber sensor recovered");
-            }
-            state_unlock();
-        }
+    memcpy(g_sensorReadings, readings, sizeof(SensorReading) * channelCount);
+    if (ntcAdc >= 0) {
+        g_ntcAdc = ntcAdc;
+        g_ntcResistance = 0;
     }
 
-    // Mięso – NTC
-    double tMeatNtc = readNtcTemperature();
-    bool meatValid = (tMeatNtc > NTC_TEMP_MIN && tMeatNtc < NTC_TEMP_MAX);
-
-    if (meatValid) {
-        cachedMeatNtc.value = tMeatNtc;
-        cachedMeatNtc.timestamp = now;
-        cachedMeatNtc.valid = true;
-        cachedMeatNtc.readAttempts = 0;
-
-        if (state_lock()) {
-            g_tMeat = tMeatNtc;
-            state_unlock();
+    if (chamberValid > 0) {
+        g_tChamber = chamberSum / chamberValid;
+        g_sensorSeq++;   // świeży pomiar - korekta obserwatora
+        if (g_errorSensor && g_currentState == ProcessState::PAUSE_SENSOR) {
+            g_errorSensor = false;
+            log_msg(LOG_LEVEL_INFO, "Chamber sensor recovered");
         }
-    } else if (cachedMeatNtc.valid) {
-        if (state_lock()) {
-            g_tMeat = cachedMeatNtc.value;
-            state_unlock();
+    } else if (chamberCached > 0) {
+        g_tChamber = chamberCacheSum / chamberCached;
+    }
+
+    if (chamberError && sensorErrorCount >= SENSOR_ERROR_THRESHOLD) {
+        g_errorSensor = true;
+        if (g_currentState == ProcessState::RUNNING_AUTO ||
+            g_currentState == ProcessState::RUNNING_MANUAL) {
+            g_currentState = ProcessState::PAUSE_SENSOR;
+            log_msg(LOG_LEVEL_ERROR, "All chamber sensors error - pausing process");
         }
-        LOG_FMT(LOG_LEVEL_WARN, "NTC invalid reading (%.1f), using cached: %.1f",
-                tMeatNtc, cachedMeatNtc.value);
     }
 
+    if (meatValid) g_tMeat = meatMin;
+    g_tAmbient = ambientValid > 0 ? ambientSum / ambientValid : NAN;
+    g_tChamberSpread = chamberValid >= 2 ? (float)(chamberHi - chamberLo) : NAN;
+    g_smokeDensity = smokeDensity;
+
     // Przegrzanie komory
-    if (state_lock()) {
-        if (g_tChamber > CFG_T_MAX_SOFT) {
-            g_errorOverheat = true;
-            g_currentState = ProcessState::PAUSE_OVERHEAT;
-            LOG_FMT(LOG_LEVEL_ERROR, "OVERHEAT detected: %.1f C (avg chamber)", g_tChamber);
-        }
-        state_unlock();
+    if (g_tChamber > CFG_T_MAX_SOFT) {
+        g_errorOverheat = true;
+        g_currentState = ProcessState::PAUSE_OVERHEAT;
+        LOG_FMT(LOG_LEVEL_ERROR, "OVERHEAT detected: %.1f C (avg chamber)", g_tChamber);
     }
+    state_unlock();
+    return chamberValid > 0;
 }
 
 // ────────────────────────────────────────────────
@@ -338,7 +735,12 @@ void checkDoor() {
 
 unsigned long getSensorCacheAge() {
     unsigned long now = millis();
-    return cachedChamber1.valid ? (now - cachedChamber1.timestamp) : 0xFFFFFFFF;
+    for (int ch = 0; ch < channelCount; ch++) {
+        if (channels[ch].role == (uint8_t)SensorRole::CHAMBER && readings[ch].timestamp != 0) {
+            return now - readings[ch].timestamp;
+        }
+    }
+    return 0xFFFFFFFF;
 }
 
 void forceSensorRead() {
@@ -346,59 +748,58 @@ void forceSensorRead() {
     lastTempReadPossible = 0;
 }
 
-String getSensorDiagnostics() {
-    char buffer[384];
-    snprintf(buffer, sizeof(buffer),
-        "Chamber1: %.1f C (sensor: %d, valid: %d)\n"
-        "Chamber2: %.1f C (sensor: %d, valid: %d)\n"
-        "Chamber Avg: %.1f C\n"
-        "Meat (NTC): %.1f C (GPIO%d, valid: %d)\n"
-        "Error count: %d, Identified: %s",
-        cachedChamber1.value, chamberSensor1Index, cachedChamber1.valid,
-        cachedChamber2.value, chamberSensor2Index, cachedChamber2.valid,
-        (cachedChamber1.value + cachedChamber2.value) / 2.0,
-        cachedMeatNtc.value, PIN_NTC, cachedMeatNtc.valid,
-        sensorErrorCount,
-        sensorsIdentified ? "YES" : "NO");
-    return String(buffer);
+int sensors_copy_table(SensorChannel* table, SensorReading* rd) {
+    int count = 0;
+    if (!state_lock()) return 0;
+    count = g_sensorChannelCount;
+    if (table) memcpy(table, g_sensorChannels, sizeof(SensorChannel) * count);
+    if (rd)    memcpy(rd, g_sensorReadings, sizeof(SensorReading) * count);
+    state_unlock();
+    return count;
 }
 
-String getSensorAssignmentInfo() {
-    char buffer[192];
-    snprintf(buffer, sizeof(buffer),
-        "Sensor Assignments:\n"
-        "  Chamber1: DS18B20 idx %d\n"
-        "  Chamber2: DS18B20 idx %d\n"
-        "  Meat: NTC 100k on GPIO%d\n"
-        "  Total DS18B20: %d\n"
-        "  Identified: %s",
-        chamberSensor1Index, chamberSensor2Index,
-        PIN_NTC, sensors.getDeviceCount(),
-        sensorsIdentified ? "YES" : "NO");
-    return String(buffer);
+String getSensorDiagnostics() {
+    SensorChannel table[MAX_SENSOR_CHANNELS];
+    SensorReading rd[MAX_SENSOR_CHANNELS];
+    int count = sensors_copy_table(table, rd);
+
+    String out;
+    char line[96];
+    for (int ch = 0; ch < count; ch++) {
+        snprintf(line, sizeof(line), "Ch%d %-8s %-7s: %.1f C (raw %.1f, valid: %d)\n",
+                 ch, table[ch].name, sensors_role_name(table[ch].role),
+                 rd[ch].value, rd[ch].raw, rd[ch].valid);
+        out += line;
+    }
+    snprintf(line, sizeof(line), "Error count: %d, Channels: %d", sensorErrorCount, count);
+    out += line;
+    return out;
 }
 
-bool autoDetectAndAssignSensors() {
-    int deviceCount = sensors.getDeviceCount();
-    if (deviceCount < 1) {
-        log_msg(LOG_LEVEL_ERROR, "Need at least 1 DS18B20 sensor");
-        return false;
+String getSensorAssignmentInfo() {
+    SensorChannel table[MAX_SENSOR_CHANNELS];
+    int count = sensors_copy_table(table, nullptr);
+
+    String out = "Sensor Assignments:\n";
+    char line[80];
+    for (int ch = 0; ch < count; ch++) {
+        char src[20];
+        if (table[ch].type == (uint8_t)SensorType::DS18B20) sensors_rom_to_str(table[ch].rom, src, sizeof(src));
+        else snprintf(src, sizeof(src), "GPIO%d", table[ch].pin);
+        snprintf(line, sizeof(line), "  Ch%d %s: %s %s\n", ch, sensors_role_name(table[ch].role),
+                 sensors_type_name(table[ch].type), src);
+        out += line;
     }
-
-    sensorsIdentified = false;
-    identifyAndAssignSensors();
-    return sensorsIdentified;
+    snprintf(line, sizeof(line), "  Total DS18B20 on bus: %d", sensors.getDeviceCount());
+    out += line;
+    return out;
 }
 
-int getChamberSensor1Index() { return chamberSensor1Index; }
-int getChamberSensor2Index() { return chamberSensor2Index; }
-int getTotalSensorCount()    { return sensors.getDeviceCount(); }
-bool areSensorsIdentified()  { return sensorsIdentified; }
-
+int getTotalSensorCount() { return sensors.getDeviceCount(); }
 
 // ======================================================
-// KALIBRACJA NTC - wielopunktowa LUT z flash
-// Plik: /profiles/ntc_cal.dat
+// KALIBRACJA NTC - wielopunktowa LUT z flash, osobna dla każdego pinu
+// Plik: /profiles/ntc_cal.dat (PIN_NTC), /profiles/ntc_cal_<pin>.dat (pozostałe)
 // Format CSV: temp;adc (jedna linia = jeden punkt)
 // Przykład: 20.0;2845
 // ======================================================
@@ -411,26 +812,71 @@ struct CalPoint {
     double adc;
 };
 
-static CalPoint calLUT[CAL_MAX_POINTS];
-static int      calCount   = 0;
-static bool     calActive  = false;
+struct CalTable {
+    uint8_t  pin;
+    int      count;
+    bool     active;
+    CalPoint pts[CAL_MAX_POINTS];
+};
 
-// Zaladuj kalibracje z flash - wywolaj przy starcie i po zapisie
-void calibration_load() {
-    calCount  = 0;
-    calActive = false;
+// [FIX] Tablice czytane z taskSensors, przeładowywane z taskWeb (zapis/odczyt
+// kalibracji). Nowa tablica budowana w kopii lokalnej (plik czytany bez locka),
+// podmiana i odczyt tylko pod calMux.
+static CalTable calTables[MAX_NTC_CHANNELS];
+static int      calTableCount = 0;
+static portMUX_TYPE calMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void calFilePath(uint8_t pin, char* out, size_t outSize) {
+    if (pin == PIN_NTC) snprintf(out, outSize, "%s", CAL_FILE);
+    else                snprintf(out, outSize, "/profiles/ntc_cal_%d.dat", pin);
+}
+
+// Tylko pod calMux
+static CalTable* calFind(uint8_t pin) {
+    for (int i = 0; i < calTableCount; i++) {
+        if (calTables[i].pin == pin) return &calTables[i];
+    }
+    return nullptr;
+}
+
+// Kopia tablicy pinu; false = brak aktywnej kalibracji
+static bool calGet(uint8_t pin, CalTable& out) {
+    portENTER_CRITICAL(&calMux);
+    const CalTable* t = calFind(pin);
+    bool ok = t && t->active && t->count >= 2;
+    if (ok) out = *t;
+    portEXIT_CRITICAL(&calMux);
+    return ok;
+}
+
+// Podmiana tablicy jednego pinu (dodanie, jeśli jest miejsce)
+static void calStore(const CalTable& src) {
+    portENTER_CRITICAL(&calMux);
+    CalTable* t = calFind(src.pin);
+    if (!t && calTableCount < MAX_NTC_CHANNELS) t = &calTables[calTableCount++];
+    if (t) *t = src;
+    portEXIT_CRITICAL(&calMux);
+}
 
-    if (!flash_is_ready() || !flash_file_exists(CAL_FILE)) {
-        log_msg(LOG_LEVEL_INFO, "NTC: brak pliku kalibracji, uzywana domyslna LUT");
+// Wczytanie pliku kalibracji pinu do 't' (kopia lokalna, bez locka)
+static void calParseFile(uint8_t pin, CalTable& t) {
+    t.pin    = pin;
+    t.count  = 0;
+    t.active = false;
+
+    char path[40];
+    calFilePath(pin, path, sizeof(path));
+    if (!flash_is_ready() || !flash_file_exists(path)) {
+        LOG_FMT(LOG_LEVEL_INFO, "NTC GPIO%d: brak pliku kalibracji, uzywana domyslna LUT", pin);
         return;
     }
 
-    String content = flash_file_read_string(CAL_FILE);
+    String content = flash_file_read_string(path);
     if (content.length() == 0) return;
 
     int pos = 0;
     int len = content.length();
-    while (pos < len && calCount < CAL_MAX_POINTS) {
+    while (pos < len && t.count < CAL_MAX_POINTS) {
         int eol = content.indexOf('\n', pos);
         if (eol < 0) eol = len;
 
@@ -447,56 +893,90 @@ void calibration_load() {
         double adc  = line.substring(sep + 1).toFloat();
 
         if (adc > 0 && temp > -50 && temp < 200) {
-            calLUT[calCount].temp = temp;
-            calLUT[calCount].adc  = adc;
-            calCount++;
+            t.pts[t.count].temp = temp;
+            t.pts[t.count].adc  = adc;
+            t.count++;
         }
     }
 
-    if (calCount >= 2) {
+    if (t.count >= 2) {
         // Posortuj malejaco po ADC (rosna temperatura)
-        for (int i = 0; i < calCount - 1; i++) {
-            for (int j = 0; j < calCount - i - 1; j++) {
-                if (calLUT[j].adc < calLUT[j+1].adc) {
-                    CalPoint tmp = calLUT[j];
-                    calLUT[j]    = calLUT[j+1];
-                    calLUT[j+1]  = tmp;
+        for (int i = 0; i < t.count - 1; i++) {
+            for (int j = 0; j < t.count - i - 1; j++) {
+                if (t.pts[j].adc < t.pts[j+1].adc) {
+                    CalPoint tmp = t.pts[j];
+                    t.pts[j]     = t.pts[j+1];
+                    t.pts[j+1]   = tmp;
                 }
             }
         }
-        calActive = true;
-        LOG_FMT(LOG_LEVEL_INFO, "NTC: kalibracja zaladowana (%d punktow)", calCount);
+        t.active = true;
+        LOG_FMT(LOG_LEVEL_INFO, "NTC GPIO%d: kalibracja zaladowana (%d punktow)", pin, t.count);
     } else {
-        calCount  = 0;
-        calActive = false;
-        log_msg(LOG_LEVEL_WARN, "NTC: za malo punktow kalibracji (min 2)");
+        t.count  = 0;
+        t.active = false;
+        LOG_FMT(LOG_LEVEL_WARN, "NTC GPIO%d: za malo punktow kalibracji (min 2)", pin);
     }
 }
 
-bool calibration_is_active() { return calActive; }
+static void calibration_load_pin(uint8_t pin) {
+    CalTable t;
+    calParseFile(pin, t);
+    calStore(t);
+}
 
-// Interpolacja z kalibrowanej LUT
-static double getTempFromCalibration(double adc) {
-    if (!calActive || calCount < 2) return getTempFromLUT(adc);
+// Zaladuj kalibracje wszystkich pinow NTC z tablicy kanalow (+ PIN_NTC).
+// Tylko z taskSensors (channels) - cały zestaw podmieniany naraz.
+void calibration_load() {
+    static CalTable fresh[MAX_NTC_CHANNELS];   // poza stosem taskSensors
+    int n = 0;
+    calParseFile(PIN_NTC, fresh[n++]);
+    for (int ch = 0; ch < channelCount && n < MAX_NTC_CHANNELS; ch++) {
+        if (channels[ch].type != (uint8_t)SensorType::NTC) continue;
+        if (channels[ch].role == (uint8_t)SensorRole::SMOKE) continue;   // gęstość, nie LUT
+        bool dup = false;
+        for (int i = 0; i < n; i++) dup |= (fresh[i].pin == channels[ch].pin);
+        if (!dup) calParseFile(channels[ch].pin, fresh[n++]);
+    }
+    portENTER_CRITICAL(&calMux);
+    memcpy(calTables, fresh, sizeof(CalTable) * n);
+    calTableCount = n;
+    portEXIT_CRITICAL(&calMux);
+}
+
+bool calibration_is_active(uint8_t pin) {
+    portENTER_CRITICAL(&calMux);
+    const CalTable* t = calFind(pin);
+    bool active = t && t->active;
+    portEXIT_CRITICAL(&calMux);
+    return active;
+}
+
+// Interpolacja z kalibrowanej LUT pinu, bez kalibracji - domyslna LUT
+static double getTempFromCalibration(uint8_t pin, double adc) {
+    static CalTable cal;   // tylko taskSensors
+    if (!calGet(pin, cal)) return getTempFromLUT(adc);
+    const CalPoint* p = cal.pts;
+    int n = cal.count;
 
     // Zakres
-    if (adc >= calLUT[0].adc)               return calLUT[0].temp;
-    if (adc <= calLUT[calCount-1].adc)       return calLUT[calCount-1].temp;
+    if (adc >= p[0].adc)   return p[0].temp;
+    if (adc <= p[n-1].adc) return p[n-1].temp;
 
     // Interpolacja liniowa
-    for (int i = 0; i < calCount - 1; i++) {
-        if (adc <= calLUT[i].adc && adc > calLUT[i+1].adc) {
-            double adcRange  = calLUT[i].adc  - calLUT[i+1].adc;
-            double tempRange = calLUT[i+1].temp - calLUT[i].temp;
-            double adcOffset = calLUT[i].adc  - adc;
-            return calLUT[i].temp + (adcOffset * tempRange / adcRange);
+    for (int i = 0; i < n - 1; i++) {
+        if (adc <= p[i].adc && adc > p[i+1].adc) {
+            double adcRange  = p[i].adc  - p[i+1].adc;
+            double tempRange = p[i+1].temp - p[i].temp;
+            double adcOffset = p[i].adc  - adc;
+            return p[i].temp + (adcOffset * tempRange / adcRange);
         }
     }
     return getTempFromLUT(adc);
 }
 
 // Zapisz kalibracje z JSON body {points:[{temp,adc},...]}
-bool calibration_save_from_json(const String& json) {
+bool calibration_save_from_json(uint8_t pin, const String& json) {
     // Prosty parser - szukaj par temp i adc
     String content = "# NTC kalibracja - format: temp;adc\n";
     int pos = 0;
@@ -535,38 +1015,49 @@ bool calibration_save_from_json(const String& json) {
         return false;
     }
 
-    bool ok = flash_file_write_string(CAL_FILE, content);
-    LOG_FMT(LOG_LEVEL_INFO, "NTC cal saved: %d points, ok=%d", savedCount, ok);
+    char path[40];
+    calFilePath(pin, path, sizeof(path));
+    bool ok = flash_file_write_string(path, content);
+    LOG_FMT(LOG_LEVEL_INFO, "NTC GPIO%d cal saved: %d points, ok=%d", pin, savedCount, ok);
+    if (ok) calibration_load_pin(pin);  // przeladuj natychmiast
     return ok;
 }
 
-// Zwroc aktualna kalibracje jako JSON
-String calibration_load_as_json() {
-    if (!calActive || calCount == 0) {
+// Zwroc aktualna kalibracje pinu jako JSON
+String calibration_load_as_json(uint8_t pin) {
+    if (!calibration_is_active(pin)) {
         // Sprobuj wczytac z pliku
-        calibration_load();
+        calibration_load_pin(pin);
     }
-    if (!calActive || calCount == 0) {
+    CalTable t;
+    if (!calGet(pin, t)) {
         return "{\"ok\":false,\"points\":[]}";
     }
     String json = "{\"ok\":true,\"points\":[";
-    for (int i = 0; i < calCount; i++) {
+    for (int i = 0; i < t.count; i++) {
         if (i > 0) json += ",";
         char buf[48];
         snprintf(buf, sizeof(buf), "{\"temp\":%.1f,\"adc\":%.0f}",
-                 calLUT[i].temp, calLUT[i].adc);
+                 t.pts[i].temp, t.pts[i].adc);
         json += buf;
     }
     json += "]}";
     return json;
 }
 
-// Usun plik kalibracji
-void calibration_clear() {
-    if (flash_is_ready() && flash_file_exists(CAL_FILE)) {
-        flash_file_delete(CAL_FILE);
+// Usun plik kalibracji pinu
+void calibration_clear(uint8_t pin) {
+    char path[40];
+    calFilePath(pin, path, sizeof(path));
+    if (flash_is_ready() && flash_file_exists(path)) {
+        flash_file_delete(path);
     }
-    calCount  = 0;
-    calActive = false;
-    log_msg(LOG_LEVEL_INFO, "NTC: kalibracja usunieta, uzywana domyslna LUT");
-}
\ No newline at end of file
+    portENTER_CRITICAL(&calMux);
+    CalTable* t = calFind(pin);
+    if (t) {
+        t->count  = 0;
+        t->active = false;
+    }
+    portEXIT_CRITICAL(&calMux);
+    LOG_FMT(LOG_LEVEL_INFO, "NTC GPIO%d: kalibracja usunieta, uzywana domyslna LUT", pin);
+}
@@ -1,40 +1,48 @@
 // sensors.h - Zmodernizowana wersja z NTC 100k
-// [MOD] Oba DS18B20 = komora, NTC 100k na GPIO34 = mięso
+// [MOD] Tablica kanałów (DS18B20 ROM / pin NTC + rola + filtr) zamiast
+//       stałego układu 2x DS18B20 komora + NTC mięso
 #pragma once
 #include <Arduino.h>
+#include "config.h"
+#include "sensor_filter.h"
 
 // Podstawowe funkcje
 void requestTemperature();
-void readTemperature();
+bool readTemperature();   // [MOD] true = opublikowano świeży pomiar komory (g_sensorSeq++)
 void checkDoor();
 
-// [NEW] Odczyt NTC 100k
-double readNtcTemperature();
+// [MOD] Odczyt NTC 100k z pinu kanału (surowy, bez offsetu i filtra)
+double readNtcTemperature(uint8_t pin, double* adcOut = nullptr);
 
-// Funkcje przypisywania czujników (teraz oba DS18B20 to komora)
-void identifyAndAssignSensors();
+// [NEW] Tablica kanałów - NVS "sens_tab", brak = autodetekcja
+void sensors_init_channels();
+bool sensors_set_channel(int ch, const SensorChannel& cfg);   // ch == liczba kanałów -> dodaj
+bool sensors_remove_channel(int ch);
 bool autoDetectAndAssignSensors();
+// Kopia tablicy i ostatnich odczytów (jedno state_lock). Zwraca liczbę kanałów.
+int  sensors_copy_table(SensorChannel* table, SensorReading* readings);
+
+const char* sensors_role_name(uint8_t role);
+const char* sensors_type_name(uint8_t type);
+bool sensors_role_from_name(const char* name, uint8_t& role);
+void sensors_rom_to_str(const uint8_t* rom, char* out, size_t outSize);
+bool sensors_rom_from_str(const char* str, uint8_t* rom);
+
+// [NEW] Filtry per kanał (konfiguracja w NVS "flt<ch>")
+bool sensors_filter_set(int ch, const FilterConfig& cfg, bool persist);
+bool sensors_filter_get(int ch, FilterConfig& cfg);
+String sensors_filters_json();
 
 // Funkcje diagnostyczne
 unsigned long getSensorCacheAge();
 void forceSensorRead();
 String getSensorDiagnostics();
 String getSensorAssignmentInfo();
-
-// Funkcje pomocnicze do web servera
-int getChamberSensor1Index();
-int getChamberSensor2Index();
 int getTotalSensorCount();
-bool areSensorsIdentified();
-
-// Zmienne globalne
-extern uint8_t sensorAddresses[2][8];
-extern int chamberSensor1Index;
-extern int chamberSensor2Index;
-extern bool sensorsIdentified;
 
+// [MOD] Kalibracja NTC osobno dla każdego pinu
 void calibration_load();
-bool calibration_is_active();
-bool calibration_save_from_json(const String& json);
-String calibration_load_as_json();
-void calibration_clear();
\ No newline at end of file
+bool calibration_is_active(uint8_t pin);
+bool calibration_save_from_json(uint8_t pin, const String& json);
+String calibration_load_as_json(uint8_t pin);
+void calibration_clear(uint8_t pin);
@@ -0,0 +1,188 @@
+// filter_replay.cpp - Zapisany przebieg surowych próbek przez łańcuchy sensor_filter
+// Dla każdej konfiguracji: szum przed/po filtrze i opóźnienie. Bez prawdy o
+// temperaturze odniesieniem jest wycentrowana mediana surowych próbek (nie ma
+// opóźnienia, odrzuca pojedyncze skoki):
+//   szum we  = RMS(surowe - odniesienie),
+//   opóźnienie = przesunięcie k, dla którego RMS(wyjście[i] - odniesienie[i-k]) najmniejsze,
+//   szum wy  = ten RMS (po wyrównaniu, więc rampa nie liczy się jako szum).
+#include "sensor_filter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static constexpr int REF_HALF_WINDOW = 5;    // mediana odniesienia z 2*5+1 próbek
+static constexpr int MAX_LAG_SAMPLES = 120;
+
+struct TraceSample {
+    double tSec;
+    float  raw;
+};
+
+// CSV: kolumna 0 - czas [s] (nagłówek "t_min" - minuty), kolumna 'col' - próbka.
+// col: numer albo nazwa z nagłówka. Puste / nan pomijane.
+static bool loadTrace(const char* path, const char* col, std::vector<TraceSample>& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Nie można otworzyć %s\n", path);
+        return false;
+    }
+    char line[512];
+    int colIdx = -1;
+    double timeScale = 1.0;
+    bool first = true;
+    char* endp;
+    long num = strtol(col, &endp, 10);
+    if (*endp == '\0') colIdx = (int)num;
+
+    while (fgets(line, sizeof(line), f)) {
+        std::vector<std::string> cells;
+        for (char* tok = strtok(line, ",;\t\r\n"); tok; tok = strtok(nullptr, ",;\t\r\n")) {
+            cells.push_back(tok);
+        }
+        if (cells.empty() || cells[0][0] == '#') continue;
+        char* e;
+        strtod(cells[0].c_str(), &e);
+        if (first && *e != '\0') {   // nagłówek
+            first = false;
+            if (cells[0] == "t_min") timeScale = 60.0;
+            if (colIdx < 0) {
+                for (size_t i = 0; i < cells.size(); i++) {
+                    if (cells[i] == col) colIdx = (int)i;
+                }
+            }
+            continue;
+        }
+        first = false;
+        if (colIdx <= 0 || colIdx >= (int)cells.size()) continue;
+        double t = atof(cells[0].c_str()) * timeScale;
+        double v = strtod(cells[colIdx].c_str(), &e);
+        if (e == cells[colIdx].c_str() || isnan(v)) continue;
+        out.push_back({t, (float)v});
+    }
+    fclose(f);
+    if (colIdx <= 0) {
+        fprintf(stderr, "%s: brak kolumny '%s'\n", path, col);
+        return false;
+    }
+    if (out.size() < 4 * (REF_HALF_WINDOW + MAX_LAG_SAMPLES)) {
+        fprintf(stderr, "%s: za mało próbek (%zu)\n", path, out.size());
+        return false;
+    }
+    return true;
+}
+
+static void reference(const std::vector<TraceSample>& tr, std::vector<float>& ref) {
+    ref.resize(tr.size());
+    float win[2 * REF_HALF_WINDOW + 1];
+    for (size_t i = 0; i < tr.size(); i++) {
+        size_t lo = i >= REF_HALF_WINDOW ? i - REF_HALF_WINDOW : 0;
+        size_t hi = std::min(tr.size() - 1, i + REF_HALF_WINDOW);
+        int n = 0;
+        for (size_t j = lo; j <= hi; j++) win[n++] = tr[j].raw;
+        std::nth_element(win, win + n / 2, win + n);
+        ref[i] = win[n / 2];
+    }
+}
+
+struct FilterResult {
+    double noiseIn, noiseOut, lagSec;
+    unsigned rejected;
+};
+
+static FilterResult evaluate(const FilterConfig& cfg, const std::vector<TraceSample>& tr,
+                             const std::vector<float>& ref, double dtSec) {
+    FilterResult res = {};
+    FilterState st;
+    filter_reset(st);
+    std::vector<float> out(tr.size());
+    float last = tr[0].raw;
+    for (size_t i = 0; i < tr.size(); i++) {
+        float v;
+        if (filter_apply(cfg, st, tr[i].raw, v)) last = v;
+        else res.rejected++;
+        out[i] = last;   // jak sensors.cpp: odrzucona próbka - ostatnia wartość
+    }
+
+    // Początek (rozbieg filtra) i koniec (odniesienie z niepełnego okna) pominięte
+    size_t from = REF_HALF_WINDOW + MAX_LAG_SAMPLES, to = tr.size() - REF_HALF_WINDOW;
+    double sIn = 0;
+    for (size_t i = from; i < to; i++) sIn += (tr[i].raw - ref[i]) * (tr[i].raw - ref[i]);
+    res.noiseIn = sqrt(sIn / (to - from));
+
+    double best = INFINITY;
+    int bestK = 0;
+    for (int k = 0; k <= MAX_LAG_SAMPLES; k++) {
+        double s = 0;
+        for (size_t i = from; i < to; i++) s += (out[i] - ref[i - k]) * (out[i] - ref[i - k]);
+        if (s < best) {
+            best = s;
+            bestK = k;
+        }
+    }
+    res.noiseOut = sqrt(best / (to - from));
+    res.lagSec = bestK * dtSec;
+    return res;
+}
+
+int runFilterReplay(const char* path, const char* col, const char* stages) {
+    std::vector<TraceSample> tr;
+    if (!loadTrace(path, col, tr)) return 1;
+    std::vector<double> dts;
+    for (size_t i = 1; i < tr.size(); i++) dts.push_back(tr[i].tSec - tr[i - 1].tSec);
+    std::nth_element(dts.begin(), dts.begin() + dts.size() / 2, dts.end());
+    double dtSec = dts[dts.size() / 2];
+    std::vector<float> ref;
+    reference(tr, ref);
+
+    // Domyślne konfiguracje kanałów i etapy z parametrami domyślnymi
+    struct Candidate { std::string name; FilterConfig cfg; };
+    std::vector<Candidate> cands;
+    FilterConfig c;
+    if (stages) {
+        filter_config_default_ntc(c);
+        if (!filter_stages_from_string(c, stages)) {
+            fprintf(stderr, "Nieznane etapy filtra: %s\n", stages);
+            return 1;
+        }
+        cands.push_back({stages, c});
+    } else {
+        filter_config_default_ds18b20(c);
+        cands.push_back({"ds18b20 (spike)", c});
+        filter_config_default_ntc(c);
+        cands.push_back({"ntc (ema)", c});
+        static const char* const SETS[] = {
+            "median", "kalman", "spike,median", "spike,kalman", "spike,median,ema",
+            "spike,median,kalman",
+        };
+        for (const char* s : SETS) {
+            filter_config_default_ntc(c);
+            filter_stages_from_string(c, s);
+            cands.push_back({s, c});
+        }
+    }
+
+    printf("%s: %zu próbek co %.2f s, %.1f min\n", path, tr.size(), dtSec,
+           (tr.back().tSec - tr.front().tSec) / 60.0);
+    printf("\n%-22s %9s %9s %9s %9s %9s\n", "filtr", "szum we", "szum wy", "redukcja",
+           "opóźn.[s]", "odrzuc.");
+    std::vector<FilterResult> results;
+    for (const Candidate& cd : cands) {
+        FilterResult r = evaluate(cd.cfg, tr, ref, dtSec);
+        results.push_back(r);
+        printf("%-22s %9.3f %9.3f %8.1fx %9.1f %9u\n", cd.name.c_str(), r.noiseIn, r.noiseOut,
+               r.noiseOut > 0 ? r.noiseIn / r.noiseOut : 0.0, r.lagSec, r.rejected);
+    }
+    printf("\n");
+    for (size_t i = 0; i < cands.size(); i++) {
+        std::string key = cands[i].name.substr(0, cands[i].name.find(' '));
+        std::replace(key.begin(), key.end(), ',', '+');
+        const FilterResult& r = results[i];
+        printf("filter.%s.reduction=%.2f\n", key.c_str(), r.noiseOut > 0 ? r.noiseIn / r.noiseOut : 0.0);
+        printf("filter.%s.lag_s=%.1f\n", key.c_str(), r.lagSec);
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+// plant.cpp - Model cieplny wędzarni + piny widziane przez firmware
+#include "plant.h"
+#include <Arduino.h>
+#include "config.h"
+
+// Stan pinów po stronie firmware (ledcWrite / digitalWrite / digitalRead)
+static uint32_t ledcDuty[40];
+static uint8_t  pinLevel[40];
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin < 40) pinLevel[pin] = val;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < 40 ? pinLevel[pin] : LOW;
+}
+
+bool ledcWrite(uint8_t pin, uint32_t duty) {
+    if (pin >= 40) return false;
+    ledcDuty[pin] = duty > 255 ? 255 : duty;
+    return true;
+}
+
+void plant_read_outputs(PlantInputs& in) {
+    in.heaterDuty[0] = pinLevel[PIN_SSR1] == HIGH ? 1.0f : 0.0f;
+    in.heaterDuty[1] = pinLevel[PIN_SSR2] == HIGH ? 1.0f : 0.0f;
+    in.heaterDuty[2] = pinLevel[PIN_SSR3] == HIGH ? 1.0f : 0.0f;
+    in.fanOn         = pinLevel[PIN_FAN] == HIGH;
+    in.smokeDuty     = ledcDuty[PIN_SMOKE_FAN] / 255.0f;
+    in.doorOpen      = pinLevel[PIN_DOOR] == HIGH;
+}
+
+// Krańcówka drzwi: HIGH = otwarte (jak w checkDoor())
+void plant_set_door(bool open) {
+    pinLevel[PIN_DOOR] = open ? HIGH : LOW;
+}
+
+void plant_init(const PlantParams& p, PlantState& s) {
+    s.tAir = s.tWall = s.tMeat = p.ambient;
+    s.tProbe = s.tMeatProbe = p.ambient;
+    s.energyJ = 0;
+}
+
+void plant_step(const PlantParams& p, PlantState& s, const PlantInputs& in, double dt) {
+    double qHeat = 0;
+    for (int i = 0; i < 3; i++) qHeat += in.heaterDuty[i] * p.heaterW;
+
+    double conv   = in.fanOn ? p.fanBoost : 1.0;
+    double qWall  = p.uaAirWall * conv * (s.tAir - s.tWall);
+    double qMeat  = p.uaAirMeat * conv * (s.tAir - s.tMeat);
+    double qLoss  = p.uaWallAmb * (s.tWall - p.ambient);
+    double uaVent = in.smokeDuty * p.smokeFlowMax + (in.doorOpen ? p.doorOpenUA : 0.0);
+    double qVent  = uaVent * (s.tAir - p.ambient);
+
+    s.tAir  += dt * (qHeat - qWall - qMeat - qVent) / p.cAir;
+    s.tWall += dt * (qWall - qLoss) / p.cWall;
+    s.tMeat += dt * qMeat / p.cMeat;
+
+    s.tProbe     += (s.tAir - s.tProbe) * dt / (p.tauProbe + dt);
+    s.tMeatProbe += (s.tMeat - s.tMeatProbe) * dt / (p.tauMeatProbe + dt);
+    s.energyJ    += qHeat * dt;
+}
@@ -0,0 +1,44 @@
+// plant.h - Model cieplny wędzarni dla symulatora
+// Węzły: powietrze komory, ściany, rdzeń mięsa; czujnik komory jako inercja
+// I rzędu na temperaturze powietrza. Wejścia: 3 grzałki (wypełnienie SSR z
+// ledcWrite), wentylator obiegowy (zwiększa konwekcję), wentylator dymu
+// (wymiana powietrza ze świeżym), otwarte drzwi (duża wymiana powietrza).
+#pragma once
+#include <stdint.h>
+
+struct PlantParams {
+    float heaterW       = 1500.0f;   // [W] moc jednej grzałki
+    float ambient       = 20.0f;     // [°C]
+    float cAir          = 20000.0f;  // [J/K] powietrze + ruszty + grzałki
+    float cWall         = 60000.0f;  // [J/K] ściany komory
+    float cMeat         = 10500.0f;  // [J/K] wsad (ok. 3 kg)
+    float uaAirWall     = 35.0f;     // [W/K] powietrze-ściany, wentylator wyłączony
+    float uaWallAmb     = 6.0f;      // [W/K] ściany-otoczenie (izolacja)
+    float uaAirMeat     = 1.2f;      // [W/K] powietrze-rdzeń mięsa, wentylator wyłączony
+    float fanBoost      = 1.8f;      // mnożnik konwekcji przy pracującym wentylatorze
+    float smokeFlowMax  = 4.0f;      // [W/K] wymiana powietrza przy smokePwm = 255
+    float doorOpenUA    = 60.0f;     // [W/K] wymiana powietrza przy otwartych drzwiach
+    float tauProbe      = 45.0f;     // [s] inercja czujnika komory
+    float tauMeatProbe  = 20.0f;     // [s] inercja sondy mięsa
+};
+
+struct PlantState {
+    double tAir, tWall, tMeat;
+    double tProbe, tMeatProbe;
+    double energyJ;                  // energia pobrana przez grzałki
+};
+
+struct PlantInputs {
+    float heaterDuty[3];             // 0..1 (SSR: 0 lub 1 w danym półokresie)
+    bool  fanOn;
+    float smokeDuty;                 // 0..1
+    bool  doorOpen;
+};
+
+void plant_init(const PlantParams& p, PlantState& s);
+void plant_step(const PlantParams& p, PlantState& s, const PlantInputs& in, double dt);
+
+// Stan pinów zapisany przez firmware (ledcWrite/digitalWrite) -> wejścia modelu.
+// SSR z przejściem przez zero: wyjście wysokie na początku półokresu = półokres przewodzi.
+void plant_read_outputs(PlantInputs& in);
+void plant_set_door(bool open);
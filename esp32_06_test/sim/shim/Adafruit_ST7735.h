@@ -0,0 +1,8 @@
+// Adafruit_ST7735.h - zamiennik dla symulatora (tylko konstruktor z state.cpp)
+#pragma once
+#include <Arduino.h>
+
+class Adafruit_ST7735 {
+public:
+    Adafruit_ST7735(int8_t, int8_t, int8_t) {}
+};
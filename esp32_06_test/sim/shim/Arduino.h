@@ -0,0 +1,89 @@
+// Arduino.h - minimalny zamiennik rdzenia ESP32 Arduino dla symulatora (sim/)
+// Tylko to, czego używają process.cpp, outputs.cpp, state.cpp i profile_parser.cpp.
+// Czas (millis) i piny obsługuje sim_main.cpp / plant.cpp.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+using std::min;
+using std::max;
+
+#define HIGH 1
+#define LOW  0
+#define INPUT        0
+#define OUTPUT       1
+#define INPUT_PULLUP 2
+#define IRAM_ATTR
+#define PROGMEM
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+enum adc_attenuation_t { ADC_0db, ADC_2_5db, ADC_6db, ADC_11db };
+
+// --- Czas symulowany ---
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+// --- Piny: zapis trafia do modelu obiektu (plant.cpp) ---
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int  digitalRead(uint8_t pin);
+bool ledcWrite(uint8_t pin, uint32_t duty);
+
+// --- String: cienka nakładka na std::string ---
+class String {
+public:
+    String() {}
+    String(const char* c) : s(c ? c : "") {}
+    String(const std::string& x) : s(x) {}
+    String(int v) : s(std::to_string(v)) {}
+    String(unsigned long v) : s(std::to_string(v)) {}
+    String(double v, int d = 2) { char b[48]; snprintf(b, sizeof(b), "%.*f", d, v); s = b; }
+
+    const char* c_str() const { return s.c_str(); }
+    unsigned length() const { return (unsigned)s.size(); }
+    bool reserve(unsigned n) { s.reserve(n); return true; }
+
+    String& operator+=(const String& o) { s += o.s; return *this; }
+    String& operator+=(const char* o) { s += o; return *this; }
+    String& operator+=(char c) { s += c; return *this; }
+    friend String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+    friend String operator+(const String& a, const char* b) { return String(a.s + b); }
+    friend String operator+(const char* a, const String& b) { return String(std::string(a) + b.s); }
+    bool operator==(const char* o) const { return s == o; }
+
+private:
+    std::string s;
+};
+
+// --- Serial: logi na stderr, wyciszalne (--verbose w sim_main) ---
+class HardwareSerial {
+public:
+    bool enabled = false;
+    void begin(unsigned long) {}
+    int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        if (!enabled) return 0;
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vfprintf(stderr, fmt, ap);
+        va_end(ap);
+        return n;
+    }
+    void println(const char* s) { if (enabled) fprintf(stderr, "%s\n", s); }
+};
+extern HardwareSerial Serial;
@@ -0,0 +1,8 @@
+// DallasTemperature.h - zamiennik dla symulatora (temperatury podaje plant.cpp)
+#pragma once
+#include <OneWire.h>
+
+class DallasTemperature {
+public:
+    explicit DallasTemperature(OneWire*) {}
+};
@@ -0,0 +1,8 @@
+// OneWire.h - zamiennik dla symulatora (tylko konstruktor z state.cpp)
+#pragma once
+#include <Arduino.h>
+
+class OneWire {
+public:
+    explicit OneWire(uint8_t) {}
+};
@@ -0,0 +1,51 @@
+// PID_v1.h - odtworzenie Arduino PID Library v1.2.x (Brett Beauregard) dla symulatora
+// Zachowanie 1:1 z biblioteką używaną na ESP32: ten sam Compute(), Initialize()
+// przy MANUAL -> AUTOMATIC i przeliczanie ki/kd przy zmianie SampleTime.
+#pragma once
+
+#define AUTOMATIC 1
+#define MANUAL    0
+#define DIRECT    0
+#define REVERSE   1
+#define P_ON_M    0
+#define P_ON_E    1
+
+class PID {
+public:
+    PID(double* input, double* output, double* setpoint,
+        double Kp, double Ki, double Kd, int POn, int ControllerDirection);
+    PID(double* input, double* output, double* setpoint,
+        double Kp, double Ki, double Kd, int ControllerDirection);
+
+    void SetMode(int Mode);
+    bool Compute();
+    void SetOutputLimits(double Min, double Max);
+    void SetTunings(double Kp, double Ki, double Kd);
+    void SetTunings(double Kp, double Ki, double Kd, int POn);
+    void SetControllerDirection(int Direction);
+    void SetSampleTime(int NewSampleTime);
+
+    double GetKp() { return dispKp; }
+    double GetKi() { return dispKi; }
+    double GetKd() { return dispKd; }
+    int GetMode() { return inAuto ? AUTOMATIC : MANUAL; }
+    int GetDirection() { return controllerDirection; }
+
+private:
+    void Initialize();
+
+    double dispKp, dispKi, dispKd;
+    double kp, ki, kd;
+    int controllerDirection;
+    int pOn;
+
+    double* myInput;
+    double* myOutput;
+    double* mySetpoint;
+
+    unsigned long lastTime;
+    double outputSum, lastInput;
+    unsigned long SampleTime;
+    double outMin, outMax;
+    bool inAuto, pOnE;
+};
@@ -0,0 +1,8 @@
+// WebServer.h - zamiennik dla symulatora (tylko konstruktor z state.cpp)
+#pragma once
+#include <Arduino.h>
+
+class WebServer {
+public:
+    explicit WebServer(int) {}
+};
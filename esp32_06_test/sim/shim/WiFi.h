@@ -0,0 +1,3 @@
+// WiFi.h - pusty zamiennik dla symulatora (config.h go dołącza)
+#pragma once
+#include <Arduino.h>
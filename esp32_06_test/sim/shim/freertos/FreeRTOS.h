@@ -0,0 +1,21 @@
+// FreeRTOS.h - zamiennik dla symulatora: jeden wątek, mutexy zawsze wolne
+#pragma once
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef void*    SemaphoreHandle_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdMS_TO_TICKS(x) ((TickType_t)(x))
+#define portMAX_DELAY    0xffffffffu
+
+// Sekcje krytyczne (ssr_driver) - bez współbieżności w symulacji
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux)  ((void)(mux))
+
+// Oddanie CPU (state_snapshot_read) - nigdy nie wołane przy jednym wątku
+inline void vTaskDelay(TickType_t) {}
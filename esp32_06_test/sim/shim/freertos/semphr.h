@@ -0,0 +1,10 @@
+// semphr.h - zamiennik dla symulatora: symulacja jest jednowątkowa
+#pragma once
+#include "FreeRTOS.h"
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+    static int dummy;
+    return &dummy;
+}
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
@@ -0,0 +1,989 @@
+// sim_main.cpp - Symulator wędzarni szybszy niż czas rzeczywisty
+// Kod sterowania (process.cpp, outputs.cpp, parser profili) w wersji z firmware,
+// obiekt z plant.cpp, czas z millis() przesuwany ręcznie co tick taskControl.
+// Wynik: przeregulowanie, czas ustalania, energia i czasy kroków profilu.
+// --replay: zamiast obiektu temperatury z zapisu przebiegu (run_recorder.h).
+// --fault-replay: zapisy przebiegów przez sam detektor heater_fault (fałszywe alarmy).
+#include <Arduino.h>
+#include <chrono>
+#include <vector>
+#include "config.h"
+#include "state.h"
+#include "process.h"
+#include "outputs.h"
+#include "profile_parser.h"
+#include "ssr_driver.h"
+#include "heater_rotation.h"
+#include "run_recorder.h"
+#include "flash_storage.h"
+#include "history.h"
+#include "energy.h"
+#include "plant.h"
+#include "heater_fault.h"
+#include <esp_timer.h>
+
+// ======================================================
+// CZAS SYMULOWANY
+// ======================================================
+
+// Obiekt i sterownik SSR liczone co półokres sieci, logika sterowania co TICK_MS
+static uint64_t      simUs = 0;
+static unsigned long simMs = 0;
+
+unsigned long millis() { return (unsigned long)(simUs / 1000); }
+unsigned long micros() { return (unsigned long)simUs; }
+int64_t esp_timer_get_time() { return (int64_t)simUs; }
+void delay(unsigned long ms) { simUs += (uint64_t)ms * 1000; }
+
+static constexpr unsigned long TICK_MS = 100;   // jak taskControl
+
+bool sim_flash_export(const char* path, uint32_t len, const char* hostPath);   // sim_stubs.cpp
+
+// ======================================================
+// OPCJE
+// ======================================================
+
+struct DoorEvent {
+    unsigned long atMs;
+    unsigned long durationMs;
+};
+
+struct SimOptions {
+    const char* profile = nullptr;
+    const char* csv = nullptr;
+    const char* replay = nullptr;
+    const char* record = nullptr;
+    const char* filterTrace = nullptr;   // --filter-replay
+    const char* traceCol = "1";
+    const char* filterStages = nullptr;
+    std::vector<const char*> faultRuns;   // --fault-replay (wielokrotnie)
+    double maxHours = 0;          // 0 = suma minTime profilu + 4 h
+    double noise = 0.1;           // [°C] szum czujników (odchylenie standardowe)
+    unsigned seed = 1;
+    int    useEstimator = -1;     // -1 = domyślna konfiguracja
+    int    adaptive = -1;
+    double settleBand = 2.0;      // [°C]
+    bool   verbose = false;
+    std::vector<DoorEvent> doors;
+    int    failHeater = -1;       // 0..2 - grzałka (fizyczna) przestaje grzać
+    unsigned long failAtMs = 0;
+    // Progi dla przebiegów automatycznych - przekroczenie = kod wyjścia 2
+    double limitOvershoot = -1;
+    double limitSettleMin = -1;
+    double limitEnergyKWh = -1;
+    int    ssrMode = -1;          // -1 = domyślna konfiguracja ssr_driver
+    int    ssrWindowMs = 0;
+    int    ssrMinOnMs = 0;
+    bool   ssrSweep = false;
+    float  gains[3] = {-1, -1, -1};   // Kp, Ki, Kd dla wszystkich powerMode (harmonogram)
+    PlantParams plant;
+};
+
+// filter_replay.cpp
+int runFilterReplay(const char* path, const char* col, const char* stages);
+
+static void usage() {
+    fprintf(stderr,
+        "Użycie: wedzarnia_sim -p profil.prof [opcje]\n"
+        "        wedzarnia_sim --replay r_N.bin [opcje]\n"
+        "        wedzarnia_sim --filter-replay trace.csv [--trace-col K] [--filter ETAPY]\n"
+        "        wedzarnia_sim --fault-replay r_1.bin [--fault-replay r_2.bin ...]\n"
+        "  -p FILE           profil .prof (format jak na flash)\n"
+        "  --replay FILE     zapis przebiegu z GET /api/runs - temperatury z zapisu,\n"
+        "                    wyjście PID liczone od nowa i porównane z zapisanym\n"
+        "  --record FILE     zapis przebiegu symulacji przez run_recorder (wejście --replay)\n"
+        "  --filter-replay FILE  surowe próbki czujnika (CSV: czas [s], wartości) przez\n"
+        "                    łańcuchy sensor_filter - szum przed/po i opóźnienie\n"
+        "  --fault-replay FILE  zapis przebiegu ze sprawnymi grzałkami przez detektor\n"
+        "                    heater_fault - fałszywe alarmy na godzinę (wielokrotnie)\n"
+        "  --trace-col K     kolumna próbek (numer lub nazwa z nagłówka), domyślnie 1\n"
+        "  --filter ETAPY    tylko ten łańcuch, np. spike,median,ema\n"
+        "  --gains KP:KI:KD  nastawy PID dla wszystkich powerMode\n"
+        "  --hours H         limit czasu symulacji (domyślnie profil + 4 h)\n"
+        "  --door MIN:SEK    otwarcie drzwi w minucie MIN na SEK sekund (wielokrotnie)\n"
+        "  --heater-fail H:MIN  grzałka H (1..3) przestaje grzać od minuty MIN (martwy SSR)\n"
+        "  --estimator 0|1   PID na estymacie powietrza (chamber_estimator)\n"
+        "  --adaptive 0|1    heurystyczna adaptacja nastaw\n"
+        "  --noise C         szum czujników [°C], domyślnie 0.1\n"
+        "  --seed N          ziarno szumu\n"
+        "  --heater-w W      moc jednej grzałki [W], domyślnie 1500\n"
+        "  --ambient C       temperatura otoczenia [°C], domyślnie 20\n"
+        "  --band C          pasmo ustalania [°C], domyślnie 2\n"
+        "  --csv FILE        przebieg co 10 s do pliku CSV\n"
+        "  --ssr burst|tp    tryb sterownika SSR, --ssr-window MS, --ssr-min-on MS\n"
+        "  --ssr-sweep       tylko charakterystyka SSR: zadane vs oddane wypełnienie\n"
+        "  --max-overshoot C / --max-settle MIN / --max-energy KWH\n"
+        "                    progi: przekroczenie = kod wyjścia 2\n"
+        "  -v                logi firmware na stderr\n");
+}
+
+static bool parseArgs(int argc, char** argv, SimOptions& o) {
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool hasValue = true;
+        if (!strcmp(a, "-p") && v)                   o.profile = v;
+        else if (!strcmp(a, "--csv") && v)           o.csv = v;
+        else if (!strcmp(a, "--replay") && v)        o.replay = v;
+        else if (!strcmp(a, "--record") && v)        o.record = v;
+        else if (!strcmp(a, "--filter-replay") && v) o.filterTrace = v;
+        else if (!strcmp(a, "--fault-replay") && v)  o.faultRuns.push_back(v);
+        else if (!strcmp(a, "--trace-col") && v)     o.traceCol = v;
+        else if (!strcmp(a, "--filter") && v)        o.filterStages = v;
+        else if (!strcmp(a, "--hours") && v)         o.maxHours = atof(v);
+        else if (!strcmp(a, "--noise") && v)         o.noise = atof(v);
+        else if (!strcmp(a, "--seed") && v)          o.seed = (unsigned)atoi(v);
+        else if (!strcmp(a, "--estimator") && v)     o.useEstimator = atoi(v) ? 1 : 0;
+        else if (!strcmp(a, "--adaptive") && v)      o.adaptive = atoi(v) ? 1 : 0;
+        else if (!strcmp(a, "--heater-w") && v)      o.plant.heaterW = (float)atof(v);
+        else if (!strcmp(a, "--ambient") && v)       o.plant.ambient = (float)atof(v);
+        else if (!strcmp(a, "--band") && v)          o.settleBand = atof(v);
+        else if (!strcmp(a, "--max-overshoot") && v) o.limitOvershoot = atof(v);
+        else if (!strcmp(a, "--max-settle") && v)    o.limitSettleMin = atof(v);
+        else if (!strcmp(a, "--max-energy") && v)    o.limitEnergyKWh = atof(v);
+        else if (!strcmp(a, "--ssr-window") && v)    o.ssrWindowMs = atoi(v);
+        else if (!strcmp(a, "--ssr-min-on") && v)    o.ssrMinOnMs = atoi(v);
+        else if (!strcmp(a, "--ssr") && v) {
+            if (!strcmp(v, "burst"))   o.ssrMode = (int)SsrMode::BURST;
+            else if (!strcmp(v, "tp")) o.ssrMode = (int)SsrMode::TIME_PROPORTIONAL;
+            else return false;
+        } else if (!strcmp(a, "--ssr-sweep")) {
+            o.ssrSweep = true;
+            hasValue = false;
+        }
+        else if (!strcmp(a, "--door") && v) {
+            double atMin = 0, durSec = 0;
+            if (sscanf(v, "%lf:%lf", &atMin, &durSec) != 2 || durSec <= 0) return false;
+            o.doors.push_back({(unsigned long)(atMin * 60000.0), (unsigned long)(durSec * 1000.0)});
+        } else if (!strcmp(a, "--gains") && v) {
+            if (sscanf(v, "%f:%f:%f", &o.gains[0], &o.gains[1], &o.gains[2]) != 3 ||
+                o.gains[0] < 0 || o.gains[1] < 0 || o.gains[2] < 0) return false;
+        } else if (!strcmp(a, "--heater-fail") && v) {
+            int h = 0;
+            double atMin = 0;
+            if (sscanf(v, "%d:%lf", &h, &atMin) != 2 || h < 1 || h > 3 || atMin < 0) return false;
+            o.failHeater = h - 1;
+            o.failAtMs = (unsigned long)(atMin * 60000.0);
+        } else if (!strcmp(a, "-v")) {
+            o.verbose = true;
+            hasValue = false;
+        } else {
+            return false;
+        }
+        if (hasValue) i++;
+    }
+    return o.profile != nullptr || o.ssrSweep || o.replay != nullptr || o.filterTrace != nullptr ||
+           !o.faultRuns.empty();
+}
+
+// ======================================================
+// CHARAKTERYSTYKA STEROWNIKA SSR (bez obiektu)
+// ======================================================
+
+static int runSsrSweep() {
+    constexpr uint32_t TICKS = 60UL * 1000000UL / SSR_HALF_CYCLE_US;   // 60 s na punkt
+    SsrConfig cfg;
+    ssr_get_config(cfg);
+    printf("SSR %s, okno %u ms, min. załączenie %u ms\n",
+           cfg.mode == (uint8_t)SsrMode::BURST ? "burst" : "time-proportional",
+           cfg.windowMs, cfg.minOnMs);
+    printf("%8s %9s %8s %10s\n", "zadane%", "oddane%", "błąd%", "załącz/min");
+    double maxErr = 0;
+    for (int d = 0; d <= 1000; d += 25) {
+        ssr_all_off();
+        ssr_set_duty(0, d / 10.0);
+        uint32_t on = 0, sw = 0;
+        bool prev = false;
+        for (uint32_t t = 0; t < TICKS; t++) {
+            ssr_tick();
+            bool s = ssr_is_on(0);
+            if (s) on++;
+            if (s && !prev) sw++;
+            prev = s;
+        }
+        double delivered = on * 100.0 / TICKS;
+        double err = delivered - d / 10.0;
+        if (fabs(err) > maxErr) maxErr = fabs(err);
+        printf("%8.1f %9.2f %8.2f %10u\n", d / 10.0, delivered, err, sw);
+    }
+    ssr_all_off();
+    printf("\nsim.ssr_max_error_pct=%.2f\n", maxErr);
+    return 0;
+}
+
+// ======================================================
+// CZUJNIKI I DRZWI (odpowiedniki sensors.cpp)
+// ======================================================
+
+static uint32_t rngState = 1;
+
+static double gaussian() {
+    // Box-Muller na prostym LCG - powtarzalne między platformami
+    auto uni = []() {
+        rngState = rngState * 1664525u + 1013904223u;
+        return ((rngState >> 8) + 0.5) / 16777216.0;
+    };
+    double u1 = uni(), u2 = uni();
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * PI * u2);
+}
+
+static void publishSensors(const PlantState& ps, double noise) {
+    if (!state_lock()) return;
+    g_tChamber = ps.tProbe + noise * gaussian();
+    // Jeden kanał CHAMBER - historia dla trendu wentylatora
+    SensorReading& r = g_sensorReadings[0];
+    r.value = r.raw = (float)g_tChamber;
+    r.timestamp = millis();
+    r.valid = true;
+    g_tMeat = ps.tMeatProbe + noise * gaussian();
+    g_errorSensor = false;
+    g_sensorSeq++;
+    state_unlock();
+}
+
+// Te same przejścia stanów co checkDoor()
+static void simCheckDoor() {
+    bool nowOpen = (digitalRead(PIN_DOOR) == HIGH);
+    bool shouldTurnOff = false;
+    bool shouldResume = false;
+
+    if (state_lock()) {
+        bool wasOpen = g_doorOpen;
+        if (nowOpen && !wasOpen) {
+            g_doorOpen = true;
+            if (g_currentState == ProcessState::RUNNING_AUTO ||
+                g_currentState == ProcessState::RUNNING_MANUAL) {
+                g_currentState = ProcessState::PAUSE_DOOR;
+                g_processStats.pauseCount++;
+                shouldTurnOff = true;
+            }
+        } else if (!nowOpen && wasOpen) {
+            g_doorOpen = false;
+            if (g_currentState == ProcessState::PAUSE_DOOR) {
+                g_currentState = ProcessState::SOFT_RESUME;
+                shouldResume = true;
+            }
+        }
+        state_unlock();
+    }
+
+    if (shouldTurnOff) allOutputsOff();
+    if (shouldResume)  initHeaterEnable();
+}
+
+// ======================================================
+// ODTWORZENIE ZAPISU PRZEBIEGU
+// ======================================================
+
+struct ReplayRecord {
+    unsigned long tMs;            // od startu przebiegu
+    RunRecord r;
+};
+
+static bool loadRun(const char* path, RunFileHeader& hdr, std::vector<ReplayRecord>& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Nie można otworzyć %s\n", path);
+        return false;
+    }
+    bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 && hdr.magic == RUNREC_FILE_MAGIC &&
+              hdr.version == RUNREC_VERSION && hdr.recordSize == sizeof(RunRecord);
+    if (!ok) {
+        fprintf(stderr, "%s: to nie jest zapis przebiegu (v%d)\n", path, RUNREC_VERSION);
+        fclose(f);
+        return false;
+    }
+    // Bloki od drugiej strony do pierwszej niepoprawnej; luka w seq (blok
+    // zgubiony przy pełnej kolejce) - czas z baseMs następnego bloku
+    RunBlock b;
+    uint32_t seq = 0, gaps = 0;
+    fseek(f, sizeof(RunBlock), SEEK_SET);   // nagłówek zajmuje całą pierwszą stronę
+    while (fread(&b, sizeof(b), 1, f) == 1 && runrec_block_valid(b)) {
+        if (b.seq != seq) gaps++;
+        seq = b.seq + 1;
+        unsigned long t = b.baseMs;
+        for (int k = 0; k < b.count; k++) {
+            if (k > 0) t += b.rec[k].dt * 100UL;
+            out.push_back({t, b.rec[k]});
+        }
+    }
+    fclose(f);
+    if (gaps) fprintf(stderr, "%s: %u brakujących bloków\n", path, gaps);
+    if (out.empty()) {
+        fprintf(stderr, "%s: brak rekordów\n", path);
+        return false;
+    }
+    return true;
+}
+
+static double lerpTemp(int16_t a, int16_t b, double f) {
+    double ta = runrec_temp(a), tb = runrec_temp(b);
+    if (isnan(ta)) return tb;
+    if (isnan(tb)) return ta;
+    return ta + (tb - ta) * f;
+}
+
+static bool isRunning(ProcessState st) {
+    return st == ProcessState::RUNNING_AUTO || st == ProcessState::RUNNING_MANUAL;
+}
+
+// Temperatury z zapisu (interpolacja między rekordami), zadana/moc/drzwi jak w
+// zapisie, proces w trybie ręcznym - ścieżka PID ta sama co w AUTO. Obiekt nie
+// reaguje na wyjście, więc porównanie dotyczy regulatora przy tych samych wejściach:
+// inne --gains/--estimator/--adaptive -> jak zmieniłoby się wysterowanie.
+static int runReplay(const SimOptions& opt) {
+    RunFileHeader hdr;
+    std::vector<ReplayRecord> recs;
+    if (!loadRun(opt.replay, hdr, recs)) return 1;
+    hdr.profile[sizeof(hdr.profile) - 1] = '\0';
+    printf("przebieg #%lu, %s %s, %zu rekordów, %.1f min\n", (unsigned long)hdr.runNo,
+           hdr.runMode == (uint8_t)RunMode::MODE_AUTO ? "AUTO" : "MANUAL", hdr.profile,
+           recs.size(), recs.back().tMs / 60000.0);
+
+    FILE* csv = nullptr;
+    if (opt.csv) {
+        csv = fopen(opt.csv, "w");
+        if (!csv) {
+            fprintf(stderr, "Nie można utworzyć %s\n", opt.csv);
+            return 1;
+        }
+        fprintf(csv, "t_min,state_rec,state_sim,t_set,t_chamber,t_meat,t_est_rec,t_est_sim,"
+                     "pid_rec,pid_sim,h1,h2,h3\n");
+    }
+
+    auto apply = [](const RunRecord& r) {
+        if (!state_lock()) return;
+        double tSet = runrec_temp(r.tSet);
+        if (!isnan(tSet)) g_tSet = tSet;
+        int pm = (r.flags >> RUNREC_F_POWER_SH) & 3;
+        if (pm >= 1) g_powerMode = pm;
+        state_unlock();
+    };
+    auto publish = [](const RunRecord& a, const RunRecord& b, double f) {
+        if (!state_lock()) return;
+        g_tChamber = lerpTemp(a.tChamber, b.tChamber, f);
+        g_tMeat = lerpTemp(a.tMeat, b.tMeat, f);
+        g_tAmbient = lerpTemp(a.tAmbient, b.tAmbient, f);
+        g_errorSensor = false;
+        g_sensorSeq++;
+        state_unlock();
+    };
+
+    apply(recs[0].r);
+    publish(recs[0].r, recs[0].r, 0);
+    process_start_manual();
+
+    const unsigned long t0 = millis();
+    unsigned long lastSensor = t0;
+    size_t i = 0, next = 0;
+    double pidErr = 0, pidBias = 0;
+    long pidSamples = 0, stateMismatch = 0, compared = 0, faultOverrides = 0;
+    while (i + 1 < recs.size() || next < recs.size()) {
+        simUs += TICK_MS * 1000UL;
+        sim_esp_timer_run(simUs);
+        simMs = millis();
+        unsigned long t = simMs - t0;
+        while (i + 1 < recs.size() && recs[i + 1].tMs <= t) i++;
+        const ReplayRecord& a = recs[i];
+        const ReplayRecord& b = i + 1 < recs.size() ? recs[i + 1] : recs[i];
+        double f = b.tMs > a.tMs ? (double)(t - a.tMs) / (b.tMs - a.tMs) : 0.0;
+        if (f > 1) f = 1;
+
+        apply(a.r);
+        plant_set_door(a.r.flags & RUNREC_F_DOOR);
+        simCheckDoor();
+        if (simMs - lastSensor >= TEMP_REQUEST_INTERVAL) {
+            lastSensor = simMs;
+            publish(a.r, b.r, f);
+        }
+
+        process_run_control_logic();
+
+        // Obiekt nie odpowiada na wyjście - detektor grzałek widzi brak mocy,
+        // której w zapisie nie było. Stan wraca do procesu, zliczone osobno.
+        if (g_currentState == ProcessState::PAUSE_HEATER_FAULT &&
+            (ProcessState)a.r.state != ProcessState::PAUSE_HEATER_FAULT) {
+            if (state_lock()) {
+                g_currentState = ProcessState::RUNNING_MANUAL;
+                state_unlock();
+            }
+            resetHeaterFaultMonitor();
+            initHeaterEnable();
+            faultOverrides++;
+        }
+
+        // Porównanie w chwilach rekordów (wyjście PID z zapisu = stan po ticku)
+        while (next < recs.size() && recs[next].tMs <= t) {
+            const RunRecord& r = recs[next].r;
+            ProcessState stRec = (ProcessState)r.state;
+            ProcessState stSim = g_currentState;
+            compared++;
+            if (isRunning(stRec) != isRunning(stSim)) stateMismatch++;
+            if (isRunning(stRec) && isRunning(stSim)) {
+                double d = pidOutput - r.pid / 2.0;
+                pidErr += fabs(d);
+                pidBias += d;
+                pidSamples++;
+            }
+            if (csv) {
+                double duty[3];
+                outputs_heater_duties(duty);
+                fprintf(csv, "%.3f,%s,%s,%.2f,%.2f,%.2f,%.2f,%.2f,%.1f,%.1f,%.0f,%.0f,%.0f\n",
+                        recs[next].tMs / 60000.0, processStateStr(stRec), processStateStr(stSim),
+                        runrec_temp(r.tSet), runrec_temp(r.tChamber), runrec_temp(r.tMeat),
+                        runrec_temp(r.tEst), (double)g_tChamberEst, r.pid / 2.0, pidOutput,
+                        duty[0], duty[1], duty[2]);
+            }
+            next++;
+        }
+    }
+    if (csv) fclose(csv);
+
+    printf("\nsim.replay_records=%zu\n", recs.size());
+    printf("sim.replay_duration_min=%.1f\n", recs.back().tMs / 60000.0);
+    printf("sim.replay_state_mismatch_pct=%.1f\n", compared ? stateMismatch * 100.0 / compared : 0.0);
+    printf("sim.replay_fault_overrides=%ld\n", faultOverrides);
+    if (pidSamples > 0) {
+        printf("sim.replay_pid_mae=%.2f\n", pidErr / pidSamples);
+        printf("sim.replay_pid_bias=%.2f\n", pidBias / pidSamples);
+    }
+    return 0;
+}
+
+// [NEW] Detektor martwej grzałki na zapisach przebiegów, w otwartej pętli: wejścia
+// jak w sampleHeaterFault() - estymata powietrza (tEst z zapisu), otoczenie,
+// wysterowanie grzałek; pauza/drzwi = hold, skok zadanej = rebase. Zapisy
+// przebiegów bez awarii - każdy alarm jest fałszywy. Przebieg, w którym zapis
+// ma PAUSE_HEATER_FAULT (prawdziwa albo ówczesna fałszywa pauza), liczony
+// osobno do chwili pauzy. Rekordy co RUNREC_INTERVAL_MS - w bloku HF_BLOCK_MS
+// 6 próbek zamiast ~50 z pomiarów czujników; blok liczy narastanie z końców
+// i średnie wysterowania, więc decyzje na blok te same, szum średnich większy.
+// Alarm = grzałka wskazana (beep / pauza); ostrzeżenie = CUSUM bez wskazania
+// grzałki ("Heater power low" w logu) - liczone osobno.
+static int runFaultReplay(const SimOptions& opt) {
+    EstimatorConfig ecfg;
+    estimator_get_config(ecfg);
+    const float gain = ecfg.heaterGain / ecfg.tauAir, invTau = 1.0f / ecfg.tauAir;
+
+    double hours = 0;
+    long alarms = 0, warnings = 0, runsWithAlarm = 0, runsWithPause = 0, runs = 0;
+    printf("%-28s %8s %8s %8s %8s %s\n", "przebieg", "[h]", "alarmy", "ostrz.", "maska", "uwagi");
+    for (const char* path : opt.faultRuns) {
+        RunFileHeader hdr;
+        std::vector<ReplayRecord> recs;
+        if (!loadRun(path, hdr, recs)) continue;
+        runs++;
+
+        HeaterFaultState det;
+        heater_fault_reset(det);
+        double lastSp = runrec_temp(recs[0].r.tSet);
+        double runH = 0;
+        int runAlarms = 0, runWarnings = 0;
+        bool paused = false;
+        for (size_t i = 0; i < recs.size(); i++) {
+            const RunRecord& r = recs[i].r;
+            ProcessState st = (ProcessState)r.state;
+            if (st == ProcessState::PAUSE_HEATER_FAULT) {
+                paused = true;
+                break;
+            }
+            if (i > 0 && isRunning((ProcessState)recs[i - 1].r.state)) {
+                runH += (recs[i].tMs - recs[i - 1].tMs) / 3600000.0;
+            }
+            double sp = runrec_temp(r.tSet);
+            bool spJump = !isnan(sp) && !isnan(lastSp) && fabs(sp - lastSp) >= PID_SP_JUMP_C;
+            if (!isnan(sp)) lastSp = sp;
+            if (spJump) {
+                heater_fault_rebase(det);
+                continue;
+            }
+            if (!isRunning(st) || (r.flags & RUNREC_F_DOOR)) {
+                heater_fault_hold(det);
+                continue;
+            }
+            double tAir = runrec_temp(r.tEst);
+            if (isnan(tAir)) tAir = runrec_temp(r.tChamber);
+            double amb = runrec_temp(r.tAmbient);
+            if (isnan(tAir)) continue;
+            const float duty[3] = {r.heater[0] / 200.0f, r.heater[1] / 200.0f, r.heater[2] / 200.0f};
+            uint8_t found = heater_fault_sample(det, recs[i].tMs, (float)tAir,
+                                                isnan(amb) ? ecfg.ambient : (float)amb,
+                                                duty, gain, invTau);
+            for (int h = 0; h < 3; h++) runAlarms += (found >> h) & 1;
+            if (det.samples == 0 && det.ambiguous) runWarnings++;   // koniec bloku, jak process.cpp
+        }
+        hours += runH;
+        alarms += runAlarms;
+        warnings += runWarnings;
+        if (runAlarms) runsWithAlarm++;
+        if (paused) runsWithPause++;
+        printf("%-28s %8.2f %8d %8d %8u %s\n", path, runH, runAlarms, runWarnings, det.faultMask,
+               paused ? "PAUSE_HEATER_FAULT w zapisie - do pauzy" : "");
+    }
+    if (runs == 0) return 1;
+
+    printf("\nsim.fault_replay_runs=%ld\n", runs);
+    printf("sim.fault_replay_hours=%.2f\n", hours);
+    printf("sim.fault_replay_alarms=%ld\n", alarms);
+    printf("sim.fault_replay_warnings=%ld\n", warnings);
+    printf("sim.fault_replay_runs_with_alarm=%ld\n", runsWithAlarm);
+    printf("sim.fault_replay_runs_paused=%ld\n", runsWithPause);
+    printf("sim.fault_replay_false_per_100h=%.2f\n", hours > 0 ? alarms * 100.0 / hours : 0.0);
+    printf("sim.fault_replay_warnings_per_100h=%.2f\n", hours > 0 ? warnings * 100.0 / hours : 0.0);
+    return 0;
+}
+
+// ======================================================
+// METRYKI KROKÓW
+// ======================================================
+
+struct StepMetrics {
+    char   name[32];
+    double tSet;
+    unsigned long plannedMs;
+    unsigned long startMs = 0;
+    unsigned long endMs = 0;
+    long   reachMs = -1;          // pierwsze wejście powietrza w pasmo [ms od startu kroku]
+    long   lastOutMs = -1;        // ostatnie wyjście z pasma po osiągnięciu
+    bool   inBandAtEnd = false;
+    double overshoot = 0;         // max (powietrze - tSet) po osiągnięciu pasma
+    double energyJ = 0;
+    bool   done = false;
+};
+
+static void printSummary(const std::vector<StepMetrics>& steps, const PlantState& ps,
+                         double estErr, double rawErr, long errSamples,
+                         double wallSec, bool completed, const char* finalState) {
+    printf("\n%-3s %-16s %6s %9s %9s %8s %8s %7s %7s\n",
+           "#", "krok", "tSet", "plan[min]", "fakt[min]", "dojście", "ustal.", "przer.", "kWh");
+    for (size_t i = 0; i < steps.size(); i++) {
+        const StepMetrics& m = steps[i];
+        if (!m.done) continue;
+        char reach[16], settle[16];
+        if (m.reachMs >= 0) snprintf(reach, sizeof(reach), "%.1f", m.reachMs / 60000.0);
+        else snprintf(reach, sizeof(reach), "-");
+        long settleMs = m.inBandAtEnd ? (m.lastOutMs >= 0 ? m.lastOutMs : m.reachMs) : -1;
+        if (settleMs >= 0) snprintf(settle, sizeof(settle), "%.1f", settleMs / 60000.0);
+        else snprintf(settle, sizeof(settle), "-");
+        printf("%-3zu %-16.16s %6.1f %9.1f %9.1f %8s %8s %7.2f %7.3f\n",
+               i, m.name, m.tSet, m.plannedMs / 60000.0, (m.endMs - m.startMs) / 60000.0,
+               reach, settle, m.overshoot, m.energyJ / 3.6e6);
+    }
+    double simH = simMs / 3600000.0;
+    printf("\nczas symulowany %.2f h, obliczenia %.2f s (x%.0f), stan końcowy %s%s\n",
+           simH, wallSec, wallSec > 0 ? simMs / 1000.0 / wallSec : 0.0, finalState,
+           completed ? "" : " (profil NIE zakończony)");
+    printf("energia %.3f kWh, mięso %.1f °C\n", ps.energyJ / 3.6e6, ps.tMeat);
+    if (errSamples > 0) {
+        printf("MAE vs powietrze: czujnik %.2f °C, estymata %.2f °C\n",
+               rawErr / errSamples, estErr / errSamples);
+    }
+}
+
+// ======================================================
+// MAIN
+// ======================================================
+
+int main(int argc, char** argv) {
+    SimOptions opt;
+    if (!parseArgs(argc, argv, opt)) {
+        usage();
+        return 1;
+    }
+    Serial.enabled = opt.verbose;
+    rngState = opt.seed ? opt.seed : 1;
+
+    // Jak setup(): mutexy, PID, konfiguracje z (pustego) NVS
+    init_state();
+    pid.SetMode(AUTOMATIC);
+    pid.SetOutputLimits(0, 100);
+    estimator_load_config();
+    process_load_tunings();
+
+    if (opt.useEstimator >= 0) {
+        EstimatorConfig ecfg;
+        estimator_get_config(ecfg);
+        ecfg.usePid = (uint8_t)opt.useEstimator;
+        ecfg.ambient = opt.plant.ambient;
+        estimator_set_config(ecfg, false);
+    }
+    if (opt.adaptive >= 0) process_set_adaptive(opt.adaptive != 0);
+    if (opt.gains[0] >= 0) {
+        for (int pm = 1; pm <= 3; pm++) {
+            GainPoint gp = {};
+            gp.setpoint = 60.0f;   // jeden punkt na powerMode = stałe nastawy
+            gp.kp = opt.gains[0];
+            gp.ki = opt.gains[1];
+            gp.kd = opt.gains[2];
+            gp.powerMode = (uint8_t)pm;
+            gp.source = (uint8_t)GainSource::USER;
+            process_set_schedule_point(gp);
+        }
+    }
+
+    // Jak hardware_init_ledc(): sterownik grzałek z timerem półokresów
+    ssr_init();
+    heater_rot_load();
+    energy_load();
+    {
+        EnergyConfig ecfg;
+        energy_get_config(ecfg);
+        for (int h = 0; h < 3; h++) ecfg.watts[h] = (uint16_t)lroundf(opt.plant.heaterW);
+        energy_set_config(ecfg);
+    }
+    if (opt.ssrMode >= 0 || opt.ssrWindowMs || opt.ssrMinOnMs) {
+        SsrConfig scfg;
+        ssr_get_config(scfg);
+        if (opt.ssrMode >= 0) scfg.mode = (uint8_t)opt.ssrMode;
+        if (opt.ssrWindowMs)  scfg.windowMs = (uint16_t)opt.ssrWindowMs;
+        if (opt.ssrMinOnMs)   scfg.minOnMs = (uint16_t)opt.ssrMinOnMs;
+        if (!ssr_set_config(scfg, false)) {
+            fprintf(stderr, "Niepoprawna konfiguracja SSR\n");
+            return 1;
+        }
+    }
+    if (opt.ssrSweep) return runSsrSweep();
+    if (opt.replay) return runReplay(opt);
+    if (opt.filterTrace) return runFilterReplay(opt.filterTrace, opt.traceCol, opt.filterStages);
+    if (!opt.faultRuns.empty()) return runFaultReplay(opt);
+
+    FILE* f = fopen(opt.profile, "rb");
+    if (!f) {
+        fprintf(stderr, "Nie można otworzyć %s\n", opt.profile);
+        return 1;
+    }
+    std::vector<char> text;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) text.insert(text.end(), buf, buf + n);
+    fclose(f);
+
+    g_profile = profile_parse_text(text.data(), text.size());
+    g_stepCount = profile_count(g_profile);
+    if (g_stepCount == 0) {
+        fprintf(stderr, "Profil %s bez poprawnych kroków\n", opt.profile);
+        return 1;
+    }
+    // Kroki rozpakowane raz - arena bez zmian do końca symulacji
+    std::vector<Step> prof(g_stepCount);
+    for (int i = 0; i < g_stepCount; i++) profile_step_get(g_profile, i, prof[i]);
+
+    unsigned long plannedMs = 0;
+    std::vector<StepMetrics> steps(g_stepCount);
+    for (int i = 0; i < g_stepCount; i++) {
+        snprintf(steps[i].name, sizeof(steps[i].name), "%.31s", prof[i].name);
+        steps[i].tSet = prof[i].tSet;
+        steps[i].plannedMs = prof[i].minTimeMs;
+        plannedMs += prof[i].minTimeMs;
+    }
+    unsigned long limitMs = opt.maxHours > 0
+        ? (unsigned long)(opt.maxHours * 3600000.0)
+        : plannedMs + 4UL * 3600000UL;
+    if (limitMs > CFG_MAX_PROCESS_TIME_MS) limitMs = CFG_MAX_PROCESS_TIME_MS;
+
+    FILE* csv = nullptr;
+    if (opt.csv) {
+        csv = fopen(opt.csv, "w");
+        if (!csv) {
+            fprintf(stderr, "Nie można utworzyć %s\n", opt.csv);
+            return 1;
+        }
+        fprintf(csv, "t_min,step,state,t_set,t_air,t_probe,t_est,t_meat,pid,h1,h2,h3,fan,smoke,door\n");
+    }
+
+    PlantState ps;
+    plant_init(opt.plant, ps);
+    PlantInputs in;
+    g_sensorChannelCount = 1;
+    g_sensorChannels[0] = {};
+    g_sensorChannels[0].role = (uint8_t)SensorRole::CHAMBER;
+    snprintf(g_sensorChannels[0].name, SENSOR_NAME_LEN, "sim");
+    publishSensors(ps, opt.noise);
+    if (opt.record) runrec_init();
+    process_start_auto();
+
+    auto wallStart = std::chrono::steady_clock::now();
+    unsigned long lastSensor = simMs;
+    int curStep = -1;
+    double estErr = 0, rawErr = 0;
+    long errSamples = 0;
+    bool completed = false;
+    const double band = opt.settleBand;
+    const double halfCycleSec = SSR_HALF_CYCLE_US / 1e6;
+    double requestedJ = 0;        // moc zadana przez mapPowerToHeaters() x czas
+    unsigned long ssrSwitches = 0;
+    unsigned long ssrCoincident = 0;   // półokresy z >= 2 załączeniami naraz (szczyt prądu)
+    double heaterOnSec[3] = {0, 0, 0};
+    bool ssrPrev[3] = {false, false, false};
+    // Prognoza mięsa: przewidywany koniec (ms) z pewnością >= 0.5, co minutę
+    std::vector<std::pair<unsigned long, double>> etaPred;
+    long meatDoneMs = -1;
+    // Kaskada: odchyłka rdzenia od trajektorii (jak runCascade()), max setpoint komory
+    double cascTm0 = 0, cascRate = 0, cascErr2 = 0, cascSpMax = 0;
+    long cascSamples = 0;
+    unsigned long cascStartMs = 0, cascEndMs = 0, cascTargetMs = 0;
+    // Drzwi: przeregulowanie w DOOR_WINDOW_MS po zamknięciu i powrót do pasma.
+    // [FIX] Okno kończy skok zadanej (krok profilu) - zejście w dół nie jest
+    // przeregulowaniem po drzwiach. Powrót = wejście w pasmo, w którym powietrze
+    // zostało DOOR_HOLD_MS (albo do końca okna) - nie samo przejście przez pasmo.
+    const unsigned long DOOR_WINDOW_MS = 30UL * 60000UL;
+    const unsigned long DOOR_HOLD_MS = 5UL * 60000UL;
+    bool doorPrev = false, doorRecovered = true, doorWindow = false;
+    unsigned long doorClosedMs = 0;
+    long doorInBandMs = -1;   // początek bieżącego pobytu w paśmie
+    double doorOvershoot = 0, doorRecoverMin = 0, doorLastSp = 0;
+    int doorEvents = 0, doorUnrecovered = 0;
+    // Detektor grzałek: pierwsze zgłoszenie (czas, maska)
+    long hfFirstMs = -1;
+    uint8_t hfFirstMask = 0;
+
+    while (simMs < limitMs) {
+        // Obiekt i SSR co półokres przez jeden tick z wysterowaniem z poprzedniego ticku
+        double stepJ = 0;
+        for (uint64_t endUs = simUs + TICK_MS * 1000UL; simUs < endUs; ) {
+            simUs += SSR_HALF_CYCLE_US;
+            sim_esp_timer_run(simUs);
+            plant_read_outputs(in);
+            if (opt.failHeater >= 0 && simUs >= (uint64_t)opt.failAtMs * 1000ULL) {
+                in.heaterDuty[opt.failHeater] = 0;
+            }
+            plant_step(opt.plant, ps, in, halfCycleSec);
+
+            double duty[3];
+            outputs_heater_duties(duty);
+            int switchedOn = 0;
+            for (int h = 0; h < 3; h++) {
+                requestedJ += duty[h] / 100.0 * opt.plant.heaterW * halfCycleSec;
+                stepJ += in.heaterDuty[h] * opt.plant.heaterW * halfCycleSec;
+                bool on = in.heaterDuty[h] > 0;
+                if (on) heaterOnSec[h] += halfCycleSec;
+                if (on && !ssrPrev[h]) { ssrSwitches++; switchedOn++; }
+                ssrPrev[h] = on;
+            }
+            if (switchedOn >= 2) ssrCoincident++;
+        }
+        simMs = millis();
+
+        bool doorOpen = false;
+        for (const DoorEvent& d : opt.doors) {
+            if (simMs >= d.atMs && simMs < d.atMs + d.durationMs) doorOpen = true;
+        }
+        plant_set_door(doorOpen);
+        simCheckDoor();
+        if (doorPrev && !doorOpen) {
+            doorClosedMs = simMs;
+            doorRecovered = false;
+            doorWindow = true;
+            doorInBandMs = -1;
+            doorLastSp = g_tSet;
+            doorEvents++;
+        }
+        doorPrev = doorOpen;
+        if (doorWindow && (doorOpen || simMs - doorClosedMs >= DOOR_WINDOW_MS ||
+                           fabs(g_tSet - doorLastSp) >= PID_SP_JUMP_C)) {
+            // Koniec okna: w paśmie od doorInBandMs do końca - powrót, inaczej nie wrócił
+            doorWindow = false;
+            if (!doorRecovered && doorInBandMs >= 0) {
+                doorRecovered = true;
+                doorRecoverMin = std::max(doorRecoverMin, (doorInBandMs - (long)doorClosedMs) / 60000.0);
+            }
+            if (!doorRecovered) doorUnrecovered++;
+        }
+        if (doorWindow) {
+            double e = ps.tAir - g_tSet;
+            doorLastSp = g_tSet;   // rampa przesuwa zadaną po trochu - okno trwa
+            if (e > doorOvershoot) doorOvershoot = e;
+            if (fabs(e) > band) {
+                doorInBandMs = -1;
+            } else if (doorInBandMs < 0) {
+                doorInBandMs = (long)simMs;
+            }
+            if (!doorRecovered && doorInBandMs >= 0 && simMs - doorInBandMs >= DOOR_HOLD_MS) {
+                doorRecovered = true;
+                doorRecoverMin = std::max(doorRecoverMin, (doorInBandMs - (long)doorClosedMs) / 60000.0);
+            }
+        }
+
+        if (simMs - lastSensor >= TEMP_REQUEST_INTERVAL) {
+            lastSensor = simMs;
+            publishSensors(ps, opt.noise);   // + xTaskNotifyGive -> sterowanie w tym samym ticku
+        }
+
+        process_run_control_logic();
+        history_tick();
+        if (opt.record) {
+            runrec_tick();
+            runrec_flush();
+        }
+
+        ProcessState st = g_currentState;
+        int step = g_currentStep;
+
+        // Przejścia kroków
+        if (step != curStep) {
+            if (curStep >= 0 && curStep < g_stepCount) {
+                steps[curStep].endMs = simMs;
+                steps[curStep].done = true;
+                if (prof[curStep].useMeatTemp && meatDoneMs < 0) meatDoneMs = (long)simMs;
+            }
+            curStep = step;
+            if (curStep >= 0 && curStep < g_stepCount) {
+                steps[curStep].startMs = simMs;
+                const Step& s = prof[curStep];
+                if (s.control == StepControl::CASCADE) {
+                    cascTm0 = g_tMeat;
+                    cascRate = s.cascRate > 0 ? s.cascRate / 60000.0
+                                              : (s.tMeatTarget - cascTm0) / (double)s.cascTimeMs;
+                    cascStartMs = simMs;
+                    cascTargetMs = (unsigned long)((s.tMeatTarget - cascTm0) / cascRate);
+                }
+            }
+        }
+        if (curStep >= 0 && curStep < g_stepCount) {
+            StepMetrics& m = steps[curStep];
+            long rel = (long)(simMs - m.startMs);
+            double e = ps.tAir - g_tSet;   // kaskada przestawia setpoint w trakcie kroku
+            bool inBand = fabs(e) <= band;
+            if (m.reachMs < 0 && inBand) m.reachMs = rel;
+            if (m.reachMs >= 0) {
+                if (!inBand) m.lastOutMs = rel;
+                if (e > m.overshoot) m.overshoot = e;
+            }
+            m.inBandAtEnd = inBand;
+            m.energyJ += stepJ;
+
+            const Step& s = prof[curStep];
+            if (s.control == StepControl::CASCADE && st == ProcessState::RUNNING_AUTO) {
+                double ref = std::min((double)s.tMeatTarget, cascTm0 + cascRate * (simMs - cascStartMs));
+                cascErr2 += (g_tMeat - ref) * (g_tMeat - ref);
+                cascSamples++;
+                cascEndMs = simMs;
+                if (g_tSet > cascSpMax) cascSpMax = g_tSet;
+            }
+        }
+
+        if (st == ProcessState::RUNNING_AUTO && step < g_stepCount && prof[step].useMeatTemp &&
+            meatDoneMs < 0) {
+            if (g_tMeat >= prof[step].tMeatTarget) {
+                meatDoneMs = (long)simMs;
+            } else if (simMs % 60000 == 0 && g_processStats.meatEtaSec >= 0 &&
+                       g_processStats.meatEtaConf >= 0.5f) {
+                etaPred.push_back({simMs, simMs + g_processStats.meatEtaSec * 1000.0});
+            }
+        }
+
+        if (hfFirstMs < 0 && g_processStats.heaterFaultMask) {
+            hfFirstMs = (long)simMs;
+            hfFirstMask = g_processStats.heaterFaultMask;
+        }
+
+        if (st == ProcessState::RUNNING_AUTO) {
+            estErr += fabs(g_tChamberEst - ps.tAir);
+            rawErr += fabs(g_tChamber - ps.tAir);
+            errSamples++;
+        }
+
+        if (csv && simMs % 10000 == 0) {
+            fprintf(csv, "%.3f,%d,%s,%.2f,%.3f,%.3f,%.3f,%.3f,%.1f,%.0f,%.0f,%.0f,%d,%.0f,%d\n",
+                    simMs / 60000.0, step, processStateStr(), (double)g_tSet, ps.tAir, ps.tProbe,
+                    (double)g_tChamberEst, ps.tMeat, pidOutput,
+                    in.heaterDuty[0] * 100, in.heaterDuty[1] * 100, in.heaterDuty[2] * 100,
+                    in.fanOn ? 1 : 0, in.smokeDuty * 255, in.doorOpen ? 1 : 0);
+        }
+
+        if (step >= g_stepCount) {
+            completed = true;
+            break;
+        }
+        if (st == ProcessState::PAUSE_HEATER_FAULT || st == ProcessState::PAUSE_OVERHEAT ||
+            st == ProcessState::PAUSE_USER) {
+            break;
+        }
+    }
+    if (curStep >= 0 && curStep < g_stepCount && !steps[curStep].done) {
+        steps[curStep].endMs = simMs;
+        steps[curStep].done = true;
+    }
+    if (csv) fclose(csv);
+    if (opt.record) {
+        // Przebieg przerwany limitem czasu - zapisane bloki jak po resecie
+        char files[1][MAX_FILENAME_LEN];
+        if (flash_list_files(RUNREC_DIR, files, 1) != 1 ||
+            !sim_flash_export(files[0], runrec_file_length(files[0]), opt.record)) {
+            fprintf(stderr, "Nie można zapisać %s\n", opt.record);
+        }
+    }
+
+    double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    printSummary(steps, ps, estErr, rawErr, errSamples, wallSec, completed, processStateStr());
+
+    // Linie klucz=wartość do porównań między przebiegami (grep / diff)
+    double maxOvershoot = 0, maxSettleMin = 0;
+    long transitionDevMs = 0;
+    for (const StepMetrics& m : steps) {
+        if (!m.done) continue;
+        if (m.overshoot > maxOvershoot) maxOvershoot = m.overshoot;
+        long settleMs = m.inBandAtEnd ? (m.lastOutMs >= 0 ? m.lastOutMs : m.reachMs) : -1;
+        double settleMin = settleMs >= 0 ? settleMs / 60000.0 : (m.endMs - m.startMs) / 60000.0;
+        if (settleMin > maxSettleMin) maxSettleMin = settleMin;
+        transitionDevMs += (long)(m.endMs - m.startMs) - (long)m.plannedMs;
+    }
+    double energyKWh = ps.energyJ / 3.6e6;
+    printf("\nsim.completed=%d\n", completed ? 1 : 0);
+    printf("sim.duration_min=%.1f\n", simMs / 60000.0);
+    printf("sim.planned_min=%.1f\n", plannedMs / 60000.0);
+    printf("sim.step_delay_min=%.1f\n", transitionDevMs / 60000.0);
+    printf("sim.max_overshoot=%.2f\n", maxOvershoot);
+    printf("sim.max_settle_min=%.1f\n", maxSettleMin);
+    printf("sim.energy_kwh=%.3f\n", energyKWh);
+    // Licznik firmware (energy.h) vs model - różnica = półokresy poza procesem
+    printf("sim.energy_acct_kwh=%.3f\n", energy_wh(g_processStats.energyUj) / 1000.0);
+    // Liniowość SSR: energia oddana przez grzałki vs zadana przez PID (po soft-enable)
+    printf("sim.ssr_requested_kwh=%.3f\n", requestedJ / 3.6e6);
+    printf("sim.ssr_energy_error_pct=%.2f\n",
+           requestedJ > 0 ? (ps.energyJ - requestedJ) * 100.0 / requestedJ : 0.0);
+    printf("sim.ssr_switches_per_h=%.0f\n", simMs > 0 ? ssrSwitches * 3600000.0 / simMs : 0.0);
+    printf("sim.ssr_coincident_on=%lu\n", ssrCoincident);
+    printf("sim.heater_on_h=%.2f/%.2f/%.2f\n",
+           heaterOnSec[0] / 3600.0, heaterOnSec[1] / 3600.0, heaterOnSec[2] / 3600.0);
+    if (cascSamples > 0) {
+        printf("sim.cascade_time_min=%.1f\n", (cascEndMs - cascStartMs) / 60000.0);
+        printf("sim.cascade_target_min=%.1f\n", cascTargetMs / 60000.0);
+        printf("sim.cascade_track_rms=%.2f\n", sqrt(cascErr2 / cascSamples));
+        printf("sim.cascade_sp_max=%.1f\n", cascSpMax);
+    }
+    if (doorWindow && !doorRecovered) {   // koniec symulacji w oknie
+        if (doorInBandMs >= 0) doorRecoverMin = std::max(doorRecoverMin, (doorInBandMs - (long)doorClosedMs) / 60000.0);
+        else doorUnrecovered++;
+    }
+    if (doorEvents > 0) {
+        printf("sim.door_overshoot=%.2f\n", doorOvershoot);
+        printf("sim.door_recover_min=%.1f\n", doorUnrecovered ? DOOR_WINDOW_MS / 60000.0 : doorRecoverMin);
+    }
+    // Grzałka: zgłoszenie przed awarią albo nie tej grzałki = fałszywy alarm
+    if (opt.failHeater >= 0) {
+        bool right = hfFirstMs >= (long)opt.failAtMs && hfFirstMask == (1 << opt.failHeater);
+        printf("sim.heater_fault_detect_min=%.1f\n",
+               right ? (hfFirstMs - (long)opt.failAtMs) / 60000.0 : -1.0);
+    }
+    printf("sim.heater_fault_false=%d\n",
+           hfFirstMs >= 0 && (opt.failHeater < 0 || hfFirstMs < (long)opt.failAtMs ||
+                              hfFirstMask != (1 << opt.failHeater)) ? 1 : 0);
+    if (meatDoneMs >= 0 && !etaPred.empty()) {
+        // Błąd przewidywanego końca względem faktycznego dojścia sondy mięsa
+        double sumErr = 0;
+        for (const auto& p : etaPred) sumErr += fabs(p.second - meatDoneMs);
+        printf("sim.meat_eta_mae_min=%.1f\n", sumErr / etaPred.size() / 60000.0);
+        printf("sim.meat_eta_lead_min=%.1f\n", (meatDoneMs - (double)etaPred.front().first) / 60000.0);
+    }
+    if (errSamples > 0) {
+        printf("sim.mae_raw=%.3f\n", rawErr / errSamples);
+        printf("sim.mae_est=%.3f\n", estErr / errSamples);
+    }
+
+    bool fail = !completed;
+    if (opt.limitOvershoot >= 0 && maxOvershoot > opt.limitOvershoot) fail = true;
+    if (opt.limitSettleMin >= 0 && maxSettleMin > opt.limitSettleMin) fail = true;
+    if (opt.limitEnergyKWh >= 0 && energyKWh > opt.limitEnergyKWh) fail = true;
+    return fail ? 2 : 0;
+}
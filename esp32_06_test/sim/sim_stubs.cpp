@@ -0,0 +1,168 @@
+// sim_stubs.cpp - Zamienniki modułów firmware, które nie wchodzą do symulatora
+// (UI, NVS, flash). Bloby NVS i pliki flash trzymane w pamięci - każdy przebieg
+// startuje od domyślnych.
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "ui.h"
+#include "storage.h"
+#include "flash_storage.h"
+#include "history.h"
+#include "state.h"
+
+HardwareSerial Serial;
+
+void ui_force_redraw() {}
+
+// Timery esp_timer - okresowe, odpalane z pętli symulacji
+struct sim_esp_timer {
+    esp_timer_create_args_t args;
+    uint64_t period = 0;
+    uint64_t next = 0;
+    bool     running = false;
+};
+
+static std::vector<sim_esp_timer*> simTimers;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+    sim_esp_timer* t = new sim_esp_timer();
+    t->args = *args;
+    simTimers.push_back(t);
+    *out = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t period_us) {
+    t->period = period_us;
+    t->next = (uint64_t)esp_timer_get_time() + period_us;
+    t->running = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t t) {
+    t->running = false;
+    return ESP_OK;
+}
+
+void sim_esp_timer_run(uint64_t nowUs) {
+    for (sim_esp_timer* t : simTimers) {
+        while (t->running && t->next <= nowUs) {
+            t->args.callback(t->args.arg);
+            t->next += t->period;
+        }
+    }
+}
+
+const char* storage_get_profile_path() { return "sim"; }
+
+// Historia: tylko tier 0 (1 s) kanałów czujników - tyle czyta fanControl()
+static std::vector<HistPoint> histCh[MAX_SENSOR_CHANNELS];
+static unsigned long histLastMs = 0;
+
+void history_tick() {
+    unsigned long now = millis();
+    if (histLastMs != 0 && now - histLastMs < 1000) return;
+    histLastMs = now;
+    for (int ch = 0; ch < g_sensorChannelCount; ch++) {
+        const SensorReading& r = g_sensorReadings[ch];
+        HistPoint p = {(uint32_t)(now / 1000), r.value, r.value, r.value, r.timestamp != 0};
+        histCh[ch].push_back(p);
+        if (histCh[ch].size() > (size_t)HIST_TIER0_SLOTS) histCh[ch].erase(histCh[ch].begin());
+    }
+}
+
+int history_read_last(uint8_t tier, uint8_t series, HistPoint* out, int count) {
+    if (tier != 0 || series >= MAX_SENSOR_CHANNELS || count <= 0) return 0;
+    const std::vector<HistPoint>& h = histCh[series];
+    int n = (int)h.size() < count ? (int)h.size() : count;
+    for (int i = 0; i < n; i++) out[i] = h[h.size() - n + i];
+    return n;
+}
+
+static std::map<std::string, std::vector<uint8_t>> nvsBlobs;
+
+bool storage_load_blob_nvs(const char* key, void* data, size_t size) {
+    auto it = nvsBlobs.find(key);
+    if (it == nvsBlobs.end() || it->second.size() != size) return false;
+    memcpy(data, it->second.data(), size);
+    return true;
+}
+
+void storage_save_blob_nvs(const char* key, const void* data, size_t size) {
+    const uint8_t* p = (const uint8_t*)data;
+    nvsBlobs[key].assign(p, p + size);
+}
+
+// Pliki flash (tylko to, czego używa run_recorder.cpp). Rezerwacja wypełniona
+// 0xFF jak skasowany sektor, zapis jak page program (AND z zawartością).
+struct SimFlashFile {
+    std::vector<uint8_t> data;    // cała rezerwacja
+    uint32_t size;                // fileSize z FAT
+};
+
+static std::map<std::string, SimFlashFile> flashFiles;
+
+bool flash_is_ready() { return true; }
+
+bool flash_file_exists(const char* path) { return flashFiles.count(path) > 0; }
+
+uint32_t flash_file_get_size(const char* path) {
+    auto it = flashFiles.find(path);
+    return it == flashFiles.end() ? 0 : it->second.size;
+}
+
+int flash_file_read_chunk(const char* path, uint32_t offset, uint8_t* buf, uint32_t size) {
+    auto it = flashFiles.find(path);
+    if (it == flashFiles.end()) return -1;
+    if (offset >= it->second.size) return 0;
+    if (offset + size > it->second.size) size = it->second.size - offset;
+    memcpy(buf, it->second.data.data() + offset, size);
+    return (int)size;
+}
+
+bool flash_file_delete(const char* path) { return flashFiles.erase(path) > 0; }
+
+int flash_list_files(const char* dirPrefix, char files[][MAX_FILENAME_LEN], int maxFiles) {
+    int count = 0;
+    for (const auto& f : flashFiles) {
+        if (count >= maxFiles) break;
+        if (f.first.compare(0, strlen(dirPrefix), dirPrefix) != 0) continue;
+        snprintf(files[count++], MAX_FILENAME_LEN, "%s", f.first.c_str());
+    }
+    return count;
+}
+
+bool flash_file_reserve(const char* path, uint32_t size) {
+    if (flashFiles.count(path)) return false;
+    uint32_t bytes = (size + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE * FLASH_SECTOR_SIZE;
+    flashFiles[path] = {std::vector<uint8_t>(bytes, 0xFF), bytes};
+    return true;
+}
+
+bool flash_file_write_at(const char* path, uint32_t offset, const uint8_t* data, uint32_t size) {
+    auto it = flashFiles.find(path);
+    if (it == flashFiles.end() || offset + size > it->second.data.size()) return false;
+    for (uint32_t i = 0; i < size; i++) it->second.data[offset + i] &= data[i];
+    return true;
+}
+
+bool flash_file_truncate(const char* path, uint32_t size) {
+    auto it = flashFiles.find(path);
+    if (it == flashFiles.end() || size > it->second.data.size()) return false;
+    it->second.size = size;
+    return true;
+}
+
+// --record: plik z pamięci na dysk hosta
+bool sim_flash_export(const char* path, uint32_t len, const char* hostPath) {
+    auto it = flashFiles.find(path);
+    if (it == flashFiles.end()) return false;
+    FILE* f = fopen(hostPath, "wb");
+    if (!f) return false;
+    if (len > it->second.data.size()) len = it->second.data.size();
+    bool ok = fwrite(it->second.data.data(), 1, len, f) == len;
+    fclose(f);
+    return ok;
+}
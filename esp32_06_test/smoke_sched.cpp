@@ -0,0 +1,62 @@
+// smoke_sched.cpp - Harmonogram i regulacja dymu (patrz smoke_sched.h)
+#include "smoke_sched.h"
+#include <math.h>
+#include <string.h>
+
+void smoke_reset(SmokeState& st) {
+    memset(&st, 0, sizeof(st));
+    st.integ = SMOKE_INTEG0;
+}
+
+void smoke_start_step(SmokeState& st, uint32_t nowMs, uint8_t fromPwm) {
+    st.startMs = nowMs;
+    st.lastMs = nowMs;
+    st.fromPwm = fromPwm;
+}
+
+uint8_t smoke_output(SmokeState& st, const SmokeSchedule& s, uint32_t nowMs, float density) {
+    uint32_t elapsed = nowMs - st.startMs;
+    float dt = (nowMs - st.lastMs) / 1000.0f;
+    st.lastMs = nowMs;
+
+    float level = s.pwm;
+    if (s.rampSec > 0 && elapsed < s.rampSec * 1000UL) {
+        level = st.fromPwm + (s.pwm - st.fromPwm) * (elapsed / (s.rampSec * 1000.0f));
+    }
+
+    bool gateOn = true;
+    if (s.onSec > 0 && s.offSec > 0) {
+        uint32_t period = (s.onSec + s.offSec) * 1000UL;
+        gateOn = (elapsed % period) < s.onSec * 1000UL;
+    }
+
+    st.closedLoop = s.density > 0 && !isnan(density);
+    if (st.closedLoop) {
+        // PI z całkowaniem warunkowym: całka stoi w fazie OFF i w nasyceniu w stronę nasycenia
+        float e = s.density - density;
+        float u = SMOKE_KP * e + st.integ;
+        bool satHigh = u >= 1.0f && e > 0;
+        bool satLow = u <= 0.0f && e < 0;
+        if (gateOn && !satHigh && !satLow) {
+            st.integ += SMOKE_KP / SMOKE_TI_S * e * dt;
+            if (st.integ < 0) st.integ = 0;
+            if (st.integ > 1) st.integ = 1;
+        }
+        if (u < 0) u = 0;
+        if (u > 1) u = 1;
+        level *= u;
+    }
+
+    if (!gateOn) return 0;
+    if (level < 0) level = 0;
+    if (level > 255) level = 255;
+    return (uint8_t)lroundf(level);
+}
+
+float smoke_density_from_adc(double adc) {
+    if (adc < 20 || adc > 4075) return NAN;
+    float d = (float)((adc - SMOKE_ADC_CLEAN) * 100.0 / (SMOKE_ADC_DENSE - SMOKE_ADC_CLEAN));
+    if (d < 0) d = 0;
+    if (d > 100) d = 100;
+    return d;
+}
@@ -0,0 +1,44 @@
+// smoke_sched.h - Harmonogram i regulacja dymu na PIN_SMOKE_FAN
+// [NEW] Dym był stałym PWM kroku (smokePwm / g_manualSmokePwm) zapisywanym co
+//       tick. Na krok (pola .prof, patrz profile_parser.h):
+//         spulse=ON:OFF - impulsy: ON s dymu, OFF s przerwy (np. generator trocin
+//                         dymi lepiej z przerwami na dopalenie),
+//         sramp=MIN     - PWM dochodzi liniowo od poziomu poprzedniego kroku,
+//         sdens=PCT     - gęstość dymu z czujnika (kanał roli "smoke" typu NTC,
+//                         czyli pin ADC, np. MQ-135) regulowana PI;
+//                         smokePwm kroku = górna granica PWM.
+//       Bez czujnika (brak takiego kanału albo odczyt poza zakresem) sdens
+//       nie działa - PWM jak bez regulacji. W fazie OFF impulsów całka PI stoi.
+//       Liczone w taskControl; wyjście zapisywane tylko przy zmianie PWM
+//       (outputs_set_smoke), stan kroku pobierany pod tym samym state_lock co dotąd.
+//       Czysty C++ (bez Arduino) - liczony też w symulacji na hoście.
+#pragma once
+#include <stdint.h>
+
+constexpr float SMOKE_KP        = 0.02f;    // [1/%] wyjście 0..1 na % uchybu gęstości
+constexpr float SMOKE_TI_S      = 120.0f;   // [s] czas zdwojenia PI (dym reaguje w dziesiątki s)
+constexpr float SMOKE_INTEG0    = 0.5f;     // całka na starcie procesu
+constexpr int   SMOKE_ADC_CLEAN = 300;      // ADC czujnika w czystym powietrzu = 0 %
+constexpr int   SMOKE_ADC_DENSE = 3000;     // ADC przy gęstym dymie = 100 %
+
+struct SmokeSchedule {
+    uint8_t  pwm;            // poziom kroku, przy sdens - górna granica
+    uint16_t onSec, offSec;  // impulsy, offSec 0 = ciągle
+    uint16_t rampSec;        // dojście od poziomu poprzedniego kroku, 0 = skok
+    float    density;        // cel czujnika [%], 0 = bez regulacji
+};
+
+struct SmokeState {
+    uint32_t startMs;        // start kroku (impulsy, rampa)
+    uint32_t lastMs;
+    uint8_t  fromPwm;        // poziom na starcie rampy
+    float    integ;          // całka PI, ułamek górnej granicy 0..1
+    bool     closedLoop;     // ostatnie wyjście z regulacji czujnikiem
+};
+
+void    smoke_reset(SmokeState& st);                                   // nowy proces
+void    smoke_start_step(SmokeState& st, uint32_t nowMs, uint8_t fromPwm);
+// density - odczyt czujnika [%], NAN = brak
+uint8_t smoke_output(SmokeState& st, const SmokeSchedule& s, uint32_t nowMs, float density);
+// ADC czujnika -> gęstość [%], NAN = czujnik odłączony / zwarty
+float   smoke_density_from_adc(double adc);
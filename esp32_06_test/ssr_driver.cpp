@@ -0,0 +1,255 @@
+// ssr_driver.cpp - Sterownik grzałek przez SSR z przejściem przez zero
+// Takt: esp_timer co półokres sieci (dispatch ESP_TIMER_TASK - wątek esp_timer ma
+// najwyższy priorytet, ISR dispatch wymaga opcji menuconfig niedostępnej w Arduino).
+// Timer nie jest zsynchronizowany z siecią: SSR załącza przy najbliższym przejściu
+// przez zero, więc N taktów załączenia = N przewodzących półokresów.
+#include "ssr_driver.h"
+#include "config.h"
+#include "storage.h"
+#include <esp_timer.h>
+
+static constexpr uint8_t SSR_MODE_MAX = (uint8_t)SsrMode::TIME_PROPORTIONAL;
+static constexpr int32_t PERMILLE = 1000;
+
+static const uint8_t ssrPins[SSR_CHANNELS] = {PIN_SSR1, PIN_SSR2, PIN_SSR3};
+
+struct SsrChannel {
+    int32_t  duty;        // [‰] zadane wypełnienie
+    int32_t  acc;         // zadane - oddane [‰ x półokres], przenoszone między impulsami/oknami
+    uint16_t pulseLeft;   // BURST: pozostałe półokresy bieżącego impulsu
+    uint16_t onTicks;     // TIME_PROPORTIONAL: półokresy załączenia w bieżącym oknie
+    bool     on;
+    uint64_t requested;   // suma zadanego wypełnienia [‰ x półokres]
+    uint32_t delivered;   // półokresy z załączonym wyjściem
+    uint32_t switches;    // liczba załączeń
+    uint32_t onTotal;     // półokresy załączenia od startu - nie zerowane konfiguracją
+};
+
+// Wszystko pod ssrMux - ssr_tick() w wątku esp_timer, reszta z taskControl / WWW
+static portMUX_TYPE ssrMux = portMUX_INITIALIZER_UNLOCKED;
+static SsrChannel   chan[SSR_CHANNELS];
+static SsrConfig    ssrCfg;
+static uint16_t     pulseTicks  = 2;
+static uint16_t     windowTicks = 200;
+static uint16_t     phase = 0;
+static uint32_t     ticks = 0;
+static esp_timer_handle_t ssrTimer = nullptr;
+
+static uint16_t msToTicks(uint16_t ms) {
+    uint32_t t = ((uint32_t)ms * 1000UL + SSR_HALF_CYCLE_US - 1) / SSR_HALF_CYCLE_US;
+    return (uint16_t)(t < 1 ? 1 : t);
+}
+
+static void defaultConfig(SsrConfig& cfg) {
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.mode     = (uint8_t)SsrMode::BURST;
+    cfg.windowMs = SSR_WINDOW_MS_DEFAULT;
+    cfg.minOnMs  = SSR_MIN_ON_MS_DEFAULT;
+}
+
+bool ssr_config_valid(const SsrConfig& cfg) {
+    if (cfg.mode > SSR_MODE_MAX) return false;
+    if (cfg.windowMs < SSR_WINDOW_MS_MIN || cfg.windowMs > SSR_WINDOW_MS_MAX) return false;
+    if ((uint32_t)cfg.minOnMs * 1000UL < SSR_HALF_CYCLE_US) return false;
+    if ((uint32_t)cfg.minOnMs * 2 > cfg.windowMs) return false;
+    return true;
+}
+
+// Pod ssrMux - przeliczenie taktów i reset akumulatorów oraz liczników
+static void applyConfigLocked() {
+    pulseTicks  = msToTicks(ssrCfg.minOnMs);
+    windowTicks = msToTicks(ssrCfg.windowMs);
+    phase = 0;
+    ticks = 0;
+    for (int i = 0; i < SSR_CHANNELS; i++) {
+        SsrChannel& c = chan[i];
+        c.acc = 0;
+        c.pulseLeft = 0;
+        c.onTicks = 0;
+        c.requested = 0;
+        c.delivered = 0;
+        c.switches = 0;
+    }
+}
+
+// Pod ssrMux - decyzja dla jednego kanału w bieżącym półokresie.
+// startBlocked: inny kanał załączył się w tym półokresie - nowy impuls BURST czeka.
+static bool nextStateLocked(SsrChannel& c, bool windowStart, uint16_t chPhase, bool startBlocked) {
+    if (c.duty <= 0) {
+        // Wyłączenie natychmiast. Bilans zostaje (max jedno okno) - zerowany w ssr_all_off()
+        c.pulseLeft = 0;
+        c.onTicks = 0;
+        return false;
+    }
+
+    bool on;
+    if (ssrCfg.mode == (uint8_t)SsrMode::BURST) {
+        // Impuls startuje dopiero gdy akumulator pokrywa cały impuls - reszta zostaje
+        if (c.pulseLeft == 0 && c.acc + c.duty >= PERMILLE * pulseTicks &&
+            !(startBlocked && !c.on)) {
+            c.pulseLeft = pulseTicks;
+        }
+        on = c.pulseLeft > 0;
+        if (on) c.pulseLeft--;
+    } else {
+        if (windowStart) {
+            // Plan okna z bieżącego wypełnienia i długu z poprzednich okien
+            int32_t n = (c.duty * windowTicks + c.acc + PERMILLE / 2) / PERMILLE;
+            if (n < 0) n = 0;
+            if (n > windowTicks) n = windowTicks;
+            // Za krótkie załączenie albo za krótka przerwa - zaokrąglenie, różnica zostaje w acc
+            if (n < pulseTicks) n = 0;
+            else if (windowTicks - n < pulseTicks) n = windowTicks;
+            c.onTicks = (uint16_t)n;
+        }
+        on = chPhase < c.onTicks;
+    }
+    // Zmiany wypełnienia w trakcie okna/impulsu też trafiają do bilansu
+    c.acc += c.duty - (on ? PERMILLE : 0);
+    c.acc = constrain(c.acc, -PERMILLE * windowTicks, PERMILLE * windowTicks);
+    return on;
+}
+
+void ssr_tick() {
+    portENTER_CRITICAL(&ssrMux);
+    ticks++;
+    bool switchedOn = false;
+    for (int i = 0; i < SSR_CHANNELS; i++) {
+        SsrChannel& c = chan[i];
+        // Okno kanału i przesunięte o i/3 okna - początki załączeń nie pokrywają się
+        uint16_t chPhase = (uint16_t)((phase + (uint32_t)i * windowTicks / SSR_CHANNELS) % windowTicks);
+        c.requested += (uint32_t)c.duty;
+        bool on = nextStateLocked(c, chPhase == 0, chPhase, switchedOn);
+        if (on) {
+            c.delivered++;
+            c.onTotal++;
+        }
+        if (on != c.on) {
+            c.on = on;
+            if (on) {
+                c.switches++;
+                switchedOn = true;
+            }
+            digitalWrite(ssrPins[i], on ? HIGH : LOW);
+        }
+    }
+    phase = (uint16_t)((phase + 1) % windowTicks);
+    portEXIT_CRITICAL(&ssrMux);
+}
+
+static void ssrTimerCb(void*) {
+    ssr_tick();
+}
+
+void ssr_set_duty(int ch, double percent) {
+    if (ch < 0 || ch >= SSR_CHANNELS) return;
+    int32_t d = (int32_t)lround(constrain(percent, 0.0, 100.0) * 10.0);
+    portENTER_CRITICAL(&ssrMux);
+    chan[ch].duty = d;
+    if (d == 0 && chan[ch].on) {
+        chan[ch].on = false;
+        digitalWrite(ssrPins[ch], LOW);
+    }
+    portEXIT_CRITICAL(&ssrMux);
+}
+
+void ssr_all_off() {
+    portENTER_CRITICAL(&ssrMux);
+    for (int i = 0; i < SSR_CHANNELS; i++) {
+        SsrChannel& c = chan[i];
+        c.duty = 0;
+        c.acc = 0;
+        c.pulseLeft = 0;
+        c.onTicks = 0;
+        c.on = false;
+        digitalWrite(ssrPins[i], LOW);
+    }
+    portEXIT_CRITICAL(&ssrMux);
+}
+
+bool ssr_is_on(int ch) {
+    if (ch < 0 || ch >= SSR_CHANNELS) return false;
+    return chan[ch].on;
+}
+
+void ssr_on_counts(uint32_t out[SSR_CHANNELS]) {
+    portENTER_CRITICAL(&ssrMux);
+    for (int i = 0; i < SSR_CHANNELS; i++) out[i] = chan[i].onTotal;
+    portEXIT_CRITICAL(&ssrMux);
+}
+
+void ssr_init() {
+    SsrConfig cfg;
+    if (!storage_load_blob_nvs("ssr_cfg", &cfg, sizeof(cfg)) || !ssr_config_valid(cfg)) {
+        defaultConfig(cfg);
+    }
+    for (int i = 0; i < SSR_CHANNELS; i++) {
+        pinMode(ssrPins[i], OUTPUT);
+        digitalWrite(ssrPins[i], LOW);
+    }
+    portENTER_CRITICAL(&ssrMux);
+    ssrCfg = cfg;
+    applyConfigLocked();
+    portEXIT_CRITICAL(&ssrMux);
+
+    if (!ssrTimer) {
+        esp_timer_create_args_t args = {};
+        args.callback = ssrTimerCb;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "ssr";
+        if (esp_timer_create(&args, &ssrTimer) != ESP_OK ||
+            esp_timer_start_periodic(ssrTimer, SSR_HALF_CYCLE_US) != ESP_OK) {
+            log_msg(LOG_LEVEL_ERROR, "SSR timer start failed - heaters disabled");
+            return;
+        }
+    }
+    LOG_FMT(LOG_LEVEL_INFO, "SSR driver: %s, window=%ums, min_on=%ums",
+            cfg.mode == (uint8_t)SsrMode::BURST ? "burst" : "time-proportional",
+            cfg.windowMs, cfg.minOnMs);
+}
+
+bool ssr_get_config(SsrConfig& cfg) {
+    portENTER_CRITICAL(&ssrMux);
+    cfg = ssrCfg;
+    portEXIT_CRITICAL(&ssrMux);
+    return true;
+}
+
+bool ssr_set_config(const SsrConfig& cfg, bool persist) {
+    if (!ssr_config_valid(cfg)) return false;
+    portENTER_CRITICAL(&ssrMux);
+    ssrCfg = cfg;
+    applyConfigLocked();
+    portEXIT_CRITICAL(&ssrMux);
+    if (persist) storage_save_blob_nvs("ssr_cfg", &cfg, sizeof(cfg));
+    return true;
+}
+
+// requested / delivered - średnie wypełnienie [%] od ostatniej zmiany konfiguracji
+String ssr_json() {
+    SsrConfig cfg;
+    SsrChannel c[SSR_CHANNELS];
+    uint32_t n;
+    portENTER_CRITICAL(&ssrMux);
+    cfg = ssrCfg;
+    memcpy(c, chan, sizeof(c));
+    n = ticks;
+    portEXIT_CRITICAL(&ssrMux);
+
+    char buf[512];
+    int len = snprintf(buf, sizeof(buf),
+        "{\"mode\":\"%s\",\"window_ms\":%u,\"min_on_ms\":%u,\"half_cycle_us\":%lu,"
+        "\"ticks\":%lu,\"channels\":[",
+        cfg.mode == (uint8_t)SsrMode::BURST ? "burst" : "time_proportional",
+        cfg.windowMs, cfg.minOnMs, (unsigned long)SSR_HALF_CYCLE_US, (unsigned long)n);
+    for (int i = 0; i < SSR_CHANNELS && len < (int)sizeof(buf); i++) {
+        double req = n ? c[i].requested / (n * 10.0) : 0.0;
+        double del = n ? c[i].delivered * 100.0 / n : 0.0;
+        len += snprintf(buf + len, sizeof(buf) - len,
+            "%s{\"duty\":%.1f,\"on\":%s,\"requested\":%.2f,\"delivered\":%.2f,\"switches\":%lu}",
+            i ? "," : "", c[i].duty / 10.0, c[i].on ? "true" : "false", req, del,
+            (unsigned long)c[i].switches);
+    }
+    if (len < (int)sizeof(buf)) snprintf(buf + len, sizeof(buf) - len, "]}");
+    return String(buf);
+}
@@ -0,0 +1,40 @@
+// ssr_driver.h - Sterownik grzałek przez SSR z przejściem przez zero
+// [NEW] Zamiast LEDC 5 kHz (SSR zero-cross nie nadąża - moc nieliniowa względem
+//       wypełnienia). Wyjścia przełączane co półokres sieci z esp_timer:
+//         BURST             - impulsy po minOnMs rozłożone równomiernie (sigma-delta),
+//         TIME_PROPORTIONAL - jedno załączenie na okno windowMs.
+//       Reszta z zaokrąglenia przechodzi na następny impuls/okno, więc oddana
+//       energia = zadana moc x czas, także przy wypełnieniach krótszych od minOnMs.
+// [NEW] Rozsunięcie kanałów: okna TIME_PROPORTIONAL przesunięte o 1/3 okna, w BURST
+//       najwyżej jedno załączenie na półokres (następne czeka takt, bilans zostaje).
+#pragma once
+#include <Arduino.h>
+
+constexpr int SSR_CHANNELS = 3;
+
+enum class SsrMode : uint8_t {
+    BURST             = 0,
+    TIME_PROPORTIONAL = 1
+};
+
+// Konfiguracja - blob NVS "ssr_cfg", układ stały
+struct SsrConfig {
+    uint8_t  mode;        // SsrMode
+    uint8_t  reserved;
+    uint16_t windowMs;    // okno TIME_PROPORTIONAL
+    uint16_t minOnMs;     // najkrótsze załączenie (i przerwa w TIME_PROPORTIONAL)
+    uint16_t reserved2;
+};
+
+// Piny, konfiguracja z NVS, start timera (hardware_init_ledc)
+void ssr_init();
+void ssr_set_duty(int ch, double percent);   // 0..100, działa od następnego półokresu
+void ssr_all_off();                          // natychmiast, razem z akumulatorami
+bool ssr_is_on(int ch);
+void ssr_on_counts(uint32_t out[SSR_CHANNELS]);   // [NEW] półokresy załączenia od startu (licznik zawija się)
+void ssr_tick();                             // jeden półokres - z timera lub symulatora
+
+bool   ssr_config_valid(const SsrConfig& cfg);
+bool   ssr_get_config(SsrConfig& cfg);
+bool   ssr_set_config(const SsrConfig& cfg, bool persist);
+String ssr_json();
@@ -1,6 +1,12 @@
 // state.cpp - Zoptymalizowana wersja z timeoutami i statystykami
-// [MOD] Dodano g_tChamber1, g_tChamber2
+// [MOD] Tablica kanałów czujników zamiast g_tChamber1/g_tChamber2
+// [NEW] Seqlock ProcessSnapshot + liczniki rywalizacji o mutexy
 #include "state.h"
+#include "storage.h"
+#include "outputs.h"
+#include "energy.h"
+#include <esp_timer.h>
+#include <atomic>
 
 // Definicje obiektów globalnych
 Adafruit_ST7735 display(TFT_CS, TFT_DC, TFT_RST);
@@ -20,10 +26,17 @@ SemaphoreHandle_t heaterMutex = NULL;
 volatile ProcessState g_currentState = ProcessState::IDLE;
 RunMode g_lastRunMode = RunMode::MODE_AUTO;
 volatile double g_tSet = 70.0;
-volatile double g_tChamber = 25.0;       // średnia z dwóch DS18B20
-volatile double g_tChamber1 = 25.0;      // [NEW] DS18B20 #1
-volatile double g_tChamber2 = 25.0;      // [NEW] DS18B20 #2
-volatile double g_tMeat = 25.0;          // [MOD] teraz z NTC 100k
+volatile double g_tChamber = 25.0;       // średnia z kanałów CHAMBER
+volatile double g_tMeat = 25.0;          // najzimniejsza sonda MEAT
+volatile double g_tAmbient = NAN;        // średnia z kanałów AMBIENT
+volatile float g_tChamberSpread = NAN;   // [NEW] rozwarstwienie komory
+volatile float g_smokeDensity = NAN;     // [NEW] czujnik dymu
+volatile double g_tChamberEst = 25.0;    // estymata powietrza (process.cpp)
+volatile uint32_t g_sensorSeq = 0;
+
+SensorChannel g_sensorChannels[MAX_SENSOR_CHANNELS];
+SensorReading g_sensorReadings[MAX_SENSOR_CHANNELS];
+int g_sensorChannelCount = 0;
 
 volatile int g_powerMode = 1;
 volatile int g_manualSmokePwm = 0;
@@ -37,36 +50,58 @@ volatile bool g_errorProfile = false;
 volatile double g_ntcAdc        = 0.0;
 volatile double g_ntcResistance = 0.0;
 
-Step g_profile[MAX_STEPS];
+ProfileArena* g_profile = nullptr;
 int g_stepCount = 0;
 int g_currentStep = 0;
 unsigned long g_processStartTime = 0;
 unsigned long g_stepStartTime = 0;
 
 // Statystyki procesu
-ProcessStats g_processStats = {0, 0, 0, 0, 0.0, 0, 0, 0};
+ProcessStats g_processStats = {0, 0, 0, 0, 0.0, 0, 0, 0, false, -1, 0.0f, 0, 0.0f, 0};
 
-// Funkcje blokowania z timeoutami
-bool state_lock(TickType_t timeout_ms) {
-    if (!stateMutex) return false;
-    if (xSemaphoreTake(stateMutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
-        log_msg(LOG_LEVEL_WARN, "state_lock timeout!");
+// [NEW] Statystyki mutexów - takes/contended/czas czekania zmieniane tylko
+// przez właściciela mutexa, timeouty atomowo (bez mutexa)
+struct LockStats {
+    uint32_t takes;          // wszystkie udane wzięcia
+    uint32_t contended;      // w tym po czekaniu (mutex był zajęty)
+    uint64_t waitUsTotal;
+    uint32_t waitUsMax;
+    std::atomic<uint32_t> timeouts{0};
+};
+
+static LockStats stateStats, outputStats, heaterStats;
+
+static bool timedLock(SemaphoreHandle_t m, LockStats& st, TickType_t timeout_ms, const char* warn) {
+    if (!m) return false;
+    if (xSemaphoreTake(m, 0) == pdTRUE) {
+        st.takes++;
+        return true;
+    }
+    int64_t t0 = esp_timer_get_time();
+    if (xSemaphoreTake(m, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        st.timeouts.fetch_add(1, std::memory_order_relaxed);
+        log_msg(LOG_LEVEL_WARN, warn);
         return false;
     }
+    uint32_t waited = (uint32_t)(esp_timer_get_time() - t0);
+    st.takes++;
+    st.contended++;
+    st.waitUsTotal += waited;
+    if (waited > st.waitUsMax) st.waitUsMax = waited;
     return true;
 }
 
+// Funkcje blokowania z timeoutami
+bool state_lock(TickType_t timeout_ms) {
+    return timedLock(stateMutex, stateStats, timeout_ms, "state_lock timeout!");
+}
+
 void state_unlock() {
     if (stateMutex) xSemaphoreGive(stateMutex);
 }
 
 bool output_lock(TickType_t timeout_ms) {
-    if (!outputMutex) return false;
-    if (xSemaphoreTake(outputMutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
-        log_msg(LOG_LEVEL_WARN, "output_lock timeout!");
-        return false;
-    }
-    return true;
+    return timedLock(outputMutex, outputStats, timeout_ms, "output_lock timeout!");
 }
 
 void output_unlock() {
@@ -74,21 +109,132 @@ void output_unlock() {
 }
 
 bool heater_lock(TickType_t timeout_ms) {
-    if (!heaterMutex) return false;
-    if (xSemaphoreTake(heaterMutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
-        log_msg(LOG_LEVEL_WARN, "heater_lock timeout!");
-        return false;
-    }
-    return true;
+    return timedLock(heaterMutex, heaterStats, timeout_ms, "heater_lock timeout!");
 }
 
 void heater_unlock() {
     if (heaterMutex) xSemaphoreGive(heaterMutex);
 }
 
+// ======================================================
+// [NEW] MIGAWKA STANU (seqlock)
+// ======================================================
+// Jeden pisarz (taskControl pod state_lock). Czytelnik kopiuje całą strukturę
+// i sprawdza, czy licznik się nie zmienił - nigdy nie czeka na state_lock.
+// Control ma najwyższy priorytet, więc czytelnik z tego samego rdzenia nie
+// przerwie zapisu; po kilku nieudanych próbach oddaje CPU (drugi rdzeń).
+
+static constexpr int SNAPSHOT_SPIN_LIMIT = 8;
+
+static ProcessSnapshot       snapshot;
+static std::atomic<uint32_t> snapshotSeq{0};
+static std::atomic<uint32_t> snapshotReads{0};
+static std::atomic<uint32_t> snapshotRetries{0};
+
+void state_snapshot_publish_locked() {
+    uint32_t s = snapshotSeq.load(std::memory_order_relaxed);
+    snapshotSeq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    ProcessSnapshot& p = snapshot;
+    p.seq            = s / 2 + 1;
+    p.publishedMs    = millis();
+    p.state          = g_currentState;
+    p.tChamber       = g_tChamber;
+    p.tChamberEst    = g_tChamberEst;
+    p.tMeat          = g_tMeat;
+    p.tAmbient       = g_tAmbient;
+    p.tSet           = g_tSet;
+    p.pidOutput      = pidOutput;
+    p.ntcAdc         = g_ntcAdc;
+    p.ntcResistance  = g_ntcResistance;
+    p.powerMode      = g_powerMode;
+    p.fanMode        = g_fanMode;
+    p.manualSmokePwm = g_manualSmokePwm;
+    p.fanOnTime      = g_fanOnTime;
+    p.fanOffTime     = g_fanOffTime;
+    p.doorOpen       = g_doorOpen;
+    p.errorSensor    = g_errorSensor;
+    p.errorOverheat  = g_errorOverheat;
+    p.currentStep    = g_currentStep;
+    p.stepCount      = g_stepCount;
+    bool hasStep = g_currentStep >= 0 && g_currentStep < g_stepCount;
+    strncpy(p.stepName, hasStep ? profile_step_name(g_profile, g_currentStep) : "", sizeof(p.stepName) - 1);
+    p.stepName[sizeof(p.stepName) - 1] = '\0';
+    p.stepMinTimeMs  = hasStep ? profile_steps(g_profile)[g_currentStep].minTimeSec * 1000UL : 0;
+    p.processStartTime = g_processStartTime;
+    p.stepStartTime  = g_stepStartTime;
+    p.remainingProcessTimeSec = g_processStats.remainingProcessTimeSec;
+    p.remainingOpen  = g_processStats.remainingOpen;
+    p.meatEtaSec     = g_processStats.meatEtaSec;
+    p.meatEtaConf    = g_processStats.meatEtaConf;
+    p.heaterFaultMask  = g_processStats.heaterFaultMask;
+    p.heatersEffective = g_processStats.heatersEffective;
+    p.energyWh       = (float)energy_wh(g_processStats.energyUj);
+    p.stepEnergyWh   = hasStep ? (float)energy_wh(profile_step_energy(g_profile)[g_currentStep]) : 0;
+    p.smokeOut       = outputs_smoke();
+    p.smokeDensity   = g_smokeDensity;
+    p.sensorSeq      = g_sensorSeq;
+    p.channelCount   = g_sensorChannelCount;
+    memcpy(p.channels, g_sensorChannels, sizeof(SensorChannel) * g_sensorChannelCount);
+    memcpy(p.readings, g_sensorReadings, sizeof(SensorReading) * g_sensorChannelCount);
+    strncpy(p.profilePath, storage_get_profile_path(), sizeof(p.profilePath) - 1);
+    p.profilePath[sizeof(p.profilePath) - 1] = '\0';
+
+    std::atomic_thread_fence(std::memory_order_release);
+    snapshotSeq.store(s + 2, std::memory_order_release);
+}
+
+void state_snapshot_read(ProcessSnapshot& out) {
+    for (int attempt = 0; ; attempt++) {
+        uint32_t s1 = snapshotSeq.load(std::memory_order_acquire);
+        if ((s1 & 1) == 0) {
+            memcpy(&out, &snapshot, sizeof(out));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (snapshotSeq.load(std::memory_order_relaxed) == s1) break;
+        }
+        snapshotRetries.fetch_add(1, std::memory_order_relaxed);
+        if (attempt >= SNAPSHOT_SPIN_LIMIT) vTaskDelay(1);
+    }
+    snapshotReads.fetch_add(1, std::memory_order_relaxed);
+}
+
+static int lockStatsJson(char* buf, size_t size, const char* name, const LockStats& st) {
+    // Odczyt bez mutexa - liczniki 32-bit, wartości przybliżone
+    uint32_t takes = st.takes, contended = st.contended;
+    uint64_t waitTotal = st.waitUsTotal;
+    return snprintf(buf, size,
+                    "\"%s\":{\"takes\":%lu,\"contended\":%lu,\"contended_pct\":%.2f,"
+                    "\"timeouts\":%lu,\"wait_avg_us\":%lu,\"wait_max_us\":%lu}",
+                    name, (unsigned long)takes, (unsigned long)contended,
+                    takes ? contended * 100.0 / takes : 0.0,
+                    (unsigned long)st.timeouts.load(std::memory_order_relaxed),
+                    (unsigned long)(contended ? waitTotal / contended : 0),
+                    (unsigned long)st.waitUsMax);
+}
+
+String state_lock_stats_json() {
+    char buf[640];
+    int len = snprintf(buf, sizeof(buf), "{");
+    len += lockStatsJson(buf + len, sizeof(buf) - len, "state", stateStats);
+    len += snprintf(buf + len, sizeof(buf) - len, ",");
+    len += lockStatsJson(buf + len, sizeof(buf) - len, "output", outputStats);
+    len += snprintf(buf + len, sizeof(buf) - len, ",");
+    len += lockStatsJson(buf + len, sizeof(buf) - len, "heater", heaterStats);
+    unsigned long publishedMs = snapshot.publishedMs;
+    snprintf(buf + len, sizeof(buf) - len,
+             ",\"snapshot\":{\"published\":%lu,\"reads\":%lu,\"retries\":%lu,\"age_ms\":%lu}}",
+             (unsigned long)(snapshotSeq.load(std::memory_order_relaxed) / 2),
+             (unsigned long)snapshotReads.load(std::memory_order_relaxed),
+             (unsigned long)snapshotRetries.load(std::memory_order_relaxed),
+             millis() - publishedMs);
+    return String(buf);
+}
+
 void init_state() {
     stateMutex = xSemaphoreCreateMutex();
     outputMutex = xSemaphoreCreateMutex();
     heaterMutex = xSemaphoreCreateMutex();
+    state_snapshot_publish_locked();   // [NEW] wartości startowe przed pierwszym tickiem
     log_msg(LOG_LEVEL_INFO, "State mutexes initialized");
 }
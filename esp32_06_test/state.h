@@ -1,11 +1,13 @@
 // state.h - Zoptymalizowana wersja
-// [MOD] Dodano g_tChamber1, g_tChamber2 dla dwóch czujników DS18B20 komory
+// [MOD] Odczyty czujników jako tablica kanałów (g_sensorChannels/g_sensorReadings)
+// [NEW] ProcessSnapshot - spójna kopia stanu dla czytelników (seqlock) + statystyki mutexów
 #pragma once
 #include <Adafruit_ST7735.h>
 #include <DallasTemperature.h>
 #include <PID_v1.h>
 #include <WebServer.h>
 #include "config.h"
+#include "profile_store.h"
 
 // Deklaracje extern dla obiektów globalnych
 extern Adafruit_ST7735 display;
@@ -28,10 +30,18 @@ extern double pidSetpoint;
 extern volatile ProcessState g_currentState;
 extern RunMode g_lastRunMode;
 extern volatile double g_tSet;
-extern volatile double g_tChamber;      // średnia temperatura komory
-extern volatile double g_tChamber1;     // [NEW] DS18B20 #1 - komora
-extern volatile double g_tChamber2;     // [NEW] DS18B20 #2 - komora
-extern volatile double g_tMeat;         // [MOD] teraz z NTC 100k
+extern volatile double g_tChamber;      // średnia z kanałów CHAMBER
+extern volatile double g_tMeat;         // najzimniejsza sonda MEAT
+extern volatile double g_tAmbient;      // [NEW] średnia kanałów AMBIENT, NAN gdy brak
+extern volatile float g_tChamberSpread;  // [NEW] max-min czujników CHAMBER, NAN gdy < 2
+extern volatile float g_smokeDensity;   // [NEW] kanały roli SMOKE (analogowe) [%], NAN gdy brak
+extern volatile double g_tChamberEst;   // [NEW] estymata temperatury powietrza (obserwator)
+extern volatile uint32_t g_sensorSeq;   // [NEW] licznik cykli ze świeżym pomiarem komory
+
+// [NEW] Tablica kanałów i odczyty - pod state_lock, publikowane raz na cykl czujników
+extern SensorChannel g_sensorChannels[MAX_SENSOR_CHANNELS];
+extern SensorReading g_sensorReadings[MAX_SENSOR_CHANNELS];
+extern int g_sensorChannelCount;
 extern volatile int g_powerMode;
 extern volatile int g_manualSmokePwm;
 extern volatile int g_fanMode;
@@ -42,7 +52,7 @@ extern volatile bool g_errorSensor;
 extern volatile bool g_errorOverheat;
 extern volatile bool g_errorProfile;
 
-extern Step g_profile[MAX_STEPS];
+extern ProfileArena* g_profile;   // [MOD] arena profilu, g_stepCount = liczba kroków w niej
 extern int g_stepCount;
 extern int g_currentStep;
 extern unsigned long g_processStartTime;
@@ -52,8 +62,8 @@ extern unsigned long g_stepStartTime;
 extern ProcessStats g_processStats;
 
 // WebServer
-inline const char* processStateStr() {
-  switch (g_currentState) {
+inline const char* processStateStr(ProcessState st) {
+  switch (st) {
     case ProcessState::IDLE:               return "IDLE";
     case ProcessState::RUNNING_AUTO:       return "RUNNING_AUTO";
     case ProcessState::RUNNING_MANUAL:     return "RUNNING_MANUAL";
@@ -64,12 +74,56 @@ inline const char* processStateStr() {
     case ProcessState::ERROR_PROFILE:      return "ERROR_PROFILE";
     case ProcessState::SOFT_RESUME:        return "SOFT_RESUME";
     case ProcessState::PAUSE_HEATER_FAULT: return "PAUSE_HEATER_FAULT";
+    case ProcessState::AUTOTUNE:           return "AUTOTUNE";
     default:                               return "IDLE";
   }
 }
 
+inline const char* processStateStr() {
+  return processStateStr(g_currentState);
+}
+
+// [NEW] Migawka stanu procesu dla UI / WWW / chmury.
+// Zapis: taskControl raz na tick pod state_lock (który i tak bierze) - jeden pisarz.
+// Odczyt: bez mutexa, licznik sekwencji (nieparzysty = zapis w toku, powtórz kopię).
+struct ProcessSnapshot {
+    uint32_t      seq;                      // numer publikacji
+    unsigned long publishedMs;
+    ProcessState  state;
+    double        tChamber, tChamberEst, tMeat, tAmbient, tSet;
+    double        pidOutput;
+    double        ntcAdc, ntcResistance;
+    int           powerMode, fanMode, manualSmokePwm;
+    unsigned long fanOnTime, fanOffTime;
+    bool          doorOpen, errorSensor, errorOverheat;
+    int           currentStep, stepCount;
+    char          stepName[32];             // "" gdy brak kroku
+    unsigned long stepMinTimeMs;
+    unsigned long processStartTime, stepStartTime;
+    unsigned long remainingProcessTimeSec;
+    bool          remainingOpen;            // [NEW] czas orientacyjny (kroki z exit=)
+    long          meatEtaSec;               // [NEW] -1 = brak prognozy
+    float         meatEtaConf;
+    uint8_t       heaterFaultMask;          // [NEW] bit i = grzałka i+1 martwa
+    float         heatersEffective;
+    float         energyWh;                 // [NEW] energia grzałek w procesie
+    float         stepEnergyWh;             // [NEW] energia bieżącego kroku
+    int           smokeOut;                 // [NEW] PWM dymu faktycznie na wyjściu
+    float         smokeDensity;             // [NEW] NAN = brak czujnika
+    uint32_t      sensorSeq;
+    int           channelCount;
+    SensorChannel channels[MAX_SENSOR_CHANNELS];
+    SensorReading readings[MAX_SENSOR_CHANNELS];
+    char          profilePath[64];
+};
+
+void state_snapshot_publish_locked();            // pod state_lock
+void state_snapshot_read(ProcessSnapshot& out);  // dowolny task, bez blokowania
+String state_lock_stats_json();                  // /api/locks
+
 
 // Funkcje pomocnicze do blokowania z timeoutami
+// [MOD] Każde wzięcie liczone: od razu / po czekaniu (czas czekania) / timeout
 bool state_lock(TickType_t timeout_ms = CFG_MUTEX_TIMEOUT_MS);
 void state_unlock();
 bool output_lock(TickType_t timeout_ms = CFG_MUTEX_TIMEOUT_MS);
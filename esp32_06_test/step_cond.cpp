@@ -0,0 +1,267 @@
+// step_cond.cpp - Kompilacja i wykonanie warunków exit= (patrz step_cond.h)
+#include "step_cond.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+// Kod stosowy: OP_K i, OP_VAR v - na stos; porównania i logika zdejmują dwa
+// (NOT jeden) i kładą 0/1; OP_STABLE slot kB kM - na stos 0/1
+enum : uint8_t {
+    OP_K, OP_VAR, OP_LT, OP_LE, OP_GT, OP_GE, OP_AND, OP_OR, OP_NOT, OP_STABLE
+};
+
+static const struct { const char* name; CondVar var; } VAR_NAMES[] = {
+    {"chamber", COND_V_CHAMBER}, {"meat", COND_V_MEAT}, {"ambient", COND_V_AMBIENT},
+    {"set", COND_V_SET}, {"target", COND_V_TARGET}, {"time", COND_V_TIME},
+    {"mintime", COND_V_MINTIME}, {"total", COND_V_TOTAL}, {"smoke", COND_V_SMOKE},
+};
+
+// ======================================================
+// KOMPILACJA - zejście rekurencyjne, kod w kolejności postfiksowej
+// ======================================================
+
+struct Compiler {
+    const char* src;
+    const char* p;
+    StepCond*   out;
+    uint8_t     nConst;
+    uint8_t     nStable;
+    int         depth, maxDepth;
+    int         nest;       // [FIX] bieżące zagnieżdżenie ( / ! - rekursja ograniczona
+    const char* err;
+    const char* errAt;
+};
+
+static bool fail(Compiler& c, const char* msg) {
+    if (!c.err) {
+        c.err = msg;
+        c.errAt = c.p;
+    }
+    return false;
+}
+
+static void skipSpace(Compiler& c) {
+    while (*c.p == ' ' || *c.p == '\t') c.p++;
+}
+
+static bool emit(Compiler& c, uint8_t b) {
+    if (c.out->len >= COND_MAX_CODE) return fail(c, "expression too long");
+    c.out->code[c.out->len++] = b;
+    return true;
+}
+
+static bool push(Compiler& c) {
+    if (++c.depth > c.maxDepth) c.maxDepth = c.depth;
+    return c.depth <= COND_MAX_STACK || fail(c, "expression too deep");
+}
+
+static bool addConst(Compiler& c, float v, uint8_t& idx) {
+    for (uint8_t i = 0; i < c.nConst; i++) {
+        if (c.out->k[i] == v) { idx = i; return true; }
+    }
+    if (c.nConst >= COND_MAX_CONST) return fail(c, "too many constants");
+    c.out->k[c.nConst] = v;
+    idx = c.nConst++;
+    return true;
+}
+
+// Słowo kluczowe / nazwa: litery, bez rozróżniania wielkości
+static int wordLen(const char* p) {
+    int n = 0;
+    while (isalpha((unsigned char)p[n])) n++;
+    return n;
+}
+
+static bool acceptWord(Compiler& c, const char* w) {
+    skipSpace(c);
+    int n = wordLen(c.p);
+    if (n != (int)strlen(w) || strncasecmp(c.p, w, n) != 0) return false;
+    c.p += n;
+    return true;
+}
+
+static bool acceptSym(Compiler& c, const char* s) {
+    skipSpace(c);
+    size_t n = strlen(s);
+    if (strncmp(c.p, s, n) != 0) return false;
+    c.p += n;
+    return true;
+}
+
+static bool number(Compiler& c, float& v) {
+    skipSpace(c);
+    char* end;
+    v = strtof(c.p, &end);
+    if (end == c.p || !isfinite(v)) return fail(c, "number expected");
+    c.p = end;
+    return true;
+}
+
+static bool operand(Compiler& c) {
+    skipSpace(c);
+    int n = wordLen(c.p);
+    if (n > 0) {
+        for (const auto& vn : VAR_NAMES) {
+            if ((int)strlen(vn.name) == n && strncasecmp(c.p, vn.name, n) == 0) {
+                c.p += n;
+                return emit(c, OP_VAR) && emit(c, vn.var) && push(c);
+            }
+        }
+        return fail(c, "unknown variable");
+    }
+    float v;
+    uint8_t idx;
+    return number(c, v) && addConst(c, v, idx) && emit(c, OP_K) && emit(c, idx) && push(c);
+}
+
+static bool relop(Compiler& c, uint8_t& op) {
+    // Dłuższe najpierw; ≤ ≥ w UTF-8
+    if (acceptSym(c, "<=") || acceptSym(c, "\xE2\x89\xA4")) op = OP_LE;
+    else if (acceptSym(c, ">=") || acceptSym(c, "\xE2\x89\xA5")) op = OP_GE;
+    else if (acceptSym(c, "<")) op = OP_LT;
+    else if (acceptSym(c, ">")) op = OP_GT;
+    else return fail(c, "comparison expected");
+    return true;
+}
+
+static bool orExpr(Compiler& c);
+
+// Zejście o poziom - COND_MAX_STACK liczy tylko operandy, a "((((..." albo "!!!!..."
+// do 160 znaków exit= to ~20 KB stosu (taskWeb przy ładowaniu profilu)
+static bool enter(Compiler& c) {
+    return ++c.nest <= COND_MAX_NEST || fail(c, "expression too deep");
+}
+
+static bool primary(Compiler& c) {
+    if (acceptSym(c, "(")) {
+        if (!enter(c)) return false;
+        bool ok = orExpr(c) && (acceptSym(c, ")") || fail(c, "')' expected"));
+        c.nest--;
+        return ok;
+    }
+    const char* save = c.p;
+    if (acceptWord(c, "stable")) {
+        float band, mins;
+        uint8_t kb, km;
+        if (!acceptSym(c, "(")) return fail(c, "'(' expected");
+        if (!number(c, band)) return false;
+        if (!acceptSym(c, ",")) return fail(c, "',' expected");
+        if (!number(c, mins)) return false;
+        if (!acceptSym(c, ")")) return fail(c, "')' expected");
+        if (band <= 0 || mins < 0) return fail(c, "stable(band>0, minutes>=0)");
+        if (c.nStable >= COND_MAX_STABLE) return fail(c, "too many stable()");
+        return addConst(c, band, kb) && addConst(c, mins, km) &&
+               emit(c, OP_STABLE) && emit(c, c.nStable++) && emit(c, kb) && emit(c, km) && push(c);
+    }
+    c.p = save;
+    uint8_t op;
+    if (!operand(c) || !relop(c, op) || !operand(c)) return false;
+    c.depth--;
+    return emit(c, op);
+}
+
+static bool notExpr(Compiler& c) {
+    if (acceptSym(c, "!") || acceptWord(c, "not")) {
+        if (!enter(c)) return false;
+        bool ok = notExpr(c) && emit(c, OP_NOT);
+        c.nest--;
+        return ok;
+    }
+    return primary(c);
+}
+
+static bool andExpr(Compiler& c) {
+    if (!notExpr(c)) return false;
+    while (acceptSym(c, "&&") || acceptSym(c, "&") || acceptWord(c, "and")) {
+        if (!notExpr(c)) return false;
+        c.depth--;
+        if (!emit(c, OP_AND)) return false;
+    }
+    return true;
+}
+
+static bool orExpr(Compiler& c) {
+    if (!andExpr(c)) return false;
+    while (acceptSym(c, "||") || acceptSym(c, "|") || acceptWord(c, "or")) {
+        if (!andExpr(c)) return false;
+        c.depth--;
+        if (!emit(c, OP_OR)) return false;
+    }
+    return true;
+}
+
+bool cond_compile(const char* src, StepCond& out, const char** errMsg, int* errPos) {
+    memset(&out, 0, sizeof(out));
+    Compiler c = {};
+    c.src = c.p = src;
+    c.out = &out;
+    bool ok = orExpr(c);
+    if (ok) {
+        skipSpace(c);
+        if (*c.p) ok = fail(c, "unexpected text");
+    }
+    out.nk = c.nConst;
+    if (!ok) {
+        memset(&out, 0, sizeof(out));
+        if (errMsg) *errMsg = c.err;
+        if (errPos) *errPos = (int)(c.errAt - src);
+        return false;
+    }
+    return true;
+}
+
+// ======================================================
+// WYKONANIE - bez alokacji, najwyżej COND_MAX_CODE kroków
+// ======================================================
+
+void cond_reset(CondState& st) {
+    memset(&st, 0, sizeof(st));
+}
+
+bool cond_eval(const StepCond& c, const float* v, CondState& st, uint32_t nowMs) {
+    float stack[COND_MAX_STACK];
+    int sp = 0;
+    for (int pc = 0; pc < c.len; ) {
+        uint8_t op = c.code[pc++];
+        switch (op) {
+            case OP_K:   stack[sp++] = c.k[c.code[pc++]]; break;
+            case OP_VAR: stack[sp++] = v[c.code[pc++]]; break;
+            case OP_NOT: stack[sp - 1] = stack[sp - 1] != 0 ? 0.0f : 1.0f; break;
+            case OP_STABLE: {
+                uint8_t slot = c.code[pc];
+                float band = c.k[c.code[pc + 1]];
+                float mins = c.k[c.code[pc + 2]];
+                pc += 3;
+                // Liczone co tick - czas w paśmie ciągnie się także gdy reszta wyrażenia fałszywa
+                float dev = fabsf(v[COND_V_CHAMBER] - v[COND_V_SET]);
+                bool in = dev <= band;   // NAN -> false
+                if (!in) {
+                    st.inBand[slot] = false;
+                } else if (!st.inBand[slot]) {
+                    st.inBand[slot] = true;
+                    st.sinceMs[slot] = nowMs;
+                }
+                stack[sp++] = in && nowMs - st.sinceMs[slot] >= (uint32_t)(mins * 60000.0f) ? 1.0f : 0.0f;
+                break;
+            }
+            default: {
+                float b = stack[--sp];
+                float a = stack[sp - 1];
+                bool r;
+                switch (op) {
+                    case OP_LT:  r = a < b; break;
+                    case OP_LE:  r = a <= b; break;
+                    case OP_GT:  r = a > b; break;
+                    case OP_GE:  r = a >= b; break;
+                    case OP_AND: r = a != 0 && b != 0; break;
+                    default:     r = a != 0 || b != 0; break;   // OP_OR
+                }
+                stack[sp - 1] = r ? 1.0f : 0.0f;
+                break;
+            }
+        }
+    }
+    return sp > 0 && stack[sp - 1] != 0;
+}
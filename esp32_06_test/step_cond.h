@@ -0,0 +1,48 @@
+// step_cond.h - Warunki zakończenia kroku profilu (pole exit= w .prof)
+// [NEW] Krok kończył się tylko po minTime i (useMeatTemp) rdzeniu >= tMeat.
+//       exit= zastępuje ten warunek wyrażeniem, np.:
+//         exit=meat>=68 & time>=30
+//         exit=stable(1,10) | time>=240
+//         exit=(meat>=target & time>=mintime) | total>=600
+//       Zmienne: chamber, meat, ambient, set (setpoint komory), target (tMeat
+//       kroku) [°C]; time, mintime (czas / minTime kroku), total (od startu
+//       procesu) [min]; smoke - gęstość dymu [%].
+//       stable(B,M) - komora w paśmie set±B °C nieprzerwanie od M min.
+//       Porównania < <= > >= (także ≤ ≥), łączenie & | ! albo and or not, nawiasy.
+//       Brak odczytu (NAN) - każde porównanie z nim fałszywe.
+//       Kompilowane raz przy parsowaniu profilu (storage_load_profile) do kodu
+//       stosowego o stałym rozmiarze w Step; taskControl liczy go co tick bez
+//       alokacji, koszt ograniczony COND_MAX_CODE. Czysty C++ - także w symulatorze.
+#pragma once
+#include <stdint.h>
+
+constexpr int COND_MAX_CODE   = 32;   // bajty kodu na krok
+constexpr int COND_MAX_CONST  = 8;    // stałe liczbowe
+constexpr int COND_MAX_STACK  = 6;    // głębokość stosu przy wykonaniu
+constexpr int COND_MAX_STABLE = 2;    // stable() w jednym wyrażeniu
+constexpr int COND_MAX_NEST   = 8;    // zagnieżdżenie ( i ! przy kompilacji (stos taska)
+
+enum CondVar : uint8_t {
+    COND_V_CHAMBER, COND_V_MEAT, COND_V_AMBIENT, COND_V_SET, COND_V_TARGET,
+    COND_V_TIME, COND_V_MINTIME, COND_V_TOTAL, COND_V_SMOKE,
+    COND_VAR_COUNT
+};
+
+struct StepCond {
+    uint8_t len;                     // 0 = brak exit=, warunek domyślny
+    uint8_t nk;                      // użyte stałe k[]
+    uint8_t code[COND_MAX_CODE];
+    float   k[COND_MAX_CONST];
+};
+
+// Stan stable() - zerowany na starcie kroku
+struct CondState {
+    uint32_t sinceMs[COND_MAX_STABLE];
+    bool     inBand[COND_MAX_STABLE];
+};
+
+// false = błąd składni / limit; *errMsg i *errPos wskazują przyczynę, out.len = 0
+bool cond_compile(const char* src, StepCond& out, const char** errMsg, int* errPos);
+void cond_reset(CondState& st);
+// v[COND_VAR_COUNT] - bieżące wartości zmiennych
+bool cond_eval(const StepCond& c, const float* v, CondState& st, uint32_t nowMs);
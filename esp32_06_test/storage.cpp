@@ -4,6 +4,7 @@
 #include "config.h"
 #include "state.h"
 #include "flash_storage.h"    // [MOD] Zamiast <SD.h>
+#include "profile_parser.h"   // [NEW]
 #include <nvs_flash.h>
 #include <nvs.h>
 #include <WiFi.h>
@@ -21,10 +22,6 @@ static char authPass[64] = "";
 static int backupCounter = 0;
 static constexpr int MAX_BACKUPS = 5;
 
-static bool parseBool(const char* s) {
-    return (strcmp(s, "1") == 0 || strcasecmp(s, "true") == 0);
-}
-
 const char* storage_get_profile_path() { return lastProfilePath; }
 const char* storage_get_wifi_ssid()    { return wifiStaSsid; }
 const char* storage_get_wifi_pass()    { return wifiStaPass; }
@@ -41,48 +38,60 @@ const char* storage_get_auth_pass() {
     return (authPass[0] != '\0') ? authPass : CFG_AUTH_DEFAULT_PASS;
 }
 
-static bool parseProfileLine(char* line, Step& step) {
-    while (*line == ' ' || *line == '\t') line++;
+// ======================================================
+// [MOD] ŁADOWANIE PROFILU Z FLASH (zamiast SD)
+// ======================================================
 
-    int len = strlen(line);
-    while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == '\n' || line[len - 1] == ' ')) {
-        line[--len] = '\0';
+// [FIX] Przebieg auto - także wstrzymany i wznawiany - czyta kroki, nazwę
+// i energię kroków z areny; podmiana zwolniłaby je w trakcie procesu
+static bool profileInUseLocked() {
+    switch (g_currentState) {
+        case ProcessState::RUNNING_AUTO:
+            return true;
+        case ProcessState::IDLE:
+        case ProcessState::RUNNING_MANUAL:
+        case ProcessState::ERROR_PROFILE:
+        case ProcessState::AUTOTUNE:
+            return false;
+        default:   // pauzy, SOFT_RESUME
+            return g_lastRunMode == RunMode::MODE_AUTO;
     }
+}
 
-    if (len == 0 || line[0] == '#') return false;
-
-    char* fields[10];
-    int fieldCount = 0;
-    char* token = strtok(line, ";");
-    while (token && fieldCount < 10) {
-        fields[fieldCount++] = token;
-        token = strtok(NULL, ";");
-    }
+bool storage_profile_in_use() {
+    if (!state_lock()) return true;
+    bool inUse = profileInUseLocked();
+    state_unlock();
+    return inUse;
+}
 
-    if (fieldCount < 10) {
-        log_msg(LOG_LEVEL_WARN, "Invalid profile line - not enough fields");
-        return false;
+// [NEW] Podmiana areny profilu pod state_lock (wcześniej parser pisał do
+// g_profile bez locka); nullptr = brak kroków. Stara arena zwalniana po locku.
+// [FIX] false = proces auto w toku, nowa arena odrzucona.
+static bool installProfile(ProfileArena* arena) {
+    ProfileArena* old = arena;
+    bool installed = false;
+    if (state_lock()) {
+        if (!profileInUseLocked()) {
+            old = g_profile;
+            g_profile      = arena;
+            g_stepCount    = profile_count(arena);
+            g_errorProfile = (g_stepCount == 0);
+            g_processStats.totalProcessTimeSec = profile_time_sec(arena, 0, g_stepCount);
+            installed = true;
+        }
+        state_unlock();
     }
-
-    strncpy(step.name, fields[0], sizeof(step.name) - 1);
-    step.name[sizeof(step.name) - 1] = '\0';
-    step.tSet         = constrain(atof(fields[1]), CFG_T_MIN_SET, CFG_T_MAX_SET);
-    step.tMeatTarget  = constrain(atof(fields[2]), 0, 100);
-    step.minTimeMs    = (unsigned long)(atoi(fields[3])) * 60UL * 1000UL;
-    step.powerMode    = constrain(atoi(fields[4]), CFG_POWERMODE_MIN, CFG_POWERMODE_MAX);
-    step.smokePwm     = constrain(atoi(fields[5]), CFG_SMOKE_PWM_MIN, CFG_SMOKE_PWM_MAX);
-    step.fanMode      = constrain(atoi(fields[6]), 0, 2);
-    step.fanOnTime    = max(1000UL, (unsigned long)(atoi(fields[7])) * 1000UL);
-    step.fanOffTime   = max(1000UL, (unsigned long)(atoi(fields[8])) * 1000UL);
-    step.useMeatTemp  = parseBool(fields[9]);
-
-    return true;
+    profile_arena_free(old);
+    if (!installed) log_msg(LOG_LEVEL_WARN, "Profile not changed - auto process in progress");
+    return installed;
 }
 
-// ======================================================
-// [MOD] ŁADOWANIE PROFILU Z FLASH (zamiast SD)
-// ======================================================
 bool storage_load_profile() {
+    if (storage_profile_in_use()) {
+        log_msg(LOG_LEVEL_WARN, "Profile not reloaded - auto process in progress");
+        return false;
+    }
     if (strncmp(lastProfilePath, "github:", 7) == 0) {
         return storage_load_github_profile(lastProfilePath + 7);
     } else {
@@ -108,35 +117,7 @@ bool storage_load_profile() {
             return false;
         }
 
-        int loadedStepCount = 0;
-        int pos = 0;
-        int contentLen = content.length();
-
-        while (pos < contentLen && loadedStepCount < MAX_STEPS) {
-            int eol = content.indexOf('\n', pos);
-            if (eol < 0) eol = contentLen;
-
-            char lineBuf[256];
-            int lineLen = min((int)(eol - pos), (int)(sizeof(lineBuf) - 1));
-            content.substring(pos, pos + lineLen).toCharArray(lineBuf, sizeof(lineBuf));
-            lineBuf[lineLen] = '\0';
-
-            if (parseProfileLine(lineBuf, g_profile[loadedStepCount])) {
-                loadedStepCount++;
-            }
-            pos = eol + 1;
-        }
-
-        if (state_lock()) {
-            g_stepCount    = loadedStepCount;
-            g_errorProfile = (g_stepCount == 0);
-
-            g_processStats.totalProcessTimeSec = 0;
-            for (int i = 0; i < g_stepCount; i++) {
-                g_processStats.totalProcessTimeSec += g_profile[i].minTimeMs / 1000;
-            }
-            state_unlock();
-        }
+        if (!installProfile(profile_parse_text(content.c_str(), content.length()))) return false;
 
         if (g_errorProfile) {
             LOG_FMT(LOG_LEVEL_ERROR, "Failed to load profile: %s", lastProfilePath);
@@ -238,6 +219,27 @@ void storage_save_profile_path_nvs(const char* path) {
     LOG_FMT(LOG_LEVEL_INFO, "Profile path saved: %s", path);
 }
 
+// [NEW] Blob o stałym rozmiarze (konfiguracje struktur). Rozmiar w NVS musi się
+// zgadzać - po zmianie układu struktury wołający dostaje false i używa domyślnych.
+bool storage_load_blob_nvs(const char* key, void* data, size_t size) {
+    nvs_handle_t nvsHandle;
+    if (nvs_open("wedzarnia", NVS_READONLY, &nvsHandle) != ESP_OK) return false;
+
+    size_t len = 0;
+    bool ok = (nvs_get_blob(nvsHandle, key, NULL, &len) == ESP_OK && len == size);
+    if (ok) {
+        ok = (nvs_get_blob(nvsHandle, key, data, &len) == ESP_OK);
+    }
+    nvs_close(nvsHandle);
+    return ok;
+}
+
+void storage_save_blob_nvs(const char* key, const void* data, size_t size) {
+    nvs_save_generic([&](nvs_handle_t handle){
+        nvs_set_blob(handle, key, data, size);
+    });
+}
+
 void storage_save_manual_settings_nvs() {
     if (!state_lock()) return;
 
@@ -358,9 +360,10 @@ String storage_get_profile_as_json(const char* profileName) {
         return "[]";
     }
 
-    char json[2048];
-    int offset = 0;
-    offset += snprintf(json + offset, sizeof(json) - offset, "[");
+    // [MOD] Profil bez limitu kroków - JSON w String zamiast char[2048] na stosie
+    String json;
+    json.reserve(content.length() * 2 + 16);
+    json += '[';
     bool firstStep = true;
 
     int pos = 0;
@@ -388,32 +391,35 @@ String storage_get_profile_as_json(const char* profileName) {
         strncpy(lineCopy, line, sizeof(lineCopy));
         lineCopy[sizeof(lineCopy) - 1] = '\0';
 
-        char* fields[10];
+        char* fields[PROFILE_MAX_FIELDS];
         int fieldCount = 0;
         char* token = strtok(lineCopy, ";");
-        while (token && fieldCount < 10) {
+        while (token && fieldCount < PROFILE_MAX_FIELDS) {
             fields[fieldCount++] = token;
             token = strtok(NULL, ";");
         }
         if (fieldCount < 10) continue;
 
-        if (!firstStep) {
-            offset += snprintf(json + offset, sizeof(json) - offset, ",");
+        // [NEW] Pola klucz=wartość przechodzą do kreatora bez zmian ("ext")
+        char ext[160] = "";   // [MOD] z exit= dłuższe
+        for (int i = 10, extLen = 0; i < fieldCount && extLen < (int)sizeof(ext); i++) {
+            extLen += snprintf(ext + extLen, sizeof(ext) - extLen, "%s%s", i > 10 ? ";" : "", fields[i]);
         }
-        offset += snprintf(json + offset, sizeof(json) - offset,
-            "{\"name\":\"%s\",\"tSet\":%s,\"tMeat\":%s,\"minTime\":%s,"
+
+        char item[448];
+        snprintf(item, sizeof(item),
+            "%s{\"name\":\"%s\",\"tSet\":%s,\"tMeat\":%s,\"minTime\":%s,"
             "\"powerMode\":%s,\"smoke\":%s,\"fanMode\":%s,"
-            "\"fanOn\":%s,\"fanOff\":%s,\"useMeatTemp\":%s}",
-            fields[0], fields[1], fields[2], fields[3],
+            "\"fanOn\":%s,\"fanOff\":%s,\"useMeatTemp\":%s,\"ext\":\"%s\"}",
+            firstStep ? "" : ",", fields[0], fields[1], fields[2], fields[3],
             fields[4], fields[5], fields[6],
-            fields[7], fields[8], fields[9]);
+            fields[7], fields[8], fields[9], ext);
+        json += item;
         firstStep = false;
-
-        if (offset >= (int)sizeof(json) - 50) break;
     }
-    snprintf(json + offset, sizeof(json) - offset, "]");
+    json += ']';
 
-    return String(json);
+    return json;
 }
 
 // ======================================================
@@ -476,6 +482,10 @@ String storage_list_github_profiles_json() {
 }
 
 bool storage_load_github_profile(const char* profileName) {
+    if (storage_profile_in_use()) {
+        log_msg(LOG_LEVEL_WARN, "Profile not reloaded - auto process in progress");
+        return false;
+    }
     if (WiFi.status() != WL_CONNECTED) {
         LOG_FMT(LOG_LEVEL_ERROR, "WiFi not connected - cannot load from GitHub");
         if (state_lock()) { g_errorProfile = true; state_unlock(); }
@@ -516,35 +526,7 @@ bool storage_load_github_profile(const char* profileName) {
 
     LOG_FMT(LOG_LEVEL_DEBUG, "GitHub body: %d bytes", body.length());
 
-    int loadedStepCount = 0;
-    int pos = 0;
-    int bodyLen = body.length();
-
-    while (pos < bodyLen && loadedStepCount < MAX_STEPS) {
-        int eol = body.indexOf('\n', pos);
-        if (eol < 0) eol = bodyLen;
-
-        char lineBuf[256];
-        int lineLen = min((int)(eol - pos), (int)(sizeof(lineBuf) - 1));
-        body.substring(pos, pos + lineLen).toCharArray(lineBuf, sizeof(lineBuf));
-        lineBuf[lineLen] = '\0';
-
-        if (parseProfileLine(lineBuf, g_profile[loadedStepCount])) {
-            loadedStepCount++;
-        }
-        pos = eol + 1;
-    }
-
-    if (state_lock()) {
-        g_stepCount    = loadedStepCount;
-        g_errorProfile = (g_stepCount == 0);
-
-        g_processStats.totalProcessTimeSec = 0;
-        for (int i = 0; i < g_stepCount; i++) {
-            g_processStats.totalProcessTimeSec += g_profile[i].minTimeMs / 1000;
-        }
-        state_unlock();
-    }
+    if (!installProfile(profile_parse_text(body.c_str(), body.length()))) return false;
 
     if (g_errorProfile) {
         LOG_FMT(LOG_LEVEL_ERROR, "No valid steps in GitHub profile: %s", profileName);
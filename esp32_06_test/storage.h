@@ -7,10 +7,13 @@ const char* storage_get_profile_path();
 const char* storage_get_wifi_ssid();
 const char* storage_get_wifi_pass();
 bool storage_load_profile();
+bool storage_profile_in_use();        // [NEW] przebieg auto trzyma arenę - profil bez zmiany
 void storage_load_config_nvs();
 void storage_save_wifi_nvs(const char* ssid, const char* pass);
 void storage_save_profile_path_nvs(const char* path);
 void storage_save_manual_settings_nvs();
+bool storage_load_blob_nvs(const char* key, void* data, size_t size);
+void storage_save_blob_nvs(const char* key, const void* data, size_t size);
 String storage_list_profiles_json();
 bool storage_reinit_flash();          // [MOD] Było storage_reinit_sd()
 String storage_get_profile_as_json(const char* profileName);
@@ -1,5 +1,8 @@
 // tasks.cpp - [FIX OTA] taskWeb wyrejestrowany z WDT podczas uploadu
 // [NEW v3] taskWeb wywołuje web_server_ws_broadcast() co ~1s
+// [NEW] taskControl budzony przez taskSensors po publikacji świeżego pomiaru
+// [MOD] Takt taskControl z esp_timer (stały okres zamiast oczekiwania po pracy) +
+//       pomiary jittera, czasu wykonania i przekroczeń - GET /api/perf
 //
 // Problem: podczas OTA upload handleClient() blokuje taska na wiele sekund
 // (czas transferu pliku ~700KB przez WiFi to 2-10s).
@@ -19,10 +22,15 @@
 #include "sensors.h"
 #include "ui.h"
 #include "outputs.h"
+#include "history.h"
 #include "web_server.h"
 #include "wifimanager.h"
 #include "notifications.h"
+#include "checkpoint.h"
+#include "run_recorder.h"
+#include "energy.h"
 #include <esp_task_wdt.h>
+#include <esp_timer.h>
 
 
 struct TaskWatchdog {
@@ -40,6 +48,44 @@ static TaskWatchdog taskWatchdogs[] = {
     {0, false, "Monitor"}
 };
 
+// [NEW] Powiadomienie taskControl o świeżym pomiarze (xTaskNotifyGive)
+// [MOD] Bity powiadomienia: takt z esp_timer i świeży pomiar z taskSensors
+static TaskHandle_t controlTaskHandle = NULL;
+static constexpr uint32_t CTL_NOTIFY_TICK   = 0x01;
+static constexpr uint32_t CTL_NOTIFY_SENSOR = 0x02;
+
+// [NEW] Takt sterowania. Wcześniej ulTaskNotifyTake(CONTROL_TICK_MS) po pracy -
+// okres = 100 ms + czas pracy + czekanie na state_lock. Timer odpala się co
+// CONTROL_TICK_MS niezależnie od pracy; takt, który wypadł w trakcie pracy,
+// nie jest nadrabiany (liczony jako przekroczenie).
+static esp_timer_handle_t controlTimer = nullptr;
+static volatile uint32_t  ctlTickSeq = 0;   // takty odpalone przez timer
+static volatile int64_t   ctlTickUs = 0;    // czas ostatniego taktu
+
+struct ControlPerf {
+    uint32_t ticks;          // przebiegi z taktu timera
+    uint32_t events;         // przebiegi ze świeżego pomiaru
+    uint32_t overruns;       // takty pominięte - praca dłuższa niż okres
+    uint64_t jitterSumUs;    // opóźnienie startu względem taktu
+    uint32_t jitterMaxUs;
+    uint64_t execSumUs;      // czas pracy (wszystkie przebiegi)
+    uint32_t execMaxUs;      // WCET od resetu
+    uint32_t execLastUs;
+    int64_t  sinceUs;
+};
+
+static ControlPerf  ctlPerf;
+static portMUX_TYPE perfMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void controlTimerCb(void*) {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&perfMux);   // para seq/czas spójna (int64 - dwa zapisy)
+    ctlTickUs = now;
+    ctlTickSeq++;
+    portEXIT_CRITICAL(&perfMux);
+    if (controlTaskHandle) xTaskNotify(controlTaskHandle, CTL_NOTIFY_TICK, eSetBits);
+}
+
 static void watchdog_init() {
     esp_task_wdt_config_t wdt_config = {
         .timeout_ms = WDT_TIMEOUT * 1000,
@@ -71,16 +117,99 @@ void taskControl(void* pv) {
     esp_task_wdt_add(NULL);
     int taskIndex = 0;
     taskWatchdogs[taskIndex].lastReset = xTaskGetTickCount();
+    controlTaskHandle = xTaskGetCurrentTaskHandle();
+
+    esp_timer_create_args_t args = {};
+    args.callback = controlTimerCb;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "control";
+    bool timerOk = esp_timer_create(&args, &controlTimer) == ESP_OK &&
+                   esp_timer_start_periodic(controlTimer, CONTROL_TICK_MS * 1000ULL) == ESP_OK;
+    if (!timerOk) log_msg(LOG_LEVEL_ERROR, "Control timer start failed - falling back to timeout tick");
+    portENTER_CRITICAL(&perfMux);
+    memset(&ctlPerf, 0, sizeof(ctlPerf));
+    ctlPerf.sinceUs = esp_timer_get_time();
+    portEXIT_CRITICAL(&perfMux);
     log_msg(LOG_LEVEL_INFO, "Control task started");
+
+    uint32_t lastSeq = ctlTickSeq;
+    uint32_t bits = CTL_NOTIFY_TICK;
     for (;;) {
+        int64_t startUs = esp_timer_get_time();
+        // [FIX] Takt odczytany zaraz po obudzeniu, przed pracą - takt odpalony w
+        // trakcie pracy liczony był jako pominięty (fałszywy overrun), jitter
+        // wychodził ujemny i przepadał, a w następnym obiegu bit TICK bez nowego
+        // seq szedł do zdarzeń. Taki takt należy teraz do następnego obiegu.
+        portENTER_CRITICAL(&perfMux);
+        uint32_t seq = ctlTickSeq;
+        int64_t tickUs = ctlTickUs;
+        portEXIT_CRITICAL(&perfMux);
         esp_task_wdt_reset();
         taskWatchdogs[taskIndex].lastReset = xTaskGetTickCount();
         process_run_control_logic();
+        history_tick();   // [NEW] próbka historii raz na sekundę
+        checkpoint_tick();   // [NEW] wznowienie po resecie, kopia rekordu do zapisu
+        runrec_tick();       // [NEW] rekord przebiegu do bloku w RAM
         checkTaskWatchdog(taskIndex);
-        vTaskDelay(pdMS_TO_TICKS(100));
+        uint32_t execUs = (uint32_t)(esp_timer_get_time() - startUs);
+
+        // Takt: start względem odpalenia timera; więcej niż jeden nowy takt = pominięte
+        bool tick = (bits & CTL_NOTIFY_TICK) && seq != lastSeq;
+        uint32_t missed = tick ? seq - lastSeq - 1 : 0;
+        int64_t jitter = tick ? startUs - tickUs : 0;
+        if (tick) lastSeq = seq;
+        portENTER_CRITICAL(&perfMux);
+        if (tick) {
+            ctlPerf.ticks++;
+            ctlPerf.overruns += missed;
+            if (jitter > 0) {
+                ctlPerf.jitterSumUs += (uint64_t)jitter;
+                if ((uint32_t)jitter > ctlPerf.jitterMaxUs) ctlPerf.jitterMaxUs = (uint32_t)jitter;
+            }
+        } else {
+            ctlPerf.events++;
+        }
+        ctlPerf.execSumUs += execUs;
+        ctlPerf.execLastUs = execUs;
+        if (execUs > ctlPerf.execMaxUs) ctlPerf.execMaxUs = execUs;
+        portEXIT_CRITICAL(&perfMux);
+
+        // [MOD] Czekanie na takt timera albo świeży pomiar; bez timera - jak dotąd timeout
+        bits = 0;
+        if (xTaskNotifyWait(0, UINT32_MAX, &bits, pdMS_TO_TICKS(timerOk ? 2 * CONTROL_TICK_MS
+                                                                        : CONTROL_TICK_MS)) != pdTRUE) {
+            bits = CTL_NOTIFY_TICK;
+        }
     }
 }
 
+String tasks_perf_json() {
+    ControlPerf p;
+    portENTER_CRITICAL(&perfMux);
+    p = ctlPerf;
+    portEXIT_CRITICAL(&perfMux);
+    uint32_t runs = p.ticks + p.events;
+    char buf[320];
+    snprintf(buf, sizeof(buf),
+        "{\"control\":{\"period_us\":%lu,\"ticks\":%lu,\"events\":%lu,\"overruns\":%lu,"
+        "\"jitter_avg_us\":%lu,\"jitter_max_us\":%lu,"
+        "\"exec_avg_us\":%lu,\"exec_max_us\":%lu,\"exec_last_us\":%lu,\"since_s\":%lu}}",
+        (unsigned long)(CONTROL_TICK_MS * 1000UL), (unsigned long)p.ticks, (unsigned long)p.events,
+        (unsigned long)p.overruns,
+        (unsigned long)(p.ticks ? p.jitterSumUs / p.ticks : 0), (unsigned long)p.jitterMaxUs,
+        (unsigned long)(runs ? p.execSumUs / runs : 0), (unsigned long)p.execMaxUs,
+        (unsigned long)p.execLastUs,
+        (unsigned long)((esp_timer_get_time() - p.sinceUs) / 1000000));
+    return String(buf);
+}
+
+void tasks_perf_reset() {
+    portENTER_CRITICAL(&perfMux);
+    memset(&ctlPerf, 0, sizeof(ctlPerf));
+    ctlPerf.sinceUs = esp_timer_get_time();
+    portEXIT_CRITICAL(&perfMux);
+}
+
 void taskSensors(void* pv) {
     esp_task_wdt_add(NULL);
     int taskIndex = 1;
@@ -90,8 +219,9 @@ void taskSensors(void* pv) {
         esp_task_wdt_reset();
         taskWatchdogs[taskIndex].lastReset = xTaskGetTickCount();
         requestTemperature();
-        readTemperature();
+        bool fresh = readTemperature();
         checkDoor();
+        if (fresh && controlTaskHandle) xTaskNotify(controlTaskHandle, CTL_NOTIFY_SENSOR, eSetBits);   // [MOD]
         checkTaskWatchdog(taskIndex);
         vTaskDelay(pdMS_TO_TICKS(100));
     }
@@ -179,6 +309,8 @@ void taskMonitor(void* pv) {
         unsigned long now = millis();
         // [NEW] ntfy alerts co 5s
         if (now - lastNotifyCheck > 5000) { lastNotifyCheck = now; notifications_check(); }
+        checkpoint_flush();   // [NEW] punkt kontrolny procesu do flash
+        runrec_flush();       // [NEW] bloki zapisu przebiegu do flash
 
         if (now - lastHeapLog > 60000) {
             lastHeapLog = now;
@@ -210,6 +342,7 @@ void taskMonitor(void* pv) {
                     LOG_FMT(LOG_LEVEL_INFO, "[STATS] Runtime: %luh %lum", runHours, runMins);
                     LOG_FMT(LOG_LEVEL_INFO, "[STATS] Heating: %lu%%, Avg: %.1f C", heatPercent, stats.avgTemp);
                     LOG_FMT(LOG_LEVEL_INFO, "[STATS] Steps: %d, Pauses: %d", stats.stepChanges, stats.pauseCount);
+                    LOG_FMT(LOG_LEVEL_INFO, "[STATS] Energy: %.2f kWh", energy_wh(stats.energyUj) / 1000.0);
                 }
             }
             if (wifi_is_connected()) {
@@ -227,7 +360,7 @@ void tasks_create_all() {
     watchdog_init();
 
     // Core 1: zadania krytyczne
-    xTaskCreatePinnedToCore(taskControl, "Control", 4096,  NULL, 3, NULL, 1);
+    xTaskCreatePinnedToCore(taskControl, "Control", 4096,  NULL, 3, &controlTaskHandle, 1);
     xTaskCreatePinnedToCore(taskSensors, "Sensors", 5120,  NULL, 2, NULL, 1);
     // [FIX] 4096 → 10240: WiFiClientSecure (HTTPS) dla GitHub wymaga ~8KB stosu.
     xTaskCreatePinnedToCore(taskUI,      "UI",      16384, NULL, 2, NULL, 1);  // [FIX-T1] 16KB: WiFiClientSecure HTTPS GitHub wymaga ~8KB stosu
@@ -6,4 +6,8 @@
 void tasks_create_all();
 
 // Status watchdog
-String getTaskWatchdogStatus();
\ No newline at end of file
+String getTaskWatchdogStatus();
+
+// [NEW] Takt taskControl: jitter, czas wykonania, przekroczenia (GET /api/perf)
+String tasks_perf_json();
+void tasks_perf_reset();
@@ -17,6 +17,7 @@
 #include "sensors.h"
 #include "hardware.h"        // [FIX-1] g_spiMutex, display_begin/end_transaction
 #include "flash_storage.h"   // [FIX-1] zamiast <SD.h>
+#include "energy.h"
 #include <climits>
 #include <vector>
 #include <ArduinoJson.h>
@@ -61,6 +62,8 @@ struct DisplayCache {
     String stepName = "";
     String elapsedStr = "";
     String remainingStr = "";
+    String meatEtaStr = "";   // [NEW]
+    String energyStr = "";    // [NEW]
     unsigned long lastUpdate = 0;
     bool needsRedraw = true;
 };
@@ -71,6 +74,16 @@ static DisplayCache displayCache;
 // FUNKCJE POMOCNICZE DLA WYSWIETLACZA
 // ============================================================
 
+// [NEW] "E: 2.64kWh 1.85zl" - energia procesu, koszt gdy ustawiona cena
+static String energyLine(float wh) {
+    EnergyConfig cfg;
+    String s = "E: " + String(wh / 1000.0f, 2) + "kWh";
+    if (energy_get_config(cfg) && cfg.pricePerKwh > 0) {
+        s += " " + String(wh / 1000.0f * cfg.pricePerKwh, 2) + "zl";
+    }
+    return s;
+}
+
 static int calculateTextWidth(const String& text, int size) {
     return text.length() * (size == 1 ? 6 : 12);
 }
@@ -134,6 +147,7 @@ const char* getStateStringForDisplay(ProcessState st) {
         case ProcessState::PAUSE_SENSOR:       return "Pauza: Czujnik";
         case ProcessState::PAUSE_OVERHEAT:     return "Pauza: Przegrzanie";
         case ProcessState::PAUSE_HEATER_FAULT: return "AWARIA Grzalki";
+        case ProcessState::AUTOTUNE:           return "Autotune PID";
         case ProcessState::PAUSE_USER:         return "PAUZA";
         case ProcessState::ERROR_PROFILE:      return "Blad Profilu";
         case ProcessState::SOFT_RESUME:        return "Wznawianie...";
@@ -287,15 +301,14 @@ static void handleSystemSettingsAction() {
             display.setCursor(10, 85);
             display.print("Identyfikacja czujnikow...");
 
-            identifyAndAssignSensors();
-
             display.setCursor(10, 105);
-            if (areSensorsIdentified()) {
+            if (autoDetectAndAssignSensors()) {
                 display.print("Kalibracja OK!");
+                // Tablica podmienia się w taskSensors - pokaż wynik autodetekcji z magistrali
                 display.setCursor(10, 120);
-                display.print("Czujnik 0: Komora");
+                display.printf("DS18B20: %d -> Komora", getTotalSensorCount());
                 display.setCursor(10, 135);
-                display.print("Czujnik 1: Mieso");
+                display.printf("NTC GPIO%d -> Mieso", PIN_NTC);
                 buzzerBeep(3, 100, 100);
             } else {
                 display.print("Blad kalibracji!");
@@ -380,6 +393,8 @@ while (millis() < resetTimeout) {
             g_processStats.stepChanges     = 0;
             g_processStats.pauseCount      = 0;
             g_processStats.avgTemp         = 0.0;
+            g_processStats.energyUj        = 0;   // [NEW]
+            profile_energy_reset(g_profile);
             state_unlock();
         }
         buzzerBeep(3, 100, 100);
@@ -712,6 +727,11 @@ state_unlock();
                                 currentUiState = UiState::UI_STATE_MENU_SOURCE;
                                 ui_transition_effect(false);
                             }
+                            else if (pin == PIN_BTN_ENTER && storage_profile_in_use()) {
+                                // [FIX] Proces auto w toku - profil (arena) bez zmiany
+                                buzzerBeep(3, 200, 100);
+                                log_msg(LOG_LEVEL_WARN, "Profile locked - auto process in progress");
+                            }
                             else if (pin == PIN_BTN_ENTER) {
                                 String selectedProfile = profileList[profileMenuIndex];
 
@@ -914,14 +934,10 @@ void ui_update_display() {
 
     lastDisplayUpdate = millis();
 
-ProcessState st;
-if (state_lock()) {
-    st = g_currentState;
-    state_unlock();
-} else {
-    // Nie udało się – użyj ostatniego znanego stanu
-    st = lastProcessState;
-}
+    // [MOD] Jedna spójna migawka na odświeżenie - bez state_lock (seqlock, state.h)
+    static ProcessSnapshot snap;   // tylko taskUI
+    state_snapshot_read(snap);
+    ProcessState st = snap.state;
 
     if (st != lastProcessState) {
         currentUiState = UiState::UI_STATE_IDLE;
@@ -948,28 +964,24 @@ if (state_lock()) {
         displayCache.stepName    = "";
         displayCache.elapsedStr  = "";
         displayCache.remainingStr= "";
+        displayCache.meatEtaStr  = "";
+        displayCache.energyStr   = "";
     }
 
-if (!state_lock()) {
-    // Nie udało się uzyskać mutexa – pomiń tę aktualizację display
-    display_end_transaction();
-    return;
-}
-double tc                  = g_tChamber;
-double tm                  = g_tMeat;
-double ts                  = g_tSet;
-int pm                     = g_powerMode;
-int fm                     = g_fanMode;
-int smoke                  = g_manualSmokePwm;
-unsigned long stepStartTime    = g_stepStartTime;
-unsigned long processStartTime = g_processStartTime;
-int currentStep            = g_currentStep;
-int stepCount              = g_stepCount;
-char stepName[32];
-strncpy(stepName, (currentStep < stepCount) ? g_profile[currentStep].name : "", sizeof(stepName));
-stepName[sizeof(stepName) - 1] = '\0';
-unsigned long stepTotalTimeMs = (currentStep < stepCount) ? g_profile[currentStep].minTimeMs : 0;
-state_unlock();
+    double tc                      = snap.tChamber;
+    double tm                      = snap.tMeat;
+    double ts                      = snap.tSet;
+    int pm                         = snap.powerMode;
+    int fm                         = snap.fanMode;
+    int smoke                      = snap.manualSmokePwm;
+    unsigned long stepStartTime    = snap.stepStartTime;
+    unsigned long processStartTime = snap.processStartTime;
+    int currentStep                = snap.currentStep;
+    int stepCount                  = snap.stepCount;
+    const char* stepName           = snap.stepName;
+    unsigned long stepTotalTimeMs  = snap.stepMinTimeMs;
+    long meatEtaSec                = snap.meatEtaSec;
+    float meatEtaConf              = snap.meatEtaConf;
 
     char buf[32];
 
@@ -1049,6 +1061,19 @@ state_unlock();
                            ST77XX_WHITE, 1);
                 displayCache.remainingStr = String("Zostalo:  ") + buf;
 
+                // [NEW] Prognoza dojścia rdzenia (tylko kroki z celem temp. mięsa)
+                String etaStr = "";
+                if (meatEtaSec >= 0) {
+                    formatTime(buf, sizeof(buf), (unsigned long)meatEtaSec);
+                    etaStr = String("Mieso: ") + buf + " " + String((int)(meatEtaConf * 100)) + "%";
+                }
+                updateText(0, 120, 128, 8,
+                           displayCache.meatEtaStr,
+                           etaStr,
+                           ST77XX_YELLOW, 1);
+                displayCache.meatEtaStr = etaStr;
+                display.setTextColor(ST77XX_WHITE);
+
                 display.setCursor(5, 130);
                 display.print("DOWN - Nastepny krok");
                 display.setCursor(5, 145);
@@ -1071,9 +1096,20 @@ state_unlock();
                 displayCache.elapsedStr = buf;
 
                 display.setTextSize(1);
+                String eStr = energyLine(snap.energyWh);   // [NEW]
+                updateText(0, 130, 128, 8, displayCache.energyStr, eStr, ST77XX_CYAN, 1);
+                displayCache.energyStr = eStr;
+                display.setTextColor(ST77XX_WHITE);
                 display.fillRect(0, 145, display.width(), 16, ST77XX_BLACK);
                 display.setCursor(5, 145);
                 display.print("EXIT - Zatrzymaj");
+            } else {
+                // [NEW] Pauza / koniec profilu - podsumowanie energii
+                display.setTextSize(1);
+                String eStr = energyLine(snap.energyWh);
+                updateText(0, 95, 128, 8, displayCache.energyStr, eStr, ST77XX_CYAN, 1);
+                displayCache.energyStr = eStr;
+                display.setTextColor(ST77XX_WHITE);
             }
         } else {
             display.setTextSize(2);
@@ -1081,6 +1117,13 @@ state_unlock();
             display.print("Menu");
             display.setCursor(25, 115);
             display.print("ENTER");
+            if (snap.energyWh > 0) {   // [NEW] ostatni proces
+                display.setTextSize(1);
+                display.setTextColor(ST77XX_CYAN);
+                display.setCursor(5, 140);
+                display.print(energyLine(snap.energyWh));
+                display.setTextColor(ST77XX_WHITE);
+            }
         }
     } else {
         display.setTextSize(1);
@@ -11,6 +11,13 @@
 #include "process.h"
 #include "outputs.h"
 #include "sensors.h"
+#include "ntc_scanner.h"
+#include "history.h"
+#include "ssr_driver.h"
+#include "heater_rotation.h"
+#include "energy.h"
+#include "run_recorder.h"
+#include "tasks.h"
 #include <WiFi.h>
 #include <Update.h>
 #include <HTTPClient.h>
@@ -33,42 +40,39 @@ static void onWsEvent(uint8_t num, WStype_t type, uint8_t* payload, size_t lengt
     }
 }
 
+// [MOD] Miejsce na tablicę "ch" z MAX_SENSOR_CHANNELS kanałami (+ prognoza mięsa, dym, energia)
+static constexpr size_t STATUS_JSON_SIZE = 1280;
+
+// Tablica kanałów jako JSON: [{"n":"DS1","r":"chamber","v":65.2,"ok":1},...]
+static void buildChannelsJson(char* out, size_t outSize,
+                              const SensorChannel* table, const SensorReading* rd, int count) {
+    size_t len = snprintf(out, outSize, "[");
+    for (int ch = 0; ch < count && len < outSize; ch++) {
+        len += snprintf(out + len, outSize - len, "%s{\"n\":\"%s\",\"r\":\"%s\",\"v\":%.1f,\"ok\":%d}",
+                        ch > 0 ? "," : "", table[ch].name, sensors_role_name(table[ch].role),
+                        rd[ch].value, rd[ch].valid ? 1 : 0);
+    }
+    if (len < outSize) snprintf(out + len, outSize - len, "]");
+}
+
 // Buduje JSON statusu - współdzielony między WS a /status HTTP
 static void buildStatusJson(char* buf, size_t bufSize) {
-    double tc, tc1, tc2, tm, ts;
-    int pm, fm, sm;
-    ProcessState st;
-    unsigned long elapsedSec = 0, stepTotalSec = 0, remainingSec = 0;
+    // [MOD] Migawka seqlock zamiast state_lock - spójna kopia, bez czekania na taskControl
+    static ProcessSnapshot snap;   // tylko taskWeb
+    state_snapshot_read(snap);
+    const ProcessState st = snap.state;
+    const double tc = snap.tChamber, te = snap.tChamberEst, tm = snap.tMeat, ts = snap.tSet;
+    const int pm = snap.powerMode, fm = snap.fanMode, sm = snap.manualSmokePwm;
+    const unsigned long remainingSec = snap.remainingProcessTimeSec;
+    unsigned long elapsedSec = 0, stepTotalSec = 0;
     const char* stepName = "";
-    char activeProfile[64] = "Brak";
-
-    // [FIX-B1] Sprawdz wynik state_lock - timeout zwraca false
-    if (!state_lock()) {
-        snprintf(buf, bufSize,
-            "{\"tChamber\":0,\"tChamber1\":0,\"tChamber2\":0,\"tMeat\":0,\"tSet\":0,"
-            "\"powerMode\":1,\"fanMode\":0,\"smokePwm\":0,\"mode\":\"IDLE\",\"state\":0,"
-            "\"powerModeText\":\"-\",\"fanModeText\":\"-\",\"elapsedTimeSec\":0,"
-            "\"stepName\":\"\",\"stepTotalTimeSec\":0,\"activeProfile\":\"\","
-            "\"remainingProcessTimeSec\":0}");
-        return;
-    }
-    st   = g_currentState;
-    tc   = g_tChamber;  tc1 = g_tChamber1;  tc2 = g_tChamber2;
-    tm   = g_tMeat;     ts  = g_tSet;
-    pm   = g_powerMode; fm  = g_fanMode;     sm  = g_manualSmokePwm;
-    remainingSec = g_processStats.remainingProcessTimeSec;
-    strncpy(activeProfile, storage_get_profile_path(), sizeof(activeProfile)-1);
-    activeProfile[sizeof(activeProfile)-1] = '\0';
     if (st == ProcessState::RUNNING_MANUAL) {
-        elapsedSec = (millis() - g_processStartTime) / 1000;
+        elapsedSec = (millis() - snap.processStartTime) / 1000;
     } else if (st == ProcessState::RUNNING_AUTO) {
-        elapsedSec = (millis() - g_stepStartTime) / 1000;
-        if (g_currentStep < g_stepCount) {
-            stepName     = g_profile[g_currentStep].name;
-            stepTotalSec = g_profile[g_currentStep].minTimeMs / 1000;
-        }
+        elapsedSec = (millis() - snap.stepStartTime) / 1000;
+        stepName     = snap.stepName;
+        stepTotalSec = snap.stepMinTimeMs / 1000;
     }
-    state_unlock();
 
     const char* modeStr;
     switch (st) {
@@ -79,6 +83,7 @@ static void buildStatusJson(char* buf, size_t bufSize) {
         case ProcessState::PAUSE_SENSOR:       modeStr = "PAUZA: CZUJNIK";     break;
         case ProcessState::PAUSE_OVERHEAT:     modeStr = "PAUZA: PRZEGRZANIE"; break;
         case ProcessState::PAUSE_HEATER_FAULT: modeStr = "AWARIA: GRZALKA";   break;
+        case ProcessState::AUTOTUNE:           modeStr = "AUTOTUNE PID";       break;
         case ProcessState::PAUSE_USER:         modeStr = "PAUZA UZYTK.";       break;
         case ProcessState::ERROR_PROFILE:      modeStr = "ERROR_PROFILE";      break;
         case ProcessState::SOFT_RESUME:        modeStr = "Wznawianie...";      break;
@@ -88,30 +93,38 @@ static void buildStatusJson(char* buf, size_t bufSize) {
     const char* fmStr = fm==0?"OFF":fm==1?"ON":fm==2?"Cyklicznie":"Brak";
 
     char profClean[64];
-    strncpy(profClean, activeProfile, sizeof(profClean));
+    strncpy(profClean, snap.profilePath, sizeof(profClean));
     profClean[sizeof(profClean)-1] = '\0';
     if      (strstr(profClean,"/profiles/")) memmove(profClean, strstr(profClean,"/profiles/")+10, strlen(profClean));
     else if (strstr(profClean,"github:"))    memmove(profClean, profClean+7, strlen(profClean)-6);
 
+    char chJson[MAX_SENSOR_CHANNELS * 64];
+    buildChannelsJson(chJson, sizeof(chJson), snap.channels, snap.readings, snap.channelCount);
+
     snprintf(buf, bufSize,
-        "{\"tChamber\":%.1f,\"tChamber1\":%.1f,\"tChamber2\":%.1f,"
+        "{\"tChamber\":%.1f,\"tEst\":%.1f,\"ch\":%s,"
         "\"tMeat\":%.1f,\"tSet\":%.1f,"
         "\"powerMode\":%d,\"fanMode\":%d,\"smokePwm\":%d,"
         "\"mode\":\"%s\",\"state\":%d,"
         "\"powerModeText\":\"%s\",\"fanModeText\":\"%s\","
         "\"elapsedTimeSec\":%lu,\"stepName\":\"%s\","
         "\"stepTotalTimeSec\":%lu,\"activeProfile\":\"%s\","
-        "\"remainingProcessTimeSec\":%lu}",
-        tc,tc1,tc2,tm,ts,pm,fm,sm,
+        "\"remainingProcessTimeSec\":%lu,\"remainingOpen\":%d,\"meatEtaSec\":%ld,\"meatEtaConf\":%.2f,"
+        "\"heaterFault\":%d,\"heatersEff\":%.1f,\"smokeOut\":%d,\"smokeDens\":%.1f,"
+        "\"energyWh\":%.1f,\"stepWh\":%.1f}",
+        tc,te,chJson,tm,ts,pm,fm,sm,
         modeStr,(int)st,pmStr,fmStr,
         elapsedSec,stepName,stepTotalSec,
-        profClean,remainingSec);
+        profClean,remainingSec,(int)snap.remainingOpen,snap.meatEtaSec,snap.meatEtaConf,
+        snap.heaterFaultMask,snap.heatersEffective,snap.smokeOut,
+        isnan(snap.smokeDensity) ? -1.0f : snap.smokeDensity,
+        snap.energyWh,snap.stepEnergyWh);
 }
 
 // Broadcastuj status do wszystkich klientów WS - wywołuj co ~1s z taskWeb
 void web_server_ws_broadcast() {
     if (ws.connectedClients() == 0) return;
-    static char buf[700];
+    static char buf[STATUS_JSON_SIZE];
     buildStatusJson(buf, sizeof(buf));
     ws.broadcastTXT(buf);
 }
@@ -174,6 +187,65 @@ static void sendHtml(int code, const String& body) {
     server.send(code, "text/html; charset=utf-8", body);
 }
 
+// [NEW] Zapisy przebiegów (run_recorder.h)
+// GET             -> [{"name":"r_3.bin","size":18432,"mode":0,"profile":"...","recording":false},...]
+// GET name=r_3.bin -> plik binarny; bieżący przebieg - tylko zapisane bloki
+static void handleRuns() {
+    if (!requireAuth()) return;
+    if (!flash_is_ready()) {
+        server.send(503, "application/json", "{\"error\":\"Flash not ready\"}");
+        return;
+    }
+    char path[MAX_FILENAME_LEN];
+    if (server.hasArg("name")) {
+        String name = server.arg("name");
+        if (!name.startsWith("r_") || name.indexOf('/') >= 0 ||
+            name.length() + strlen(RUNREC_DIR) >= sizeof(path)) {
+            server.send(400, "application/json", "{\"error\":\"Invalid name\"}");
+            return;
+        }
+        snprintf(path, sizeof(path), RUNREC_DIR "%s", name.c_str());
+        if (!flash_file_exists(path)) {
+            server.send(404, "application/json", "{\"error\":\"No such run\"}");
+            return;
+        }
+        uint32_t len = runrec_file_length(path);
+        server.sendHeader("Content-Disposition", "attachment; filename=\"" + name + "\"");
+        server.setContentLength(len);
+        server.send(200, "application/octet-stream", "");
+        uint8_t buf[FLASH_PAGE_SIZE * 4];
+        uint32_t offset = 0;
+        while (offset < len) {
+            int n = flash_file_read_chunk(path, offset, buf, min((uint32_t)sizeof(buf), len - offset));
+            if (n <= 0) break;
+            server.client().write((const char*)buf, n);
+            offset += n;
+            esp_task_wdt_reset();
+            vTaskDelay(1);
+        }
+        return;
+    }
+
+    char files[8][MAX_FILENAME_LEN];
+    int n = flash_list_files(RUNREC_DIR, files, 8);
+    String json = "[";
+    for (int i = 0; i < n; i++) {
+        RunFileHeader hdr;
+        if (flash_file_read_chunk(files[i], 0, (uint8_t*)&hdr, sizeof(hdr)) != (int)sizeof(hdr) ||
+            hdr.magic != RUNREC_FILE_MAGIC) continue;
+        hdr.profile[sizeof(hdr.profile) - 1] = '\0';
+        uint32_t len = runrec_file_length(files[i]);
+        char item[160];
+        snprintf(item, sizeof(item),
+                 "%s{\"name\":\"%s\",\"size\":%lu,\"mode\":%u,\"profile\":\"%s\",\"recording\":%s}",
+                 json.length() > 1 ? "," : "", files[i] + strlen(RUNREC_DIR), (unsigned long)len,
+                 hdr.runMode, hdr.profile, len != flash_file_get_size(files[i]) ? "true" : "false");
+        json += item;
+    }
+    json += "]";
+    server.send(200, "application/json", json);
+}
+
 // =================================================================
 // STRONA BOOTSTRAPOWA - serwowana gdy /web/index.html nie istnieje
 // Pozwala wgrać pliki web bez działającego interfejsu
@@ -257,7 +329,7 @@ input[type=number]{width:80px}
 <div class="temp-box temp-chamber">
 <div class="label">🌡️ Komora (śr.)</div>
 <div class="value" id="temp-chamber">--°C</div>
-<div style="font-size:.7em;opacity:.7;margin-top:5px">DS1: <span id="temp-ch1">--</span>°C | DS2: <span id="temp-ch2">--</span>°C</div>
+<div style="font-size:.7em;opacity:.7;margin-top:5px" id="temp-channels">--</div>
 </div>
 <div class="temp-box temp-meat">
 <div class="label">🍖 Mięso (NTC)</div>
@@ -360,6 +432,7 @@ input[type=number]{width:80px}
 <div class="footer-grid">
 <a class="footer-link" href="/creator">📝 Nowy Profil</a>
 <a class="footer-link" href="/sensors">🔧 Czujniki</a>
+<a class="footer-link" href="/pid">🎛️ PID / Autotune</a>
 <a class="footer-link" href="/wifi">📶 WiFi</a>
 <a class="footer-link" href="/update">📦 OTA Update</a>
 <a class="footer-link" href="/auth/set">🔑 Zmień hasło</a>
@@ -486,8 +559,9 @@ function wsConnect(){
 // ── Aktualizacja UI ────────────────────────────────────────────────
 function updateUI(d){
   document.getElementById('temp-chamber').textContent = d.tChamber.toFixed(1)+'°C';
-  document.getElementById('temp-ch1').textContent = d.tChamber1.toFixed(1);
-  document.getElementById('temp-ch2').textContent = d.tChamber2.toFixed(1);
+  document.getElementById('temp-channels').textContent = (d.ch||[]).map(function(c){
+    return c.n+': '+(c.ok?c.v.toFixed(1):'--')+'°C';
+  }).join(' | ') + (d.tEst!==undefined ? ' | powietrze ≈'+d.tEst.toFixed(1)+'°C' : '');
   document.getElementById('temp-meat').textContent = d.tMeat.toFixed(1)+'°C';
   document.getElementById('temp-target').textContent = d.tSet.toFixed(1)+'°C';
 
@@ -504,7 +578,7 @@ function updateUI(d){
 
   document.getElementById('power-mode').textContent = d.powerModeText;
   document.getElementById('fan-mode').textContent   = d.fanModeText;
-  document.getElementById('smoke-level').textContent= Math.round((d.smokePwm/255)*100)+'%';
+  document.getElementById('smoke-level').textContent= Math.round((d.smokeOut/255)*100)+'%'+(d.smokeDens>=0?' ('+d.smokeDens+'%)':'');
 
   var ts = document.getElementById('timer-section');
   if(d.mode==='AUTO'||d.mode==='MANUAL'){
@@ -518,7 +592,7 @@ function updateUI(d){
       var ps=document.getElementById('process-total-section');
       if(d.remainingProcessTimeSec>0){
         ps.style.display='block';
-        document.getElementById('process-remaining').textContent=formatTime(d.remainingProcessTimeSec);
+        document.getElementById('process-remaining').textContent=(d.remainingOpen?'~':'')+formatTime(d.remainingProcessTimeSec);
       } else ps.style.display='none';
     } else {
       document.getElementById('step-name').textContent='Tryb Manualny';
@@ -786,7 +860,7 @@ static void handleCommonCss() {
 // STATUS JSON - /status HTTP (kompatybilność wsteczna)
 // =================================================================
 static const char* getStatusJSON() {
-    static char buf[700];
+    static char buf[STATUS_JSON_SIZE];
     buildStatusJson(buf, sizeof(buf));
     return buf;
 }
@@ -826,7 +900,7 @@ static void handleSysInfoJson() {
         millis()/1000, ESP.getCpuFreqMHz(), temperatureRead(), rrStr,
         flashOk?"true":"false", jedecStr,
         flashOk?flash_get_used_sectors():0u, flashOk?flash_get_free_sectors():0u,
-        sensors.getDeviceCount(), areSensorsIdentified()?"true":"false",
+        sensors.getDeviceCount(), sensors_copy_table(nullptr, nullptr) > 0 ? "true":"false",
         wifiConn?"true":"false",
         wifiConn?WiFi.SSID().c_str():"",
         wifiConn?WiFi.localIP().toString().c_str():"",
@@ -839,31 +913,390 @@ static void handleSysInfoJson() {
 // =================================================================
 // CZUJNIKI API
 // =================================================================
+// [MOD] Tablica kanałów + adresy DS18B20 widoczne na magistrali
 static void handleSensorInfo() {
     if (!requireAuth()) return;
-    char buf[128];
-    snprintf(buf, sizeof(buf),
-        "{\"total_sensors\":%d,\"chamber1_index\":%d,\"chamber2_index\":%d,"
-        "\"identified\":%s,\"ntc_pin\":%d}",
-        getTotalSensorCount(), getChamberSensor1Index(), getChamberSensor2Index(),
-        areSensorsIdentified()?"true":"false", PIN_NTC);
-    server.send(200, "application/json", buf);
+    SensorChannel table[MAX_SENSOR_CHANNELS];
+    SensorReading rd[MAX_SENSOR_CHANNELS];
+    int count = sensors_copy_table(table, rd);
+
+    String json = "{\"channels\":[";
+    char buf[200];
+    for (int ch = 0; ch < count; ch++) {
+        char src[20];
+        if (table[ch].type == (uint8_t)SensorType::DS18B20) sensors_rom_to_str(table[ch].rom, src, sizeof(src));
+        else snprintf(src, sizeof(src), "%d", table[ch].pin);
+        snprintf(buf, sizeof(buf),
+            "%s{\"ch\":%d,\"name\":\"%s\",\"type\":\"%s\",\"role\":\"%s\",\"src\":\"%s\","
+            "\"offset\":%.2f,\"value\":%.2f,\"raw\":%.2f,\"valid\":%s}",
+            ch > 0 ? "," : "", ch, table[ch].name, sensors_type_name(table[ch].type),
+            sensors_role_name(table[ch].role), src, table[ch].offset,
+            rd[ch].value, rd[ch].raw, rd[ch].valid ? "true" : "false");
+        json += buf;
+    }
+    json += "],\"bus\":[";
+    int devCount = getTotalSensorCount();
+    for (int i = 0; i < devCount; i++) {
+        uint8_t rom[8];
+        if (!sensors.getAddress(rom, i)) continue;
+        char addr[20];
+        sensors_rom_to_str(rom, addr, sizeof(addr));
+        snprintf(buf, sizeof(buf), "%s\"%s\"", i > 0 ? "," : "", addr);
+        json += buf;
+    }
+    snprintf(buf, sizeof(buf), "],\"max_channels\":%d}", MAX_SENSOR_CHANNELS);
+    json += buf;
+    server.send(200, "application/json", json);
 }
-static void handleSensorReassign() {
+// POST ch=<idx> type=ds18b20|ntc role=chamber|meat|smoke|ambient src=<ROM hex|pin>
+//      [name=] [offset=] - ch równy liczbie kanałów dodaje nowy; delete=1 usuwa
+static void handleSensorChannel() {
     if (!requireAuth()) return;
-    if (server.hasArg("chamber1") && server.hasArg("chamber2")) {
-        int c1 = server.arg("chamber1").toInt(), c2 = server.arg("chamber2").toInt();
-        if (c1 >= 0 && c2 >= 0 && c1 != c2) {
-            chamberSensor1Index = c1; chamberSensor2Index = c2; sensorsIdentified = true;
-            server.send(200,"application/json","{\"status\":\"ok\"}");
-        } else server.send(400,"application/json","{\"error\":\"Invalid indices\"}");
-    } else server.send(400,"application/json","{\"error\":\"Missing parameters\"}");
+    if (!server.hasArg("ch")) { server.send(400,"application/json","{\"error\":\"Missing ch\"}"); return; }
+    int ch = server.arg("ch").toInt();
+
+    if (server.arg("delete") == "1") {
+        if (sensors_remove_channel(ch)) server.send(200,"application/json","{\"status\":\"ok\"}");
+        else server.send(400,"application/json","{\"error\":\"Cannot remove channel\"}");
+        return;
+    }
+
+    SensorChannel c;
+    memset(&c, 0, sizeof(c));
+    String type = server.arg("type");
+    String src  = server.arg("src");
+    if (type == "ds18b20") {
+        c.type = (uint8_t)SensorType::DS18B20;
+        if (!sensors_rom_from_str(src.c_str(), c.rom)) {
+            server.send(400,"application/json","{\"error\":\"Invalid ROM\"}");
+            return;
+        }
+    } else if (type == "ntc") {
+        c.type = (uint8_t)SensorType::NTC;
+        c.pin  = (uint8_t)src.toInt();
+    } else {
+        server.send(400,"application/json","{\"error\":\"Invalid type\"}");
+        return;
+    }
+    if (!sensors_role_from_name(server.arg("role").c_str(), c.role)) {
+        server.send(400,"application/json","{\"error\":\"Invalid role\"}");
+        return;
+    }
+    String name = server.hasArg("name") ? server.arg("name") : String(sensors_type_name(c.type));
+    strncpy(c.name, name.c_str(), sizeof(c.name) - 1);
+    c.offset = server.hasArg("offset") ? server.arg("offset").toFloat() : 0.0f;
+
+    if (sensors_set_channel(ch, c)) server.send(200,"application/json","{\"status\":\"ok\"}");
+    else server.send(400,"application/json","{\"error\":\"Invalid channel\"}");
 }
 static void handleSensorAutoDetect() {
     if (!requireAuth()) return;
-    identifyAndAssignSensors();
-    server.send(areSensorsIdentified()?200:500,"application/json",
-        areSensorsIdentified()?"{\"message\":\"OK\"}":"{\"error\":\"Failed\"}");
+    bool ok = autoDetectAndAssignSensors();
+    server.send(ok?200:500,"application/json",
+        ok?"{\"message\":\"OK\"}":"{\"error\":\"Failed\"}");
+}
+
+// [NEW] Pin sondy NTC dla endpointów kalibracji (?pin=, domyślnie PIN_NTC)
+static uint8_t calibrationPinArg() {
+    if (!server.hasArg("pin")) return PIN_NTC;
+    int pin = server.arg("pin").toInt();
+    return ntc_scanner_pin_ok(pin) ? (uint8_t)pin : PIN_NTC;
+}
+
+// [NEW] Łańcuch filtrów per kanał
+static void handleFilterInfo() {
+    if (!requireAuth()) return;
+    server.send(200, "application/json", sensors_filters_json());
+}
+// POST ch=<0..> [stages=spike,median,ema] [median=] [spike_step=] [spike_rejects=]
+//      [ema_alpha=] [kalman_q=] [kalman_r=] [save=0] - brakujące pola bez zmian
+static void handleFilterSet() {
+    if (!requireAuth()) return;
+    if (!server.hasArg("ch")) { server.send(400,"application/json","{\"error\":\"Missing ch\"}"); return; }
+    int ch = server.arg("ch").toInt();
+    FilterConfig cfg;
+    if (!sensors_filter_get(ch, cfg)) { server.send(400,"application/json","{\"error\":\"Invalid ch\"}"); return; }
+
+    if (server.hasArg("stages") && !filter_stages_from_string(cfg, server.arg("stages").c_str())) {
+        server.send(400,"application/json","{\"error\":\"Invalid stages\"}");
+        return;
+    }
+    if (server.hasArg("median"))        cfg.medianWindow    = (uint8_t)server.arg("median").toInt();
+    if (server.hasArg("spike_step"))    cfg.spikeMaxStep    = server.arg("spike_step").toFloat();
+    if (server.hasArg("spike_rejects")) cfg.spikeMaxRejects = (uint8_t)server.arg("spike_rejects").toInt();
+    if (server.hasArg("ema_alpha"))     cfg.emaAlpha        = server.arg("ema_alpha").toFloat();
+    if (server.hasArg("kalman_q"))      cfg.kalmanQ         = server.arg("kalman_q").toFloat();
+    if (server.hasArg("kalman_r"))      cfg.kalmanR         = server.arg("kalman_r").toFloat();
+
+    bool persist = !(server.hasArg("save") && server.arg("save") == "0");
+    if (!sensors_filter_set(ch, cfg, persist)) {
+        server.send(400,"application/json","{\"error\":\"Invalid filter config\"}");
+        return;
+    }
+    LOG_FMT(LOG_LEVEL_INFO, "Filter ch%d updated (persist=%d)", ch, persist);
+    server.send(200,"application/json","{\"status\":\"ok\"}");
+}
+
+// [NEW] Obserwator temperatury powietrza
+static void handleEstimatorInfo() {
+    if (!requireAuth()) return;
+    server.send(200, "application/json", estimator_json());
+}
+// POST [use_pid=0|1] [tau_probe=] [tau_air=] [heater_gain=] [ambient=] [q_air=] [q_dist=]
+//      [r_meas=] [max_dev=] [save=0] - brakujące pola bez zmian
+static void handleEstimatorSet() {
+    if (!requireAuth()) return;
+    EstimatorConfig cfg;
+    if (!estimator_get_config(cfg)) { server.send(503,"application/json","{\"error\":\"Busy\"}"); return; }
+
+    if (server.hasArg("use_pid"))     cfg.usePid       = server.arg("use_pid").toInt() ? 1 : 0;
+    if (server.hasArg("tau_probe"))   cfg.tauProbe     = server.arg("tau_probe").toFloat();
+    if (server.hasArg("tau_air"))     cfg.tauAir       = server.arg("tau_air").toFloat();
+    if (server.hasArg("heater_gain")) cfg.heaterGain   = server.arg("heater_gain").toFloat();
+    if (server.hasArg("ambient"))     cfg.ambient      = server.arg("ambient").toFloat();
+    if (server.hasArg("q_air"))       cfg.qAir         = server.arg("q_air").toFloat();
+    if (server.hasArg("q_dist"))      cfg.qDist        = server.arg("q_dist").toFloat();
+    if (server.hasArg("r_meas"))      cfg.rMeas        = server.arg("r_meas").toFloat();
+    if (server.hasArg("max_dev"))     cfg.maxDeviation = server.arg("max_dev").toFloat();
+
+    bool persist = !(server.hasArg("save") && server.arg("save") == "0");
+    if (!estimator_set_config(cfg, persist)) {
+        server.send(400,"application/json","{\"error\":\"Invalid estimator config\"}");
+        return;
+    }
+    LOG_FMT(LOG_LEVEL_INFO, "Estimator updated (pid=%d, persist=%d)", cfg.usePid, persist);
+    server.send(200,"application/json","{\"status\":\"ok\"}");
+}
+
+// [NEW] Sterownik SSR grzałek
+static void handleSsrInfo() {
+    if (!requireAuth()) return;
+    server.send(200, "application/json", ssr_json());
+}
+// POST [mode=burst|time_proportional] [window_ms=] [min_on_ms=] [save=0]
+static void handleSsrSet() {
+    if (!requireAuth()) return;
+    SsrConfig cfg;
+    ssr_get_config(cfg);
+
+    if (server.hasArg("mode")) {
+        String m = server.arg("mode");
+        if (m == "burst")                  cfg.mode = (uint8_t)SsrMode::BURST;
+        else if (m == "time_proportional") cfg.mode = (uint8_t)SsrMode::TIME_PROPORTIONAL;
+        else { server.send(400,"application/json","{\"error\":\"Invalid mode\"}"); return; }
+    }
+    if (server.hasArg("window_ms")) cfg.windowMs = (uint16_t)server.arg("window_ms").toInt();
+    if (server.hasArg("min_on_ms")) cfg.minOnMs  = (uint16_t)server.arg("min_on_ms").toInt();
+
+    bool persist = !(server.hasArg("save") && server.arg("save") == "0");
+    if (!ssr_set_config(cfg, persist)) {
+        server.send(400,"application/json","{\"error\":\"Invalid SSR config\"}");
+        return;
+    }
+    LOG_FMT(LOG_LEVEL_INFO, "SSR driver updated (mode=%d, window=%u, min_on=%u, persist=%d)",
+            cfg.mode, cfg.windowMs, cfg.minOnMs, persist);
+    server.send(200,"application/json","{\"status\":\"ok\"}");
+}
+
+// [NEW] Rotacja grzałek i liczniki czasu pracy
+static void handleHeatersInfo() {
+    if (!requireAuth()) return;
+    server.send(200, "application/json", heater_rot_json());
+}
+// POST [rotation=off|per_run|hourly] [reset=1]
+static void handleHeatersSet() {
+    if (!requireAuth()) return;
+    if (server.hasArg("rotation")) {
+        String m = server.arg("rotation");
+        HeaterRotation mode;
+        if (m == "off")          mode = HeaterRotation::OFF;
+        else if (m == "per_run") mode = HeaterRotation::PER_RUN;
+        else if (m == "hourly")  mode = HeaterRotation::HOURLY;
+        else { server.send(400,"application/json","{\"error\":\"Invalid rotation\"}"); return; }
+        if (!heater_rot_set_mode(mode)) { server.send(503,"application/json","{\"error\":\"Busy\"}"); return; }
+    }
+    if (server.hasArg("reset") && server.arg("reset") == "1") heater_rot_reset_counters();
+    server.send(200,"application/json","{\"status\":\"ok\"}");
+}
+
+// [NEW] Energia grzałek: moce, cena kWh, bieżący proces
+static void handleEnergyInfo() {
+    if (!requireAuth()) return;
+    server.send(200, "application/json", energy_json());
+}
+// POST [watts=1500,1500,1500] [price=0.95]
+static void handleEnergySet() {
+    if (!requireAuth()) return;
+    EnergyConfig cfg;
+    if (!energy_get_config(cfg)) { server.send(503,"application/json","{\"error\":\"Busy\"}"); return; }
+    if (server.hasArg("watts")) {
+        unsigned w[3];
+        if (sscanf(server.arg("watts").c_str(), "%u,%u,%u", &w[0], &w[1], &w[2]) != 3 ||
+            w[0] > ENERGY_MAX_W || w[1] > ENERGY_MAX_W || w[2] > ENERGY_MAX_W) {
+            server.send(400,"application/json","{\"error\":\"Invalid watts\"}");
+            return;
+        }
+        for (int i = 0; i < 3; i++) cfg.watts[i] = (uint16_t)w[i];
+    }
+    if (server.hasArg("price")) cfg.pricePerKwh = server.arg("price").toFloat();
+    if (!energy_set_config(cfg)) { server.send(400,"application/json","{\"error\":\"Invalid energy config\"}"); return; }
+    LOG_FMT(LOG_LEVEL_INFO, "Energy config: %u/%u/%u W, %.2f/kWh",
+            cfg.watts[0], cfg.watts[1], cfg.watts[2], cfg.pricePerKwh);
+    server.send(200,"application/json","{\"status\":\"ok\"}");
+}
+
+// [NEW] Rywalizacja o mutexy + odczyty migawki stanu
+static void handleLockStats() {
+    if (!requireAuth()) return;
+    server.send(200, "application/json", state_lock_stats_json());
+}
+
+// [NEW] Takt taskControl - POST zeruje liczniki
+static void handlePerfInfo() {
+    if (!requireAuth()) return;
+    server.send(200, "application/json", tasks_perf_json());
+}
+static void handlePerfReset() {
+    if (!requireAuth()) return;
+    tasks_perf_reset();
+    server.send(200, "application/json", tasks_perf_json());
+}
+
+// [NEW] Autotune PID
+static void handleAutotuneInfo() {
+    if (!requireAuth()) return;
+    server.send(200, "application/json", autotune_json());
+}
+// POST setpoint=<°C> power_mode=<1..3>
+static void handleAutotuneStart() {
+    if (!requireAuth()) return;
+    if (!server.hasArg("setpoint") || !server.hasArg("power_mode")) {
+        server.send(400,"application/json","{\"error\":\"Missing setpoint/power_mode\"}");
+        return;
+    }
+    double sp = server.arg("setpoint").toFloat();
+    int pm = server.arg("power_mode").toInt();
+    if (!process_start_autotune(sp, pm)) {
+        server.send(409,"application/json","{\"error\":\"Cannot start (process running, door open or invalid args)\"}");
+        return;
+    }
+    server.send(200,"application/json","{\"status\":\"ok\"}");
+}
+static void handleAutotuneStop() {
+    if (!requireAuth()) return;
+    process_stop_autotune();
+    server.send(200,"application/json","{\"status\":\"ok\"}");
+}
+// POST power_mode=<1..3> - powrót do nastaw domyślnych
+static void handleAutotuneClear() {
+    if (!requireAuth()) return;
+    int pm = server.arg("power_mode").toInt();
+    if (pm < CFG_POWERMODE_MIN || pm > CFG_POWERMODE_MAX) {
+        server.send(400,"application/json","{\"error\":\"Invalid power_mode\"}");
+        return;
+    }
+    process_clear_tuning(pm);
+    server.send(200,"application/json","{\"status\":\"ok\"}");
+}
+
+// [NEW] Harmonogram nastaw PID
+static void handleScheduleInfo() {
+    if (!requireAuth()) return;
+    server.send(200, "application/json", schedule_json());
+}
+// POST sp= pm= kp= ki= kd=  - dodanie/zastąpienie punktu
+//      delete=<i>           - usunięcie punktu
+//      adaptive=0|1         - heurystyka adaptacji jako warstwa na harmonogramie
+static void handleScheduleSet() {
+    if (!requireAuth()) return;
+    bool ok = true;
+    if (server.hasArg("adaptive")) {
+        ok = process_set_adaptive(server.arg("adaptive").toInt() != 0);
+    } else if (server.hasArg("delete")) {
+        ok = process_remove_schedule_point(server.arg("delete").toInt());
+    } else {
+        if (!server.hasArg("sp") || !server.hasArg("pm") || !server.hasArg("kp") ||
+            !server.hasArg("ki") || !server.hasArg("kd")) {
+            server.send(400,"application/json","{\"error\":\"Missing sp/pm/kp/ki/kd\"}");
+            return;
+        }
+        GainPoint p = {};
+        p.setpoint  = server.arg("sp").toFloat();
+        p.powerMode = (uint8_t)server.arg("pm").toInt();
+        p.kp        = server.arg("kp").toFloat();
+        p.ki        = server.arg("ki").toFloat();
+        p.kd        = server.arg("kd").toFloat();
+        p.source    = (uint8_t)GainSource::USER;
+        ok = process_set_schedule_point(p);
+    }
+    if (!ok) {
+        server.send(400,"application/json","{\"error\":\"Invalid point or table full\"}");
+        return;
+    }
+    server.send(200,"application/json","{\"status\":\"ok\"}");
+}
+
+// [NEW] Historia pomiarów z RAM
+static void handleHistoryInfo() {
+    if (!requireAuth()) return;
+    server.send(200, "application/json", history_info_json());
+}
+// GET tier=0|1|2 series=<ch>|pid|h1|h2|h3 [since=<s>] [max=<n>]
+// -> {"tier":1,"series":0,"period":60,"points":[[t,avg,min,max],...]}, null = brak odczytu
+static void handleHistoryGet() {
+    if (!requireAuth()) return;
+    int tier = server.hasArg("tier") ? server.arg("tier").toInt() : 0;
+    String s = server.arg("series");
+    int series;
+    if      (s == "pid") series = HIST_SERIES_PID;
+    else if (s == "h1")  series = HIST_SERIES_H1;
+    else if (s == "h2")  series = HIST_SERIES_H2;
+    else if (s == "h3")  series = HIST_SERIES_H3;
+    else if (s.length() > 0 && isDigit(s[0])) series = s.toInt();
+    else series = -1;
+    if (tier < 0 || tier >= HIST_TIERS || series < 0 || series >= HIST_SERIES_COUNT) {
+        server.send(400,"application/json","{\"error\":\"Invalid tier/series\"}");
+        return;
+    }
+    uint32_t since = server.hasArg("since") ? (uint32_t)server.arg("since").toInt() : 0;
+    int maxPts = server.hasArg("max") ? server.arg("max").toInt() : HIST_TIER1_SLOTS;
+    maxPts = constrain(maxPts, 1, HIST_TIER1_SLOTS);
+
+    // Porcjami po 32 punkty - bez dużego bufora na cały wynik
+    static constexpr int CHUNK = 32;
+    HistPoint pts[CHUNK];
+    char line[64];
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/json", "");
+    snprintf(line, sizeof(line), "{\"tier\":%d,\"series\":%d,\"period\":%lu,\"points\":[",
+             tier, series, (unsigned long)history_tier_period(tier));
+    server.sendContent(line);
+
+    bool first = true;
+    int sent = 0;
+    while (sent < maxPts) {
+        int n = history_read(tier, series, since, pts, min(CHUNK, maxPts - sent));
+        if (n <= 0) break;
+        String chunk;
+        chunk.reserve(n * 32);
+        for (int i = 0; i < n; i++) {
+            if (pts[i].valid) {
+                snprintf(line, sizeof(line), "%s[%lu,%.1f,%.1f,%.1f]", first ? "" : ",",
+                         (unsigned long)pts[i].t, pts[i].avg, pts[i].min, pts[i].max);
+            } else {
+                snprintf(line, sizeof(line), "%s[%lu,null,null,null]", first ? "" : ",",
+                         (unsigned long)pts[i].t);
+            }
+            chunk += line;
+            first = false;
+        }
+        server.sendContent(chunk);
+        since = pts[n - 1].t;
+        sent += n;
+        if (n < CHUNK) break;
+    }
+    server.sendContent("]}");
+    server.sendContent("");
 }
 
 // =================================================================
@@ -962,8 +1395,30 @@ void web_server_init() {
         server.send(200, "application/json", json);
     });
     server.on("/api/sensors",         HTTP_GET,  handleSensorInfo);
-    server.on("/api/sensors/reassign",   HTTP_POST, handleSensorReassign);
+    server.on("/api/sensors/channel",    HTTP_POST, handleSensorChannel);
     server.on("/api/sensors/autodetect", HTTP_POST, handleSensorAutoDetect);
+    server.on("/api/filters",            HTTP_GET,  handleFilterInfo);
+    server.on("/api/filters",            HTTP_POST, handleFilterSet);
+    server.on("/api/estimator",          HTTP_GET,  handleEstimatorInfo);
+    server.on("/api/estimator",          HTTP_POST, handleEstimatorSet);
+    server.on("/api/ssr",                HTTP_GET,  handleSsrInfo);
+    server.on("/api/ssr",                HTTP_POST, handleSsrSet);
+    server.on("/api/heaters",            HTTP_GET,  handleHeatersInfo);
+    server.on("/api/heaters",            HTTP_POST, handleHeatersSet);
+    server.on("/api/energy",             HTTP_GET,  handleEnergyInfo);
+    server.on("/api/energy",             HTTP_POST, handleEnergySet);
+    server.on("/api/locks",              HTTP_GET,  handleLockStats);
+    server.on("/api/perf",               HTTP_GET,  handlePerfInfo);
+    server.on("/api/perf",               HTTP_POST, handlePerfReset);
+    server.on("/api/history",            HTTP_GET,  handleHistoryGet);
+    server.on("/api/autotune",           HTTP_GET,  handleAutotuneInfo);
+    server.on("/api/autotune/start",     HTTP_POST, handleAutotuneStart);
+    server.on("/api/autotune/stop",      HTTP_POST, handleAutotuneStop);
+    server.on("/api/autotune/clear",     HTTP_POST, handleAutotuneClear);
+    server.on("/api/pid/schedule",       HTTP_GET,  handleScheduleInfo);
+    server.on("/api/pid/schedule",       HTTP_POST, handleScheduleSet);
+    server.on("/api/history/info",       HTTP_GET,  handleHistoryInfo);
+    server.on("/api/runs",               HTTP_GET,  handleRuns);
 
     // -- Flash API ----------------------------------------------
     server.on("/flash/info",   HTTP_GET,  handleFlashInfo);
@@ -977,6 +1432,7 @@ void web_server_init() {
         { "/flash2",   "/web/flash2.html",   false },
         { "/creator",  "/web/creator.html",  false },
         { "/sensors",  "/web/sensors.html",  false },
+        { "/pid",      "/web/pid.html",      false },
         { "/sysinfo",  "/web/sysinfo.html",  false },
         { "/update",   "/web/update.html",   false },
         { "/auth/set", "/web/auth_set.html", false },
@@ -1031,6 +1487,7 @@ void web_server_init() {
         if (!requireAuth()) return;
         if (!server.hasArg("name")||!server.hasArg("source")){server.send(400,"text/plain","Brak parametrów");return;}
         String name=server.arg("name"),src=server.arg("source");
+        if (storage_profile_in_use()){server.send(409,"text/plain","Proces w toku - profil zablokowany.");return;}   // [FIX]
         bool ok=false;
         if (src=="sd"){ storage_save_profile_path_nvs(("/profiles/"+name).c_str()); ok=storage_load_profile(); }
         else if (src=="github"){ storage_save_profile_path_nvs(("github:"+name).c_str()); ok=storage_load_github_profile(name.c_str()); }
@@ -1053,6 +1510,7 @@ void web_server_init() {
     });
     server.on("/profile/reload", HTTP_GET, [](){
         if (!requireAuth()) return;
+        if (storage_profile_in_use()){server.send(409,"text/plain","Proces w toku - profil zablokowany.");return;}   // [FIX]
         if (storage_reinit_flash()){storage_load_profile();server.send(200,"text/plain","Flash odświeżony.");}
         else server.send(500,"text/plain","Błąd reinicjalizacji!");
     });
@@ -1062,7 +1520,7 @@ void web_server_init() {
         if (!requireAuth()) return;
         state_lock();
         if (g_currentState==ProcessState::RUNNING_AUTO&&g_currentStep<g_stepCount)
-            g_profile[g_currentStep].minTimeMs=0;
+            profile_step_skip(g_profile,g_currentStep);   // [MOD] minTime 0, bez exit=
         state_unlock();
         server.send(200,"text/plain","OK");
     });
@@ -1079,6 +1537,7 @@ void web_server_init() {
     });
     server.on("/auto/start", HTTP_GET, [](){
         if (!requireAuth()) return;
+        if (storage_profile_in_use()){server.send(409,"text/plain","Proces w toku");return;}   // [FIX]
         if (storage_load_profile()){process_start_auto();server.send(200,"text/plain","OK");}
         else server.send(500,"text/plain","Profile error");
     });
@@ -1322,12 +1781,19 @@ void web_server_init() {
     });
 
     // Aktualny surowy ADC + temperatura - do live podgladu w kalibratorze
+    // [MOD] ?pin= wybiera sondę NTC (domyślnie PIN_NTC)
     server.on("/api/ntc_raw", HTTP_GET, [](){
+        uint8_t pin = calibrationPinArg();
+        SensorChannel table[MAX_SENSOR_CHANNELS];
+        SensorReading rd[MAX_SENSOR_CHANNELS];
+        int count = sensors_copy_table(table, rd);
         double adc = 0, temp = 0;
-        if (state_lock()) {
-            adc  = g_ntcAdc;
-            temp = g_tMeat;
-            state_unlock();
+        for (int ch = 0; ch < count; ch++) {
+            if (table[ch].type == (uint8_t)SensorType::NTC && table[ch].pin == pin) {
+                adc  = rd[ch].adc;
+                temp = rd[ch].value;
+                break;
+            }
         }
         char json[64];
         snprintf(json, sizeof(json), "{\"adc\":%.1f,\"temp\":%.2f}", adc, temp);
@@ -1336,7 +1802,7 @@ void web_server_init() {
 
     // Status kalibracji - czy aktywna
     server.on("/calibrate/status", HTTP_GET, [](){
-        bool active = calibration_is_active();
+        bool active = calibration_is_active(calibrationPinArg());
         char json[32];
         snprintf(json, sizeof(json), "{\"active\":%s}", active?"true":"false");
         server.send(200, "application/json", json);
@@ -1350,8 +1816,7 @@ void web_server_init() {
             server.send(400, "application/json", "{\"ok\":false,\"message\":\"Puste body\"}");
             return;
         }
-        if (calibration_save_from_json(body)) {
-            calibration_load();  // przeladuj natychmiast
+        if (calibration_save_from_json(calibrationPinArg(), body)) {
             server.send(200, "application/json", "{\"ok\":true}");
         } else {
             server.send(500, "application/json", "{\"ok\":false,\"message\":\"Blad zapisu\"}");
@@ -1360,13 +1825,13 @@ void web_server_init() {
 
     // Wczytaj kalibracje z flash
     server.on("/calibrate/load", HTTP_GET, [](){
-        server.send(200, "application/json", calibration_load_as_json());
+        server.send(200, "application/json", calibration_load_as_json(calibrationPinArg()));
     });
 
     // Wyczysc kalibracje
     server.on("/calibrate/clear", HTTP_POST, [](){
         if (!requireAuth()) return;
-        calibration_clear();
+        calibration_clear(calibrationPinArg());
         server.send(200, "application/json", "{\"ok\":true}");
     });
 